@@ -0,0 +1,135 @@
+#include <ctime>
+#include <iostream>
+#include <vector>
+#include <string>
+#include "../src/GHPR.h"
+#include "../src/readtxt.h"
+
+///************************************************************************///
+// a benchmark to compare the hull index recovery of GHPR
+// input files are the dumps of ConfidenceMap::OutputOcclusionClouds
+// each line is "x y z visibility", the last line is the viewpoint with label 2
+// usage: ghpr_benchmark [repeat times] PC_xxx.txt [PC_xxx.txt ...]
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - compare QuickHull vertex indexing with qhull + kdtree index recovery
+
+///************************************************************************///
+
+//compute the time cost in millisecond
+double ElapsedMs(const clock_t & oBegin){
+
+	return double(clock() - oBegin) * 1000.0 / CLOCKS_PER_SEC;
+
+}
+
+//count the different labels of two visibility results
+int CountDifference(const std::vector<bool> & vResOne,
+	                const std::vector<bool> & vResTwo){
+
+	if (vResOne.size() != vResTwo.size())
+		return -1;
+
+	int iDiffNum = 0;
+	for (size_t i = 0; i != vResOne.size(); ++i)
+		if (vResOne[i] != vResTwo[i])
+			iDiffNum++;
+
+	return iDiffNum;
+
+}
+
+int main(int argc, char ** argv){
+
+	if (argc < 2){
+		std::cout << "usage: ghpr_benchmark [repeat times] PC_xxx.txt [PC_xxx.txt ...]" << std::endl;
+		return 1;
+	}
+
+	//the first argument is the repeat times if it is a number
+	int iRepeatNum = 1;
+	int iFileBegin = 1;
+	if (atoi(argv[1]) > 0){
+		iRepeatNum = atoi(argv[1]);
+		iFileBegin = 2;
+	}
+
+	//the same parameter as ConfidenceMap
+	topology_map::GHPR oGHPRer(3.7);
+
+	double dTotalNewMs = 0.0;
+	double dTotalOldMs = 0.0;
+
+	for (int f = iFileBegin; f < argc; ++f){
+
+		//read the dump
+		std::vector<std::vector<double>> vDumpRows;
+		ReadMatrix(argv[f], vDumpRows);
+
+		//remove empty lines
+		std::vector<std::vector<double>> vRows;
+		for (size_t i = 0; i != vDumpRows.size(); ++i)
+			if (vDumpRows[i].size() >= 4)
+				vRows.push_back(vDumpRows[i]);
+
+		if (vRows.size() < 4){
+			std::cout << argv[f] << ": not enough points, skipped" << std::endl;
+			continue;
+		}
+
+		//the last line is the viewpoint
+		pcl::PointXYZ oViewPoint;
+		oViewPoint.x = vRows.back()[0];
+		oViewPoint.y = vRows.back()[1];
+		oViewPoint.z = vRows.back()[2];
+		vRows.pop_back();
+
+		pcl::PointCloud<pcl::PointXYZ> vCloud;
+		std::vector<bool> vRecordRes;
+		for (size_t i = 0; i != vRows.size(); ++i){
+			pcl::PointXYZ oPoint;
+			oPoint.x = vRows[i][0];
+			oPoint.y = vRows[i][1];
+			oPoint.z = vRows[i][2];
+			vCloud.push_back(oPoint);
+			vRecordRes.push_back(vRows[i][3] > 0.5);
+		}
+
+		//new path - direct hull vertex indexing
+		std::vector<bool> vNewRes;
+		clock_t oBegin = clock();
+		for (int r = 0; r != iRepeatNum; ++r)
+			vNewRes = oGHPRer.ComputeVisibility(vCloud, oViewPoint);
+		double dNewMs = ElapsedMs(oBegin) / iRepeatNum;
+
+		//old path - qhull and kdtree matching
+		std::vector<bool> vOldRes;
+		oBegin = clock();
+		for (int r = 0; r != iRepeatNum; ++r)
+			vOldRes = oGHPRer.ComputeVisibilityQhull(vCloud, oViewPoint, true);
+		double dOldMs = ElapsedMs(oBegin) / iRepeatNum;
+
+		dTotalNewMs += dNewMs;
+		dTotalOldMs += dOldMs;
+
+		int iVisibleNum = 0;
+		for (size_t i = 0; i != vNewRes.size(); ++i)
+			if (vNewRes[i])
+				iVisibleNum++;
+
+		std::cout << argv[f] << ": points " << vCloud.size()
+		          << ", visible " << iVisibleNum
+		          << ", direct " << dNewMs << " ms"
+		          << ", kdtree " << dOldMs << " ms"
+		          << ", differ from kdtree " << CountDifference(vNewRes, vOldRes)
+		          << ", differ from dump " << CountDifference(vNewRes, vRecordRes)
+		          << std::endl;
+
+	}//end for f
+
+	std::cout << "total: direct " << dTotalNewMs << " ms, kdtree " << dTotalOldMs << " ms" << std::endl;
+
+	return 0;
+
+}
@@ -0,0 +1,162 @@
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <string>
+#include "../src/BranchBound.h"
+#include "../src/AnytimeOP.h"
+#include "../src/readtxt.h"
+
+///************************************************************************///
+// a benchmark to compare the solvers of orienteering problem in BranchBound
+// each input file is a node set, each line is "x y totalvalue" of one node,
+// the first line is the current robot node (the beginning of travel)
+// the objective is the same as OP::ObjectiveFunction (distance / max(1 - totalvalue, 0.5))
+// usage: op_benchmark NodeSet_xxx.txt [NodeSet_xxx.txt ...]
+//        op_benchmark random [node number] [set number]
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - compare the raw branch and bound with dynamic programming and pruned branch and bound
+// - compare the anytime solver in a 50 ms budget
+
+///************************************************************************///
+
+//compute the time cost in millisecond
+double ElapsedMs(const clock_t & oBegin){
+
+	return double(clock() - oBegin) * 1000.0 / CLOCKS_PER_SEC;
+
+}
+
+//the objective matrix of a node set, the same as OP::ObjectiveFunction
+void NodeSetMatrix(std::vector<std::vector<float> > & vObjectMatrix,
+	               const std::vector<std::vector<double> > & vNodeRows){
+
+	vObjectMatrix.assign(vNodeRows.size(), std::vector<float>(vNodeRows.size(), 0.0));
+
+	for (size_t i = 0; i != vNodeRows.size(); ++i){
+		for (size_t j = 0; j != vNodeRows.size(); ++j){
+
+			float fCost = sqrt(pow(vNodeRows[i][0] - vNodeRows[j][0], 2.0)
+				             + pow(vNodeRows[i][1] - vNodeRows[j][1], 2.0));
+
+			float fReward = 1.0 - vNodeRows[j][2];
+			if (fReward < 0.5)
+				fReward = 0.5;
+
+			vObjectMatrix[i][j] = fCost / fReward;
+
+		}
+	}
+
+}
+
+//run the solvers on one node set
+void RunNodeSet(const std::string & sName,
+	            const std::vector<std::vector<double> > & vNodeRows){
+
+	std::vector<std::vector<float> > vObjectMatrix;
+	NodeSetMatrix(vObjectMatrix, vNodeRows);
+
+	topology_map::BranchBound oBBSolver(5);
+	oBBSolver.ObjectiveMatrix(vObjectMatrix);
+
+	std::vector<int> vResTour;
+
+	//dynamic programming (exact)
+	double dDPMs = -1.0;
+	float fDPCost = -1.0;
+	if (vNodeRows.size() <= 20){
+		oBBSolver.SetDPMaxNodeNum(20);
+		clock_t oBegin = clock();
+		fDPCost = oBBSolver.SolveOPExact(vResTour);
+		dDPMs = ElapsedMs(oBegin);
+	}
+
+	//pruned branch and bound
+	oBBSolver.SetDPMaxNodeNum(0);
+	clock_t oBegin = clock();
+	float fPrunedCost = oBBSolver.SolveOPExact(vResTour);
+	double dPrunedMs = ElapsedMs(oBegin);
+
+	//anytime solver in a budget of 50 ms
+	topology_map::AnytimeOP oAnytimeSolver;
+	std::vector<int> vGreedyTour;
+	topology_map::AnytimeOP::GreedyTour(vObjectMatrix, vGreedyTour);
+	float fGreedyCost = topology_map::AnytimeOP::TourCost(vObjectMatrix, vGreedyTour);
+	oBegin = clock();
+	float fAnytimeCost = oAnytimeSolver.Solve(vObjectMatrix, vGreedyTour, vResTour, 50.0);
+	double dAnytimeMs = ElapsedMs(oBegin);
+
+	//raw branch and bound, which is too slow for large node sets
+	double dRawMs = -1.0;
+	float fRawCost = -1.0;
+	if (vNodeRows.size() <= 11){
+		oBegin = clock();
+		fRawCost = oBBSolver.SolveOP(vResTour);
+		dRawMs = ElapsedMs(oBegin);
+	}
+
+	std::cout << sName << ": nodes " << vNodeRows.size()
+	          << ", dp " << fDPCost << " (" << dDPMs << " ms)"
+	          << ", pruned bb " << fPrunedCost << " (" << dPrunedMs << " ms)"
+	          << ", raw bb " << fRawCost << " (" << dRawMs << " ms)"
+	          << ", greedy " << fGreedyCost
+	          << ", anytime " << fAnytimeCost << " (" << dAnytimeMs << " ms)"
+	          << std::endl;
+
+}
+
+int main(int argc, char ** argv){
+
+	if (argc < 2){
+		std::cout << "usage: op_benchmark NodeSet_xxx.txt [NodeSet_xxx.txt ...]" << std::endl;
+		std::cout << "       op_benchmark random [node number] [set number]" << std::endl;
+		return 1;
+	}
+
+	//random node sets in a 50m x 50m region
+	if (std::string(argv[1]) == "random"){
+
+		int iNodeNum = argc > 2 ? atoi(argv[2]) : 12;
+		int iSetNum = argc > 3 ? atoi(argv[3]) : 10;
+		srand(0);
+
+		for (int s = 0; s != iSetNum; ++s){
+			std::vector<std::vector<double> > vNodeRows(iNodeNum, std::vector<double>(3, 0.0));
+			for (int i = 0; i != iNodeNum; ++i){
+				vNodeRows[i][0] = (rand() % 5000) / 100.0;
+				vNodeRows[i][1] = (rand() % 5000) / 100.0;
+				vNodeRows[i][2] = (rand() % 100) / 100.0;
+			}
+			RunNodeSet("random set " + std::to_string(s), vNodeRows);
+		}
+
+		return 0;
+
+	}
+
+	for (int f = 1; f < argc; ++f){
+
+		std::vector<std::vector<double> > vFileRows;
+		ReadMatrix(argv[f], vFileRows);
+
+		//remove empty lines
+		std::vector<std::vector<double> > vNodeRows;
+		for (size_t i = 0; i != vFileRows.size(); ++i)
+			if (vFileRows[i].size() >= 3)
+				vNodeRows.push_back(vFileRows[i]);
+
+		if (vNodeRows.size() < 2){
+			std::cout << argv[f] << ": not enough nodes, skipped" << std::endl;
+			continue;
+		}
+
+		RunNodeSet(argv[f], vNodeRows);
+
+	}//end for f
+
+	return 0;
+
+}
@@ -0,0 +1,724 @@
+#include "AnytimeOP.h"
+
+namespace topology_map {
+
+/*************************************************
+Function: AnytimeOP
+Description: constrcution function for AnytimeOP class
+Calls: none
+Called By: OP
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the random kicks use a fixed seed so that a plan can be repeated
+*************************************************/
+AnytimeOP::AnytimeOP():m_oRandom(0),
+                       m_bStopFlag(false),
+                       m_iBackNodeNum(0),
+                       m_fBackBestCost(-1.0){
+
+}
+
+/*************************************************
+Function: ~AnytimeOP
+Description: destrcution function for AnytimeOP class
+Calls: StopBackground
+Called By: ~OP
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+AnytimeOP::~AnytimeOP(){
+
+	std::vector<int> vTour;
+	StopBackground(vTour);
+
+}
+
+/*************************************************
+Function: Solve
+Description: solve the non-loop travel from node 0 in a time budget
+Calls: FlattenMatrix
+       IsValidTour
+       GreedyTour
+       ImproveTour
+Called By: OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes, vObjectMatrix[i][j] is from i to j
+       vSeedTour - the initial tour starting with 0, an empty or invalid one means the greedy tour
+       dBudgetMs - the time budget in millisecond
+Output: vResTour - the best tour found, which starts with 0
+Return: the cost of vResTour
+Others: the local search is checked against the budget after each pass,
+        so the time may exceed the budget by one pass (about n * n moves)
+*************************************************/
+float AnytimeOP::Solve(const std::vector<std::vector<float> > & vObjectMatrix,
+	                   const std::vector<int> & vSeedTour,
+	                   std::vector<int> & vResTour,
+	                   const double & dBudgetMs){
+
+	int iNodeNum = int(vObjectMatrix.size());
+	vResTour.clear();
+
+	if (!iNodeNum)
+		return 0.0;
+
+	if (iNodeNum == 1){
+		vResTour.push_back(0);
+		return 0.0;
+	}
+
+	TimePoint oDeadline = std::chrono::steady_clock::now()
+	                    + std::chrono::microseconds(int64_t(std::max(dBudgetMs, 0.0) * 1000.0));
+
+	std::vector<float> vFlatMatrix;
+	FlattenMatrix(vObjectMatrix, vFlatMatrix);
+
+	//the initial tour
+	if (IsValidTour(vSeedTour, iNodeNum))
+		vResTour = vSeedTour;
+	else
+		GreedyTour(vObjectMatrix, vResTour);
+
+	return ImproveTour(vResTour, vFlatMatrix, iNodeNum, oDeadline, m_oRandom, false);
+
+}
+
+/*************************************************
+Function: StartBackground
+Description: keep improving a tour in a background thread
+Calls: StopBackground
+       FlattenMatrix
+       IsValidTour
+       GreedyTour
+       BackgroundLoop
+Called By: OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes
+       vSeedTour - the initial tour starting with 0, an empty or invalid one means the greedy tour
+Output: none
+Return: none
+Others: the matrix is copied, so the caller may change its data at once,
+        the thread quits itself once the tour converges
+*************************************************/
+void AnytimeOP::StartBackground(const std::vector<std::vector<float> > & vObjectMatrix,
+	                            const std::vector<int> & vSeedTour){
+
+	std::vector<int> vOldTour;
+	StopBackground(vOldTour);
+
+	int iNodeNum = int(vObjectMatrix.size());
+
+	//a tour with less than 3 nodes can not be improved
+	if (iNodeNum < 3)
+		return;
+
+	FlattenMatrix(vObjectMatrix, m_vBackFlatMatrix);
+	m_iBackNodeNum = iNodeNum;
+
+	//the worker is not running, no lock is needed
+	if (IsValidTour(vSeedTour, iNodeNum))
+		m_vBackBestTour = vSeedTour;
+	else
+		GreedyTour(vObjectMatrix, m_vBackBestTour);
+	m_fBackBestCost = FlatTourCost(m_vBackBestTour, m_vBackFlatMatrix, m_iBackNodeNum);
+
+	m_bStopFlag = false;
+	m_oWorker = std::thread(&AnytimeOP::BackgroundLoop, this);
+
+}
+
+/*************************************************
+Function: StopBackground
+Description: stop the background improvement and get its best tour
+Calls: none
+Called By: StartBackground
+           ~AnytimeOP
+           OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: vResTour - the best tour found in background, empty if no one is running
+Return: the cost of vResTour, -1 if no one is running
+Others: none
+*************************************************/
+float AnytimeOP::StopBackground(std::vector<int> & vResTour){
+
+	vResTour.clear();
+
+	if (!m_oWorker.joinable())
+		return -1.0;
+
+	m_bStopFlag = true;
+	m_oWorker.join();
+
+	std::unique_lock<std::mutex> oLock(m_oBestMutex);
+	vResTour = m_vBackBestTour;
+	float fBestCost = m_fBackBestCost;
+
+	m_vBackBestTour.clear();
+	m_fBackBestCost = -1.0;
+
+	return fBestCost;
+
+}
+
+/*************************************************
+Function: BackgroundLoop
+Description: the loop of background thread
+Calls: ImproveTour
+Called By: StartBackground
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: m_vBackBestTour - the best tour found in background
+Return: none
+Others: it has no deadline, it quits when the stop flag is set or the tour converges
+*************************************************/
+void AnytimeOP::BackgroundLoop(){
+
+	std::vector<int> vTour;
+	{
+		std::unique_lock<std::mutex> oLock(m_oBestMutex);
+		vTour = m_vBackBestTour;
+	}
+
+	//a random engine of this thread
+	std::mt19937 oRandom(m_iBackNodeNum);
+
+	ImproveTour(vTour, m_vBackFlatMatrix, m_iBackNodeNum,
+	            TimePoint::max(), oRandom, true);
+
+}
+
+/*************************************************
+Function: ImproveTour
+Description: iterated local search, which kicks the best tour and searches it again
+Calls: LocalSearch
+       KickTour
+       FlatTourCost
+Called By: Solve
+           BackgroundLoop
+Table Accessed: none
+Table Updated: none
+Input: vTour - the initial tour starting with 0
+       vFlatMatrix - the flat objective matrix
+       iNodeNum - the node number
+       oDeadline - the deadline of search
+       oRandom - the random engine of kicks
+       bBackFlag - the search runs in background, which checks the stop flag and publishes the better tours
+Output: vTour - the best tour found
+Return: the cost of vTour
+Others: the search also stops after 20 * n kicks without improvement
+*************************************************/
+float AnytimeOP::ImproveTour(std::vector<int> & vTour,
+	                         const std::vector<float> & vFlatMatrix,
+	                         const int & iNodeNum,
+	                         const TimePoint & oDeadline,
+	                         std::mt19937 & oRandom,
+	                         const bool & bBackFlag){
+
+	LocalSearch(vTour, vFlatMatrix, iNodeNum, oDeadline, bBackFlag);
+	float fBestCost = FlatTourCost(vTour, vFlatMatrix, iNodeNum);
+
+	if (bBackFlag){
+		std::unique_lock<std::mutex> oLock(m_oBestMutex);
+		if (fBestCost < m_fBackBestCost){
+			m_vBackBestTour = vTour;
+			m_fBackBestCost = fBestCost;
+		}
+	}
+
+	//the local search already tries all orders of less than 4 nodes
+	if (iNodeNum < 4)
+		return fBestCost;
+
+	int iFailNum = 0;
+	int iMaxFailNum = 20 * iNodeNum;
+	std::vector<int> vCandTour;
+
+	while (iFailNum < iMaxFailNum
+	       && std::chrono::steady_clock::now() < oDeadline
+	       && !(bBackFlag && m_bStopFlag)){
+
+		vCandTour = vTour;
+		KickTour(vCandTour, oRandom);
+		LocalSearch(vCandTour, vFlatMatrix, iNodeNum, oDeadline, bBackFlag);
+
+		float fCandCost = FlatTourCost(vCandTour, vFlatMatrix, iNodeNum);
+
+		//only accept the better one
+		if (fCandCost < fBestCost - 1e-6f){
+
+			vTour.swap(vCandTour);
+			fBestCost = fCandCost;
+			iFailNum = 0;
+
+			if (bBackFlag){
+				std::unique_lock<std::mutex> oLock(m_oBestMutex);
+				m_vBackBestTour = vTour;
+				m_fBackBestCost = fBestCost;
+			}
+
+		}else
+			iFailNum++;
+
+	}//end while
+
+	return fBestCost;
+
+}
+
+/*************************************************
+Function: LocalSearch
+Description: 2-opt and Or-opt passes until no move improves the tour
+Calls: TwoOptPass
+       OrOptPass
+Called By: ImproveTour
+Table Accessed: none
+Table Updated: none
+Input: vTour - the tour starting with 0
+       vFlatMatrix - the flat objective matrix
+       iNodeNum - the node number
+       oDeadline - the deadline of search
+       bBackFlag - check the stop flag of background
+Output: vTour - the tour at a local optimum (or when the time is over)
+Return: none
+Others: none
+*************************************************/
+void AnytimeOP::LocalSearch(std::vector<int> & vTour,
+	                        const std::vector<float> & vFlatMatrix,
+	                        const int & iNodeNum,
+	                        const TimePoint & oDeadline,
+	                        const bool & bBackFlag){
+
+	bool bImproveFlag = true;
+
+	while (bImproveFlag){
+
+		bImproveFlag = TwoOptPass(vTour, vFlatMatrix, iNodeNum);
+
+		if (OrOptPass(vTour, vFlatMatrix, iNodeNum))
+			bImproveFlag = true;
+
+		if (std::chrono::steady_clock::now() >= oDeadline
+			|| (bBackFlag && m_bStopFlag))
+			break;
+
+	}//end while
+
+}
+
+/*************************************************
+Function: TwoOptPass
+Description: one pass of 2-opt, which reverses the segments of tour
+Calls: none
+Called By: LocalSearch
+Table Accessed: none
+Table Updated: none
+Input: vTour - the tour starting with 0
+       vFlatMatrix - the flat objective matrix
+       iNodeNum - the node number
+Output: vTour - the improved tour
+Return: whether the tour is improved
+Others: the matrix is asymmetric, so the cost inside the reversed segment is changed too,
+        it is computed by the prefix sums of the forward and backward edges
+*************************************************/
+bool AnytimeOP::TwoOptPass(std::vector<int> & vTour,
+	                       const std::vector<float> & vFlatMatrix,
+	                       const int & iNodeNum){
+
+	bool bImproveFlag = false;
+
+	//vForward[k] is the cost from vTour[0] to vTour[k]
+	//vBackward[k] is the cost from vTour[k] back to vTour[0]
+	std::vector<double> vForward(iNodeNum, 0.0);
+	std::vector<double> vBackward(iNodeNum, 0.0);
+
+	bool bPrefixFlag = false;
+
+	for (int i = 1; i < iNodeNum - 1; ++i){
+		for (int j = i + 1; j < iNodeNum; ++j){
+
+			if (!bPrefixFlag){
+				for (int k = 1; k != iNodeNum; ++k){
+					vForward[k] = vForward[k - 1] + vFlatMatrix[vTour[k - 1] * iNodeNum + vTour[k]];
+					vBackward[k] = vBackward[k - 1] + vFlatMatrix[vTour[k] * iNodeNum + vTour[k - 1]];
+				}
+				bPrefixFlag = true;
+			}
+
+			int iPrev = vTour[i - 1];
+			int iFirst = vTour[i];
+			int iLast = vTour[j];
+
+			double dOldCost = vFlatMatrix[iPrev * iNodeNum + iFirst] + vForward[j] - vForward[i];
+			double dNewCost = vFlatMatrix[iPrev * iNodeNum + iLast] + vBackward[j] - vBackward[i];
+
+			//the tour is open, the last node has no next one
+			if (j + 1 < iNodeNum){
+				int iNext = vTour[j + 1];
+				dOldCost += vFlatMatrix[iLast * iNodeNum + iNext];
+				dNewCost += vFlatMatrix[iFirst * iNodeNum + iNext];
+			}
+
+			if (dNewCost + 1e-6 < dOldCost){
+				std::reverse(vTour.begin() + i, vTour.begin() + j + 1);
+				bPrefixFlag = false;
+				bImproveFlag = true;
+			}
+
+		}//end for j
+	}//end for i
+
+	return bImproveFlag;
+
+}
+
+/*************************************************
+Function: OrOptPass
+Description: one pass of Or-opt, which moves a segment of 1 to 3 nodes to another position
+Calls: none
+Called By: LocalSearch
+Table Accessed: none
+Table Updated: none
+Input: vTour - the tour starting with 0
+       vFlatMatrix - the flat objective matrix
+       iNodeNum - the node number
+Output: vTour - the improved tour
+Return: whether the tour is improved
+Others: the segment keeps its direction, the first node (start) is never moved
+*************************************************/
+bool AnytimeOP::OrOptPass(std::vector<int> & vTour,
+	                      const std::vector<float> & vFlatMatrix,
+	                      const int & iNodeNum){
+
+	bool bImproveFlag = false;
+
+	for (int iSegLen = 1; iSegLen <= 3; ++iSegLen){
+		for (int i = 1; i + iSegLen <= iNodeNum; ++i){
+
+			int iSegEnd = i + iSegLen - 1;
+			int iPrev = vTour[i - 1];
+			int iFirst = vTour[i];
+			int iLast = vTour[iSegEnd];
+			int iNext = iSegEnd + 1 < iNodeNum ? vTour[iSegEnd + 1] : -1;
+
+			//the gain to take the segment out
+			double dRemoveGain = vFlatMatrix[iPrev * iNodeNum + iFirst];
+			if (iNext >= 0)
+				dRemoveGain += vFlatMatrix[iLast * iNodeNum + iNext]
+				             - vFlatMatrix[iPrev * iNodeNum + iNext];
+
+			//insert the segment between vTour[k] and vTour[k + 1]
+			int iBestPos = -1;
+			double dBestDelta = -1e-6;
+			for (int k = 0; k != iNodeNum; ++k){
+
+				//the same position
+				if (k >= i - 1 && k <= iSegEnd)
+					continue;
+
+				int iFrom = vTour[k];
+				double dAddCost = vFlatMatrix[iFrom * iNodeNum + iFirst];
+				if (k + 1 < iNodeNum){
+					int iTo = vTour[k + 1];
+					dAddCost += vFlatMatrix[iLast * iNodeNum + iTo]
+					          - vFlatMatrix[iFrom * iNodeNum + iTo];
+				}
+
+				if (dAddCost - dRemoveGain < dBestDelta){
+					dBestDelta = dAddCost - dRemoveGain;
+					iBestPos = k;
+				}
+
+			}//end for k
+
+			if (iBestPos >= 0){
+
+				std::vector<int> vSegment(vTour.begin() + i, vTour.begin() + iSegEnd + 1);
+				vTour.erase(vTour.begin() + i, vTour.begin() + iSegEnd + 1);
+
+				//the position after erasing
+				int iInsertPos = iBestPos < i ? iBestPos + 1 : iBestPos + 1 - iSegLen;
+				vTour.insert(vTour.begin() + iInsertPos, vSegment.begin(), vSegment.end());
+
+				bImproveFlag = true;
+
+			}
+
+		}//end for i
+	}//end for iSegLen
+
+	return bImproveFlag;
+
+}
+
+/*************************************************
+Function: KickTour
+Description: perturb a tour by a random double bridge move
+Calls: none
+Called By: ImproveTour
+Table Accessed: none
+Table Updated: none
+Input: vTour - the tour starting with 0
+       oRandom - the random engine
+Output: vTour - the perturbed tour
+Return: none
+Others: the tour after the start is cut into A B C D and rebuilt as A C B D,
+        a tour with less than 4 free nodes uses a random swap instead
+*************************************************/
+void AnytimeOP::KickTour(std::vector<int> & vTour,
+	                     std::mt19937 & oRandom){
+
+	int iNodeNum = int(vTour.size());
+
+	if (iNodeNum < 3)
+		return;
+
+	if (iNodeNum < 5){
+		std::uniform_int_distribution<int> oPick(1, iNodeNum - 1);
+		int a = oPick(oRandom);
+		int b = oPick(oRandom);
+		if (a == b)
+			b = a == 1 ? 2 : a - 1;
+		std::swap(vTour[a], vTour[b]);
+		return;
+	}
+
+	//three different cuts in [2, n - 1]
+	std::uniform_int_distribution<int> oCut(2, iNodeNum - 1);
+	int vCuts[3];
+	do{
+		vCuts[0] = oCut(oRandom);
+		vCuts[1] = oCut(oRandom);
+		vCuts[2] = oCut(oRandom);
+	}while (vCuts[0] == vCuts[1] || vCuts[1] == vCuts[2] || vCuts[0] == vCuts[2]);
+	std::sort(vCuts, vCuts + 3);
+
+	//A = [1, c0), B = [c0, c1), C = [c1, c2), D = [c2, n)
+	std::rotate(vTour.begin() + vCuts[0], vTour.begin() + vCuts[1], vTour.begin() + vCuts[2]);
+
+}
+
+/*************************************************
+Function: TourCost
+Description: the cost of a tour
+Calls: none
+Called By: OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes
+       vTour - a tour
+Output: none
+Return: the sum of objective values along the tour
+Others: none
+*************************************************/
+float AnytimeOP::TourCost(const std::vector<std::vector<float> > & vObjectMatrix,
+	                      const std::vector<int> & vTour){
+
+	float fCost = 0.0;
+
+	for (int i = 1; i < int(vTour.size()); ++i)
+		fCost += vObjectMatrix[vTour[i - 1]][vTour[i]];
+
+	return fCost;
+
+}
+
+/*************************************************
+Function: FlatTourCost
+Description: the cost of a tour on the flat matrix
+Calls: none
+Called By: StartBackground
+           ImproveTour
+Table Accessed: none
+Table Updated: none
+Input: vTour - a tour
+       vFlatMatrix - the flat objective matrix
+       iNodeNum - the node number
+Output: none
+Return: the sum of objective values along the tour
+Others: none
+*************************************************/
+float AnytimeOP::FlatTourCost(const std::vector<int> & vTour,
+	                          const std::vector<float> & vFlatMatrix,
+	                          const int & iNodeNum){
+
+	double dCost = 0.0;
+
+	for (int i = 1; i < int(vTour.size()); ++i)
+		dCost += vFlatMatrix[vTour[i - 1] * iNodeNum + vTour[i]];
+
+	return float(dCost);
+
+}
+
+/*************************************************
+Function: GreedyTour
+Description: the greedy tour which always goes to the nearest unvisited node (the same as OP::GTR)
+Calls: none
+Called By: Solve
+           StartBackground
+           OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes
+Output: vTour - the greedy tour starting with 0
+Return: none
+Others: none
+*************************************************/
+void AnytimeOP::GreedyTour(const std::vector<std::vector<float> > & vObjectMatrix,
+	                       std::vector<int> & vTour){
+
+	int iNodeNum = int(vObjectMatrix.size());
+
+	vTour.clear();
+	if (!iNodeNum)
+		return;
+
+	std::vector<bool> vVisitedFlag(iNodeNum, false);
+	vTour.push_back(0);
+	vVisitedFlag[0] = true;
+
+	for (int s = 1; s != iNodeNum; ++s){
+
+		int iCurIdx = vTour.back();
+		int iMinIdx = -1;
+		float fMinMeasure = FLT_MAX;
+
+		for (int j = 0; j != iNodeNum; ++j){
+			if (!vVisitedFlag[j] && (iMinIdx < 0 || vObjectMatrix[iCurIdx][j] < fMinMeasure)){
+				fMinMeasure = vObjectMatrix[iCurIdx][j];
+				iMinIdx = j;
+			}
+		}
+
+		vTour.push_back(iMinIdx);
+		vVisitedFlag[iMinIdx] = true;
+
+	}//end for s
+
+}
+
+/*************************************************
+Function: CompleteTour
+Description: insert the nodes missing in a partial tour at their cheapest positions
+Calls: none
+Called By: OP::AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes
+       vTour - a partial tour starting with 0 without repeated nodes
+Output: vTour - the complete tour
+Return: none
+Others: it is used to reuse an old tour after some nodes are added
+*************************************************/
+void AnytimeOP::CompleteTour(const std::vector<std::vector<float> > & vObjectMatrix,
+	                         std::vector<int> & vTour){
+
+	int iNodeNum = int(vObjectMatrix.size());
+
+	if (!iNodeNum)
+		return;
+
+	if (vTour.empty() || vTour[0] != 0)
+		vTour.insert(vTour.begin(), 0);
+
+	std::vector<bool> vInTourFlag(iNodeNum, false);
+	for (int i = 0; i != int(vTour.size()); ++i)
+		vInTourFlag[vTour[i]] = true;
+
+	for (int j = 1; j != iNodeNum; ++j){
+
+		if (vInTourFlag[j])
+			continue;
+
+		//insert after vTour[k]
+		int iBestPos = 0;
+		float fBestAdd = FLT_MAX;
+		for (int k = 0; k != int(vTour.size()); ++k){
+
+			float fAdd = vObjectMatrix[vTour[k]][j];
+			if (k + 1 < int(vTour.size()))
+				fAdd += vObjectMatrix[j][vTour[k + 1]] - vObjectMatrix[vTour[k]][vTour[k + 1]];
+
+			if (fAdd < fBestAdd){
+				fBestAdd = fAdd;
+				iBestPos = k;
+			}
+
+		}//end for k
+
+		vTour.insert(vTour.begin() + iBestPos + 1, j);
+		vInTourFlag[j] = true;
+
+	}//end for j
+
+}
+
+/*************************************************
+Function: IsValidTour
+Description: check a tour starts with 0 and visits each node once
+Calls: none
+Called By: Solve
+           StartBackground
+Table Accessed: none
+Table Updated: none
+Input: vTour - a tour
+       iNodeNum - the node number
+Output: none
+Return: true if it is a valid tour
+Others: none
+*************************************************/
+bool AnytimeOP::IsValidTour(const std::vector<int> & vTour,
+	                        const int & iNodeNum){
+
+	if (int(vTour.size()) != iNodeNum || !iNodeNum || vTour[0] != 0)
+		return false;
+
+	std::vector<bool> vVisitedFlag(iNodeNum, false);
+	for (int i = 0; i != iNodeNum; ++i){
+		if (vTour[i] < 0 || vTour[i] >= iNodeNum || vVisitedFlag[vTour[i]])
+			return false;
+		vVisitedFlag[vTour[i]] = true;
+	}
+
+	return true;
+
+}
+
+/*************************************************
+Function: FlattenMatrix
+Description: store the objective matrix in one array
+Calls: none
+Called By: Solve
+           StartBackground
+Table Accessed: none
+Table Updated: none
+Input: vObjectMatrix - the objective value of each pair of nodes
+Output: vFlatMatrix - vFlatMatrix[i * n + j] = vObjectMatrix[i][j]
+Return: none
+Others: none
+*************************************************/
+void AnytimeOP::FlattenMatrix(const std::vector<std::vector<float> > & vObjectMatrix,
+	                          std::vector<float> & vFlatMatrix){
+
+	int iNodeNum = int(vObjectMatrix.size());
+
+	vFlatMatrix.resize(iNodeNum * iNodeNum);
+
+	for (int i = 0; i != iNodeNum; ++i)
+		for (int j = 0; j != iNodeNum; ++j)
+			vFlatMatrix[i * iNodeNum + j] = vObjectMatrix[i][j];
+
+}
+
+}/*namespace*/
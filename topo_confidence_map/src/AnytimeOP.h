@@ -0,0 +1,146 @@
+#ifndef ANYTIMEOP_H
+#define ANYTIMEOP_H
+
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+///************************************************************************///
+// a class to implement an anytime solver of the orienteering problem (non-loop travel)
+// the tour is improved by 2-opt and Or-opt local search with random kicks (iterated local search),
+// the solver returns the best tour found when the time budget expires,
+// and it can keep improving the tour in a background thread until the next decision
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the time budgeted solver and the background improvement used by OP::AnytimeMethod
+
+///************************************************************************///
+
+namespace topology_map {
+
+class AnytimeOP{
+
+public:
+
+	//constructor
+	AnytimeOP();
+
+	//destructor, the background improvement is stopped
+	~AnytimeOP();
+
+	//solve the non-loop travel from node 0 in a time budget (millisecond)
+	//vSeedTour is the initial tour starting with 0, an empty one means the greedy tour
+	float Solve(const std::vector<std::vector<float> > & vObjectMatrix,
+	            const std::vector<int> & vSeedTour,
+	            std::vector<int> & vResTour,
+	            const double & dBudgetMs);
+
+	//keep improving a tour in background until StopBackground is called
+	void StartBackground(const std::vector<std::vector<float> > & vObjectMatrix,
+	                     const std::vector<int> & vSeedTour);
+
+	//stop the background improvement and get its best tour and cost
+	//the cost is -1 if no background improvement is running
+	float StopBackground(std::vector<int> & vResTour);
+
+	//the cost of a tour
+	static float TourCost(const std::vector<std::vector<float> > & vObjectMatrix,
+	                      const std::vector<int> & vTour);
+
+	//the greedy tour from node 0 (nearest next node)
+	static void GreedyTour(const std::vector<std::vector<float> > & vObjectMatrix,
+	                       std::vector<int> & vTour);
+
+	//insert the nodes missing in a partial tour at their cheapest positions
+	static void CompleteTour(const std::vector<std::vector<float> > & vObjectMatrix,
+	                         std::vector<int> & vTour);
+
+private:
+
+	//forbid the copy
+	AnytimeOP(const AnytimeOP &);
+	AnytimeOP & operator = (const AnytimeOP &);
+
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	//iterated local search until the deadline, the stop flag (background) or the convergence
+	float ImproveTour(std::vector<int> & vTour,
+	                  const std::vector<float> & vFlatMatrix,
+	                  const int & iNodeNum,
+	                  const TimePoint & oDeadline,
+	                  std::mt19937 & oRandom,
+	                  const bool & bBackFlag);
+
+	//local search until no move improves the tour
+	void LocalSearch(std::vector<int> & vTour,
+	                 const std::vector<float> & vFlatMatrix,
+	                 const int & iNodeNum,
+	                 const TimePoint & oDeadline,
+	                 const bool & bBackFlag);
+
+	//perturb a tour by a double bridge move (a swap for short tours)
+	static void KickTour(std::vector<int> & vTour,
+	                     std::mt19937 & oRandom);
+
+	//one pass of 2-opt (reverse a segment), return whether the tour is improved
+	static bool TwoOptPass(std::vector<int> & vTour,
+	                       const std::vector<float> & vFlatMatrix,
+	                       const int & iNodeNum);
+
+	//one pass of Or-opt (move a segment of 1 to 3 nodes), return whether the tour is improved
+	static bool OrOptPass(std::vector<int> & vTour,
+	                      const std::vector<float> & vFlatMatrix,
+	                      const int & iNodeNum);
+
+	//the cost of a tour on the flat matrix
+	static float FlatTourCost(const std::vector<int> & vTour,
+	                          const std::vector<float> & vFlatMatrix,
+	                          const int & iNodeNum);
+
+	//check a tour starts with 0 and visits each node once
+	static bool IsValidTour(const std::vector<int> & vTour,
+	                        const int & iNodeNum);
+
+	//the flat matrix of the input, vFlatMatrix[i * n + j]
+	static void FlattenMatrix(const std::vector<std::vector<float> > & vObjectMatrix,
+	                          std::vector<float> & vFlatMatrix);
+
+	//the loop of background thread
+	void BackgroundLoop();
+
+	//random kicks of the foreground solver
+	std::mt19937 m_oRandom;
+
+	//background thread and its data
+	std::thread m_oWorker;
+	std::atomic<bool> m_bStopFlag;
+	//the matrix and node number of background tour
+	std::vector<float> m_vBackFlatMatrix;
+	int m_iBackNodeNum;
+	//the best tour found in background
+	std::mutex m_oBestMutex;
+	std::vector<int> m_vBackBestTour;
+	float m_fBackBestCost;
+
+};
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//AnytimeOP oSolver;
+//std::vector<int> vTour;
+////solve in 50 ms from the greedy tour
+//oSolver.Solve(vObjectMatrix, std::vector<int>(), vTour, 50.0);
+////improve the rest of tour until the next decision
+//oSolver.StartBackground(vRestMatrix, vRestTour);
+//...
+//oSolver.StopBackground(vRestTour);
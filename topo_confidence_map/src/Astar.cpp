@@ -4,19 +4,32 @@ namespace topology_map {
 
 void Astar::InitAstarTravelMap(const grid_map::GridMap & oExtendGridMap){
 
-	//clear raw data
-	maze.clear(); 
+	m_iMapCols = oExtendGridMap.getSize()(0);
+	m_iMapRows = oExtendGridMap.getSize()(1);
 
-	//resize the maze
-    maze.resize(oExtendGridMap.getSize()(0));
+	//note that 1 bit is a obstacle grid label in astar algorithm
+	//all grids are unknown (label 0) at the beginning, which are travelable
+	m_vObstacleBits.assign((m_iMapCols * m_iMapRows + 63) / 64, 0);
 
-	//note that 1 value is a obstacle grid label in astar algorithm
-	for (int i = 0; i != oExtendGridMap.getSize()(0); ++i) {
+	SetSearchWindow(0, m_iMapCols - 1, 0, m_iMapRows - 1);
 
-		for(int j = 0; j != oExtendGridMap.getSize()(1); ++j)
-		    maze[i].push_back(1);//all obstacles at the beginning
+	InitClusters();
 
-	}
+}
+
+
+
+
+//set the cluster size (grids) of hierarchical search, 0 means the full map search only
+void Astar::SetClusterSize(const int & iClusterSize){
+
+	m_iClusterSize = iClusterSize > 0 ? iClusterSize : 0;
+
+	//a very small cluster has too many entrances
+	if (m_iClusterSize && m_iClusterSize < 8)
+		m_iClusterSize = 8;
+
+	InitClusters();
 
 }
 
@@ -25,23 +38,15 @@ void Astar::InitAstarTravelMap(const grid_map::GridMap & oExtendGridMap){
 
 //update map which record the travelable grids
 void Astar::UpdateTravelMap(const grid_map::GridMap & oExtendGridMap,
-	                        const std::vector<ConfidenceValue> & vConfidenceMap){
-
-    //i
-    for (int i = 0; i != oExtendGridMap.getSize()(0); ++i) {//i
-        //j
-		for (int j = 0; j != oExtendGridMap.getSize()(1); ++j) {//j
-            //get index
-			int iGridIdx = ExtendedGM::TwotoOneDIdx(i, j);
-
-            //record the travelable region
-            if(vConfidenceMap[iGridIdx].label == 1 ||vConfidenceMap[iGridIdx].label == 3 )
-                maze[i][j] = 1;//note that 1 value is a obstacle grid label in astar algorithm
-			else
-				maze[i][j] = 0;//note that 0 value is a travelable grid label in astar algorithm
-		}//end j
+	                        const ConfidenceMap & vConfidenceMap){
 
-    }//end i
+	//reallocate if the map size is changed
+	if (m_iMapCols != oExtendGridMap.getSize()(0) || m_iMapRows != oExtendGridMap.getSize()(1))
+		InitAstarTravelMap(oExtendGridMap);
+
+    //record the travelable region
+    for (int i = 0; i != m_iMapCols * m_iMapRows; ++i)
+    	SetObstacle(i, IsObstacleLabel(vConfidenceMap[i].label));
 
 }
 
@@ -76,67 +81,111 @@ int Astar::calcF(AstarPoint *point)
 
 
 
-AstarPoint *Astar::getLeastFpoint()
+//prepare the node pool and flags for a new search
+void Astar::PrepareSearch()
 {
-	if (!openList.empty())
+	int iNodeNum = m_iMapCols * m_iMapRows;
+
+	//the pool is allocated once for each map size
+	if (m_vNodePool.size() != iNodeNum)
 	{
-		auto resPoint = openList.front();
-		for (auto &point : openList)
-		if (point->F<resPoint->F)
-			resPoint = point;
-		return resPoint;
+		m_vNodePool.assign(iNodeNum, AstarPoint());
+		m_vOpenStamp.assign(iNodeNum, 0);
+		m_vCloseStamp.assign(iNodeNum, 0);
+		m_vHeapPos.assign(iNodeNum, -1);
+		m_iSearchStamp = 0;
 	}
-	return NULL;
+
+	//a new stamp clears all flags
+	m_iSearchStamp++;
+	if (!m_iSearchStamp)
+	{
+		std::fill(m_vOpenStamp.begin(), m_vOpenStamp.end(), 0);
+		std::fill(m_vCloseStamp.begin(), m_vCloseStamp.end(), 0);
+		m_iSearchStamp = 1;
+	}
+
+	m_vOpenHeap.clear();
 }
 
 
 
 
 
-AstarPoint *Astar::findPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner)
+//search a path in the grids of current search window
+//iEndIdx < 0 means a flood search from the start without heuristic, which computes G of all reachable grids in window
+AstarPoint *Astar::findPath(const int & iStartIdx, const int & iEndIdx, bool isIgnoreCorner)
 {
-	//Put in the starting point, copy and open a node, inside and outside isolation
-	openList.push_back(new AstarPoint(startPoint.x, startPoint.y));   
+	PrepareSearch();
+
+	if (m_vNodePool.empty())
+		return NULL;
+
+	int iRows = m_iMapRows;
+
+	AstarPoint endPoint(0, 0);
+	if (iEndIdx >= 0)
+		endPoint = AstarPoint(iEndIdx / iRows, iEndIdx % iRows);
 
-	while (!openList.empty())
+	//Put in the starting point, which is a node in the pool
+	AstarPoint *pStart = &m_vNodePool[iStartIdx];
+	*pStart = AstarPoint(iStartIdx / iRows, iStartIdx % iRows);
+	pStart->H = iEndIdx >= 0 ? calcH(pStart, &endPoint) : 0;
+	pStart->F = calcF(pStart);
+	m_vOpenStamp[iStartIdx] = m_iSearchStamp;
+	HeapPush(iStartIdx);
+
+	while (!m_vOpenHeap.empty())
 	{
-		//Find the point with the lowest F value
-		auto curPoint = getLeastFpoint();  
-		//Remove from open list
-		openList.remove(curPoint); 
+		//Find the point with the lowest F value and remove it from open list
+		int iCurIdx = HeapPop();
+		AstarPoint *curPoint = &m_vNodePool[iCurIdx];
         //put in the close list
-		closeList.push_back(curPoint);   
+		m_vCloseStamp[iCurIdx] = m_iSearchStamp;
+
+		//the path is done when the end point is closed
+		if (iCurIdx == iEndIdx)
+			return curPoint;
+
 		//1. find the grid that can pass in the current eight squares 
-		auto surroundPoints = getSurroundPoints(curPoint, isIgnoreCorner);
-		for (auto &target : surroundPoints)
+		for (int x = curPoint->x - 1; x <= curPoint->x + 1; x++)
+		for (int y = curPoint->y - 1; y <= curPoint->y + 1; y++)
 		{
+			if (!isCanreach(curPoint, x, y, isIgnoreCorner))
+				continue;
+
+			int iTargetIdx = x * iRows + y;
+			AstarPoint *target = &m_vNodePool[iTargetIdx];
+
 			//2. For a grid, if it is not in the open list, add to the open list, set the current grid to its parent, and calculate F G H 
-			if (!isInList(openList, target))
+			if (m_vOpenStamp[iTargetIdx] != m_iSearchStamp)
 			{
+				*target = AstarPoint(x, y);
 				target->parent = curPoint;
 
 				target->G = calcG(curPoint, target);
-				target->H = calcH(target, &endPoint);
+				target->H = iEndIdx >= 0 ? calcH(target, &endPoint) : 0;
 				target->F = calcF(target);
 
-				openList.push_back(target);
+				m_vOpenStamp[iTargetIdx] = m_iSearchStamp;
+				HeapPush(iTargetIdx);
 			}
 			//3. for a grid, it is in the open list, calculate the G value
 			//if it is larger than the original, do nothing, otherwise set its parent node as the current point, and update G and F
 			else
 			{
+				AstarPoint *oldParent = target->parent;
+				target->parent = curPoint;
 				int tempG = calcG(curPoint, target);
 				if (tempG<target->G)
 				{
-					target->parent = curPoint;
-
 					target->G = tempG;
 					target->F = calcF(target);
+					HeapSiftUp(m_vHeapPos[iTargetIdx]);
 				}
+				else
+					target->parent = oldParent;
 			}
-			AstarPoint *resPoint = isInList(openList, &endPoint);
-			if (resPoint)
-				return resPoint; //Return the node pointer in the list, do not use the original incoming pointer, because a deep copy occurred  
 		}
 	}
 
@@ -146,10 +195,101 @@ AstarPoint *Astar::findPath(AstarPoint &startPoint, AstarPoint &endPoint, bool i
 
 
 
+//limit the search in a window of grids (including the bounds)
+void Astar::SetSearchWindow(const int & iMinX, const int & iMaxX, const int & iMinY, const int & iMaxY)
+{
+	m_iWindowMinX = std::max(iMinX, 0);
+	m_iWindowMaxX = std::min(iMaxX, m_iMapCols - 1);
+	m_iWindowMinY = std::max(iMinY, 0);
+	m_iWindowMaxY = std::min(iMaxY, m_iMapRows - 1);
+}
+
+
+
+
+//limit the search in a cluster
+void Astar::SetClusterWindow(const int & iClusterIdx)
+{
+	int iClusterX = iClusterIdx / m_iClusterRows;
+	int iClusterY = iClusterIdx % m_iClusterRows;
+	SetSearchWindow(iClusterX * m_iClusterSize, (iClusterX + 1) * m_iClusterSize - 1,
+		            iClusterY * m_iClusterSize, (iClusterY + 1) * m_iClusterSize - 1);
+}
+
+
+
+
+//append the grids from the start to a searched node at the end of path
+//the first grid is skipped if it is the last grid of path
+void Astar::AppendPath(AstarPoint *result)
+{
+	int iOldSize = m_vPathPoints.size();
+
+	while (result)
+	{
+		m_vPathPoints.push_back(AstarPoint(result->x, result->y));
+		result = result->parent;
+	}
+
+	std::reverse(m_vPathPoints.begin() + iOldSize, m_vPathPoints.end());
+
+	if (iOldSize && iOldSize < m_vPathPoints.size()
+		&& m_vPathPoints[iOldSize - 1].x == m_vPathPoints[iOldSize].x
+		&& m_vPathPoints[iOldSize - 1].y == m_vPathPoints[iOldSize].y)
+		m_vPathPoints.erase(m_vPathPoints.begin() + iOldSize);
+}
+
+
+
+
+//search a path and return its end node, the parent of each node is the previous grid of path
+//the clusters are used if the two ends are far away, otherwise the full map is searched
+AstarPoint *Astar::SearchPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner)
+{
+	m_vPathPoints.clear();
+
+	//both of the ends must be inside the map
+	if (startPoint.x < 0 || startPoint.x >= m_iMapCols || startPoint.y < 0 || startPoint.y >= m_iMapRows
+		|| endPoint.x < 0 || endPoint.x >= m_iMapCols || endPoint.y < 0 || endPoint.y >= m_iMapRows)
+		return NULL;
+
+	int iStartIdx = startPoint.x * m_iMapRows + startPoint.y;
+	int iEndIdx = endPoint.x * m_iMapRows + endPoint.y;
+
+	bool bPathFlag = false;
+
+	//a near goal (in the same or a neighboring cluster) is cheap for the full map search
+	if (m_iClusterSize > 0
+		&& (abs(startPoint.x / m_iClusterSize - endPoint.x / m_iClusterSize) > 1
+		|| abs(startPoint.y / m_iClusterSize - endPoint.y / m_iClusterSize) > 1))
+		bPathFlag = findHierarchicalPath(iStartIdx, iEndIdx, isIgnoreCorner);
+
+	//the full map search is also a backup if the abstract graph has no path
+	if (!bPathFlag)
+	{
+		m_vPathPoints.clear();
+		SetSearchWindow(0, m_iMapCols - 1, 0, m_iMapRows - 1);
+		AppendPath(findPath(iStartIdx, iEndIdx, isIgnoreCorner));
+	}
+
+	if (m_vPathPoints.empty())
+		return NULL;
+
+	//link the path
+	m_vPathPoints[0].parent = NULL;
+	for (int i = 1; i < m_vPathPoints.size(); ++i)
+		m_vPathPoints[i].parent = &m_vPathPoints[i - 1];
+
+	return &m_vPathPoints.back();
+}
+
+
+
+
 
 std::list<AstarPoint *> Astar::GetPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner)
 {
-	AstarPoint *result = findPath(startPoint, endPoint, isIgnoreCorner);
+	AstarPoint *result = SearchPath(startPoint, endPoint, isIgnoreCorner);
 
 	std::list<AstarPoint *> path;
 
@@ -160,10 +300,6 @@ std::list<AstarPoint *> Astar::GetPath(AstarPoint &startPoint, AstarPoint &endPo
 		result = result->parent;
 	}
 
-	openList.clear();
-
-	closeList.clear();
-
 	return path;
 
 }
@@ -185,7 +321,7 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud,
     AstarPoint endPoint(oTailIdx.oTwoIndex(0),oTailIdx.oTwoIndex(1));
 
     //compute the path
-	AstarPoint *result = findPath(startPoint, endPoint, isIgnoreCorner);
+	AstarPoint *result = SearchPath(startPoint, endPoint, isIgnoreCorner);
 
 	std::list<AstarPoint *> path;
 
@@ -210,10 +346,6 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud,
 
 	}
 
-	openList.clear();
-
-	closeList.clear();
-
     //output whether path is generated
 	if(pAstarCloud->size())
 		return true;
@@ -227,7 +359,7 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud,
 		                             std::vector<float> & vQualityFeature,
 		                pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud, 
 	                                    const ExtendedGM & oExtendGridMap,
-	                  const std::vector<ConfidenceValue> & vConfidenceMap,
+	                  const ConfidenceMap & vConfidenceMap,
 	                                     const pcl::PointXYZ & oHeadPoint, 
 	                                     const pcl::PointXYZ & oTailPoint, 
 	                                                  bool isIgnoreCorner)
@@ -238,8 +370,8 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud,
     pAttractorCloud->clear();
     vQualityFeature.clear();
 
-    //define a status vector presenting the point clouds of data
-    std::vector<bool> vRegionStatus(vConfidenceMap.size(),false);
+    //the grids near the path, which are only the grids around path rather than the whole map
+    std::vector<int> vRegionIdxs;
 
     //set input
     MapIndex oHeadIdx = ExtendedGM::PointoAllTypeIdx(oHeadPoint, oExtendGridMap.m_oFeatureMap);
@@ -248,10 +380,13 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud,
     AstarPoint endPoint(oTailIdx.oTwoIndex(0),oTailIdx.oTwoIndex(1));
 
     //compute the path
-	AstarPoint *result = findPath(startPoint, endPoint, isIgnoreCorner);
+	AstarPoint *result = SearchPath(startPoint, endPoint, isIgnoreCorner);
 
 	std::list<AstarPoint *> path;
 
+    //the neighboring grids of a path grid, which is reused by all path grids
+    std::vector<MapIndex> vOneAstarNearIdxs;
+
 	//Return the path, if no path is found, return the empty list 
 	while (result)
 	{
@@ -273,43 +408,41 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud,
 		pAstarCloud->points.push_back(oPathGridPoint);
 
         //computed the neighboring grid of one astar path grid
-        std::vector<MapIndex> vOneAstarNearIdxs;
         ExtendedGM::CircleNeighborhood(vOneAstarNearIdxs,
 	                                   oExtendGridMap.m_oFeatureMap,
 	                                   oExtendGridMap.m_vAstarPathMask,
 	                                   oPathGridPoint);
 
-        //record in total map status
+        //record the neighboring grids
         for(int i = 0; i!= vOneAstarNearIdxs.size(); ++i)
-        	vRegionStatus[vOneAstarNearIdxs[i].iOneIdx] = true;
+        	vRegionIdxs.push_back(vOneAstarNearIdxs[i].iOneIdx);
 
 
 		result = result->parent;
 
 	}
 
-	openList.clear();
-
-	closeList.clear();
-
 	if(pAstarCloud->size() == 0)
 		return false;
 
+	//each grid is recorded once and in the same order as a scan of whole map
+	std::sort(vRegionIdxs.begin(), vRegionIdxs.end());
+	vRegionIdxs.erase(std::unique(vRegionIdxs.begin(), vRegionIdxs.end()), vRegionIdxs.end());
+
 	//save the attractor
-    for(int i = 0; i != vRegionStatus.size(); ++i){
-    	//if it is neiboring region of astar point
-        if(vRegionStatus[i]){
-            //if it is a selected grid
-        	if(vConfidenceMap[i].qualTerm.seletedflag){
-                //record point instead of grid
-        	   pcl::PointXYZ oAttractorPoint;
-               ExtendedGM::OneDIdxtoPoint(oAttractorPoint, i, oExtendGridMap.m_oFeatureMap);
-               oAttractorPoint.z = 0.0;
-        	   //add it at attractor point clouds
-               pAttractorCloud->push_back(oAttractorPoint);
-               //record the corresponding quality value
-               vQualityFeature.push_back(vConfidenceMap[i].qualTerm.means);
-            }
+    for(int k = 0; k != vRegionIdxs.size(); ++k){
+    	//it is neiboring region of astar point
+    	int i = vRegionIdxs[k];
+        //if it is a selected grid
+        if(vConfidenceMap[i].qualTerm.seletedflag){
+            //record point instead of grid
+            pcl::PointXYZ oAttractorPoint;
+            ExtendedGM::OneDIdxtoPoint(oAttractorPoint, i, oExtendGridMap.m_oFeatureMap);
+            oAttractorPoint.z = 0.0;
+            //add it at attractor point clouds
+            pAttractorCloud->push_back(oAttractorPoint);
+            //record the corresponding quality value
+            vQualityFeature.push_back(vConfidenceMap[i].qualTerm.means);
         }
 
     }
@@ -323,34 +456,349 @@ bool Astar::GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud,
 
 
 
-AstarPoint *Astar::isInList(const std::list<AstarPoint *> &list, const AstarPoint *point) const
+//allocate the clusters with the map size, all of them are dirty
+void Astar::InitClusters()
 {
-	//To determine whether a node is in the list, the pointer cannot be compared here, because each time the join list is a newly opened node, only the coordinates can be compared.
-	for (auto p : list)
-	if (p->x == point->x&&p->y == point->y)
-		return p;
-	return NULL;
+	m_vClusters.clear();
+	m_iClusterCols = 0;
+	m_iClusterRows = 0;
+
+	if (m_iClusterSize <= 0 || !m_iMapCols || !m_iMapRows)
+		return;
+
+	m_iClusterCols = (m_iMapCols + m_iClusterSize - 1) / m_iClusterSize;
+	m_iClusterRows = (m_iMapRows + m_iClusterSize - 1) / m_iClusterSize;
+	m_vClusters.resize(m_iClusterCols * m_iClusterRows);
+}
+
+
+
+
+//mark one cluster
+void Astar::MarkOneClusterDirty(const int & iClusterX, const int & iClusterY)
+{
+	if (iClusterX < 0 || iClusterX >= m_iClusterCols || iClusterY < 0 || iClusterY >= m_iClusterRows)
+		return;
+
+	m_vClusters[iClusterX * m_iClusterRows + iClusterY].bDirty = true;
+}
+
+
+
+
+//mark the clusters whose entrances or edges may be changed by a grid
+//the neighboring cluster is also changed if the grid is on the border
+void Astar::MarkClusterDirty(const int & iGridIdx)
+{
+	if (m_vClusters.empty())
+		return;
+
+	int x = iGridIdx / m_iMapRows;
+	int y = iGridIdx % m_iMapRows;
+	int iClusterX = x / m_iClusterSize;
+	int iClusterY = y / m_iClusterSize;
+
+	MarkOneClusterDirty(iClusterX, iClusterY);
+
+	if (x % m_iClusterSize == 0)
+		MarkOneClusterDirty(iClusterX - 1, iClusterY);
+	if (x % m_iClusterSize == m_iClusterSize - 1)
+		MarkOneClusterDirty(iClusterX + 1, iClusterY);
+	if (y % m_iClusterSize == 0)
+		MarkOneClusterDirty(iClusterX, iClusterY - 1);
+	if (y % m_iClusterSize == m_iClusterSize - 1)
+		MarkOneClusterDirty(iClusterX, iClusterY + 1);
+}
+
+
+
+
+//rebuild a cluster if it is dirty
+//the clusters are only built when the search reaches them, thus the far clusters cost nothing
+const AstarCluster & Astar::GetCluster(const int & iClusterIdx, bool isIgnoreCorner)
+{
+	//the intra edges depend on the corner rule
+	if (isIgnoreCorner != m_bClusterCornerFlag)
+	{
+		m_bClusterCornerFlag = isIgnoreCorner;
+		for (int i = 0; i != m_vClusters.size(); ++i)
+			m_vClusters[i].bDirty = true;
+	}
+
+	AstarCluster & oCluster = m_vClusters[iClusterIdx];
+	if (oCluster.bDirty)
+	{
+		BuildCluster(iClusterIdx, isIgnoreCorner);
+		oCluster.bDirty = false;
+	}
+
+	return oCluster;
 }
 
 
 
 
-bool Astar::isCanreach(const AstarPoint *point, const AstarPoint *target, bool isIgnoreCorner) const
+//add an entrance grid and its connection to a neighboring cluster
+void Astar::AddTransition(AstarCluster & oCluster, const int & iGridIdx, const int & iNeighborIdx)
 {
-	if (target->x<0 || target->x>maze.size() - 1
-		|| target->y<0 || target->y>maze[0].size() - 1
-		|| maze[target->x][target->y] == 1
-		|| target->x == point->x&&target->y == point->y
-		|| isInList(closeList, target)) //Returns false if the point coincides with the current node is out of the map, is an obstacle, or is in the close list
+	int iLocalIdx = 0;
+	while (iLocalIdx != oCluster.vEntrances.size() && oCluster.vEntrances[iLocalIdx] != iGridIdx)
+		iLocalIdx++;
+
+	if (iLocalIdx == oCluster.vEntrances.size())
+	{
+		oCluster.vEntrances.push_back(iGridIdx);
+		oCluster.vInterEdges.push_back(std::vector<int>());
+	}
+
+	oCluster.vInterEdges[iLocalIdx].push_back(iNeighborIdx);
+}
+
+
+
+
+//rebuild the entrances and edges of a cluster
+//a run of free grid pairs on a border gives one entrance at its middle, or two at its ends if it is long,
+//the neighboring cluster gets the same entrances from the same run
+void Astar::BuildCluster(const int & iClusterIdx, bool isIgnoreCorner)
+{
+	AstarCluster & oCluster = m_vClusters[iClusterIdx];
+	oCluster.vEntrances.clear();
+	oCluster.vInterEdges.clear();
+	oCluster.vIntraEdges.clear();
+
+	int iClusterX = iClusterIdx / m_iClusterRows;
+	int iClusterY = iClusterIdx % m_iClusterRows;
+	int iMinX = iClusterX * m_iClusterSize;
+	int iMaxX = std::min(iMinX + m_iClusterSize, m_iMapCols) - 1;
+	int iMinY = iClusterY * m_iClusterSize;
+	int iMaxY = std::min(iMinY + m_iClusterSize, m_iMapRows) - 1;
+
+	//the four borders, 0 and 1 are the borders at min x and max x, 2 and 3 are at min y and max y
+	for (int iSide = 0; iSide != 4; ++iSide)
+	{
+		int iBorder = iSide == 0 ? iMinX : iSide == 1 ? iMaxX : iSide == 2 ? iMinY : iMaxY;
+		int iOutside = iSide % 2 ? iBorder + 1 : iBorder - 1;
+		int iRunBegin = iSide < 2 ? iMinY : iMinX;
+		int iRunEnd = iSide < 2 ? iMaxY : iMaxX;
+
+		//no neighboring cluster
+		if (iOutside < 0 || iOutside >= (iSide < 2 ? m_iMapCols : m_iMapRows))
+			continue;
+
+		int iRunStart = -1;
+		for (int t = iRunBegin; t <= iRunEnd + 1; ++t)
+		{
+			bool bFreeFlag = false;
+			if (t <= iRunEnd)
+			{
+				if (iSide < 2)
+					bFreeFlag = !IsObstacle(iBorder, t) && !IsObstacle(iOutside, t);
+				else
+					bFreeFlag = !IsObstacle(t, iBorder) && !IsObstacle(t, iOutside);
+			}
+
+			if (bFreeFlag && iRunStart < 0)
+				iRunStart = t;
+
+			//a run is finished
+			if (!bFreeFlag && iRunStart >= 0)
+			{
+				int iRunLast = t - 1;
+				int vTransitions[2] = { (iRunStart + iRunLast) / 2, -1 };
+				if (iRunLast - iRunStart + 1 >= 6)
+				{
+					vTransitions[0] = iRunStart;
+					vTransitions[1] = iRunLast;
+				}
+
+				for (int k = 0; k != 2 && vTransitions[k] >= 0; ++k)
+				{
+					if (iSide < 2)
+						AddTransition(oCluster, iBorder * m_iMapRows + vTransitions[k], iOutside * m_iMapRows + vTransitions[k]);
+					else
+						AddTransition(oCluster, vTransitions[k] * m_iMapRows + iBorder, vTransitions[k] * m_iMapRows + iOutside);
+				}
+
+				iRunStart = -1;
+			}
+		}//end for t
+	}//end for iSide
+
+	//the path cost between entrances inside the cluster, the moves are symmetric thus each pair is searched once
+	oCluster.vIntraEdges.resize(oCluster.vEntrances.size());
+	SetClusterWindow(iClusterIdx);
+	for (int i = 0; i + 1 < oCluster.vEntrances.size(); ++i)
+	{
+		findPath(oCluster.vEntrances[i], -1, isIgnoreCorner);
+
+		for (int j = i + 1; j != oCluster.vEntrances.size(); ++j)
+		{
+			int iEntranceIdx = oCluster.vEntrances[j];
+			if (m_vCloseStamp[iEntranceIdx] == m_iSearchStamp)
+			{
+				oCluster.vIntraEdges[i].push_back(std::make_pair(j, m_vNodePool[iEntranceIdx].G));
+				oCluster.vIntraEdges[j].push_back(std::make_pair(i, m_vNodePool[iEntranceIdx].G));
+			}
+		}
+	}
+}
+
+
+
+
+//search on the cluster graph and refine the path in each cluster
+//the abstract nodes are the entrance grids, plus the start and the end connected to the entrances of their clusters
+bool Astar::findHierarchicalPath(const int & iStartIdx, const int & iEndIdx, bool isIgnoreCorner)
+{
+	int iStartCluster = ClusterOfGrid(iStartIdx);
+	int iEndCluster = ClusterOfGrid(iEndIdx);
+	const AstarCluster & oStartCluster = GetCluster(iStartCluster, isIgnoreCorner);
+	const AstarCluster & oEndCluster = GetCluster(iEndCluster, isIgnoreCorner);
+
+	if (oStartCluster.vEntrances.empty() || oEndCluster.vEntrances.empty())
+		return false;
+
+	//the cost from the start to the entrances of its cluster
+	std::vector<int> vStartCosts(oStartCluster.vEntrances.size(), -1);
+	SetClusterWindow(iStartCluster);
+	findPath(iStartIdx, -1, isIgnoreCorner);
+	for (int i = 0; i != oStartCluster.vEntrances.size(); ++i)
+		if (m_vCloseStamp[oStartCluster.vEntrances[i]] == m_iSearchStamp)
+			vStartCosts[i] = m_vNodePool[oStartCluster.vEntrances[i]].G;
+
+	//the cost from the entrances to the end (the moves are symmetric)
+	std::vector<int> vEndCosts(oEndCluster.vEntrances.size(), -1);
+	SetClusterWindow(iEndCluster);
+	findPath(iEndIdx, -1, isIgnoreCorner);
+	for (int i = 0; i != oEndCluster.vEntrances.size(); ++i)
+		if (m_vCloseStamp[oEndCluster.vEntrances[i]] == m_iSearchStamp)
+			vEndCosts[i] = m_vNodePool[oEndCluster.vEntrances[i]].G;
+
+	//the abstract search, the end node is -1 and the parent of first entrance is -2
+	//record of each abstract node (G, parent, closed flag)
+	struct AbstractRecord{ int G; int iParent; bool bClosed; };
+	std::unordered_map<int, AbstractRecord> mAbstractNodes;
+	//open list (F, node), the old items are skipped when they are popped
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > vAbstractOpen;
+
+	AstarPoint oEndPoint(iEndIdx / m_iMapRows, iEndIdx % m_iMapRows);
+
+	//put in a node if it is new or it has a lower G
+	auto fRelax = [&](const int & iNodeIdx, const int & iNodeG, const int & iParentIdx){
+		std::unordered_map<int, AbstractRecord>::iterator it = mAbstractNodes.find(iNodeIdx);
+		if (it != mAbstractNodes.end() && (it->second.bClosed || it->second.G <= iNodeG))
+			return;
+		AbstractRecord oRecord = { iNodeG, iParentIdx, false };
+		mAbstractNodes[iNodeIdx] = oRecord;
+		int iNodeH = 0;
+		if (iNodeIdx >= 0)
+		{
+			AstarPoint oNodePoint(iNodeIdx / m_iMapRows, iNodeIdx % m_iMapRows);
+			iNodeH = calcH(&oNodePoint, &oEndPoint);
+		}
+		vAbstractOpen.push(std::make_pair(iNodeG + iNodeH, iNodeIdx));
+	};
+
+	for (int i = 0; i != oStartCluster.vEntrances.size(); ++i)
+		if (vStartCosts[i] >= 0)
+			fRelax(oStartCluster.vEntrances[i], vStartCosts[i], -2);
+
+	bool bReachFlag = false;
+	while (!vAbstractOpen.empty())
+	{
+		int iNodeIdx = vAbstractOpen.top().second;
+		vAbstractOpen.pop();
+
+		AbstractRecord & oRecord = mAbstractNodes[iNodeIdx];
+		if (oRecord.bClosed)
+			continue;
+		oRecord.bClosed = true;
+		int iNodeG = oRecord.G;
+
+		if (iNodeIdx == -1)
+		{
+			bReachFlag = true;
+			break;
+		}
+
+		//find the entrance in its cluster
+		int iClusterIdx = ClusterOfGrid(iNodeIdx);
+		const AstarCluster & oCluster = GetCluster(iClusterIdx, isIgnoreCorner);
+		int iLocalIdx = 0;
+		while (iLocalIdx != oCluster.vEntrances.size() && oCluster.vEntrances[iLocalIdx] != iNodeIdx)
+			iLocalIdx++;
+		if (iLocalIdx == oCluster.vEntrances.size())
+			continue;
+
+		for (int i = 0; i != oCluster.vIntraEdges[iLocalIdx].size(); ++i)
+			fRelax(oCluster.vEntrances[oCluster.vIntraEdges[iLocalIdx][i].first],
+			       iNodeG + oCluster.vIntraEdges[iLocalIdx][i].second, iNodeIdx);
+
+		for (int i = 0; i != oCluster.vInterEdges[iLocalIdx].size(); ++i)
+			fRelax(oCluster.vInterEdges[iLocalIdx][i], iNodeG + kCost1, iNodeIdx);
+
+		if (iClusterIdx == iEndCluster && vEndCosts[iLocalIdx] >= 0)
+			fRelax(-1, iNodeG + vEndCosts[iLocalIdx], iNodeIdx);
+	}
+
+	if (!bReachFlag)
+		return false;
+
+	//the entrances of path from the start to the end
+	std::vector<int> vAbstractPath;
+	for (int iNodeIdx = mAbstractNodes[-1].iParent; iNodeIdx != -2; iNodeIdx = mAbstractNodes[iNodeIdx].iParent)
+		vAbstractPath.push_back(iNodeIdx);
+	std::reverse(vAbstractPath.begin(), vAbstractPath.end());
+	vAbstractPath.insert(vAbstractPath.begin(), iStartIdx);
+	vAbstractPath.push_back(iEndIdx);
+
+	//refine each piece in its cluster, a piece crossing two clusters is one step
+	m_vPathPoints.clear();
+	m_vPathPoints.push_back(AstarPoint(iStartIdx / m_iMapRows, iStartIdx % m_iMapRows));
+	for (int i = 1; i != vAbstractPath.size(); ++i)
+	{
+		int iFromIdx = vAbstractPath[i - 1];
+		int iToIdx = vAbstractPath[i];
+
+		if (iFromIdx == iToIdx)
+			continue;
+
+		if (ClusterOfGrid(iFromIdx) != ClusterOfGrid(iToIdx))
+		{
+			m_vPathPoints.push_back(AstarPoint(iToIdx / m_iMapRows, iToIdx % m_iMapRows));
+			continue;
+		}
+
+		SetClusterWindow(ClusterOfGrid(iFromIdx));
+		AstarPoint *result = findPath(iFromIdx, iToIdx, isIgnoreCorner);
+		if (!result)
+			return false;
+		AppendPath(result);
+	}
+
+	return true;
+}
+
+
+
+
+bool Astar::isCanreach(const AstarPoint *point, const int & x, const int & y, bool isIgnoreCorner) const
+{
+	if (x<m_iWindowMinX || x>m_iWindowMaxX
+		|| y<m_iWindowMinY || y>m_iWindowMaxY
+		|| IsObstacle(x, y)
+		|| x == point->x&&y == point->y
+		|| m_vCloseStamp[x * m_iMapRows + y] == m_iSearchStamp) //Returns false if the point coincides with the current node is out of the map, is an obstacle, or is in the close list
 		return false;
 	else
 	{
-		if (abs(point->x - target->x) + abs(point->y - target->y) == 1) //non-oblique angle pass 
+		if (abs(point->x - x) + abs(point->y - y) == 1) //non-oblique angle pass 
 			return true;
 		else
 		{
 			//judge whether is holding in diagonal
-			if (maze[point->x][target->y] == 0 && maze[target->x][point->y] == 0)
+			if (!IsObstacle(point->x, y) && !IsObstacle(x, point->y))
 				return true;
 			else
 				return isIgnoreCorner;
@@ -361,16 +809,89 @@ bool Astar::isCanreach(const AstarPoint *point, const AstarPoint *target, bool i
 
 
 
-std::vector<AstarPoint *> Astar::getSurroundPoints(const AstarPoint *point, bool isIgnoreCorner) const
+//whether node a is before node b in heap
+//the lower F goes first, the lower H goes first if F is the same
+inline bool Astar::HeapLess(const int & iNodeA, const int & iNodeB) const
+{
+	const AstarPoint & oNodeA = m_vNodePool[iNodeA];
+	const AstarPoint & oNodeB = m_vNodePool[iNodeB];
+	if (oNodeA.F != oNodeB.F)
+		return oNodeA.F < oNodeB.F;
+	return oNodeA.H < oNodeB.H;
+}
+
+
+
+
+void Astar::HeapPush(const int & iNodeIdx)
+{
+	m_vOpenHeap.push_back(iNodeIdx);
+	m_vHeapPos[iNodeIdx] = m_vOpenHeap.size() - 1;
+	HeapSiftUp(m_vOpenHeap.size() - 1);
+}
+
+
+
+
+int Astar::HeapPop()
+{
+	int iTopIdx = m_vOpenHeap.front();
+	m_vHeapPos[iTopIdx] = -1;
+
+	//move the last one to the top
+	m_vOpenHeap.front() = m_vOpenHeap.back();
+	m_vOpenHeap.pop_back();
+	if (!m_vOpenHeap.empty())
+	{
+		m_vHeapPos[m_vOpenHeap.front()] = 0;
+		HeapSiftDown(0);
+	}
+
+	return iTopIdx;
+}
+
+
+
+
+void Astar::HeapSiftUp(int iHeapPos)
 {
-	std::vector<AstarPoint *> surroundPoints;
+	int iNodeIdx = m_vOpenHeap[iHeapPos];
+	while (iHeapPos > 0)
+	{
+		int iParentPos = (iHeapPos - 1) / 2;
+		if (!HeapLess(iNodeIdx, m_vOpenHeap[iParentPos]))
+			break;
+		m_vOpenHeap[iHeapPos] = m_vOpenHeap[iParentPos];
+		m_vHeapPos[m_vOpenHeap[iHeapPos]] = iHeapPos;
+		iHeapPos = iParentPos;
+	}
+	m_vOpenHeap[iHeapPos] = iNodeIdx;
+	m_vHeapPos[iNodeIdx] = iHeapPos;
+}
+
+
 
-	for (int x = point->x - 1; x <= point->x + 1; x++)
-	for (int y = point->y - 1; y <= point->y + 1; y++)
-	if (isCanreach(point, new AstarPoint(x, y), isIgnoreCorner))
-		surroundPoints.push_back(new AstarPoint(x, y));
 
-	return surroundPoints;
+void Astar::HeapSiftDown(int iHeapPos)
+{
+	int iHeapSize = m_vOpenHeap.size();
+	int iNodeIdx = m_vOpenHeap[iHeapPos];
+	while (true)
+	{
+		int iChildPos = 2 * iHeapPos + 1;
+		if (iChildPos >= iHeapSize)
+			break;
+		//the smaller child
+		if (iChildPos + 1 < iHeapSize && HeapLess(m_vOpenHeap[iChildPos + 1], m_vOpenHeap[iChildPos]))
+			iChildPos++;
+		if (!HeapLess(m_vOpenHeap[iChildPos], iNodeIdx))
+			break;
+		m_vOpenHeap[iHeapPos] = m_vOpenHeap[iChildPos];
+		m_vHeapPos[m_vOpenHeap[iHeapPos]] = iHeapPos;
+		iHeapPos = iChildPos;
+	}
+	m_vOpenHeap[iHeapPos] = iNodeIdx;
+	m_vHeapPos[iNodeIdx] = iHeapPos;
 }
 
 
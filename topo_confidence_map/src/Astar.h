@@ -5,6 +5,10 @@
 #include <list>  
 #include <iostream>
 #include <math.h>  
+#include <stdint.h>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
 
 #include "OP.h"
 
@@ -22,6 +26,10 @@ namespace topology_map {
 // - modified the class to adapt to husky system
 //Version 3.0 2019.05.07
 // - modified to a online version
+//Version 3.1
+// - the open list is an indexed binary heap, the node records and close flags are flat arrays of the map size
+// - the obstacle map is a bit layer which is updated grid by grid with the label of confidence map
+// - add a hierarchical search (HPA*) on square clusters for the far goals
 
 ///************************************************************************///
 
@@ -35,7 +43,26 @@ struct AstarPoint
 	//The coordinates of the parent, there is no pointer here, which simplifies the code  
 	AstarPoint *parent; 
 	//Variable initialization  
-	AstarPoint(int _x, int _y) :x(_x), y(_y), F(0), G(0), H(0), parent(NULL){
+	AstarPoint(int _x = 0, int _y = 0) :x(_x), y(_y), F(0), G(0), H(0), parent(NULL){
+		//none
+	}
+
+};
+
+//a square block of grids in the hierarchical search
+//the entrances are the grids on the cluster border which connect to a neighboring cluster
+struct AstarCluster
+{
+	//whether the entrances and edges need to be rebuilt
+	bool bDirty;
+	//1d index of entrance grids
+	std::vector<int> vEntrances;
+	//the entrance grids of neighboring clusters that each entrance connects to (one straight step)
+	std::vector<std::vector<int> > vInterEdges;
+	//the reachable entrances of the same cluster and the path cost (local entrance index, cost)
+	std::vector<std::vector<std::pair<int, int> > > vIntraEdges;
+
+	AstarCluster() :bDirty(true){
 		//none
 	}
 
@@ -49,16 +76,54 @@ class Astar
 {
 public:
 
-    Astar():kCost1(10), kCost2(10){
+    Astar():kCost1(10), kCost2(10), m_iMapCols(0), m_iMapRows(0),
+            m_iWindowMinX(0), m_iWindowMaxX(-1), m_iWindowMinY(0), m_iWindowMaxY(-1),
+            m_iClusterSize(32), m_iClusterCols(0), m_iClusterRows(0), m_bClusterCornerFlag(false),
+            m_iSearchStamp(0){
 
     }
 
+    //allocate the obstacle bits with the map size, all grids are travelable at the beginning (label 0)
     void InitAstarTravelMap(const grid_map::GridMap & oExtendGridMap);
 
-    //update map which record the travelable grids
+    //rebuild all obstacle bits from the labels, it is only needed if the labels are changed without SetObstacle
     void UpdateTravelMap(const grid_map::GridMap & oExtendGridMap,
-	                     const std::vector<ConfidenceValue> & vConfidenceMap);
+	                     const ConfidenceMap & vConfidenceMap);
+
+    //the obstacle label of a confidence map label (obstacle or boundary)
+    inline static bool IsObstacleLabel(const int & iLabel){
+
+    	return iLabel == 1 || iLabel == 3;
+
+    };
+
+    //set or clear the obstacle bit of a grid, iGridIdx is the 1d index of ExtendedGM
+    inline void SetObstacle(const int & iGridIdx, const bool & bObstacleFlag){
+
+    	uint64_t iBitMask = uint64_t(1) << (iGridIdx & 63);
+    	if (bool(m_vObstacleBits[iGridIdx >> 6] & iBitMask) == bObstacleFlag)
+    		return;
+
+    	m_vObstacleBits[iGridIdx >> 6] ^= iBitMask;
+
+    	//the clusters around this grid need to be rebuilt
+    	if (m_iClusterSize > 0)
+    		MarkClusterDirty(iGridIdx);
+
+    };
+
+    //whether a grid (x,y) is an obstacle grid
+    inline bool IsObstacle(const int & x, const int & y) const{
+
+    	int iGridIdx = x * m_iMapRows + y;
+    	return (m_vObstacleBits[iGridIdx >> 6] >> (iGridIdx & 63)) & 1;
+
+    };
 
+    //set the cluster size (grids) of hierarchical search, 0 means the full map search only
+    void SetClusterSize(const int & iClusterSize);
+
+	//the output points are kept in the path buffer, which are valid until next search
 	std::list<AstarPoint *> GetPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner);
     //roload for a point cloud path output
 	bool GetPath(pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud, 
@@ -72,25 +137,62 @@ public:
 		                          std::vector<float> & vQualityFeature,
 		             pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud, 
 	                                 const ExtendedGM & oExtendGridMap,
-	               const std::vector<ConfidenceValue> & vConfidenceMap,
+	               const ConfidenceMap & vConfidenceMap,
 	                                  const pcl::PointXYZ & oHeadPoint, 
 	                                  const pcl::PointXYZ & oTailPoint, 
 	                                               bool isIgnoreCorner);
 
-	//the obstacle map
-	std::vector<std::vector<int>> maze;
-
 private:
 
-	AstarPoint *findPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner);
+	//search a path and return its end node, the parent of each node is the previous grid of path
+	AstarPoint *SearchPath(AstarPoint &startPoint, AstarPoint &endPoint, bool isIgnoreCorner);
+
+	//search in the current window, iEndIdx < 0 computes G of all reachable grids without an end
+	AstarPoint *findPath(const int & iStartIdx, const int & iEndIdx, bool isIgnoreCorner);
+
+	//limit the search in a window of grids (including the bounds)
+	void SetSearchWindow(const int & iMinX, const int & iMaxX, const int & iMinY, const int & iMaxY);
+
+	//append the grids from the start to a searched node at the end of path buffer
+	void AppendPath(AstarPoint *result);
+
+	//***hierarchical search***
+	//allocate the clusters with the map size
+	void InitClusters();
+
+	//the cluster of a grid
+	inline int ClusterOfGrid(const int & iGridIdx) const{
+
+		return (iGridIdx / m_iMapRows / m_iClusterSize) * m_iClusterRows + (iGridIdx % m_iMapRows) / m_iClusterSize;
+
+	};
 
-	std::vector<AstarPoint *> getSurroundPoints(const AstarPoint *point, bool isIgnoreCorner) const;
-	//judge whether a point can be used for the next step  
-	bool isCanreach(const AstarPoint *point, const AstarPoint *target, bool isIgnoreCorner) const; 
-	//judge whether a point is included in the on/off list
-	AstarPoint *isInList(const std::list<AstarPoint *> &list, const AstarPoint *point) const; 
-	//Returns the node with the lowest F value from the open list
-	AstarPoint *getLeastFpoint(); 
+	//limit the search in a cluster
+	void SetClusterWindow(const int & iClusterIdx);
+
+	//mark the clusters whose entrances or edges may be changed by a grid
+	void MarkClusterDirty(const int & iGridIdx);
+
+	//mark one cluster
+	void MarkOneClusterDirty(const int & iClusterX, const int & iClusterY);
+
+	//get a cluster, which is rebuilt if it is dirty
+	const AstarCluster & GetCluster(const int & iClusterIdx, bool isIgnoreCorner);
+
+	//rebuild the entrances and edges of a cluster
+	void BuildCluster(const int & iClusterIdx, bool isIgnoreCorner);
+
+	//add an entrance grid and its connection to a neighboring cluster
+	void AddTransition(AstarCluster & oCluster, const int & iGridIdx, const int & iNeighborIdx);
+
+	//search on the cluster graph and refine the path in each cluster
+	bool findHierarchicalPath(const int & iStartIdx, const int & iEndIdx, bool isIgnoreCorner);
+
+	//prepare the node pool and flags for a new search
+	void PrepareSearch();
+
+	//judge whether a grid can be used for the next step from a point
+	bool isCanreach(const AstarPoint *point, const int & x, const int & y, bool isIgnoreCorner) const; 
 
 	//compute FGH value  
 	int calcG(AstarPoint *temp_start, AstarPoint *point);
@@ -99,11 +201,50 @@ private:
 
 	int calcF(AstarPoint *point);
 
+	//***indexed binary heap of open list, ordered by F***
+	//whether node a is before node b in heap
+	inline bool HeapLess(const int & iNodeA, const int & iNodeB) const;
+	//push a node
+	void HeapPush(const int & iNodeIdx);
+	//pop the node with the lowest F value
+	int HeapPop();
+	//move a node up after its F value decreases
+	void HeapSiftUp(int iHeapPos);
+	//move a node down
+	void HeapSiftDown(int iHeapPos);
+
     //data set
-    //open the list
-	std::list<AstarPoint *> openList;    
-    //close the list
-	std::list<AstarPoint *> closeList;   
+    //obstacle bits, one bit for each grid at the 1d index, 1 is an obstacle grid in astar algorithm
+	std::vector<uint64_t> m_vObstacleBits;
+	//map size, the 1d index of grid (x,y) is x * m_iMapRows + y
+	int m_iMapCols;
+	int m_iMapRows;
+	//the search window, a node out of it is not reachable
+	int m_iWindowMinX;
+	int m_iWindowMaxX;
+	int m_iWindowMinY;
+	int m_iWindowMaxY;
+	//cluster size (grids), cluster number in x and y, the index of cluster (cx,cy) is cx * m_iClusterRows + cy
+	int m_iClusterSize;
+	int m_iClusterCols;
+	int m_iClusterRows;
+	std::vector<AstarCluster> m_vClusters;
+	//the corner rule that the intra edges are computed with
+	bool m_bClusterCornerFlag;
+	//the output path from the start to the end
+	std::vector<AstarPoint> m_vPathPoints;
+    //node records, the node of grid (x,y) is at x * rows + y
+	std::vector<AstarPoint> m_vNodePool;
+	//the node is initialized in the search if its stamp is equal to m_iSearchStamp
+	std::vector<unsigned int> m_vOpenStamp;
+	//the node is in close list if its stamp is equal to m_iSearchStamp
+	std::vector<unsigned int> m_vCloseStamp;
+	//the stamp of current search
+	unsigned int m_iSearchStamp;
+    //open list (node indices)
+	std::vector<int> m_vOpenHeap;
+	//position of each node in m_vOpenHeap
+	std::vector<int> m_vHeapPos;
 
 	const int kCost1; //Direct movement cost  
     const int kCost2; //Diagonal movement cost
@@ -4,7 +4,10 @@ namespace topology_map {
 
 
 
-BranchBound::BranchBound(const int & f_iNodeNum){
+BranchBound::BranchBound(const int & f_iNodeNum):m_iDPMaxNodeNum(16),
+                                                m_iMaxExpandNum(200000),
+                                                m_iExpandNum(0),
+                                                m_fBestCost(FLT_MAX){
 
 	//int 
 	iNodeNum = f_iNodeNum;
@@ -362,5 +365,244 @@ float BranchBound::SolveOP(std::vector<int> & vResTour){
 	return bestCostSoFar;
 }
 
-}/*namespace*/
 
+
+
+//set the largest node number solved by dynamic programming
+//the memory is 2^(n-1) * (n-1) * 5 bytes, about 47MB with 20 nodes
+void BranchBound::SetDPMaxNodeNum(const int & iDPMaxNodeNum){
+
+	m_iDPMaxNodeNum = iDPMaxNodeNum;
+	if (m_iDPMaxNodeNum > 20)
+		m_iDPMaxNodeNum = 20;
+
+}
+
+
+//set the largest number of expanded nodes in pruned branch and bound
+void BranchBound::SetMaxExpandNum(const int & iMaxExpandNum){
+
+	m_iMaxExpandNum = iMaxExpandNum > 0 ? iMaxExpandNum : 1;
+
+}
+
+
+//copy the effective matrix to a flat array (0-based)
+void BranchBound::FlattenEffective(){
+
+	m_vFlatEffective.resize(iNodeNum * iNodeNum);
+	for (int i = 0; i != iNodeNum; ++i)
+		for (int j = 0; j != iNodeNum; ++j)
+			m_vFlatEffective[i * iNodeNum + j] = vEffective[i + 1][j + 1];
+
+}
+
+
+//solve the non-loop travel exactly
+//the output is the same as SolveOP, vResTour starts with 0 (the beginning node)
+float BranchBound::SolveOPExact(std::vector<int> & vResTour){
+
+	vResTour.clear();
+
+	if (iNodeNum <= 0)
+		return -1.0;
+
+	//only the beginning node
+	if (iNodeNum == 1){
+		vResTour.push_back(0);
+		return 0.0;
+	}
+
+	FlattenEffective();
+
+	if (iNodeNum <= m_iDPMaxNodeNum)
+		return SolveOPDP(vResTour);
+	else
+		return SolveOPPruned(vResTour);
+
+}
+
+
+//Held-Karp dynamic programming for the non-loop travel
+//the subset (mask) is over the nodes except the beginning node, bit j is node j + 1
+//m_vDPCost[mask * m + j] is the least cost from the beginning node through all nodes of mask ending at node j + 1
+float BranchBound::SolveOPDP(std::vector<int> & vResTour){
+
+	int m = iNodeNum - 1;
+	unsigned int iFullMask = (1u << m) - 1;
+
+	m_vDPCost.assign(size_t(iFullMask + 1) * m, FLT_MAX);
+	m_vDPParent.resize(size_t(iFullMask + 1) * m);
+
+	//from the beginning node
+	for (int j = 0; j != m; ++j){
+		float fEdge = m_vFlatEffective[j + 1];
+		if (fEdge != -1.0){
+			m_vDPCost[(1u << j) * m + j] = fEdge;
+			m_vDPParent[(1u << j) * m + j] = 255;
+		}
+	}
+
+	//the subsets are visited in increasing order, thus all smaller subsets are done
+	for (unsigned int iMask = 1; iMask < iFullMask; ++iMask){
+
+		const float * pMaskCost = &m_vDPCost[size_t(iMask) * m];
+
+		//each end node in the subset
+		for (unsigned int iEndBits = iMask; iEndBits; iEndBits &= iEndBits - 1){
+
+			int j = __builtin_ctz(iEndBits);
+			float fCost = pMaskCost[j];
+			if (fCost == FLT_MAX)
+				continue;
+
+			const float * pEdges = &m_vFlatEffective[(j + 1) * iNodeNum + 1];
+
+			//each node out of the subset
+			for (unsigned int iNextBits = iFullMask & ~iMask; iNextBits; iNextBits &= iNextBits - 1){
+
+				int k = __builtin_ctz(iNextBits);
+				if (pEdges[k] == -1.0)
+					continue;
+
+				size_t iNextPos = size_t(iMask | (1u << k)) * m + k;
+				float fNextCost = fCost + pEdges[k];
+				if (fNextCost < m_vDPCost[iNextPos]){
+					m_vDPCost[iNextPos] = fNextCost;
+					m_vDPParent[iNextPos] = (unsigned char)j;
+				}
+
+			}//end for iNextBits
+
+		}//end for iEndBits
+
+	}//end for iMask
+
+	//the best end node
+	int iBestEnd = -1;
+	float fBestCost = FLT_MAX;
+	for (int j = 0; j != m; ++j){
+		if (m_vDPCost[size_t(iFullMask) * m + j] < fBestCost){
+			fBestCost = m_vDPCost[size_t(iFullMask) * m + j];
+			iBestEnd = j;
+		}
+	}
+
+	if (iBestEnd < 0)
+		return -1.0;
+
+	//trace back from the end node
+	std::vector<int> vBackTour;
+	unsigned int iMask = iFullMask;
+	int j = iBestEnd;
+	while (j != 255){
+		vBackTour.push_back(j + 1);
+		int iPrevNode = m_vDPParent[size_t(iMask) * m + j];
+		iMask &= ~(1u << j);
+		j = iPrevNode;
+	}
+
+	vResTour.push_back(0);
+	for (int i = int(vBackTour.size()) - 1; i >= 0; --i)
+		vResTour.push_back(vBackTour[i]);
+
+	return fBestCost;
+
+}
+
+
+//depth first branch and bound for the non-loop travel
+//the first branch of each depth is the nearest node, thus the first tour is the greedy one,
+//and the search can stop at any time with the best tour so far
+float BranchBound::SolveOPPruned(std::vector<int> & vResTour){
+
+	//the buffers are reused by each call
+	m_vSearchTour.resize(iNodeNum);
+	for (int i = 0; i != iNodeNum; ++i)
+		m_vSearchTour[i] = i;
+	m_vChildOrder.resize(iNodeNum * iNodeNum);
+	m_vBestTour.clear();
+	m_fBestCost = FLT_MAX;
+	m_iExpandNum = 0;
+
+	SearchOPTour(0, 0.0);
+
+	if (m_iExpandNum >= m_iMaxExpandNum)
+		std::cout << "branch and bound stops at " << m_iExpandNum << " expanded nodes" << std::endl;
+
+	if (m_fBestCost == FLT_MAX)
+		return -1.0;
+
+	vResTour = m_vBestTour;
+
+	return m_fBestCost;
+
+}
+
+
+//search the tours whose first s + 1 nodes are fixed in m_vSearchTour
+//each unvisited node is entered once from the current node or another unvisited node,
+//so the sum of their least such incoming edges is a lower bound of the rest cost
+void BranchBound::SearchOPTour(const int & s, const float & fCurrentCost){
+
+	if (m_iExpandNum >= m_iMaxExpandNum)
+		return;
+	m_iExpandNum++;
+
+	//a complete tour
+	if (s == iNodeNum - 1){
+		if (fCurrentCost < m_fBestCost){
+			m_fBestCost = fCurrentCost;
+			m_vBestTour = m_vSearchTour;
+		}
+		return;
+	}
+
+	//bound
+	float fRestMinCost = 0.0;
+	for (int i = s + 1; i != iNodeNum; ++i){
+		int iTargetNode = m_vSearchTour[i];
+		float fMinCost = FLT_MAX;
+		for (int k = s; k != iNodeNum; ++k){
+			float fEdge = m_vFlatEffective[m_vSearchTour[k] * iNodeNum + iTargetNode];
+			if (k != i && fEdge != -1.0 && fEdge < fMinCost)
+				fMinCost = fEdge;
+		}
+		//a node can not be reached
+		if (fMinCost == FLT_MAX)
+			return;
+		fRestMinCost += fMinCost;
+	}
+
+	if (fCurrentCost + fRestMinCost >= m_fBestCost)
+		return;
+
+	//the children ordered by the edge cost
+	int iCurNode = m_vSearchTour[s];
+	const float * pEdges = &m_vFlatEffective[iCurNode * iNodeNum];
+	int * pChildOrder = &m_vChildOrder[s * iNodeNum];
+	int iChildNum = 0;
+	for (int i = s + 1; i != iNodeNum; ++i)
+		if (pEdges[m_vSearchTour[i]] != -1.0)
+			pChildOrder[iChildNum++] = m_vSearchTour[i];
+
+	std::sort(pChildOrder, pChildOrder + iChildNum, [&](const int & iNodeA, const int & iNodeB){
+		return pEdges[iNodeA] < pEdges[iNodeB];
+	});
+
+	for (int c = 0; c != iChildNum; ++c){
+
+		//the position of child in unvisited part
+		int iChildPos = s + 1;
+		while (m_vSearchTour[iChildPos] != pChildOrder[c])
+			iChildPos++;
+
+		std::swap(m_vSearchTour[s + 1], m_vSearchTour[iChildPos]);
+		SearchOPTour(s + 1, fCurrentCost + pEdges[pChildOrder[c]]);
+		std::swap(m_vSearchTour[s + 1], m_vSearchTour[iChildPos]);
+
+	}//end for c
+
+}
+
+}/*namespace*/
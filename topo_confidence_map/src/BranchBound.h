@@ -6,6 +6,7 @@
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <cfloat>
 #include "ExtendedGridMap.h"
 
 namespace topology_map {
@@ -179,13 +180,55 @@ public:
     //solve the non-loop travel (not closed graph)
 	float SolveOP(std::vector<int> & vResTour);
 
+	//solve the non-loop travel exactly, the same output as SolveOP
+	//the subset dynamic programming is used for small node sets, otherwise the pruned branch and bound
+	float SolveOPExact(std::vector<int> & vResTour);
+
+	//set the largest node number solved by dynamic programming (at most 20)
+	void SetDPMaxNodeNum(const int & iDPMaxNodeNum);
+
+	//set the largest number of expanded nodes in pruned branch and bound, the best tour so far is output if it is up to
+	void SetMaxExpandNum(const int & iMaxExpandNum);
+
 private:
 
+	//Held-Karp dynamic programming over the subsets of nodes
+	float SolveOPDP(std::vector<int> & vResTour);
+
+	//depth first branch and bound with an admissible bound, the tour and children are kept in the reused buffers
+	float SolveOPPruned(std::vector<int> & vResTour);
+
+	//search the tours whose first s + 1 nodes are fixed in m_vSearchTour
+	void SearchOPTour(const int & s, const float & fCurrentCost);
+
+	//copy the effective matrix to a flat array (0-based)
+	void FlattenEffective();
+
 	//node number
 	int iNodeNum;
 	//vEffective[1:n][1:n] effective measure matrix
 	std::vector<std::vector<float>> vEffective; 
 
+	//flat effective matrix, m_vFlatEffective[i * iNodeNum + j] is vEffective[i + 1][j + 1]
+	std::vector<float> m_vFlatEffective;
+
+	//the largest node number of dynamic programming
+	int m_iDPMaxNodeNum;
+	//the cost and the last node of each subset and end node in dynamic programming
+	std::vector<float> m_vDPCost;
+	std::vector<unsigned char> m_vDPParent;
+
+	//the largest number of expanded nodes in pruned branch and bound
+	int m_iMaxExpandNum;
+	int m_iExpandNum;
+	//the tour being searched, the nodes after the fixed part are unvisited
+	std::vector<int> m_vSearchTour;
+	//the ordered children of each depth, m_vChildOrder[s * iNodeNum ...]
+	std::vector<int> m_vChildOrder;
+	//the best tour so far
+	std::vector<int> m_vBestTour;
+	float m_fBestCost;
+
 };
 
 
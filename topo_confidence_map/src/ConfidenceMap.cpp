@@ -29,7 +29,14 @@ Confidence::Confidence(float f_fSigma,
 	                 m_fTraversWeight(0.9),
                      m_fExploreWeight(0.1),
                          m_fDisWeight(0.6),
-                       m_fBoundWeight(0.4){
+                       m_fBoundWeight(0.4),
+                           m_oGHPRer(3.7),
+                      m_oThreadPool(0),
+                      m_iBoundColNum(1),
+                  m_fBoundResolution(1.0),
+                     m_iSuppressStamp(0),
+                         m_iRingHead(0),
+                         m_iRingSize(0){
 
     //set sigma value
 	SetSigmaValue(f_fSigma);
@@ -166,6 +173,25 @@ void Confidence::SetNodeGenParas(const float & f_fMinNodeThr){
 }
 
 
+/*************************************************
+Function: SetThreadNum
+Description: set the number of worker threads of parallel calculation
+Calls: ThreadPool::SetThreadNum
+Called By: TopologyMap::ReadLaunchParams
+Table Accessed: none
+Table Updated: none
+Input: iThreadNum - the number of workers, 0 means the number of hardware threads
+Output: m_oThreadPool
+Return: none
+Others: none
+*************************************************/
+void Confidence::SetThreadNum(const int & iThreadNum){
+
+	m_oThreadPool.SetThreadNum(iThreadNum);
+
+}
+
+
 /*************************************************
 Function: OutNodeGenParas
 Description: output the node generation threshold
@@ -639,8 +665,7 @@ float Confidence::ComputeEuclideanDis(pcl::PointXYZ & oQueryPoint, pcl::PointXYZ
 /*************************************************
 Function: DistanceTerm
 Description: the function is to compute the distance feature to the confidence value
-Calls: GaussianKernel()
-       ComputeTotalCoffidence()
+Calls: DistanceKernel
 Called By: main function of project 
 Table Accessed: none
 Table Updated: none
@@ -650,36 +675,47 @@ Input: vConfidenceMap - the confidence map (grid map)
 	   vGroundCloud - the NEARBY travelable point clouds (the NEARBY ground point clouds) 
 Output: update the total confidence (actually the travelTerm) value of the given nearby grid
 Return: none
-Others: none
+Others: the terms of nearby grids are gathered into m_oTermBuffer, 
+        the Gaussian kernel and the total value are computed in batch by DistanceKernel,
+        and the results are written back, each grid appears once in vNearGroundIdxs
 *************************************************/
-void Confidence::DistanceTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+void Confidence::DistanceTerm(ConfidenceMap & vConfidenceMap,
 	                                      const pcl::PointXYZ & oRobotPoint,
                                    const std::vector<int> & vNearGroundIdxs,
 	                                       const PCLCloudXYZ & vGroundCloud){
 
-	//**compute the distance part** 
-	for (int i = 0; i != vNearGroundIdxs.size(); ++i) {
+	int iGridNum = vNearGroundIdxs.size();
+	if (!iGridNum)
+		return;
 
-		int iNearGridId = vNearGroundIdxs[i];
-	
-		//non-empty ground grid
-		//if (vConfidenceMap[iNearGridId].label == 2) {
+	//**gather the nearby grids** 
+	m_oTermBuffer.Resize(iGridNum);
+	for (int i = 0; i != iGridNum; ++i) {
 
-			//compute smooth distance using Gaussin Kernel based on the center point
-			//the empty grid has zero value in this term
-			float fGridTravelRes = GaussianKernel(oRobotPoint, 
-				                                  vGroundCloud.points[i], 
-				                                  m_fSigma);
+		//the empty grid has zero value in this term
+		ConfidenceRef oGrid = vConfidenceMap[vNearGroundIdxs[i]];
 
-			//**********Incremental item************
-	        //fd(p) = max(fd(pi))  
-		    if(vConfidenceMap[iNearGridId].travelTerm < fGridTravelRes)
-		    	vConfidenceMap[iNearGridId].travelTerm = fGridTravelRes;
+		m_oTermBuffer.vX[i] = vGroundCloud.points[i].x - oRobotPoint.x;
+		m_oTermBuffer.vY[i] = vGroundCloud.points[i].y - oRobotPoint.y;
+		m_oTermBuffer.vZ[i] = vGroundCloud.points[i].z - oRobotPoint.z;
+		m_oTermBuffer.vTravel[i] = oGrid.travelTerm;
+		m_oTermBuffer.vBound[i] = oGrid.boundTerm;
+		m_oTermBuffer.vVisi[i] = oGrid.visiTerm.value;
 
-            //update the total coffidence value for new distance value
-		    ComputeTotalCoffidence(vConfidenceMap,iNearGridId);
+	}//end i
 
-		//}//end if 
+	//**compute the distance part** 
+	//smooth distance using Gaussin Kernel based on the center point
+	//**********Incremental item************
+	//fd(p) = max(fd(pi)), and update the total coffidence value for new distance value
+	DistanceKernel(m_oTermBuffer);
+
+	//**write back**
+	for (int i = 0; i != iGridNum; ++i) {
+
+		ConfidenceRef oGrid = vConfidenceMap[vNearGroundIdxs[i]];
+		oGrid.travelTerm = m_oTermBuffer.vTravel[i];
+		oGrid.totalValue = m_oTermBuffer.vTotal[i];
 
 	}//end i
 	
@@ -695,39 +731,37 @@ Table Accessed: none
 Table Updated: none
 Input: vConfidenceMap - the confidence map (grid map)
 	   vNearGroundIdxs - the nearby ground grid idx 
-	   pGroundCloud - the NEARBY travelable point clouds (the NEARBY ground point clouds)
-	   pBoundCloud - the NEARBY boundary point clouds
 Output: update the total confidence value (actually the boundTerm) of the given nearby grid
 Return: none
-Others: the calculation of bound term is nothing to do with the robot position
+Others: the calculation of bound term is nothing to do with the robot position,
+        the distance to the closest boundary grid is read from m_vBoundSites in O(1),
+        which is updated by AddBoundaryGrid when a boundary grid is found,
+        rather than building a kdtree of boundary points in each call
 *************************************************/
-void Confidence::BoundTerm(std::vector<ConfidenceValue> & vConfidenceMap,
-                               const std::vector<int> & vNearGroundIdxs,
-	                                const PCLCloudXYZPtr & pGroundCloud,
-	                                 const PCLCloudXYZPtr & pBoundCloud){
+void Confidence::BoundTerm(ConfidenceMap & vConfidenceMap,
+                               const std::vector<int> & vNearGroundIdxs){
 
 	 //**compute the center offset part**
 	 //maybe there is not any boundary in an open area
-	if (pBoundCloud->points.size()) {
+	if (m_vBoundSites.AllocatedTileNum()) {
 
         //define a threshold indicating where is dangerous for robot to close  
 		//float fNoTouchThr = (m_fSigma - 0.5) / m_fSigma;
 
-        //set a kdtree for boundary point clouds
-		pcl::KdTreeFLANN<pcl::PointXYZ> oBoundTree;
-		oBoundTree.setInputCloud(pBoundCloud);
+		//read only, the tiles are not allocated
+		const TiledMap<int> & vBoundSites = m_vBoundSites;
 
 		//for each non-empty neighboring grid
 		for (int i = 0; i != vNearGroundIdxs.size(); ++i) {
 
-			//compute the distance between boundary and travelable region
-			std::vector<int> vSearchIdx;
-			std::vector<float> vSearchDis;
-
-			oBoundTree.nearestKSearch(pGroundCloud->points[i], 1, vSearchIdx, vSearchDis);
+			//the boundary farther than sigma has zero value
+			int iSiteIdx = vBoundSites[vNearGroundIdxs[i]];
+			if (iSiteIdx < 0)
+				continue;
 
 			//compute the boundary distance 
-			float fBoundvalue = (m_fSigma - sqrt(vSearchDis[0])) / m_fSigma;
+			float fBoundDis = m_fBoundResolution * sqrt(float(SquareGridDis(vNearGroundIdxs[i], iSiteIdx)));
+			float fBoundvalue = (m_fSigma - fBoundDis) / m_fSigma;
 			if (fBoundvalue < 0)
 				fBoundvalue = 0.0;
             //record the maximum boundary responde indicating the closest distance
@@ -738,60 +772,199 @@ void Confidence::BoundTerm(std::vector<ConfidenceValue> & vConfidenceMap,
 			//if (vConfidenceMap[vNearGroundIdxs[i]].boundTerm > fNoTouchThr)
             //    vConfidenceMap[vNearGroundIdxs[i]].travelable = 4;
 
-            //update the total value
-            //thereby the boundterm will be calculated at the end of the other two terms 
-            ComputeTotalCoffidence(vConfidenceMap,vNearGroundIdxs[i]);
-
 		}//end i 
 
+        //update the total value
+        //thereby the boundterm will be calculated at the end of the other two terms 
+        ComputeTotalCoffidence(vConfidenceMap, vNearGroundIdxs);
+
 	}//end if
 
 }
 
+/*************************************************
+Function: InitBoundDistance
+Description: set the size of boundary distance map
+Calls: TiledMap::Initialize
+Called By: TopologyMap::InitializeGridMap
+           RebuildBoundDistance
+Table Accessed: none
+Table Updated: none
+Input: iRowNum - the row number of map
+       iColNum - the column number of map
+       fResolution - the resolution of map
+Output: m_vBoundSites - all grids have no boundary nearby
+Return: none
+Others: none
+*************************************************/
+void Confidence::InitBoundDistance(const int & iRowNum,
+	                               const int & iColNum,
+	                               const float & fResolution){
+
+	m_vBoundSites.Initialize(iRowNum, iColNum, -1);
+	m_iBoundColNum = iColNum > 0 ? iColNum : 1;
+	m_fBoundResolution = fResolution;
+
+}
+
+/*************************************************
+Function: AddBoundaryGrid
+Description: add a new boundary grid to the boundary distance map
+Calls: SquareGridDis
+Called By: TopologyMap::IngestBoundCloud
+           RebuildBoundDistance
+Table Accessed: none
+Table Updated: none
+Input: iGridIdx - the 1d index of the new boundary grid
+Output: m_vBoundSites - the grids closer to the new boundary grid than their old one
+Return: none
+Others: a brushfire from the new grid, a grid is updated and expanded only if the new boundary 
+        grid is closer than its recorded one, and the wave stops at sigma where the term is zero,
+        thus the cost only depends on the region around the new grid,
+        the boundary grid is never removed so that the map is only lowered
+*************************************************/
+void Confidence::AddBoundaryGrid(const int & iGridIdx){
+
+	if (iGridIdx < 0 || iGridIdx >= m_vBoundSites.size())
+		return;
+
+	if (m_vBoundSites[iGridIdx] == iGridIdx)
+		return;
+
+	//the distance (in grid unit) to be considered
+	float fMaxGridDis = m_fSigma / m_fBoundResolution;
+	float fMaxSquareDis = fMaxGridDis * fMaxGridDis;
+	int iRowNum = m_vBoundSites.size() / m_iBoundColNum;
+
+	const TiledMap<int> & vReadSites = m_vBoundSites;
+
+	m_vBoundSites[iGridIdx] = iGridIdx;
+	m_vBrushQueue.clear();
+	m_vBrushQueue.push_back(iGridIdx);
+
+	for (int iHead = 0; iHead != m_vBrushQueue.size(); ++iHead){
+
+		int iCurrRow = m_vBrushQueue[iHead] / m_iBoundColNum;
+		int iCurrCol = m_vBrushQueue[iHead] % m_iBoundColNum;
+
+		//8 neighbors
+		for (int iRowOff = -1; iRowOff <= 1; ++iRowOff){
+			for (int iColOff = -1; iColOff <= 1; ++iColOff){
+
+				int iNearRow = iCurrRow + iRowOff;
+				int iNearCol = iCurrCol + iColOff;
+				if ((!iRowOff && !iColOff) || iNearRow < 0 || iNearRow >= iRowNum ||
+				    iNearCol < 0 || iNearCol >= m_iBoundColNum)
+					continue;
+
+				int iNearIdx = iNearRow * m_iBoundColNum + iNearCol;
+				int iSquareDis = SquareGridDis(iNearIdx, iGridIdx);
+				if (float(iSquareDis) >= fMaxSquareDis)
+					continue;
+
+				//keep the old one if it is not farther
+				int iOldSite = vReadSites.At(iNearRow, iNearCol);
+				if (iOldSite >= 0 && SquareGridDis(iNearIdx, iOldSite) <= iSquareDis)
+					continue;
+
+				m_vBoundSites.At(iNearRow, iNearCol) = iGridIdx;
+				m_vBrushQueue.push_back(iNearIdx);
+
+			}//end for iColOff
+		}//end for iRowOff
+
+	}//end for iHead
+
+}
+
+/*************************************************
+Function: RebuildBoundDistance
+Description: rebuild the boundary distance map from the boundary labels
+Calls: InitBoundDistance
+       AddBoundaryGrid
+Called By: TopologyMap::RecenterMap
+           TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map, label 3 is the boundary grid
+Output: m_vBoundSites
+Return: none
+Others: it is used when the grid indexes are changed (rolling map),
+        the boundary grids out of map are not considered
+*************************************************/
+void Confidence::RebuildBoundDistance(ConfidenceMap & vConfidenceMap){
+
+	InitBoundDistance(vConfidenceMap.size() / m_iBoundColNum, m_iBoundColNum, m_fBoundResolution);
+
+	std::vector<int> vBoundIdxs;
+	vConfidenceMap.ForEachAllocated([&vBoundIdxs](const int & iGridIdx, ConfidenceRef oGrid){
+		if (oGrid.label == 3)
+			vBoundIdxs.push_back(iGridIdx);
+	});
+
+	for (int i = 0; i != vBoundIdxs.size(); ++i)
+		AddBoundaryGrid(vBoundIdxs[i]);
+
+}
+
 
 /*************************************************
 Function: OcclusionTerm
 Description: the function is to compute the visibility feature to the confidence value
-Calls: GHPR class
+Calls: GHPR::UpdateVisibilityBatch
        ComputeTotalCoffidence()
 Called By: main function of project or other classes
 Table Accessed: none
 Table Updated: none
 Input: vConfidenceMap - the confidence map (grid map)
        pNearAllCloud - the NEARBY point clouds (the NEARBY ground, obstacle and boundary points)
+       vNearAllKeys - the stable key of each point in pNearAllCloud
 	   vNearGroundIdxs - the NEARBY ground grid index
-	   oPastViewPoint - the past viewpoint (past robot position, also the )
+	   vPastViewPoints - the past viewpoints (past robot positions)
 	   iNodeTimes - number of node generations
 Output: update the total confidence value (actually the visiTerm) of the given nearby grid
 Return: none
-Others: none
+Others: the visibility from each viewpoint is computed in parallel on m_oThreadPool, 
+        which gives one observation of each viewpoint at about the time cost of one viewpoint,
+        the hull of each viewpoint is kept in m_oGHPRer, only the newly arrived points are inserted 
+        if the viewpoint does not move
 *************************************************/
-void Confidence::OcclusionTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+void Confidence::OcclusionTerm(ConfidenceMap & vConfidenceMap,
 	                                          PCLCloudXYZPtr & pNearAllCloud,
+	                            const std::vector<long long> & vNearAllKeys,
 	                                const std::vector<int> & vNearGroundIdxs,
-	                                    const pcl::PointXYZ & oPastViewPoint,
+	                       const std::vector<pcl::PointXYZ> & vPastViewPoints,
 	                                                  const int & iNodeTimes){ 
     
 	//check the point cloud size (down sampling if point clouds is too large)
 	unsigned int iNonGrndPSize = pNearAllCloud->points.size() - vNearGroundIdxs.size();
 	unsigned int iSmplThr = 500000;
 
+	//the point keys used in visibility calculation
+	std::vector<long long> vSamplingKeys;
+
     //if need sampling
 	if(iNonGrndPSize > iSmplThr){
 
 		pcl::PointCloud<pcl::PointXYZ> vSamplingClouds;
 		//retain ground points
-		for(int i = 0; i != vNearGroundIdxs.size(); ++i)
+		for(int i = 0; i != vNearGroundIdxs.size(); ++i){
 			vSamplingClouds.push_back(pNearAllCloud->points[i]);
+			vSamplingKeys.push_back(vNearAllKeys[i]);
+		}
 
 		//down sampling
 		int iSmplNum = int(iNonGrndPSize / iSmplThr);
 
 		//only down sample the non-ground points 
-		for(int i = vNearGroundIdxs.size(); i != pNearAllCloud->points.size(); i = i + iSmplNum){
+		//the sampling is based on the key, thus a point is always retained (or not) in each call
+		//which keeps the hull reusable
+		for(int i = vNearGroundIdxs.size(); i != pNearAllCloud->points.size(); ++i){
 			//sampling
-			vSamplingClouds.push_back(pNearAllCloud->points[i]);
-
+			if(vNearAllKeys[i] % iSmplNum == 0){
+				vSamplingClouds.push_back(pNearAllCloud->points[i]);
+				vSamplingKeys.push_back(vNearAllKeys[i]);
+			}
 		}
 
         pNearAllCloud->clear();
@@ -800,37 +973,62 @@ void Confidence::OcclusionTerm(std::vector<ConfidenceValue> & vConfidenceMap,
 		for(int i = 0; i != vSamplingClouds.points.size(); ++i)
 			pNearAllCloud->points.push_back(vSamplingClouds.points[i]);//get back
 
-	}//end if iNonGrndPSize > iSmplThr
-   
-	//using the GHPR algorithm 
-	GHPR oGHPRer(3.7);
+	}else
+		vSamplingKeys = vNearAllKeys;//end if iNonGrndPSize > iSmplThr
     
 	//**********Measurement item************
 	//compute the visibility based on the history of view points
-	std::vector<bool> vVisableRes = oGHPRer.ComputeVisibility(*pNearAllCloud, oPastViewPoint);
+	//each viewpoint is computed in parallel and its hull of last call is reused if possible
+	std::vector<std::vector<bool> > vVisableRes;
+	m_oGHPRer.UpdateVisibilityBatch(vVisableRes, *pNearAllCloud, vSamplingKeys, vPastViewPoints, m_oThreadPool);
 	
 	//**********Incremental item************
 	//fv(p) = fv(n)  
 	for (int i = 0; i != vNearGroundIdxs.size(); ++i){
-		//count in each view
-		vConfidenceMap[vNearGroundIdxs[i]].visiTerm.totaltimes++;
-		//if it is a clear view
-		if(vVisableRes[i])//get the occlusion result
-			vConfidenceMap[vNearGroundIdxs[i]].visiTerm.visibletimes += 1.0;
+		//each viewpoint is an observation
+		for (int j = 0; j != vVisableRes.size(); ++j){
+			//count in each view
+			vConfidenceMap[vNearGroundIdxs[i]].visiTerm.totaltimes++;
+			//if it is a clear view
+			if(vVisableRes[j][i])//get the occlusion result
+				vConfidenceMap[vNearGroundIdxs[i]].visiTerm.visibletimes += 1.0;
+		}
 
 		vConfidenceMap[vNearGroundIdxs[i]].visiTerm.value = vConfidenceMap[vNearGroundIdxs[i]].visiTerm.visibletimes /
 		                                                    vConfidenceMap[vNearGroundIdxs[i]].visiTerm.totaltimes;
 
-        //update the confidence map
-		ComputeTotalCoffidence(vConfidenceMap,vNearGroundIdxs[i]);                           
-
 	}
+
+    //update the confidence map
+	ComputeTotalCoffidence(vConfidenceMap, vNearGroundIdxs);
     
 	//output the occlusion result of point clouds - for test only
-	//OutputOcclusionClouds(*pNearAllCloud, vVisableRes, oPastViewPoint);
+	//OutputOcclusionClouds(*pNearAllCloud, vVisableRes.front(), vPastViewPoints.front());
  
 }
 
+/*************************************************
+Function: ResetVisibility
+Description: drop the cached hull of visibility engine
+Calls: GHPR::ResetIncremental
+Called By: TopologyMap::IngestBoundCloud
+           TopologyMap::IngestObstacleCloud
+           TopologyMap::RecenterMap
+           TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the point keys are indices in the whole point clouds, 
+        which are changed after the point clouds are sampled
+*************************************************/
+void Confidence::ResetVisibility(){
+
+	m_oGHPRer.ResetIncremental();
+
+}
+
 
 /*************************************************
 Function: QualityTermUsingDensity
@@ -892,6 +1090,7 @@ Others: none
 Function: QualityTerm
 Description: the function is to measuer the scanning quality of point clouds
 Calls: HausdorffDimension class
+       ThreadPool::ParallelForSlot
 Called By: main function of project
 Table Accessed: none
 Table Updated: none
@@ -905,12 +1104,13 @@ Input: vConfidenceMap - the confidence map (grid map)
        iSmplNum - number of seeds, the seed is randonly selected 
 Output: update the qualTerm value of the given nearby grid
 Return: none
-Others: none
+Others: the selected grids are measured in parallel on m_oThreadPool, each thread has its own scratch data,
+        the results are assigned in the order of selection, thus they are the same as the serial one
 *************************************************/
-void Confidence::QualityTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+void Confidence::QualityTerm(ConfidenceMap & vConfidenceMap,
 	                                 const PCLCloudXYZPtr & pObstacleCloud,
                                    const std::vector<int> & vObstNodeTimes,
-                    const std::vector<std::vector<int> > & vObstlPntMapIdx,
+                    const TiledMap<std::vector<int> > & vObstlPntMapIdx,
 		                                 const ExtendedGM & oExtendGridMap,
 		                         const std::vector<MapIndex> & vNearByIdxs,
                                                      const int & iNodeTime,
@@ -939,16 +1139,28 @@ void Confidence::QualityTerm(std::vector<ConfidenceValue> & vConfidenceMap,
     //choose a grid (randomly), which is equal to down sampling
     std::vector<int> vSelectedGrids = GetRandom(vNonGrndGrids.size(), iSmplNum);
 
-    //compute the dimension feature of each selected obstacle grid
-    for(int is = 0; is != vSelectedGrids.size(); ++is){
+    //the measured region and result of each selected grid
+    std::vector<std::vector<int> > vMeasuredGridIdxs(vSelectedGrids.size());
+    std::vector<float> vHausResults(vSelectedGrids.size(), 0.0);
+    std::vector<char> vMeasuredFlags(vSelectedGrids.size(), 0);
+
+    //one scratch for each thread
+    if(m_vQualityScratches.size() < m_oThreadPool.SlotNum())
+    	m_vQualityScratches.resize(m_oThreadPool.SlotNum());
+
+    //compute the dimension feature of each selected obstacle grid in parallel
+    //the map is only read here, through the const map which never allocates a tile
+    const ConfidenceMap & vReadMap = vConfidenceMap;
+    m_oThreadPool.ParallelForSlot(int(vSelectedGrids.size()), [&](int is, int iSlotIdx){
 
     	int iOneSlctIdx = vNonGrndGrids[vSelectedGrids[is]];
         
         //point clouds to be measured
-	    PCLCloudXYZPtr pMeasuredCloud(new PCLCloudXYZ);
+	    QualityScratch & oScratch = m_vQualityScratches[iSlotIdx];
+	    oScratch.vMeasuredCloud.clear();
 
 	    //compute the local region based on the selected grid
-        std::vector<int> vMeasuredGridIdx; 
+        std::vector<int> & vMeasuredGridIdx = vMeasuredGridIdxs[is]; 
 		ExtendedGM::CircleNeighborhood(vMeasuredGridIdx,
 						               oExtendGridMap.m_oFeatureMap, 
 									   oExtendGridMap.m_vLocalQualityMask,
@@ -959,11 +1171,11 @@ void Confidence::QualityTerm(std::vector<ConfidenceValue> & vConfidenceMap,
 
 		    int iOneGridIdx = vMeasuredGridIdx[i];
 		    //if this grid is a obstacle grid or boundary grid
-		    if(vConfidenceMap[iOneGridIdx].label == 1 || vConfidenceMap[iOneGridIdx].label == 3){
+		    if(vReadMap[iOneGridIdx].label == 1 || vReadMap[iOneGridIdx].label == 3){
 
 			    for (int j = 0; j != vObstlPntMapIdx[iOneGridIdx].size(); ++j){
         	        if(vObstNodeTimes[vObstlPntMapIdx[iOneGridIdx][j]] == iNodeTime)//if it is recorded at current node time
-        	    	    pMeasuredCloud->points.push_back(pObstacleCloud->points[vObstlPntMapIdx[iOneGridIdx][j]]);
+        	    	    oScratch.vMeasuredCloud.points.push_back(pObstacleCloud->points[vObstlPntMapIdx[iOneGridIdx][j]]);
 
         	    }//end for j
 	
@@ -972,24 +1184,34 @@ void Confidence::QualityTerm(std::vector<ConfidenceValue> & vConfidenceMap,
 	    }//end for i
 
         //if not points input
-        if(pMeasuredCloud->size() < 10)
-        	continue;
+        if(oScratch.vMeasuredCloud.size() < 10)
+        	return;
+
 	    //using Hausdorff Dimension to measure point clouds
-	    HausdorffDimension oHDor(5, 1);
-	    
-	    //set the 
-	    oHDor.SetMinDis(0.1);
+	    oScratch.oHDor.ClearLength();
 	    
-	    //set the dimension type
-	    oHDor.SetParaQ(0);
-	   
 	    //compute the Hausdorff result
-	    float fHausRes = oHDor.BoxCounting(*pMeasuredCloud);
+	    float fHausRes = oScratch.oHDor.BoxCounting(oScratch.vMeasuredCloud);
         //give large weight for less scan
 	    fHausRes = fHausRes - 2.0f;
 	    if(fHausRes < 0.0)
 	       fHausRes = -1.5f*fHausRes;
 
+	    vHausResults[is] = fHausRes;
+	    vMeasuredFlags[is] = 1;
+
+    });
+
+    //assign the results in the order of selection, which is the same as the serial one
+    for(int is = 0; is != vSelectedGrids.size(); ++is){
+
+    	if(!vMeasuredFlags[is])
+    		continue;
+
+    	int iOneSlctIdx = vNonGrndGrids[vSelectedGrids[is]];
+    	const std::vector<int> & vMeasuredGridIdx = vMeasuredGridIdxs[is];
+    	float fHausRes = vHausResults[is];
+
 	    //record each measured point clouds for test only
         //OutputQualityClouds(*pMeasuredCloud, fHausRes);
 	    //assig at the selected grid because it is grid
@@ -1131,7 +1353,7 @@ Output: u
 Return: update the total confidence value
 Others: none
 *************************************************/
-void Confidence::ComputeTotalCoffidence(std::vector<ConfidenceValue> & vConfidenceMap, 
+void Confidence::ComputeTotalCoffidence(ConfidenceMap & vConfidenceMap, 
 	                                                           const int & iQueryIdx){
 
     //get maximum value of distance term
@@ -1149,10 +1371,221 @@ void Confidence::ComputeTotalCoffidence(std::vector<ConfidenceValue> & vConfiden
 }
 
 
+/*************************************************
+Function: ComputeTotalCoffidence
+Description: the function is to compute the total confidence value of a list of grids in batch
+Calls: TotalKernel
+Called By: OcclusionTerm()
+           BoundTerm()
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - confindence variance 
+	   vQueryIdxs - the query grids
+Output: none
+Return: update the total confidence value
+Others: the same as the one grid version, the terms are gathered into m_oTermBuffer
+*************************************************/
+void Confidence::ComputeTotalCoffidence(ConfidenceMap & vConfidenceMap, 
+	                                    const std::vector<int> & vQueryIdxs){
+
+	int iGridNum = vQueryIdxs.size();
+	if (!iGridNum)
+		return;
+
+	m_oTermBuffer.Resize(iGridNum);
+	for (int i = 0; i != iGridNum; ++i) {
+		ConfidenceRef oGrid = vConfidenceMap[vQueryIdxs[i]];
+		m_oTermBuffer.vTravel[i] = oGrid.travelTerm;
+		m_oTermBuffer.vBound[i] = oGrid.boundTerm;
+		m_oTermBuffer.vVisi[i] = oGrid.visiTerm.value;
+	}
+
+	TotalKernel(m_oTermBuffer);
+
+	for (int i = 0; i != iGridNum; ++i)
+		vConfidenceMap[vQueryIdxs[i]].totalValue = m_oTermBuffer.vTotal[i];
+
+}
+
+#if defined(__AVX2__)
+/*************************************************
+Function: ExpNonPositive
+Description: exp(x) of 8 floats, x <= 0
+Calls: none
+Called By: DistanceKernel
+Table Accessed: none
+Table Updated: none
+Input: oValue - the exponents
+Output: none
+Return: the exponential values
+Others: the polynomial of Cephes library, exp(x) = 2^n * exp(r) with x = n * ln2 + r,
+        the relative error is about 1e-7, a value less than -87 returns 0
+*************************************************/
+static inline __m256 ExpNonPositive(__m256 oValue){
+
+	const __m256 oMinValue = _mm256_set1_ps(-87.0f);
+	__m256 oUnderFlow = _mm256_cmp_ps(oValue, oMinValue, _CMP_LT_OQ);
+	oValue = _mm256_max_ps(oValue, oMinValue);
+
+	//n = round(x / ln2)
+	__m256 oN = _mm256_round_ps(_mm256_mul_ps(oValue, _mm256_set1_ps(1.44269504088896341f)),
+	                            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+
+	//r = x - n * ln2, ln2 is split to keep the precision
+	__m256 oR = _mm256_sub_ps(oValue, _mm256_mul_ps(oN, _mm256_set1_ps(0.693359375f)));
+	oR = _mm256_sub_ps(oR, _mm256_mul_ps(oN, _mm256_set1_ps(-2.12194440e-4f)));
+
+	//exp(r)
+	__m256 oPoly = _mm256_set1_ps(1.9875691500e-4f);
+	oPoly = _mm256_add_ps(_mm256_mul_ps(oPoly, oR), _mm256_set1_ps(1.3981999507e-3f));
+	oPoly = _mm256_add_ps(_mm256_mul_ps(oPoly, oR), _mm256_set1_ps(8.3334519073e-3f));
+	oPoly = _mm256_add_ps(_mm256_mul_ps(oPoly, oR), _mm256_set1_ps(4.1665795894e-2f));
+	oPoly = _mm256_add_ps(_mm256_mul_ps(oPoly, oR), _mm256_set1_ps(1.6666665459e-1f));
+	oPoly = _mm256_add_ps(_mm256_mul_ps(oPoly, oR), _mm256_set1_ps(5.0000001201e-1f));
+	oPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(oPoly, oR), oR), _mm256_add_ps(oR, _mm256_set1_ps(1.0f)));
+
+	//2^n from the exponent bits
+	__m256i oPow2 = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(oN), _mm256_set1_epi32(127)), 23);
+	__m256 oRes = _mm256_mul_ps(oPoly, _mm256_castsi256_ps(oPow2));
+
+	return _mm256_andnot_ps(oUnderFlow, oRes);
+
+}
+#endif
+
+/*************************************************
+Function: DistanceKernel
+Description: compute the distance term and total value of the gathered grids
+Calls: ExpNonPositive
+Called By: DistanceTerm
+Table Accessed: none
+Table Updated: none
+Input: oBuffer - the offsets to robot and the terms of grids
+Output: oBuffer - vTravel = max(vTravel, exp(-||p||^2 / sigma^2)), and vTotal
+Return: none
+Others: 8 grids are computed in each step with AVX2 if the compiler enables it (TOPO_NATIVE_ARCH),
+        the rest grids (or all grids without simd) are computed one by one
+*************************************************/
+void Confidence::DistanceKernel(TermBuffer & oBuffer){
+
+	int iGridNum = oBuffer.vX.size();
+
+	const float fInvSquareSigma = 1.0f / (m_fSigma * m_fSigma);
+	const float fDisFactor = m_fTraversWeight * m_fDisWeight;
+	const float fBoundFactor = m_fTraversWeight * m_fBoundWeight;
+	const float fVisiFactor = m_fExploreWeight;
+
+	const float * pX = &oBuffer.vX[0];
+	const float * pY = &oBuffer.vY[0];
+	const float * pZ = &oBuffer.vZ[0];
+	float * pTravel = &oBuffer.vTravel[0];
+	const float * pBound = &oBuffer.vBound[0];
+	const float * pVisi = &oBuffer.vVisi[0];
+	float * pTotal = &oBuffer.vTotal[0];
+
+	int i = 0;
+
+#if defined(__AVX2__)
+
+	const __m256 oNegInvSigma = _mm256_set1_ps(-fInvSquareSigma);
+	const __m256 oDisFactor = _mm256_set1_ps(fDisFactor);
+	const __m256 oBoundFactor = _mm256_set1_ps(fBoundFactor);
+	const __m256 oVisiFactor = _mm256_set1_ps(fVisiFactor);
+
+	for (; i + 8 <= iGridNum; i += 8){
+
+		__m256 oX = _mm256_loadu_ps(pX + i);
+		__m256 oY = _mm256_loadu_ps(pY + i);
+		__m256 oZ = _mm256_loadu_ps(pZ + i);
+		__m256 oSquareNorm = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(oX, oX), _mm256_mul_ps(oY, oY)),
+		                                   _mm256_mul_ps(oZ, oZ));
+
+		//Gaussian kernel and the maximum of history
+		__m256 oTravel = _mm256_max_ps(_mm256_loadu_ps(pTravel + i),
+		                               ExpNonPositive(_mm256_mul_ps(oSquareNorm, oNegInvSigma)));
+
+		__m256 oTotal = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(oDisFactor, oTravel),
+		                                            _mm256_mul_ps(oBoundFactor, _mm256_loadu_ps(pBound + i))),
+		                              _mm256_mul_ps(oVisiFactor, _mm256_loadu_ps(pVisi + i)));
+
+		_mm256_storeu_ps(pTravel + i, oTravel);
+		_mm256_storeu_ps(pTotal + i, oTotal);
+
+	}//end for i
+
+#endif
+
+	//the rest grids (or all grids without simd)
+	for (; i < iGridNum; ++i){
+
+		float fSquareNorm = pX[i] * pX[i] + pY[i] * pY[i] + pZ[i] * pZ[i];
+		float fTravel = std::exp(-fSquareNorm * fInvSquareSigma);
+		if (pTravel[i] > fTravel)
+			fTravel = pTravel[i];
+
+		pTravel[i] = fTravel;
+		pTotal[i] = fDisFactor * fTravel + fBoundFactor * pBound[i] + fVisiFactor * pVisi[i];
+
+	}//end for i
+
+}
+
+/*************************************************
+Function: TotalKernel
+Description: compute the total value of the gathered grids
+Calls: none
+Called By: ComputeTotalCoffidence
+Table Accessed: none
+Table Updated: none
+Input: oBuffer - the terms of grids
+Output: oBuffer - vTotal
+Return: none
+Others: 8 grids are computed in each step with AVX2 if the compiler enables it
+*************************************************/
+void Confidence::TotalKernel(TermBuffer & oBuffer){
+
+	int iGridNum = oBuffer.vTravel.size();
+
+	const float fDisFactor = m_fTraversWeight * m_fDisWeight;
+	const float fBoundFactor = m_fTraversWeight * m_fBoundWeight;
+	const float fVisiFactor = m_fExploreWeight;
+
+	const float * pTravel = &oBuffer.vTravel[0];
+	const float * pBound = &oBuffer.vBound[0];
+	const float * pVisi = &oBuffer.vVisi[0];
+	float * pTotal = &oBuffer.vTotal[0];
+
+	int i = 0;
+
+#if defined(__AVX2__)
+
+	const __m256 oDisFactor = _mm256_set1_ps(fDisFactor);
+	const __m256 oBoundFactor = _mm256_set1_ps(fBoundFactor);
+	const __m256 oVisiFactor = _mm256_set1_ps(fVisiFactor);
+
+	for (; i + 8 <= iGridNum; i += 8){
+
+		__m256 oTotal = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(oDisFactor, _mm256_loadu_ps(pTravel + i)),
+		                                            _mm256_mul_ps(oBoundFactor, _mm256_loadu_ps(pBound + i))),
+		                              _mm256_mul_ps(oVisiFactor, _mm256_loadu_ps(pVisi + i)));
+		_mm256_storeu_ps(pTotal + i, oTotal);
+
+	}//end for i
+
+#endif
+
+	//the rest grids (or all grids without simd)
+	for (; i < iGridNum; ++i)
+		pTotal[i] = fDisFactor * pTravel[i] + fBoundFactor * pBound[i] + fVisiFactor * pVisi[i];
+
+}
+
 /*************************************************
 Function: RegionGrow
 Description: this function is to find the reachable grid based on current robot location
-Calls: none
+Calls: TouchTravelable
+       PushFrontier
+       PopFrontier
 Called By: main function of project
 Table Accessed: none
 Table Updated: none
@@ -1161,110 +1594,164 @@ Input: vConfidenceMap - the confidence map (grid map)
 	   oExtendGridMap - grid map for searching
 	   iNodeTimes -  the current times of node generations
 Output: label the reachable grid if possible
+        oGrownRect - it is extended by the grids grown outside the nearby region
 Return: none
 Others:  //**status of grid in region grow**
 	     //-1 indicates it is an unknown grid
 	     //0 indicates this grid is ground but not reachable now
          //1 indicates this grid is a travelable region grid
-	     //2 is the new scanned ground grids (input) without growing calculation (in this time)
-	     //3 indicates the grid has been computed
 	     //4 indicates this grid is a off groud grid (not reachable forever)
+	     //the nearby ground grids which are not reachable are checked with their neighbors,
+	     //then the region only grows from the grids which are just travelable (frontier),
+	     //thus the travelable region is never visited again and the cost depends on the new region,
+	     //a grid is grown only if it has been nearby once (nodeCount is set), as the nearby grids before
 *************************************************/
-void Confidence::RegionGrow(std::vector<ConfidenceValue> & vConfidenceMap,
+void Confidence::RegionGrow(ConfidenceMap & vConfidenceMap,
 	                        const std::vector<MapIndex> & vNearbyGridIdxs,
 								        const ExtendedGM & oExtendGridMap,
-								                   const int & iNodeTimes){
+								                   const int & iNodeTimes,
+								                   GridRect & oGrownRect){
+
+	//the grow mask with 1D offsets
+	const SearchMask & vGrowMask = oExtendGridMap.m_vGrowSearchMask;
+	int iRowNum = oExtendGridMap.m_oFeatureMap.getSize()(0);
+	int iColNum = oExtendGridMap.m_oFeatureMap.getSize()(1);
+
+	//read the neighbors without allocating their tiles
+	const ConfidenceMap & vReadMap = vConfidenceMap;
 
-    //the grid need grow in MAP index (No neighboorhood local index)
-	std::vector<int> vNeedGrowGridIdx;
-	
 	for(int i = 0; i != vNearbyGridIdxs.size(); ++i){
         //the current grid index
 		int iCurGridIdx = vNearbyGridIdxs[i].iOneIdx;
 
         //in fact the node count is nothing to do with region grow
         //it is here so computing can have one less cycle
-		if(vConfidenceMap[iCurGridIdx].nodeCount < 0)
+		if(vConfidenceMap[iCurGridIdx].nodeCount < 0){
            vConfidenceMap[iCurGridIdx].nodeCount = iNodeTimes;
+           AddNodeCandidate(vConfidenceMap, iCurGridIdx);
+		}
 
-        //find region grow candidates
-		//if it is a ground grid
-		if(vConfidenceMap[iCurGridIdx].label == 2){
-			//if this grid has not been covered by boundary
-			if(vConfidenceMap[iCurGridIdx].travelable < 1){
-		       vConfidenceMap[iCurGridIdx].travelable = 2;
-               vNeedGrowGridIdx.push_back(iCurGridIdx);
-		    }//end if
-			//else
-			//   vConfidenceMap[vNearbyGridIdxs[i]].travelable = 4;//off-ground
+        //find region grow seeds
+		//if it is a ground grid which has not been reachable or covered by boundary
+		if(vReadMap[iCurGridIdx].label == 2 && vReadMap[iCurGridIdx].travelable < 1){
+
+			if(TouchTravelable(vReadMap, vGrowMask, iCurGridIdx)){
+				vConfidenceMap[iCurGridIdx].travelable = 1;
+				PushFrontier(iCurGridIdx);
+			}else
+				vConfidenceMap[iCurGridIdx].travelable = 0;
+
+		}//end if
+
+	}//end for i
+
+    //grow from the frontier
+	int iCurIdx;
+	while(PopFrontier(iCurIdx)){
+
+		int iCurRow = iCurIdx / iColNum;
+		int iCurCol = iCurIdx - iCurRow * iColNum;
+		//the bound check is only needed near the map border
+		bool bInteriorFlag = vGrowMask.Interior(iCurRow, iCurCol, iRowNum, iColNum);
+
+		//check neighboring grids
+		for(int i = 0; i != vGrowMask.size(); ++i){
+
+			if(!bInteriorFlag){
+				int iNearRow = iCurRow + vGrowMask[i].oTwoIndex(0);
+				int iNearCol = iCurCol + vGrowMask[i].oTwoIndex(1);
+				if(iNearRow < 0 || iNearRow >= iRowNum || iNearCol < 0 || iNearCol >= iColNum)
+					continue;//if the neighboring grid is outside of the map
+			}
+
+			int iNearIdx = iCurIdx + vGrowMask[i].iOneIdx;
+			ConfidenceConstRef oNearGrid = vReadMap[iNearIdx];
+
+			//the near ground grid is reachable through the current grid
+			if(oNearGrid.label == 2 && oNearGrid.travelable < 1 && oNearGrid.nodeCount >= 0){
+				vConfidenceMap[iNearIdx].travelable = 1;
+				PushFrontier(iNearIdx);
+				//the grown grid may be far from the nearby region
+				oGrownRect.Add(iNearIdx / iColNum, iNearIdx % iColNum);
+			}
+
+		}//end for i
+
+	}//end while
+
+}
+
+/*************************************************
+Function: TouchTravelable
+Description: check whether a grid touches a travelable ground grid in the grow mask
+Calls: none
+Called By: RegionGrow
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map (grid map)
+	   vGrowMask - the grow mask with 1D offsets of the map size
+	   iQueryIdx - the query grid index
+Output: none
+Return: true if a neighboring grid is a travelable ground grid
+Others: none
+*************************************************/
+bool Confidence::TouchTravelable(const ConfidenceMap & vConfidenceMap,
+	                             const SearchMask & vGrowMask,
+	                             const int & iQueryIdx) const{
+
+	int iRowNum = vConfidenceMap.RowNum();
+	int iColNum = vConfidenceMap.ColNum();
+	int iQueryRow = iQueryIdx / iColNum;
+	int iQueryCol = iQueryIdx - iQueryRow * iColNum;
+	bool bInteriorFlag = vGrowMask.Interior(iQueryRow, iQueryCol, iRowNum, iColNum);
+
+	for(int i = 0; i != vGrowMask.size(); ++i){
+
+		if(!bInteriorFlag){
+			int iNearRow = iQueryRow + vGrowMask[i].oTwoIndex(0);
+			int iNearCol = iQueryCol + vGrowMask[i].oTwoIndex(1);
+			if(iNearRow < 0 || iNearRow >= iRowNum || iNearCol < 0 || iNearCol >= iColNum)
+				continue;
 		}
-	}
 
-    //if nothing to grow
-	if(!vNeedGrowGridIdx.size())
-		return;
+		ConfidenceConstRef oNearGrid = vConfidenceMap[iQueryIdx + vGrowMask[i].iOneIdx];
+		if(oNearGrid.travelable == 1 && oNearGrid.label == 2)
+			return true;
 
-    //check each input grid
-	for(int i = 0; i != vNeedGrowGridIdx.size(); ++i){
+	}//end for i
 
-		//current seed index
-	    int iCurIdx;
-		//inital result as a non-touchable grid
-		int iGrowRes = 0;
-		
-		//seeds
-	    std::vector<int> vSeeds;  
-		std::vector<int> vSeedHistory;
-		//get one input grid as seed
-		vSeeds.push_back(vNeedGrowGridIdx[i]);
-        
-        //if this one still has not been grown after calculation of other grids
-		if(vConfidenceMap[vNeedGrowGridIdx[i]].travelable == 2){
-            //growing
-	        while(!vSeeds.empty()){
-
-		        //choose a seed (last one)
-		        iCurIdx = *(vSeeds.end()-1);
-		        //delete the last one
-		        vSeeds.pop_back();
-
-			    //record the history of seeds
-			    vSeedHistory.push_back(iCurIdx);
-
-			    //label this seed as it has being considered
-				vConfidenceMap[iCurIdx].travelable = 3;
-
-				//find the nearboring grids
-				//std::vector<int> vGrowNearGridIdx = SearchGrids(iCurIdx, 0.5);
-				std::vector<int> vGrowNearGridIdx;
-				ExtendedGM::CircleNeighborhood(vGrowNearGridIdx,
-						                       oExtendGridMap.m_oFeatureMap, 
-											   oExtendGridMap.m_vGrowSearchMask,
-		                                       iCurIdx);
-
-				//check neighboring grids
-				for (int i = 0; i != vGrowNearGridIdx.size(); ++i) {
-					//if the near grid is new input
-					if (vConfidenceMap[vGrowNearGridIdx[i]].travelable == 2 &&
-						vConfidenceMap[vGrowNearGridIdx[i]].label == 2)
-						vSeeds.push_back(vGrowNearGridIdx[i]);
-
-					//the near grid is reachable thereby the query ground grids must be reachable too
-					if (vConfidenceMap[vGrowNearGridIdx[i]].travelable == 1 &&
-						vConfidenceMap[vGrowNearGridIdx[i]].label == 2)
-						iGrowRes = 1;
-				}//end for int i = 0;i!=vGrowNearGridIdx.size();++i
-				 
-		    }//end while
-
-		    //assignment as a touchable grid or ioslated grids
-			for(int i = 0; i != vSeedHistory.size(); ++i)
-			    vConfidenceMap[vSeedHistory[i]].travelable = iGrowRes;
-			
-        }//end if vConfidenceMap[vGrowNearGridIdx[i]].travelable == 2
-			
-	}//end for
+	return false;
+
+}
+
+/*************************************************
+Function: PushFrontier
+Description: push a grid into the frontier of region grow
+Calls: none
+Called By: RegionGrow
+Table Accessed: none
+Table Updated: none
+Input: iGridIdx - the grid index
+Output: m_vGrowRing
+Return: none
+Others: the ring is kept between calls, it is doubled if it is full
+*************************************************/
+void Confidence::PushFrontier(const int & iGridIdx){
+
+	if(m_iRingSize == int(m_vGrowRing.size())){
+
+		//the waiting grids are moved to the beginning of the new ring
+		std::vector<int> vNewRing(m_vGrowRing.empty() ? 1024 : 2 * m_vGrowRing.size());
+		for(int i = 0; i != m_iRingSize; ++i)
+			vNewRing[i] = m_vGrowRing[(m_iRingHead + i) & (int(m_vGrowRing.size()) - 1)];
+
+		m_vGrowRing.swap(vNewRing);
+		m_iRingHead = 0;
+
+	}
 
+	m_vGrowRing[(m_iRingHead + m_iRingSize) & (int(m_vGrowRing.size()) - 1)] = iGridIdx;
+	m_iRingSize++;
 
 }
 
@@ -1284,7 +1771,7 @@ Return: a binary result, true value indicates the grid is new scanning ground gr
 Others: none
 *************************************************/
 inline bool Confidence::CheckIsNewScannedGrid(const int & iCurrNodeTime, 
-	                                          const std::vector<ConfidenceValue> & vConfidenceMap,
+	                                          const ConfidenceMap & vConfidenceMap,
 	                                          const int & iQueryIdx){
     
     //it should be a ground grid at first
@@ -1303,6 +1790,118 @@ inline bool Confidence::CheckIsNewScannedGrid(const int & iCurrNodeTime,
 
 }
 
+/*************************************************
+Function: AddNodeCandidate
+Description: record a grid whose nodeCount is just set
+Calls: none
+Called By: RegionGrow
+           TopologyMap::InitializeGridMap
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map (grid map)
+	   iQueryIdx - the query grid index
+Output: m_vNodeCandidates - the node candidates
+Return: none
+Others: it must be called once the nodeCount of a grid is set,
+        since FindLocalMinimum only checks the recorded grids
+*************************************************/
+void Confidence::AddNodeCandidate(const ConfidenceMap & vConfidenceMap,
+	                                                         const int & iQueryIdx){
+
+	if(m_vCandidateFlags.size() != vConfidenceMap.size()){
+		m_vCandidateFlags.Initialize(vConfidenceMap.RowNum(), vConfidenceMap.ColNum(), 0);
+		for(int i = 0; i != m_vNodeCandidates.size(); ++i)
+			if(m_vNodeCandidates[i] < vConfidenceMap.size())
+				m_vCandidateFlags[m_vNodeCandidates[i]] = 1;
+	}
+
+	//read the flag without allocating its tile
+	const TiledMap<char> & vReadFlags = m_vCandidateFlags;
+	if(vReadFlags[iQueryIdx])
+		return;
+
+	m_vCandidateFlags[iQueryIdx] = 1;
+	m_vNodeCandidates.push_back(iQueryIdx);
+
+}
+
+/*************************************************
+Function: ShiftGrids
+Description: move the grid indexes of node candidates with the map (rolling map)
+Calls: none
+Called By: TopologyMap::RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: iRowShift - the row shift, the new grid row i is the old grid row i + iRowShift
+       iColShift - the column shift, the new grid column j is the old grid column j + iColShift
+       iRowNum - the row number of map
+       iColNum - the column number of map
+Output: m_vNodeCandidates - the candidates still on map
+Return: none
+Others: the flags and stamps are rebuilt with the moved candidates, in tiles as the confidence map
+*************************************************/
+void Confidence::ShiftGrids(const int & iRowShift,
+	                        const int & iColShift,
+	                        const int & iRowNum,
+	                        const int & iColNum){
+
+	int iCandNum = 0;
+	for(int i = 0; i != m_vNodeCandidates.size(); ++i){
+
+		int iNewRow = m_vNodeCandidates[i] / iColNum - iRowShift;
+		int iNewCol = m_vNodeCandidates[i] % iColNum - iColShift;
+
+		//the candidates out of map are dropped
+		if(iNewRow < 0 || iNewRow >= iRowNum || iNewCol < 0 || iNewCol >= iColNum)
+			continue;
+
+		m_vNodeCandidates[iCandNum++] = iNewRow * iColNum + iNewCol;
+
+	}//end for i
+	m_vNodeCandidates.resize(iCandNum);
+
+	m_vCandidateFlags.Initialize(iRowNum, iColNum, 0);
+	for(int i = 0; i != m_vNodeCandidates.size(); ++i)
+		m_vCandidateFlags[m_vNodeCandidates[i]] = 1;
+
+	m_vSuppressStamps.Initialize(iRowNum, iColNum, 0);
+	m_iSuppressStamp = 0;
+
+}
+
+/*************************************************
+Function: RebuildNodeCandidates
+Description: record the grids of current trip as node candidates again
+Calls: AddNodeCandidate
+Called By: TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map restored from a checkpoint
+       iCurrNodeTime - the current node times
+Output: m_vNodeCandidates - the node candidates
+Return: none
+Others: a grid is recorded by AddNodeCandidate once its nodeCount is set,
+        thus the candidates are the grids whose nodeCount is the current node times
+*************************************************/
+void Confidence::RebuildNodeCandidates(ConfidenceMap & vConfidenceMap,
+	                                   const int & iCurrNodeTime){
+
+	m_vNodeCandidates.clear();
+	m_vCandidateFlags.Initialize(vConfidenceMap.RowNum(), vConfidenceMap.ColNum(), 0);
+	m_vSuppressStamps.Initialize(vConfidenceMap.RowNum(), vConfidenceMap.ColNum(), 0);
+	m_iSuppressStamp = 0;
+
+	vConfidenceMap.ForEachAllocated([&](const int & iGridIdx, ConfidenceRef oGridCnfd){
+
+		if(oGridCnfd.nodeCount == iCurrNodeTime){
+			m_vCandidateFlags[iGridIdx] = 1;
+			m_vNodeCandidates.push_back(iGridIdx);
+		}
+
+	});
+
+}
+
 /*************************************************
 Function: FindLocalMinimum
 Description: this function is to find the LOCAL minimum value of confidence map 
@@ -1317,22 +1916,48 @@ Input: vNodeIdxs - node grid index (each grid would most have one node)
 	   iCurrNodeTime - the current node times
 Output: nodes in local minimum value (by given a radius)
 Return: none
-Others: none
+Others: only the grids recorded by AddNodeCandidate are checked rather than the whole map,
+        which gives the same result because a grid is a new scanned grid only if its nodeCount
+        is set in current trip, and the nodeCount of a grid is set once
 *************************************************/
 void Confidence::FindLocalMinimum(std::vector<int> & vNodeIdxs,
 	                              std::vector<pcl::PointXYZ> & vNodeClouds,
-	                              const std::vector<ConfidenceValue> & vConfidenceMap,
+	                              const ConfidenceMap & vConfidenceMap,
 								  const ExtendedGM & oExtendGridMap,
 	                              const int & iCurrNodeTime){
 
 	//define candidate variables
 	std::vector<int> vMinCandidates;
-	std::vector<bool> vMinCandidStatus(vConfidenceMap.size(),true);
 
-	//search each grid to construct a candidate node extraction region
-	for (int i = 0; i != vConfidenceMap.size(); ++i) {
-			//if it is a reachable ground grid (some initial reachable grids are not the ground grids)
+	//the suppressed flags of this call
+	if(m_vSuppressStamps.size() != vConfidenceMap.size()){
+		m_vSuppressStamps.Initialize(vConfidenceMap.RowNum(), vConfidenceMap.ColNum(), 0);
+		m_iSuppressStamp = 0;
+	}
+	m_iSuppressStamp++;
+	//read the stamps without allocating their tiles
+	const TiledMap<int> & vReadStamps = m_vSuppressStamps;
+
+	//the same order as a scan of whole map
+	std::sort(m_vNodeCandidates.begin(), m_vNodeCandidates.end());
+
+	//search each recorded grid to construct a candidate node extraction region
+	int iRetainNum = 0;
+	for (int k = 0; k != m_vNodeCandidates.size(); ++k) {
 
+		int i = m_vNodeCandidates[k];
+
+		//the grid of a past trip can not be a candidate any more
+		if(i >= vConfidenceMap.size() || vConfidenceMap[i].nodeCount != iCurrNodeTime){
+			if(i < m_vCandidateFlags.size())
+				m_vCandidateFlags[i] = 0;
+			continue;
+		}
+
+		//keep it for the next call in the same trip
+		m_vNodeCandidates[iRetainNum++] = i;
+
+		//if it is a reachable ground grid (some initial reachable grids are not the ground grids)
 		if(CheckIsNewScannedGrid(iCurrNodeTime, vConfidenceMap, i)){
 
             //if it is small
@@ -1343,16 +1968,19 @@ void Confidence::FindLocalMinimum(std::vector<int> & vNodeIdxs,
 
 		}//end CheckIsNewScannedGrid(iCurrNodeTime, vConfidenceMap, i)
 
-	}//end for i
+	}//end for k
+	m_vNodeCandidates.resize(iRetainNum);
+
+	//the neighboring grids, which is reused by all candidates
+	std::vector<int> vNeighborGrids;
 
 	//Traversal each candidate grid
 	for (int i = 0; i != vMinCandidates.size(); ++i) {
 		
 		int iCurIdx = vMinCandidates[i];
 		//if the candidate grid has not been removed
-		if (vMinCandidStatus[iCurIdx]) {
+		if (vReadStamps[iCurIdx] != m_iSuppressStamp) {
 			//find neighboring grid
-			std::vector<int> vNeighborGrids;
 			ExtendedGM::CircleNeighborhood(vNeighborGrids,
 						                   oExtendGridMap.m_oFeatureMap, 
 										   oExtendGridMap.m_vNodeMadeMask,
@@ -1367,9 +1995,9 @@ void Confidence::FindLocalMinimum(std::vector<int> & vNodeIdxs,
 				   if (iCurIdx != vNeighborGrids[j]) {
 					   //compare the total value
 					   if (vConfidenceMap[iCurIdx].totalValue <= vConfidenceMap[vNeighborGrids[j]].totalValue)
-					       vMinCandidStatus[vNeighborGrids[j]] = false;
+					       m_vSuppressStamps[vNeighborGrids[j]] = m_iSuppressStamp;
 				       else 
-					       vMinCandidStatus[iCurIdx] = false;
+					       m_vSuppressStamps[iCurIdx] = m_iSuppressStamp;
 			       }//if != vNeighborGrids[j]
 
 				}//end CheckIsNewScannedGrid(iCurrNodeTime, vConfidenceMap, vNeighborGrids[j])
@@ -1387,7 +2015,7 @@ void Confidence::FindLocalMinimum(std::vector<int> & vNodeIdxs,
     //assign to each candidate grid
 	for (int i = 0; i != vMinCandidates.size(); ++i){
         //it is the local minimum value
-		if (vMinCandidStatus[vMinCandidates[i]]){
+		if (vReadStamps[vMinCandidates[i]] != m_iSuppressStamp){
             //get grid index
 			vNodeIdxs.push_back(vMinCandidates[i]);
 		    //get corresponding ground point
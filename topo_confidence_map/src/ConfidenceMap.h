@@ -7,9 +7,17 @@
 #include "GHPR.h"
 #include "ExtendedGridMap.h"
 #include "HausdorffMeasure.h"
+#include "TiledMap.h"
 
 #include <stdlib.h>
 #include <time.h> 
+#include <algorithm>
+#include <iostream>
+
+//simd of distance and total confidence kernels
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 
 ///************************************************************************///
@@ -26,6 +34,18 @@
 // - complete distance term
 //version 2.0 2019.04.12
 // - real time processing version
+//version 2.1
+// - occlusion term uses the incremental GHPR engine kept in the object
+// - occlusion term observes from multiple past viewpoints in parallel
+// - quality term evaluates the selected grids in parallel
+// - local minimum detection only checks the grids newly scanned in current trip
+// - confidence map is stored in tiles allocated on first write (TiledMap)
+// - node candidates are moved with the rolling map
+// - confidence map stores the fields of per-frame terms in separate arrays (ConfidenceTile)
+// - distance term and total confidence are computed by batched kernels (AVX2 if enabled)
+// - boundary term reads a distance map updated incrementally with new boundary grids
+// - node candidates can be rebuilt from the map restored by a checkpoint
+// - region grow only expands the grids which are just travelable (frontier)
 ///************************************************************************///
 
 
@@ -133,6 +153,251 @@ struct ConfidenceValue{
 };
 
 
+//the fields of a grid which are rarely used in the per-frame terms
+struct ConfidenceCold{
+
+	float visibletimes;
+	float totaltimes;
+	Quality qualTerm;
+	bool qualFlag;
+	pcl::PointXYZ oCenterPoint;
+
+};
+
+//the access of visibility term through ConfidenceRef
+struct VisibleRef{
+
+	float & visibletimes;
+	float & totaltimes;
+	float & value;
+
+};
+
+struct VisibleConstRef{
+
+	const float & visibletimes;
+	const float & totaltimes;
+	const float & value;
+
+};
+
+//the access of a grid in ConfidenceTile, which has the same fields as ConfidenceValue
+//so that vConfidenceMap[i].travelTerm is the same for the old callers
+struct ConfidenceRef{
+
+	float & travelTerm;
+	float & boundTerm;
+	VisibleRef visiTerm;
+	Quality & qualTerm;
+	float & totalValue;
+	short & label;
+	short & travelable;
+	bool & qualFlag;
+	short & nodeCount;
+	pcl::PointXYZ & oCenterPoint;
+
+};
+
+struct ConfidenceConstRef{
+
+	const float & travelTerm;
+	const float & boundTerm;
+	VisibleConstRef visiTerm;
+	const Quality & qualTerm;
+	const float & totalValue;
+	const short & label;
+	const short & travelable;
+	const bool & qualFlag;
+	const short & nodeCount;
+	const pcl::PointXYZ & oCenterPoint;
+
+};
+
+//a tile of confidence map in structure of arrays
+//each field used by the per-frame terms is a contiguous array, the others are kept together in vCold
+class ConfidenceTile{
+
+public:
+
+	typedef ConfidenceRef reference;
+	typedef ConfidenceConstRef const_reference;
+
+	inline bool empty() const{
+
+		return vLabel.empty();
+
+	};
+
+	inline int size() const{
+
+		return int(vLabel.size());
+
+	};
+
+	//set all grids as a value
+	void assign(const int & iGridNum, const ConfidenceValue & oValue){
+
+		ConfidenceCold oCold;
+		oCold.visibletimes = oValue.visiTerm.visibletimes;
+		oCold.totaltimes = oValue.visiTerm.totaltimes;
+		oCold.qualTerm = oValue.qualTerm;
+		oCold.qualFlag = oValue.qualFlag;
+		oCold.oCenterPoint = oValue.oCenterPoint;
+
+		vTravelTerm.assign(iGridNum, oValue.travelTerm);
+		vBoundTerm.assign(iGridNum, oValue.boundTerm);
+		vVisiValue.assign(iGridNum, oValue.visiTerm.value);
+		vTotalValue.assign(iGridNum, oValue.totalValue);
+		vLabel.assign(iGridNum, oValue.label);
+		vTravelable.assign(iGridNum, oValue.travelable);
+		vNodeCount.assign(iGridNum, oValue.nodeCount);
+		vCold.assign(iGridNum, oCold);
+
+	};
+
+	inline reference operator[](const int & k){
+
+		ConfidenceCold & oCold = vCold[k];
+		ConfidenceRef oGrid = {vTravelTerm[k], vBoundTerm[k],
+		                       {oCold.visibletimes, oCold.totaltimes, vVisiValue[k]},
+		                       oCold.qualTerm, vTotalValue[k], vLabel[k], vTravelable[k],
+		                       oCold.qualFlag, vNodeCount[k], oCold.oCenterPoint};
+		return oGrid;
+
+	};
+
+	inline const_reference operator[](const int & k) const{
+
+		const ConfidenceCold & oCold = vCold[k];
+		ConfidenceConstRef oGrid = {vTravelTerm[k], vBoundTerm[k],
+		                            {oCold.visibletimes, oCold.totaltimes, vVisiValue[k]},
+		                            oCold.qualTerm, vTotalValue[k], vLabel[k], vTravelable[k],
+		                            oCold.qualFlag, vNodeCount[k], oCold.oCenterPoint};
+		return oGrid;
+
+	};
+
+	void swap(ConfidenceTile & oOther){
+
+		vTravelTerm.swap(oOther.vTravelTerm);
+		vBoundTerm.swap(oOther.vBoundTerm);
+		vVisiValue.swap(oOther.vVisiValue);
+		vTotalValue.swap(oOther.vTotalValue);
+		vLabel.swap(oOther.vLabel);
+		vTravelable.swap(oOther.vTravelable);
+		vNodeCount.swap(oOther.vNodeCount);
+		vCold.swap(oOther.vCold);
+
+	};
+
+	//write the arrays in binary and read them back (the same process only)
+	void Write(std::ostream & oStream) const{
+
+		WriteArray(oStream, vTravelTerm);
+		WriteArray(oStream, vBoundTerm);
+		WriteArray(oStream, vVisiValue);
+		WriteArray(oStream, vTotalValue);
+		WriteArray(oStream, vLabel);
+		WriteArray(oStream, vTravelable);
+		WriteArray(oStream, vNodeCount);
+		WriteArray(oStream, vCold);
+
+	};
+
+	bool Read(std::istream & oStream, const int & iGridNum){
+
+		assign(iGridNum, ConfidenceValue());
+
+		return ReadArray(oStream, vTravelTerm) && ReadArray(oStream, vBoundTerm) &&
+		       ReadArray(oStream, vVisiValue) && ReadArray(oStream, vTotalValue) &&
+		       ReadArray(oStream, vLabel) && ReadArray(oStream, vTravelable) &&
+		       ReadArray(oStream, vNodeCount) && ReadArray(oStream, vCold);
+
+	};
+
+	//hot fields
+	std::vector<float> vTravelTerm;
+	std::vector<float> vBoundTerm;
+	std::vector<float> vVisiValue;
+	std::vector<float> vTotalValue;
+	std::vector<short> vLabel;
+	std::vector<short> vTravelable;
+	std::vector<short> vNodeCount;
+	//cold fields
+	std::vector<ConfidenceCold> vCold;
+
+private:
+
+	template <class ArrayT>
+	static void WriteArray(std::ostream & oStream, const std::vector<ArrayT> & vArray){
+
+		oStream.write(reinterpret_cast<const char *>(&vArray[0]), vArray.size() * sizeof(ArrayT));
+
+	};
+
+	template <class ArrayT>
+	static bool ReadArray(std::istream & oStream, std::vector<ArrayT> & vArray){
+
+		oStream.read(reinterpret_cast<char *>(&vArray[0]), vArray.size() * sizeof(ArrayT));
+		return oStream.gcount() == std::streamsize(vArray.size() * sizeof(ArrayT));
+
+	};
+
+};
+
+//the confidence map, tiles of structure of arrays
+typedef TiledMap<ConfidenceValue, ConfidenceTile> ConfidenceMap;
+
+
+//the gathered fields of the nearby grids in structure of arrays
+//it is the input and output of the batched distance and total confidence kernels
+struct TermBuffer{
+
+	//offset from grid point to robot
+	std::vector<float> vX;
+	std::vector<float> vY;
+	std::vector<float> vZ;
+	//terms of each grid
+	std::vector<float> vTravel;
+	std::vector<float> vBound;
+	std::vector<float> vVisi;
+	std::vector<float> vTotal;
+
+	//the capacity is kept between calls
+	void Resize(const int & iGridNum){
+
+		vX.resize(iGridNum);
+		vY.resize(iGridNum);
+		vZ.resize(iGridNum);
+		vTravel.resize(iGridNum);
+		vBound.resize(iGridNum);
+		vVisi.resize(iGridNum);
+		vTotal.resize(iGridNum);
+
+	};
+
+};
+
+//the scratch data of quality term, one for each thread
+//it is kept between calls to avoid reallocation
+struct QualityScratch{
+
+	//point clouds to be measured
+	pcl::PointCloud<pcl::PointXYZ> vMeasuredCloud;
+	//the box counting object
+	HausdorffDimension oHDor;
+
+	QualityScratch():oHDor(5, 1){
+
+		//set the minimum scale
+		oHDor.SetMinDis(0.1);
+		//set the dimension type
+		oHDor.SetParaQ(0);
+
+	};
+
+};
+
 //a class computing confidence value of each map grid
 //there is a lot of geometrical features in it
 //it depends on pcl and grid_map lib
@@ -171,6 +436,9 @@ public:
     //set node minimum threshold
 	void SetNodeGenParas(const float & f_fMinNodeThr);
 
+	//set the number of worker threads
+	void SetThreadNum(const int & iThreadNum);
+
 	//output m_fMinNodeThr
 	float OutNodeGenParas();
 
@@ -223,25 +491,38 @@ public:
 	//*******************Feature Term Part********************
 	//1. the distance term of confidence map
 	//generate the distance feature map of a neighboring grids
-	void DistanceTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+	void DistanceTerm(ConfidenceMap & vConfidenceMap,
 		                          const pcl::PointXYZ & oRobotPoint,
                            const std::vector<int> & vNearGroundIdxs,
 	                               const PCLCloudXYZ & vGroundCloud);
 
 
 	//2. compute the boundary feature of neighboorhood
-	void BoundTerm(std::vector<ConfidenceValue> & vConfidenceMap,
-                        const std::vector<int> & vNearGroundIdxs,
-	                         const PCLCloudXYZPtr & pGroundCloud,
-	                          const PCLCloudXYZPtr & pBoundCloud);
+	void BoundTerm(ConfidenceMap & vConfidenceMap,
+                        const std::vector<int> & vNearGroundIdxs);
+
+	//set the size of boundary distance map, which is cleared
+	void InitBoundDistance(const int & iRowNum,
+	                       const int & iColNum,
+	                       const float & fResolution);
+
+	//add a new boundary grid to the boundary distance map
+	void AddBoundaryGrid(const int & iGridIdx);
+
+	//rebuild the boundary distance map from the labels (rolling map)
+	void RebuildBoundDistance(ConfidenceMap & vConfidenceMap);
 
 
 	//3. Compute the occlusion
-	void OcclusionTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+	void OcclusionTerm(ConfidenceMap & vConfidenceMap,
 	                                  PCLCloudXYZPtr & pNearAllCloud,
+	                    const std::vector<long long> & vNearAllKeys,
 	                        const std::vector<int> & vNearGroundIdxs,
-	                            const pcl::PointXYZ & oPastViewPoint,
+	               const std::vector<pcl::PointXYZ> & vPastViewPoints,
 	                                          const int & iNodeTimes);
+
+	//drop the cached visibility hull (point keys are changed)
+	void ResetVisibility();
 	
 
 	//2. quality term of confidence map
@@ -255,10 +536,10 @@ public:
 	//	              const std::vector<std::vector<int>> & vGridObsPsIdx);
 
 	//4. quality term of confidence map
-	void QualityTerm(std::vector<ConfidenceValue> & vConfidenceMap,
+	void QualityTerm(ConfidenceMap & vConfidenceMap,
 		                     const PCLCloudXYZPtr & pObstacleCloud,
                            const std::vector<int> & vObstNodeTimes,
-            const std::vector<std::vector<int> > & vObstlPntMapIdx,
+            const TiledMap<std::vector<int> > & vObstlPntMapIdx,
 		                         const ExtendedGM & oExtendGridMap,
 		                 const std::vector<MapIndex> & vNearByIdxs,
                                              const int & iNodeTime,
@@ -272,25 +553,44 @@ public:
 	//void FrontierTerm(std::vector<ConfidenceValue> & vConfidenceVec, const int & iQueryGrid, const std::vector<int> & vNearByIdxs);
 
 	//6. Compute the total coffidence value
-	void ComputeTotalCoffidence(std::vector<ConfidenceValue> & vConfidenceMap, 
+	void ComputeTotalCoffidence(ConfidenceMap & vConfidenceMap, 
 	                                                   const int & iQueryIdx);
 
+	//compute the total coffidence value of a list of grids in batch
+	void ComputeTotalCoffidence(ConfidenceMap & vConfidenceMap, 
+	                            const std::vector<int> & vQueryIdxs);
+
 
 	//region grow to obtain travelable region (travelable region is the ground which can be touch from current location)
-	void RegionGrow(std::vector<ConfidenceValue> & vConfidenceMap,
+	void RegionGrow(ConfidenceMap & vConfidenceMap,
 	                const std::vector<MapIndex> & vNearbyGridIdxs,
 								const ExtendedGM & oExtendGridMap,
-								           const int & iNodeTimes);
+								           const int & iNodeTimes,
+								           GridRect & oGrownRect);
 
     //check whether the grid is a newest scanned travelable ground grid
 	bool CheckIsNewScannedGrid(const int & iCurrNodeTime, 
-	                           const std::vector<ConfidenceValue> & vConfidenceMap,
+	                           const ConfidenceMap & vConfidenceMap,
 	                           const int & iQueryIdx);
 
+	//record a grid whose nodeCount is just set, which is a node candidate of current trip
+	void AddNodeCandidate(const ConfidenceMap & vConfidenceMap,
+	                                                 const int & iQueryIdx);
+
+	//move the grid indexes of node candidates with the map (rolling map)
+	void ShiftGrids(const int & iRowShift,
+	                const int & iColShift,
+	                const int & iRowNum,
+	                const int & iColNum);
+
+	//record the grids of current trip as node candidates again (checkpoint)
+	void RebuildNodeCandidates(ConfidenceMap & vConfidenceMap,
+	                           const int & iCurrNodeTime);
+
 	//non-minimum suppression
     void FindLocalMinimum(std::vector<int> & vNodeIdxs,
 	                      std::vector<pcl::PointXYZ> & vNodeClouds,
-	                      const std::vector<ConfidenceValue> & vConfidenceMap,
+	                      const ConfidenceMap & vConfidenceMap,
 						  const ExtendedGM & oExtendGridMap,
 	                      const int & iCurrNodeTime);
 
@@ -328,6 +628,78 @@ private:
     //node generation
 	float m_fMinNodeThr;
 
+	//visibility engine, its hull is reused between OcclusionTerm calls
+	GHPR m_oGHPRer;
+
+	//workers of the parallel calculation
+	ThreadPool m_oThreadPool;
+
+	//scratch data of each thread in QualityTerm
+	std::vector<QualityScratch> m_vQualityScratches;
+
+	//gathered grids of DistanceTerm and batched ComputeTotalCoffidence
+	TermBuffer m_oTermBuffer;
+
+	//travel = max(travel, exp(-||p||^2 / sigma^2)) and the total value of each grid in buffer
+	void DistanceKernel(TermBuffer & oBuffer);
+
+	//the total value of each grid in buffer
+	void TotalKernel(TermBuffer & oBuffer);
+
+	//the nearest boundary grid of each grid within sigma (-1 means none)
+	TiledMap<int> m_vBoundSites;
+	int m_iBoundColNum;
+	float m_fBoundResolution;
+	//the queue of brushfire in AddBoundaryGrid
+	std::vector<int> m_vBrushQueue;
+
+	//the squared distance between two grids in grid unit
+	inline int SquareGridDis(const int & iGridIdx,
+	                         const int & iSiteIdx) const{
+
+		int iRowDis = iGridIdx / m_iBoundColNum - iSiteIdx / m_iBoundColNum;
+		int iColDis = iGridIdx % m_iBoundColNum - iSiteIdx % m_iBoundColNum;
+		return iRowDis * iRowDis + iColDis * iColDis;
+
+	};
+
+	//the grids newly scanned (nodeCount is set) which have not been out of date
+	//they are the only grids that can be the local minimum of current trip
+	std::vector<int> m_vNodeCandidates;
+	//whether a grid is in m_vNodeCandidates, only the tiles having candidates are allocated
+	TiledMap<char> m_vCandidateFlags;
+
+	//a grid is suppressed in FindLocalMinimum if its stamp is equal to m_iSuppressStamp,
+	//only the tiles around candidates are allocated
+	TiledMap<int> m_vSuppressStamps;
+	int m_iSuppressStamp;
+
+	//the frontier of region grow, a ring buffer (power of two size) of the grids which are just travelable
+	std::vector<int> m_vGrowRing;
+	int m_iRingHead;
+	int m_iRingSize;
+
+	//whether a grid touches a travelable ground grid in the grow mask
+	bool TouchTravelable(const ConfidenceMap & vConfidenceMap,
+	                     const SearchMask & vGrowMask,
+	                     const int & iQueryIdx) const;
+
+	//push a grid into the frontier, the ring is enlarged if it is full
+	void PushFrontier(const int & iGridIdx);
+
+	//pop the oldest grid of frontier
+	inline bool PopFrontier(int & iGridIdx){
+
+		if (!m_iRingSize)
+			return false;
+
+		iGridIdx = m_vGrowRing[m_iRingHead];
+		m_iRingHead = (m_iRingHead + 1) & (int(m_vGrowRing.size()) - 1);
+		m_iRingSize--;
+		return true;
+
+	};
+
 };
 
 
@@ -1,5 +1,8 @@
 #include "ExtendedGridMap.h"
 
+#include <cstdlib>
+#include <algorithm>
+
 namespace topology_map {
 
 
@@ -18,7 +21,10 @@ Output: none
 Return: none
 Others: Initial naming the grid_map layer as "elevation"
 *************************************************/
-ExtendedGM::ExtendedGM():m_oFeatureMap({ "elevation" }){
+ExtendedGM::ExtendedGM():m_oFeatureMap({ "elevation" }),
+                         m_dMinMapZ(0.0),
+                         m_dMaxMapZ(0.0),
+                         m_iTileAlignSide(0){
 
 
 
@@ -72,6 +78,8 @@ void ExtendedGM::GetParam(const double & dMapMaxRange,
 	m_dMapResolution = dResolution;//map resolution, cell size
 
 	//z is initialized in ReadParameters()	
+	m_dMinMapZ = dMinMapZ;
+	m_dMaxMapZ = dMaxMapZ;
 	m_oMinCorner(2) = dMinMapZ;
 	m_oMaxCorner(2) = dMaxMapZ;
 
@@ -84,7 +92,8 @@ void ExtendedGM::GetParam(const double & dMapMaxRange,
 /*************************************************
 Function: GenerateMap
 Description: generate a grid map
-Calls: none
+Calls: HalfLength
+       BuildMaskOffsets
 Called By: external call
 Table Accessed: none
 Table Updated: none
@@ -98,19 +107,21 @@ void ExtendedGM::GenerateMap(const pcl::PointXYZ & oRobotPos){
 
 	m_oMapOriginalPos(0) = oRobotPos.x;
 	m_oMapOriginalPos(1) = oRobotPos.y;
-	m_oMapOriginalPos(2) = oRobotPos.z;
+
+	//the half length of map, which covers whole tiles in rolling map mode
+	double dHalfLength = HalfLength();
 
 	//corner of map's bounding box
-	m_oMinCorner(0) = m_oMapOriginalPos(0) - float(m_dMapMaxRange);
-	m_oMaxCorner(0) = m_oMapOriginalPos(0) + float(m_dMapMaxRange);
-	m_oMinCorner(1) = m_oMapOriginalPos(1) - float(m_dMapMaxRange);
-	m_oMaxCorner(1) = m_oMapOriginalPos(1) + float(m_dMapMaxRange);
-	m_oMinCorner(2) = m_oMapOriginalPos(2) + m_oMinCorner(2);
-	m_oMaxCorner(2) = m_oMapOriginalPos(2) + m_oMaxCorner(2);
-	//z is initialized in ReadParameters()
+	m_oMinCorner(0) = m_oMapOriginalPos(0) - float(dHalfLength);
+	m_oMaxCorner(0) = m_oMapOriginalPos(0) + float(dHalfLength);
+	m_oMinCorner(1) = m_oMapOriginalPos(1) - float(dHalfLength);
+	m_oMaxCorner(1) = m_oMapOriginalPos(1) + float(dHalfLength);
+	//z range is given in GetParam, it is set again so that the map can be generated more than once
+	m_oMinCorner(2) = oRobotPos.z + m_dMinMapZ;
+	m_oMaxCorner(2) = oRobotPos.z + m_dMaxMapZ;
 
 	//build the map
-	m_oFeatureMap.setGeometry(grid_map::Length(2.0*m_dMapMaxRange, 2.0*m_dMapMaxRange),
+	m_oFeatureMap.setGeometry(grid_map::Length(2.0*dHalfLength, 2.0*dHalfLength),
 		                                                              m_dMapResolution, 
 		                                                             m_oMapOriginalPos);
 
@@ -130,10 +141,55 @@ void ExtendedGM::GenerateMap(const pcl::PointXYZ & oRobotPos){
 	m_oFeatureMap.add("travelable", grid_map::Matrix::Zero(m_oFeatureMap.getSize()(0), m_oFeatureMap.getSize()(1)));
 	m_oFeatureMap.add("quality", grid_map::Matrix::Zero(m_oFeatureMap.getSize()(0), m_oFeatureMap.getSize()(1)));
 
+	//the masks are generated before the map, thus their 1D offsets are built here
+	BuildMaskOffsets();
+
 }
 
 
 
+/*************************************************
+Function: HalfLength
+Description: the half length of map which will be generated by GenerateMap
+Calls: none
+Called By: GenerateMap
+           GridNum
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: the half length (meter)
+Others: the map covers whole tiles in rolling map mode, thus it may be longer than m_dMapMaxRange
+*************************************************/
+double ExtendedGM::HalfLength() const{
+
+	if (m_iTileAlignSide <= 0)
+		return m_dMapMaxRange;
+
+	int iGridNum = int(std::ceil(2.0 * m_dMapMaxRange / m_dMapResolution - 1e-6));
+	iGridNum = (iGridNum + m_iTileAlignSide - 1) / m_iTileAlignSide * m_iTileAlignSide;
+	return 0.5 * double(iGridNum) * m_dMapResolution;
+
+}
+
+/*************************************************
+Function: GridNum
+Description: the grid number in rows (or columns) of the map which will be generated by GenerateMap
+Calls: HalfLength
+Called By: TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: the grid number
+Others: it is the same rounding as grid_map::GridMap::setGeometry
+*************************************************/
+int ExtendedGM::GridNum() const{
+
+	return int(std::round(2.0 * HalfLength() / m_dMapResolution));
+
+}
+
 /*************************************************
 Function: PointoOneDIdx
 Description: convert a point coordinate to a 1D grid index
@@ -341,13 +397,13 @@ Table Accessed: none
 Table Updated: none
 Input: dRadius - the radius of circle mask
 Output: vSearchMask - a mask with local grid index related to the center grid
-Return: vSearchMask - a MapIndex type vector
-Others: none
+Return: vSearchMask - a SearchMask type mask
+Others: the 1D offsets are built by BuildMaskOffsets once the map size is known
 *************************************************/
-std::vector<MapIndex> ExtendedGM::GenerateCircleMask(const double & dRadius) {
+SearchMask ExtendedGM::GenerateCircleMask(const double & dRadius) {
 
 	//define output
-	std::vector<MapIndex> vSearchMask;
+	SearchMask vSearchMask;
 
 	//fRadiusGridsNum means how many grid in the radius axis 
 	float fRadiusGridsNum = dRadius / m_dMapResolution;
@@ -369,15 +425,47 @@ std::vector<MapIndex> ExtendedGM::GenerateCircleMask(const double & dRadius) {
 				oMaskMemberIdx.oTwoIndex(0) = int(i);
 				oMaskMemberIdx.oTwoIndex(1) = int(j);
 				//the index should be tranfored to global coordinate based on query grid when use mask
-				vSearchMask.push_back(oMaskMemberIdx);
+				vSearchMask.vCells.push_back(oMaskMemberIdx);
+				vSearchMask.iRadius = std::max(vSearchMask.iRadius, std::max(std::abs(int(i)), std::abs(int(j))));
 			}//end if sqrt
 		}//end j
 	}//end i
 
+	//the offsets are valid if the map has been built
+	if (m_oFeatureMap.getSize()(0) > 0)
+		vSearchMask.BuildOffsets(m_oFeatureMap.getSize()(0), m_oFeatureMap.getSize()(1));
+
 	return vSearchMask;
 
 }
 
+/*************************************************
+Function: BuildMaskOffsets
+Description: build the 1D offsets of all search masks for the current map size
+Calls: SearchMask::BuildOffsets
+Called By: GenerateMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the 1D offsets of search masks
+Return: none
+Others: the map size is not changed by ShiftMap, thus it is only needed after GenerateMap
+*************************************************/
+void ExtendedGM::BuildMaskOffsets(){
+
+	int iRowNum = m_oFeatureMap.getSize()(0);
+	int iColNum = m_oFeatureMap.getSize()(1);
+
+	m_vRobotSearchMask.BuildOffsets(iRowNum, iColNum);
+	m_vGrowSearchMask.BuildOffsets(iRowNum, iColNum);
+	m_vBoundDefendMask.BuildOffsets(iRowNum, iColNum);
+	m_vNodeMadeMask.BuildOffsets(iRowNum, iColNum);
+	m_vInitialMask.BuildOffsets(iRowNum, iColNum);
+	m_vLocalQualityMask.BuildOffsets(iRowNum, iColNum);
+	m_vAstarPathMask.BuildOffsets(iRowNum, iColNum);
+
+}
+
 
 /*************************************************
 Function: CircleNeighborhood
@@ -391,11 +479,11 @@ Input: oFeatureMap - the grid_map
 	   oQueryPoint - a query point position
 Output: vNearbyGrids - the grid index which is near the robot
 Return: none
-Others: none
+Others: the cells are gathered by 1D offsets without bound checks if the mask is inside the map
 *************************************************/
 void ExtendedGM::CircleNeighborhood(std::vector<MapIndex> & vNearbyGrids,
 	                               const grid_map::GridMap & oFeatureMap,
-	                           const std::vector<MapIndex> & vSearchMask,
+	                                    const SearchMask & vSearchMask,
 	                                   const pcl::PointXYZ & oQueryPoint) {
 
 	vNearbyGrids.clear();
@@ -404,6 +492,19 @@ void ExtendedGM::CircleNeighborhood(std::vector<MapIndex> & vNearbyGrids,
 	grid_map::Index oQueryIdx;
 	oFeatureMap.getIndex(oQueryPos, oQueryIdx);
 
+	//far from the map border
+	if (vSearchMask.Interior(oQueryIdx(0), oQueryIdx(1), oFeatureMap.getSize()(0), oFeatureMap.getSize()(1))) {
+
+		int iQueryOneIdx = TwotoOneDIdx(oQueryIdx);
+		vNearbyGrids.resize(vSearchMask.size());
+		for (int i = 0; i != vSearchMask.size(); ++i) {
+			vNearbyGrids[i].oTwoIndex = oQueryIdx + vSearchMask[i].oTwoIndex;
+			vNearbyGrids[i].iOneIdx = iQueryOneIdx + vSearchMask[i].iOneIdx;
+		}
+		return;
+
+	}
+
 	//seach in given neighboring grids
 	for (int i = 0; i != vSearchMask.size(); ++i) {
 
@@ -427,7 +528,7 @@ void ExtendedGM::CircleNeighborhood(std::vector<MapIndex> & vNearbyGrids,
 //reload with grid index input and 1d index output
 void ExtendedGM::CircleNeighborhood(std::vector<int> & vNearbyGrids,
 	                          const grid_map::GridMap & oFeatureMap,
-	                      const std::vector<MapIndex> & vSearchMask,
+	                               const SearchMask & vSearchMask,
 	                                      const int & iQueryGridIdx) {
 						                           
 		                                       
@@ -438,6 +539,16 @@ void ExtendedGM::CircleNeighborhood(std::vector<int> & vNearbyGrids,
 	grid_map::Index oQueryIdx;
 	OneDtoTwoDIdx(oQueryIdx,iQueryGridIdx);
 
+	//far from the map border, a straight gather by 1D offsets
+	if (vSearchMask.Interior(oQueryIdx(0), oQueryIdx(1), oFeatureMap.getSize()(0), oFeatureMap.getSize()(1))) {
+
+		vNearbyGrids.resize(vSearchMask.size());
+		for (int i = 0; i != vSearchMask.size(); ++i)
+			vNearbyGrids[i] = iQueryGridIdx + vSearchMask[i].iOneIdx;
+		return;
+
+	}
+
 	//seach in given neighboring grids
 	for (int i = 0; i != vSearchMask.size(); ++i) {
 
@@ -445,11 +556,11 @@ void ExtendedGM::CircleNeighborhood(std::vector<int> & vNearbyGrids,
 		//get nearby grid idx on x
 		oOneNearGridIdx.oTwoIndex(0) = oQueryIdx(0) + vSearchMask[i].oTwoIndex(0);
 		if (oOneNearGridIdx.oTwoIndex(0) < 0 || oOneNearGridIdx.oTwoIndex(0) >= oFeatureMap.getSize()(0))
-			break;//if the neighboring grid is outside of the map
+			continue;//if the neighboring grid is outside of the map
         //get nearby grid idx on y axis
 		oOneNearGridIdx.oTwoIndex(1) = oQueryIdx(1) + vSearchMask[i].oTwoIndex(1);
 		if (oOneNearGridIdx.oTwoIndex(1) < 0 || oOneNearGridIdx.oTwoIndex(1) >= oFeatureMap.getSize()(1))
-			break;//if the neighboring grid is outside of the map
+			continue;//if the neighboring grid is outside of the map
 
 		int iOneNearIdx = TwotoOneDIdx(oOneNearGridIdx.oTwoIndex);
 		//compute the nearby grid
@@ -460,6 +571,64 @@ void ExtendedGM::CircleNeighborhood(std::vector<int> & vNearbyGrids,
 }
 
 
+/*************************************************
+Function: SetTileAlignment
+Description: set the tile side that the map size is aligned to
+Calls: none
+Called By: TopologyMap::ReadLaunchParams
+Table Accessed: none
+Table Updated: none
+Input: iTileSide - the tile side in grids, 0 means the map size is not aligned
+Output: m_iTileAlignSide
+Return: none
+Others: it should be called before GenerateMap
+*************************************************/
+void ExtendedGM::SetTileAlignment(const int & iTileSide){
+
+	m_iTileAlignSide = iTileSide > 0 ? iTileSide : 0;
+
+}
+
+/*************************************************
+Function: ShiftMap
+Description: move the map by grids to follow the robot (rolling map)
+Calls: grid_map::GridMap::move
+       grid_map::GridMap::convertToDefaultStartIndex
+Called By: TopologyMap::RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: iRowShift - the row shift, the new grid row i is the old grid row i + iRowShift
+       iColShift - the column shift, the new grid column j is the old grid column j + iColShift
+Output: the moved map and its bounding box
+Return: whether the map is moved
+Others: the start index is reset to (0, 0) after moving, 
+        so that the 1D index (row * column number + column) is still valid
+*************************************************/
+bool ExtendedGM::ShiftMap(const int & iRowShift,
+	                      const int & iColShift){
+
+	//the row index increases with -x and the column index increases with -y in grid_map
+	grid_map::Position oOldPos = m_oFeatureMap.getPosition();
+	grid_map::Position oNewPos(oOldPos.x() - double(iRowShift) * m_oFeatureMap.getResolution(),
+		                       oOldPos.y() - double(iColShift) * m_oFeatureMap.getResolution());
+
+	if (!m_oFeatureMap.move(oNewPos))
+		return false;
+
+	//the circular buffer is reordered, thus grid (0, 0) is the top-left corner again
+	m_oFeatureMap.convertToDefaultStartIndex();
+
+	//the actual moved distance is aligned to the resolution
+	grid_map::Position oMovedDis = m_oFeatureMap.getPosition() - oOldPos;
+	m_oMinCorner(0) += oMovedDis.x();
+	m_oMaxCorner(0) += oMovedDis.x();
+	m_oMinCorner(1) += oMovedDis.y();
+	m_oMaxCorner(1) += oMovedDis.y();
+
+	return true;
+
+}
+
 /*************************************************
 Function: CheckInSidePoint
 Description: check whether a point is inside the map (grid map)
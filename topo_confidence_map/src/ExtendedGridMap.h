@@ -20,6 +20,13 @@ namespace topology_map {
 // a class to extend the function of grid_map, which is at https://github.com/ANYbotics/grid_map.git
 // created and edited by Huang Pengdi
 
+//Version 1.1
+// - add the rolling map mode, the map is moved by whole tiles to follow the robot
+
+//Version 1.2
+// - add GridRect to record the changed region of map between two publishings
+// - the search masks keep their 1D offsets, a query whose mask is inside the map reads them without bound checks
+
 ///************************************************************************///
 	
 //index of grid cell
@@ -32,6 +39,130 @@ struct MapIndex{
 
 };
 
+//a neighborhood search mask, the cells are the offsets related to the query cell
+//oTwoIndex of a cell is the row and column offset, and iOneIdx is the 1D offset of the map size (iRowNum, iColNum),
+//thus a query farther than iRadius from the map border (guard border) gathers its cells by 1D offsets directly
+struct SearchMask{
+
+  std::vector<MapIndex> vCells;
+
+  //the largest row or column offset
+  int iRadius;
+
+  //the map size of 1D offsets, 0 means the offsets have not been built
+  int iRowNum;
+  int iColNum;
+
+  SearchMask():iRadius(0), iRowNum(0), iColNum(0){};
+
+  inline int size() const{
+
+    return int(vCells.size());
+
+  };
+
+  inline const MapIndex & operator[](const int & i) const{
+
+    return vCells[i];
+
+  };
+
+  void clear(){
+
+    vCells.clear();
+    iRadius = 0;
+
+  };
+
+  //build the 1D offsets of a map size
+  void BuildOffsets(const int & f_iRowNum, const int & f_iColNum){
+
+    iRowNum = f_iRowNum;
+    iColNum = f_iColNum;
+    for (int i = 0; i != vCells.size(); ++i)
+      vCells[i].iOneIdx = vCells[i].oTwoIndex(0) * iColNum + vCells[i].oTwoIndex(1);
+
+  };
+
+  //whether the mask centered at (iRow, iCol) is inside a map of the given size, 
+  //then no cell needs a bound check
+  inline bool Interior(const int & iRow, const int & iCol,
+                       const int & iMapRowNum, const int & iMapColNum) const{
+
+    return iMapRowNum == iRowNum && iMapColNum == iColNum &&
+           iRow >= iRadius && iRow < iRowNum - iRadius &&
+           iCol >= iRadius && iCol < iColNum - iRadius;
+
+  };
+
+};
+
+//a rectangle of grid cells (inclusive row and column ranges)
+//it is empty if the maximum row is less than the minimum row
+struct GridRect{
+
+  int iMinRow;
+  int iMaxRow;
+  int iMinCol;
+  int iMaxCol;
+
+  GridRect(){
+
+    Clear();
+
+  };
+
+  //no cell
+  void Clear(){
+
+    iMinRow = 0;
+    iMaxRow = -1;
+    iMinCol = 0;
+    iMaxCol = -1;
+
+  };
+
+  bool Empty() const{
+
+    return iMaxRow < iMinRow || iMaxCol < iMinCol;
+
+  };
+
+  //all cells of a map
+  void SetAll(const int & iRowNum, const int & iColNum){
+
+    iMinRow = 0;
+    iMaxRow = iRowNum - 1;
+    iMinCol = 0;
+    iMaxCol = iColNum - 1;
+
+  };
+
+  //extend the rectangle to cover a cell
+  void Add(const int & iRow, const int & iCol){
+
+    if (Empty()){
+      iMinRow = iMaxRow = iRow;
+      iMinCol = iMaxCol = iCol;
+      return;
+    }
+
+    iMinRow = iRow < iMinRow ? iRow : iMinRow;
+    iMaxRow = iRow > iMaxRow ? iRow : iMaxRow;
+    iMinCol = iCol < iMinCol ? iCol : iMinCol;
+    iMaxCol = iCol > iMaxCol ? iCol : iMaxCol;
+
+  };
+
+  void Add(const std::vector<MapIndex> & vCells){
+
+    for (int i = 0; i != vCells.size(); ++i)
+      Add(vCells[i].oTwoIndex(0), vCells[i].oTwoIndex(1));
+
+  };
+
+};
+
 //Expanded Grid_map library
 //a class to index and traverse robot's neighborhood grid
 //this class is based on grid_map class
@@ -52,6 +183,23 @@ public:
 
 	void GenerateMap(const pcl::PointXYZ & oRobotPos);
 
+	//the map size is rounded up to a multiple of tile side (grids), 0 means no alignment
+	void SetTileAlignment(const int & iTileSide);
+
+	//the geometry of the map to be generated, which is known before GenerateMap
+	double HalfLength() const;
+	int GridNum() const;
+
+	inline double Resolution() const{
+
+		return m_dMapResolution;
+
+	};
+
+	//move the map by grids, the grid (i, j) is the old grid (i + iRowShift, j + iColShift)
+	bool ShiftMap(const int & iRowShift,
+	              const int & iColShift);
+
 	//transform point position to 1 Dimension index
 	static int PointoOneDIdx(const pcl::PointXYZ & oPoint,
 		                     const grid_map::GridMap & oFeatureMap);
@@ -86,16 +234,19 @@ public:
 		                            const int & iOneDIdx);
 
 	//generate a circle neighoorhood region prepared for circle neighborhood grids research
-	std::vector<MapIndex> GenerateCircleMask(const double & dRadius);
+	SearchMask GenerateCircleMask(const double & dRadius);
+
+	//build the 1D offsets of all search masks for the current map size
+	void BuildMaskOffsets();
 
 	//get the neighboorhood grid indexes
 	static void CircleNeighborhood(std::vector<MapIndex> & vNearbyGrids,
 	                               const grid_map::GridMap & oFeatureMap,
-	                           const std::vector<MapIndex> & vSearchMask,
+	                                const SearchMask & vSearchMask,
 	                                   const pcl::PointXYZ & oQueryPoint);
 	static void CircleNeighborhood(std::vector<int> & vNearbyGrids,
 	                         const grid_map::GridMap & oFeatureMap,
-	                     const std::vector<MapIndex> & vSearchMask,
+	                          const SearchMask & vSearchMask,
 	                                     const int & iQueryGridIdx);
 
 	//check inside points
@@ -113,32 +264,38 @@ public:
     grid_map::Position3 m_oMaxCorner; //Bounding box maximum corner of map.
 
     //a neighboorhood search mask of robot
-	std::vector<MapIndex> m_vRobotSearchMask;
+	SearchMask m_vRobotSearchMask;
 
 	//a neighboorhood search mask of region operation 
-	std::vector<MapIndex> m_vGrowSearchMask;
+	SearchMask m_vGrowSearchMask;
 	//a expand operation scale of boundary grid
-	std::vector<MapIndex> m_vBoundDefendMask;
+	SearchMask m_vBoundDefendMask;
 
 	//a mask region that generates a node 
-	std::vector<MapIndex> m_vNodeMadeMask;
+	SearchMask m_vNodeMadeMask;
 
     //a mask intialing the origianl travelable region
-	std::vector<MapIndex> m_vInitialMask;
+	SearchMask m_vInitialMask;
 
 	//a mask to compute quality of a local region
-	std::vector<MapIndex> m_vLocalQualityMask;
+	SearchMask m_vLocalQualityMask;
 
 	//a mask to compute astar path neighboring grid
-	std::vector<MapIndex> m_vAstarPathMask;
+	SearchMask m_vAstarPathMask;
 
 private:
 
-	//note that the map size is fixed, thus it must be initialied large enough to pick the scene 
+	//note that the map size is fixed, thus it must be initialied large enough to pick the scene
+	//unless the rolling map mode moves it with the robot (ShiftMap)
 	double m_dMapMaxRange;///<it indicates the half length of bounding box (map)
 
 	double m_dMapResolution; //resolution of map pixels/cells 
 
+	double m_dMinMapZ; //the elevation range of map related to the robot position
+	double m_dMaxMapZ;
+
+	int m_iTileAlignSide; //the map size is a multiple of it in rolling map mode (0 means not aligned)
+
 	//double m_dRbtLocalRadius;//construted maximum range of map 
 
 	//double m_dNodeRadiusRate;//the rate between robot search radius and node generate radius
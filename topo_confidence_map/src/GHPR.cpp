@@ -21,6 +21,9 @@ GHPR::GHPR(float f_fParam){
 	//set the parameter to act on gamma value
 	SetParamExponentInput(f_fParam);
 
+	//the default reuse conditions of incremental engine
+	SetIncrementalParams(0.05, 0.1);
+
 }
 
 /*************************************************
@@ -84,18 +87,245 @@ inline float GHPR::LinearKernel(const float & fGamma,
 
 
 
+/*************************************************
+Function: ShiftToView
+Description: shift the viewpoint to the origin and save the point clouds in structure of arrays
+Calls: none
+Called By: SphericalFlip
+           RebuildIncremental
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds 
+       oViewPoint - a viewpoint
+Output: oBuffer - the shifted coordinates of each point
+Return: the maximum square norm of shifted points
+Others: none
+*************************************************/
+float GHPR::ShiftToView(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+                        const pcl::PointXYZ & oViewPoint,
+                        FlipBuffer & oBuffer){
+
+	int iPointNum = vCloud.points.size();
+	oBuffer.Resize(iPointNum);
+
+	float * pX = &oBuffer.vX[0];
+	float * pY = &oBuffer.vY[0];
+	float * pZ = &oBuffer.vZ[0];
+	float fMaxSquareNorm = 0.0;
+
+	//to each point
+	//shift the viewpoint to the origin (0,0,0) of coordinate system 
+	for (int i = 0; i != iPointNum; ++i){
+		pX[i] = vCloud.points[i].x - oViewPoint.x;
+		pY[i] = vCloud.points[i].y - oViewPoint.y;
+		pZ[i] = vCloud.points[i].z - oViewPoint.z;
+		float fSquareNorm = pX[i] * pX[i] + pY[i] * pY[i] + pZ[i] * pZ[i];
+		if (fSquareNorm > fMaxSquareNorm)
+			fMaxSquareNorm = fSquareNorm;
+	}
+
+	return fMaxSquareNorm;
+
+}
+
+/*************************************************
+Function: FlipKernel
+Description: the spherical flipping of shifted points with the linear kernel
+Calls: none
+Called By: SphericalFlip
+           RebuildIncremental
+Table Accessed: none
+Table Updated: none
+Input: oBuffer - the shifted points (viewpoint is the origin)
+       fGamma - the gamma of kernel function
+Output: oBuffer - the flipped points
+Return: none
+Others: F(p) = p * f(||p||)/||p|| = p * (2 * gamma * param * (1/||p||) - 1),
+        thus the normalization, kernel and scaling are fused into one pass with a reciprocal square root,
+        AVX2/SSE is used if the compiler enables it, 
+        a point at the viewpoint stays at the origin
+*************************************************/
+void GHPR::FlipKernel(FlipBuffer & oBuffer,
+	                  const float & fGamma){
+
+	int iPointNum = oBuffer.vX.size();
+	if (!iPointNum)
+		return;
+
+	float * pX = &oBuffer.vX[0];
+	float * pY = &oBuffer.vY[0];
+	float * pZ = &oBuffer.vZ[0];
+
+	//f(||p||) = 2 * gamma * param - ||p||
+	const float fKernelValue = 2.0f * fGamma * m_fParam;
+
+	int i = 0;
+
+#if defined(__AVX2__)
+
+	const __m256 oKernel = _mm256_set1_ps(fKernelValue);
+	const __m256 oOne = _mm256_set1_ps(1.0f);
+	const __m256 oHalf = _mm256_set1_ps(0.5f);
+	const __m256 oThree = _mm256_set1_ps(3.0f);
+	const __m256 oMinNorm = _mm256_set1_ps(FLT_MIN);
+
+	for (; i + 8 <= iPointNum; i += 8){
+
+		__m256 oX = _mm256_loadu_ps(pX + i);
+		__m256 oY = _mm256_loadu_ps(pY + i);
+		__m256 oZ = _mm256_loadu_ps(pZ + i);
+		__m256 oSquareNorm = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(oX, oX), _mm256_mul_ps(oY, oY)),
+		                                   _mm256_mul_ps(oZ, oZ));
+
+		//1/||p||, refined by one newton step
+		__m256 oInvNorm = _mm256_rsqrt_ps(oSquareNorm);
+		oInvNorm = _mm256_mul_ps(_mm256_mul_ps(oHalf, oInvNorm),
+		                         _mm256_sub_ps(oThree, _mm256_mul_ps(oSquareNorm, _mm256_mul_ps(oInvNorm, oInvNorm))));
+
+		//scale = f(||p||)/||p||, zero for the point at viewpoint
+		__m256 oScale = _mm256_sub_ps(_mm256_mul_ps(oKernel, oInvNorm), oOne);
+		oScale = _mm256_and_ps(oScale, _mm256_cmp_ps(oSquareNorm, oMinNorm, _CMP_GT_OQ));
+
+		_mm256_storeu_ps(pX + i, _mm256_mul_ps(oX, oScale));
+		_mm256_storeu_ps(pY + i, _mm256_mul_ps(oY, oScale));
+		_mm256_storeu_ps(pZ + i, _mm256_mul_ps(oZ, oScale));
+
+	}//end for i
+
+#elif defined(__SSE2__)
+
+	const __m128 oKernel = _mm_set1_ps(fKernelValue);
+	const __m128 oOne = _mm_set1_ps(1.0f);
+	const __m128 oHalf = _mm_set1_ps(0.5f);
+	const __m128 oThree = _mm_set1_ps(3.0f);
+	const __m128 oMinNorm = _mm_set1_ps(FLT_MIN);
+
+	for (; i + 4 <= iPointNum; i += 4){
+
+		__m128 oX = _mm_loadu_ps(pX + i);
+		__m128 oY = _mm_loadu_ps(pY + i);
+		__m128 oZ = _mm_loadu_ps(pZ + i);
+		__m128 oSquareNorm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(oX, oX), _mm_mul_ps(oY, oY)),
+		                                _mm_mul_ps(oZ, oZ));
+
+		//1/||p||, refined by one newton step
+		__m128 oInvNorm = _mm_rsqrt_ps(oSquareNorm);
+		oInvNorm = _mm_mul_ps(_mm_mul_ps(oHalf, oInvNorm),
+		                      _mm_sub_ps(oThree, _mm_mul_ps(oSquareNorm, _mm_mul_ps(oInvNorm, oInvNorm))));
+
+		//scale = f(||p||)/||p||, zero for the point at viewpoint
+		__m128 oScale = _mm_sub_ps(_mm_mul_ps(oKernel, oInvNorm), oOne);
+		oScale = _mm_and_ps(oScale, _mm_cmpgt_ps(oSquareNorm, oMinNorm));
+
+		_mm_storeu_ps(pX + i, _mm_mul_ps(oX, oScale));
+		_mm_storeu_ps(pY + i, _mm_mul_ps(oY, oScale));
+		_mm_storeu_ps(pZ + i, _mm_mul_ps(oZ, oScale));
+
+	}//end for i
+
+#endif
+
+	//the rest points (or all points without simd)
+	for (; i < iPointNum; ++i){
+
+		float fSquareNorm = pX[i] * pX[i] + pY[i] * pY[i] + pZ[i] * pZ[i];
+		float fScale = 0.0;
+		if (fSquareNorm > FLT_MIN)
+			fScale = fKernelValue / sqrt(fSquareNorm) - 1.0f;
+
+		pX[i] = pX[i] * fScale;
+		pY[i] = pY[i] * fScale;
+		pZ[i] = pZ[i] * fScale;
+
+	}//end for i
+
+}
+
+/*************************************************
+Function: SphericalFlip
+Description: transform the point clouds by the spherical flipping of GHPR
+Calls: ShiftToView
+       FlipKernel
+Called By: ComputeVisibility
+           ComputeVisibilityQhull
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds 
+       oViewPoint - a viewpoint
+Output: oBuffer - the transformed point clouds (without the viewpoint)
+Return: none
+Others: F(p,C) = C + (p - C) * f(||p - C||)/||p - C||
+        gamma is the maximum distance from the viewpoint to point set,
+        which is got in the shifting pass, then the flipping is done in one pass
+*************************************************/
+void GHPR::SphericalFlip(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+                         const pcl::PointXYZ & oViewPoint,
+                         FlipBuffer & oBuffer){
+
+	//shift and get the gamma
+	float fGamma = sqrt(ShiftToView(vCloud, oViewPoint, oBuffer));
+
+	//flip
+	FlipKernel(oBuffer, fGamma);
+
+}
+
+/*************************************************
+Function: SphericalFlip - Reload
+Description: transform the point clouds by the spherical flipping of GHPR, output a pcl point clouds
+Calls: SphericalFlip
+Called By: ComputeVisibilityQhull
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds 
+       oViewPoint - a viewpoint
+       oBuffer - a buffer of flipping
+Output: vFlipCloud - the transformed point clouds, the viewpoint (origin) is added at the end
+Return: none
+Others: none
+*************************************************/
+void GHPR::SphericalFlip(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+                         const pcl::PointXYZ & oViewPoint,
+                         FlipBuffer & oBuffer,
+                         pcl::PointCloud<pcl::PointXYZ> & vFlipCloud){
+
+	SphericalFlip(vCloud, oViewPoint, oBuffer);
+
+	//new point clouds include raw point set and viewpoint
+	vFlipCloud.width = vCloud.points.size() + 1;
+	vFlipCloud.height = 1;
+	vFlipCloud.is_dense = false;
+	vFlipCloud.points.resize(vFlipCloud.width * vFlipCloud.height);
+
+	for (size_t i = 0; i != vCloud.points.size(); ++i){
+		vFlipCloud.points[i].x = oBuffer.vX[i];
+		vFlipCloud.points[i].y = oBuffer.vY[i];
+		vFlipCloud.points[i].z = oBuffer.vZ[i];
+	}
+
+	//dont forget to add the viewpoint at origin!
+	vFlipCloud.points.back().x = 0.0;
+	vFlipCloud.points.back().y = 0.0;
+	vFlipCloud.points.back().z = 0.0;
+
+}
+
 /*************************************************
 Function: ComputeVisibility
 Description: Compute the visiable points of a point set from a viewpoint
-Calls: none
+Calls: SphericalFlip
+       FindVisibleIndices
+       ComputeVisibilityQhull
 Called By: main function of project
 Table Accessed: none
 Table Updated: none
 Input: vCloud - an input point clouds 
        oViewPoint - a viewpoint
 Output: none
-Return: none
-Others: none
+Return: visibility of each input point
+Others: the convex hull is computed by QuickHull, 
+        which gives the vertex indices directly (no kdtree matching),
+        the flipping buffer and hull are kept in the object to avoid reallocation
 *************************************************/
 std::vector<bool> GHPR::ComputeVisibility(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
                                                       const pcl::PointXYZ & oViewPoint){
@@ -109,63 +339,73 @@ std::vector<bool> GHPR::ComputeVisibility(const pcl::PointCloud<pcl::PointXYZ> &
 		return vVisiableRes;
 	}
 
-	//F(p,C) = C + (p - C) * f(||p - C||)/||p - C||
-	//a kernel function input, which must be larger that the maximum distance from the viewpoint to poins set
-	float fGamma = -FLT_MAX;
-
 	//*******Transform the point cloud which is to be observed *******
+	SphericalFlip(vCloud, oViewPoint, m_oFlipBuffer);
 
-	//a point cloud to save the transfored points
-	//new point clouds include raw point set and viewpoint
-	std::vector<float> vPointNorms(vCloud.points.size());///<norm of each point
-	pcl::PointCloud<pcl::PointXYZ>::Ptr pConvexCloud(new pcl::PointCloud<pcl::PointXYZ>);
-	//the viewpoint will be added in the end of calculation
-	pConvexCloud->width = vCloud.points.size();
-	pConvexCloud->height = 1;
-	pConvexCloud->is_dense = false;
-	pConvexCloud->points.resize(pConvexCloud->width * pConvexCloud->height);
+	//*******Compute the convex hull of transformed point cloud *******
+	m_oFlipHull.Clear();
+	m_oFlipHull.Reserve(vCloud.points.size() + 1);
+	for (size_t i = 0; i != vCloud.points.size(); ++i)
+		m_oFlipHull.AddPoint(m_oFlipBuffer.vX[i], m_oFlipBuffer.vY[i], m_oFlipBuffer.vZ[i]);
 
-	//to each point
-	//shift the viewpoint to the origin (0,0,0) of coordinate system 
-	for(size_t i = 0; i != vCloud.points.size(); ++i){
-		//build the local coordinate system at the origin
-		pConvexCloud->points[i].x = vCloud.points[i].x - oViewPoint.x;
-		pConvexCloud->points[i].y = vCloud.points[i].y - oViewPoint.y;
-		pConvexCloud->points[i].z = vCloud.points[i].z - oViewPoint.z;
-		//compute the distance from viewpoint to the searched point
-		vPointNorms[i] = sqrt(pConvexCloud->points[i].x * pConvexCloud->points[i].x
-			                + pConvexCloud->points[i].y * pConvexCloud->points[i].y
-		                    + pConvexCloud->points[i].z * pConvexCloud->points[i].z);
-
-		pConvexCloud->points[i].x = pConvexCloud->points[i].x / vPointNorms[i];
-		pConvexCloud->points[i].y = pConvexCloud->points[i].y / vPointNorms[i];
-		pConvexCloud->points[i].z = pConvexCloud->points[i].z / vPointNorms[i];
-		//give the maximum norm to the gamma value 
-		if (vPointNorms[i] > fGamma)
-			fGamma = vPointNorms[i];
+	//dont forget to add the viewpoint at origin!
+	m_oFlipHull.AddPoint(0.0, 0.0, 0.0);
 
-	}
+	//use qhull if the hull is degenerate or fails
+	if (!m_oFlipHull.Build())
+		return ComputeVisibilityQhull(vCloud, oViewPoint);
 
-	for (size_t i = 0; i != pConvexCloud->points.size(); ++i) {
-	
-		//compute the kernel value
-		float oKernelValue = LinearKernel(fGamma, vPointNorms[i]);
-		//compute the final transfored point set
-		pConvexCloud->points[i].x = pConvexCloud->points[i].x * oKernelValue;
-		pConvexCloud->points[i].y = pConvexCloud->points[i].y * oKernelValue;
-		pConvexCloud->points[i].z = pConvexCloud->points[i].z * oKernelValue;
-	
+	//the hull vertices are the visible points
+	FindVisibleIndices(vVisiableRes, m_oFlipHull);
+
+	//return the reslut
+	return vVisiableRes;
+
+}
+
+/*************************************************
+Function: ComputeVisibilityQhull
+Description: Compute the visiable points of a point set from a viewpoint using pcl::ConvexHull (qhull)
+Calls: SphericalFlip
+       FindVisibleIndices
+Called By: ComputeVisibility
+           UpdateVisibility
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds 
+       oViewPoint - a viewpoint
+       bKdTreeFlag - recover the hull indices by kdtree even if qhull vertex ids are available
+Output: none
+Return: visibility of each input point
+Others: getHullPointIndices is available when the version of pcl is up to 1.8.0,
+        otherwise the indices are recovered by kdtree (also O(nlogn))
+*************************************************/
+std::vector<bool> GHPR::ComputeVisibilityQhull(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+                                                           const pcl::PointXYZ & oViewPoint,
+                                                                          bool bKdTreeFlag){
+
+    //define output
+	std::vector<bool> vVisiableRes;
+    //check there  is enough input
+	if(vCloud.points.size() < 3){
+		//all points visible if less points 
+		vVisiableRes.resize(vCloud.size(),true);
+		return vVisiableRes;
 	}
 
-	//dont forget to add the viewpoint at origin!
-	pcl::PointXYZ oViewOriginPoint;
-	oViewOriginPoint.x = 0.0;
-	oViewOriginPoint.y = 0.0;
-	oViewOriginPoint.z = 0.0;
-	pConvexCloud->points.push_back(oViewOriginPoint);//in the end of point clouds
+	//*******Transform the point cloud which is to be observed *******
+	//a local buffer, since it may be called by the parallel UpdateVisibilityBatch
+	FlipBuffer oFlipBuffer;
+	pcl::PointCloud<pcl::PointXYZ>::Ptr pConvexCloud(new pcl::PointCloud<pcl::PointXYZ>);
+	SphericalFlip(vCloud, oViewPoint, oFlipBuffer, *pConvexCloud);
 
 	//*******Compute the convex hull of transformed point cloud *******
 	
+	//qhull keeps global states in old versions, thus only one hull is computed at a time
+	//(it may be called by the parallel UpdateVisibilityBatch)
+	static std::mutex oQhullMutex;
+	std::unique_lock<std::mutex> oQhullLock(oQhullMutex);
+
 	//a object based on pcl convex hull class 
     pcl::ConvexHull<pcl::PointXYZ> oConvexHull;
 	pcl::PointCloud<pcl::PointXYZ>::Ptr pChullResCloud(new pcl::PointCloud<pcl::PointXYZ>);
@@ -177,14 +417,26 @@ std::vector<bool> GHPR::ComputeVisibility(const pcl::PointCloud<pcl::PointXYZ> &
 	//compute the 3D convex hull
 	oConvexHull.reconstruct(*pChullResCloud);
 
-	//get the indices of convex hull point (visiable point set)
-	//call this function below is risk
-	//because this function could be called only when the version of pcl is up tp 1.8.0
-	//pcl::PointIndices vHullPointIndices;	
-	//oConvexHull.getHullPointIndices(vHullPointIndices);
+#if PCL_VERSION_COMPARE(>=, 1, 8, 0)
+	//get the indices of convex hull point (visiable point set) from qhull vertex ids
+	if (!bKdTreeFlag){
 
-	//In terms of this situation, we use the kdtree (also O(nlogn)) to find the index
+		pcl::PointIndices vHullPointIndices;	
+		oConvexHull.getHullPointIndices(vHullPointIndices);
 
+		int iViewPointIdx = pConvexCloud->points.size() - 1;
+		vVisiableRes.resize(vCloud.points.size(), false);
+		for (size_t i = 0; i != vHullPointIndices.indices.size(); ++i){
+			if (vHullPointIndices.indices[i] != iViewPointIdx)
+				vVisiableRes[vHullPointIndices.indices[i]] = true;
+		}
+
+		return vVisiableRes;
+
+	}
+#endif
+
+	//In terms of old pcl, we use the kdtree (also O(nlogn)) to find the index
 	FindVisibleIndices(vVisiableRes,pConvexCloud,pChullResCloud);
 
 	//return the reslut
@@ -192,13 +444,34 @@ std::vector<bool> GHPR::ComputeVisibility(const pcl::PointCloud<pcl::PointXYZ> &
 
 }
 
+/*************************************************
+Function: FindVisibleIndices
+Description: find the visible points from the vertices of constructed convex hull
+Calls: QuickHull::GetVertexFlags
+Called By: ComputeVisibility
+Table Accessed: none
+Table Updated: none
+Input: oConvexHull - the hull of transformed point clouds, the last point is the viewpoint
+Output: vVisibleRes - the visible point 
+Return: none
+Others: none
+*************************************************/
+void GHPR::FindVisibleIndices(std::vector<bool> & vVisibleRes,
+	                          const QuickHull & oConvexHull){
 
+	//hull vertex flags are in the input order
+	oConvexHull.GetVertexFlags(vVisibleRes);
+
+	//remove the viewpoint from ouput list
+	vVisibleRes.pop_back();
+
+}
 
 /*************************************************
-Function: FindHullIndices
-Description: find the point indices of constructed convex hull
+Function: FindVisibleIndices - Reload
+Description: find the point indices of constructed convex hull by kdtree
 Calls: none
-Called By: ComputeVisibility
+Called By: ComputeVisibilityQhull
 Table Accessed: none
 Table Updated: none
 Input: vVisibleRes - the visible point 
@@ -206,7 +479,7 @@ Input: vVisibleRes - the visible point
        pHullCloud - a point clouds at the convex hull
 Output: none
 Return: none
-Others: none
+Others: it is only used for pcl older than 1.8.0, which has no getHullPointIndices
 *************************************************/
 void GHPR::FindVisibleIndices(std::vector<bool> & vVisibleRes,
 	                          const pcl::PointCloud<pcl::PointXYZ>::Ptr & pTransforCloud,
@@ -245,4 +518,406 @@ void GHPR::FindVisibleIndices(std::vector<bool> & vVisibleRes,
 
 
 
-}
\ No newline at end of file
+
+/*************************************************
+Function: SetIncrementalParams
+Description: set the reuse conditions of the cached hull in incremental engine
+Calls: none
+Called By: GHPR
+           Confidence
+Table Accessed: none
+Table Updated: none
+Input: f_fViewTolerance - the viewpoint (or point) shift which is still regarded as unmoved
+       f_fGammaMargin - gamma of cached hull is enlarged by this rate 
+Output: none
+Return: none
+Others: because m_fParam is very large in practice, a small gamma margin nearly does not change the visibility
+*************************************************/
+void GHPR::SetIncrementalParams(float f_fViewTolerance,
+	                            float f_fGammaMargin){
+
+	m_fViewTolerance = f_fViewTolerance;
+	m_fGammaMargin = f_fGammaMargin;
+
+}
+
+/*************************************************
+Function: ResetIncremental
+Description: drop the cached hulls of incremental engine
+Calls: ResetCache
+Called By: Confidence::ResetVisibility
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: call it when the point keys are changed (e.g., point clouds are sampled)
+*************************************************/
+void GHPR::ResetIncremental(){
+
+	ResetCache(m_oCache);
+
+	for (size_t i = 0; i != m_vViewCaches.size(); ++i)
+		ResetCache(m_vViewCaches[i]);
+
+}
+
+/*************************************************
+Function: ResetCache
+Description: clear a cached hull
+Calls: none
+Called By: ResetIncremental
+           RebuildIncremental
+Table Accessed: none
+Table Updated: none
+Input: oCache - a cached hull
+Output: oCache - an empty cached hull
+Return: none
+Others: none
+*************************************************/
+void GHPR::ResetCache(HullCache & oCache){
+
+	oCache.oHull.Clear();
+	oCache.vPoints.clear();
+	oCache.mKeyToHullIdx.clear();
+	oCache.fGamma = 0.0;
+
+}
+
+/*************************************************
+Function: AddFlippedPoint
+Description: spherically flip a point with the cached viewpoint and gamma, then add it to the hull
+Calls: LinearKernel
+Called By: UpdateCachedVisibility
+Table Accessed: none
+Table Updated: none
+Input: oCache - a cached hull
+       oPoint - a raw point
+Output: a new point in oCache.oHull and oCache.vPoints
+Return: the index of the point in hull
+Others: none
+*************************************************/
+inline int GHPR::AddFlippedPoint(HullCache & oCache,
+	                             const pcl::PointXYZ & oPoint){
+
+	//shift the viewpoint to the origin
+	float fX = oPoint.x - oCache.oView.x;
+	float fY = oPoint.y - oCache.oView.y;
+	float fZ = oPoint.z - oCache.oView.z;
+	float fNorm = sqrt(fX * fX + fY * fY + fZ * fZ);
+
+	//F(p,C) = C + (p - C) * f(||p - C||)/||p - C||
+	float fScale = 0.0;
+	if (fNorm > FLT_MIN)
+		fScale = LinearKernel(oCache.fGamma, fNorm) / fNorm;
+
+	oCache.vPoints.push_back(oPoint);
+
+	return oCache.oHull.AddPoint(fX * fScale, fY * fScale, fZ * fScale);
+
+}
+
+/*************************************************
+Function: RebuildIncremental
+Description: rebuild a cached hull of incremental engine from scratch
+Calls: ShiftToView
+       FlipKernel
+       QuickHull::Build
+Called By: UpdateCachedVisibility
+Table Accessed: none
+Table Updated: none
+Input: oCache - a cached hull
+       vCloud - an input point clouds
+       vPointKeys - the stable key of each point
+       oViewPoint - a viewpoint
+Output: the cached hull, the i-th point in hull is the i-th input point
+Return: false if the hull can not be built
+Others: none
+*************************************************/
+bool GHPR::RebuildIncremental(HullCache & oCache,
+	                          const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                          const std::vector<long long> & vPointKeys,
+	                          const pcl::PointXYZ & oViewPoint){
+
+	ResetCache(oCache);
+
+	//gamma with a margin
+	oCache.oView = oViewPoint;
+	float fMaxNorm = ShiftToView(vCloud, oViewPoint, oCache.oFlipBuffer);
+	oCache.fGamma = sqrt(fMaxNorm) * (1.0 + m_fGammaMargin);
+
+	//flip all points in one pass
+	FlipKernel(oCache.oFlipBuffer, oCache.fGamma);
+
+	oCache.oHull.Reserve(vCloud.points.size() + 1);
+	oCache.vPoints.reserve(vCloud.points.size() + 1);
+	oCache.mKeyToHullIdx.reserve(vCloud.points.size());
+	for (size_t i = 0; i != vCloud.points.size(); ++i){
+		oCache.mKeyToHullIdx[vPointKeys[i]] = oCache.oHull.AddPoint(oCache.oFlipBuffer.vX[i],
+		                                                            oCache.oFlipBuffer.vY[i],
+		                                                            oCache.oFlipBuffer.vZ[i]);
+		oCache.vPoints.push_back(vCloud.points[i]);
+	}
+
+	//dont forget to add the viewpoint at origin!
+	oCache.oHull.AddPoint(0.0, 0.0, 0.0);
+	oCache.vPoints.push_back(oViewPoint);
+
+	if (!oCache.oHull.Build()){
+		ResetCache(oCache);
+		return false;
+	}
+
+	return true;
+
+}
+
+/*************************************************
+Function: UpdateVisibility
+Description: the incremental visibility engine, 
+             compute the visible points of a point set from a viewpoint 
+             and reuse the hull of last call if possible
+Calls: UpdateCachedVisibility
+Called By: Confidence::OcclusionTerm
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds 
+       vPointKeys - the stable key of each point (unique)
+       oViewPoint - a viewpoint
+Output: vVisibleRes - visibility of each input point
+Return: true if the cached hull is reused
+Others: see UpdateCachedVisibility
+*************************************************/
+bool GHPR::UpdateVisibility(std::vector<bool> & vVisibleRes,
+	                        const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                        const std::vector<long long> & vPointKeys,
+	                        const pcl::PointXYZ & oViewPoint){
+
+	return UpdateCachedVisibility(m_oCache, vVisibleRes, vCloud, vPointKeys, oViewPoint);
+
+}
+
+/*************************************************
+Function: UpdateVisibilityBatch
+Description: compute the visible points of a point set from multiple viewpoints,
+             the spherical flipping and hull of each viewpoint are computed in parallel
+Calls: UpdateCachedVisibility
+       ThreadPool::ParallelFor
+Called By: Confidence::OcclusionTerm
+Table Accessed: none
+Table Updated: none
+Input: vCloud - an input point clouds (shared by all viewpoints)
+       vPointKeys - the stable key of each point (unique)
+       vViewPoints - the viewpoints
+       oThreadPool - the workers
+Output: vVisibleRes - visibility of each input point from each viewpoint,
+                      vVisibleRes[i][j] is the visibility of j-th point from i-th viewpoint
+Return: the number of viewpoints whose cached hull is reused
+Others: each viewpoint is matched to a cached hull whose viewpoint is within m_fViewTolerance,
+        thus a viewpoint staying in the history keeps its hull even if its order is changed,
+        the unmatched viewpoints take the unmatched hulls and rebuild them
+*************************************************/
+int GHPR::UpdateVisibilityBatch(std::vector<std::vector<bool> > & vVisibleRes,
+	                            const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                            const std::vector<long long> & vPointKeys,
+	                            const std::vector<pcl::PointXYZ> & vViewPoints,
+	                            ThreadPool & oThreadPool){
+
+	vVisibleRes.resize(vViewPoints.size());
+
+	//one cached hull for each viewpoint at least
+	if (m_vViewCaches.size() < vViewPoints.size())
+		m_vViewCaches.resize(vViewPoints.size());
+
+	float fSquareTolerance = m_fViewTolerance * m_fViewTolerance;
+
+	//the cached hull index of each viewpoint
+	std::vector<int> vCacheIdxs(vViewPoints.size(), -1);
+	std::vector<bool> vCacheUsed(m_vViewCaches.size(), false);
+
+	//match the viewpoints to the cached hulls
+	for (size_t i = 0; i != vViewPoints.size(); ++i){
+		for (size_t j = 0; j != m_vViewCaches.size(); ++j){
+
+			if (vCacheUsed[j] || !m_vViewCaches[j].oHull.IsReady())
+				continue;
+
+			const pcl::PointXYZ & oView = m_vViewCaches[j].oView;
+			if ((vViewPoints[i].x - oView.x) * (vViewPoints[i].x - oView.x) +
+				(vViewPoints[i].y - oView.y) * (vViewPoints[i].y - oView.y) +
+				(vViewPoints[i].z - oView.z) * (vViewPoints[i].z - oView.z) <= fSquareTolerance){
+				vCacheIdxs[i] = j;
+				vCacheUsed[j] = true;
+				break;
+			}
+
+		}//end for j
+	}//end for i
+
+	//the unmatched viewpoints take the unused hulls
+	size_t iFreeIdx = 0;
+	for (size_t i = 0; i != vViewPoints.size(); ++i){
+		if (vCacheIdxs[i] >= 0)
+			continue;
+		while (vCacheUsed[iFreeIdx])
+			iFreeIdx++;
+		vCacheIdxs[i] = iFreeIdx;
+		vCacheUsed[iFreeIdx] = true;
+	}//end for i
+
+	//compute each viewpoint in parallel
+	//each task only writes its own hull and result
+	std::vector<int> vReuseFlags(vViewPoints.size(), 0);
+	oThreadPool.ParallelFor(int(vViewPoints.size()), [&](int i){
+		vReuseFlags[i] = UpdateCachedVisibility(m_vViewCaches[vCacheIdxs[i]],
+		                                        vVisibleRes[i],
+		                                        vCloud,
+		                                        vPointKeys,
+		                                        vViewPoints[i]) ? 1 : 0;
+	});
+
+	//drop the hulls of viewpoints which have left
+	if (m_vViewCaches.size() > vViewPoints.size()){
+		for (size_t j = 0; j != m_vViewCaches.size(); ++j)
+			if (!vCacheUsed[j])
+				ResetCache(m_vViewCaches[j]);
+	}
+
+	int iReuseNum = 0;
+	for (size_t i = 0; i != vReuseFlags.size(); ++i)
+		iReuseNum += vReuseFlags[i];
+
+	return iReuseNum;
+
+}
+
+/*************************************************
+Function: UpdateCachedVisibility
+Description: compute the visible points of a point set from a viewpoint 
+             and reuse the given cached hull if possible
+Calls: RebuildIncremental
+       AddFlippedPoint
+       ComputeVisibilityQhull
+       QuickHull::InsertNewPoints
+Called By: UpdateVisibility
+           UpdateVisibilityBatch
+Table Accessed: none
+Table Updated: none
+Input: oCache - a cached hull
+       vCloud - an input point clouds 
+       vPointKeys - the stable key of each point (unique)
+       oViewPoint - a viewpoint
+Output: vVisibleRes - visibility of each input point
+        oCache - the updated cached hull
+Return: true if the cached hull is reused
+Others: the cached hull is reused only if:
+        1. the viewpoint moves less than m_fViewTolerance
+        2. no cached point is missing or moved more than m_fViewTolerance
+        3. each new point is inside the cached gamma
+        then only the new points are flipped and inserted into the hull,
+        the result is reported by the hull vertex indices directly
+        it only reads the members of GHPR, thus it can run in parallel on different caches
+*************************************************/
+bool GHPR::UpdateCachedVisibility(HullCache & oCache,
+	                              std::vector<bool> & vVisibleRes,
+	                              const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                              const std::vector<long long> & vPointKeys,
+	                              const pcl::PointXYZ & oViewPoint){
+
+	//check there is enough input
+	if (vCloud.points.size() < 3){
+		//all points visible if less points 
+		vVisibleRes.assign(vCloud.points.size(), true);
+		return false;
+	}
+
+	float fSquareTolerance = m_fViewTolerance * m_fViewTolerance;
+	float fSquareGamma = oCache.fGamma * oCache.fGamma;
+
+	//the index in hull of each input point
+	std::vector<int> vHullIdxs(vCloud.points.size(), -1);
+	std::vector<int> vNewPointIdxs;
+
+	//check whether the cached hull can be reused
+	bool bReuseFlag = oCache.oHull.IsReady() && 
+	                  (oViewPoint.x - oCache.oView.x) * (oViewPoint.x - oCache.oView.x) +
+	                  (oViewPoint.y - oCache.oView.y) * (oViewPoint.y - oCache.oView.y) +
+	                  (oViewPoint.z - oCache.oView.z) * (oViewPoint.z - oCache.oView.z) <= fSquareTolerance;
+
+	if (bReuseFlag){
+
+		unsigned int iMatchedNum = 0;
+
+		for (size_t i = 0; i != vCloud.points.size() && bReuseFlag; ++i){
+
+			const pcl::PointXYZ & oPoint = vCloud.points[i];
+			std::unordered_map<long long, int>::const_iterator oIter = oCache.mKeyToHullIdx.find(vPointKeys[i]);
+
+			if (oIter != oCache.mKeyToHullIdx.end()){
+				//a cached point must not be moved
+				const pcl::PointXYZ & oCached = oCache.vPoints[oIter->second];
+				if ((oPoint.x - oCached.x) * (oPoint.x - oCached.x) +
+					(oPoint.y - oCached.y) * (oPoint.y - oCached.y) +
+					(oPoint.z - oCached.z) * (oPoint.z - oCached.z) > fSquareTolerance)
+					bReuseFlag = false;
+				vHullIdxs[i] = oIter->second;
+				iMatchedNum++;
+			}else{
+				//a new point must be inside the gamma
+				if ((oPoint.x - oCache.oView.x) * (oPoint.x - oCache.oView.x) +
+					(oPoint.y - oCache.oView.y) * (oPoint.y - oCache.oView.y) +
+					(oPoint.z - oCache.oView.z) * (oPoint.z - oCache.oView.z) > fSquareGamma)
+					bReuseFlag = false;
+				vNewPointIdxs.push_back(i);
+			}
+
+		}//end for i
+
+		//a hull can not remove points
+		if (iMatchedNum != oCache.mKeyToHullIdx.size())
+			bReuseFlag = false;
+
+	}//end if bReuseFlag
+
+	//insert only the new points
+	if (bReuseFlag){
+
+		for (size_t i = 0; i != vNewPointIdxs.size(); ++i){
+			int iHullIdx = AddFlippedPoint(oCache, vCloud.points[vNewPointIdxs[i]]);
+			oCache.mKeyToHullIdx[vPointKeys[vNewPointIdxs[i]]] = iHullIdx;
+			vHullIdxs[vNewPointIdxs[i]] = iHullIdx;
+		}
+
+		if (!oCache.oHull.InsertNewPoints())
+			bReuseFlag = false;
+
+	}
+
+	//otherwise rebuild the hull
+	if (!bReuseFlag){
+
+		if (!RebuildIncremental(oCache, vCloud, vPointKeys, oViewPoint)){
+			//use the qhull based method if the hull fails
+			vVisibleRes = ComputeVisibilityQhull(vCloud, oViewPoint);
+			return false;
+		}
+
+		for (size_t i = 0; i != vCloud.points.size(); ++i)
+			vHullIdxs[i] = i;
+
+	}
+
+	//the visible points are the vertices of hull
+	std::vector<bool> vVertexFlags;
+	oCache.oHull.GetVertexFlags(vVertexFlags);
+
+	vVisibleRes.resize(vCloud.points.size());
+	for (size_t i = 0; i != vCloud.points.size(); ++i)
+		vVisibleRes[i] = vVertexFlags[vHullIdxs[i]];
+
+	return bReuseFlag;
+
+}
+
+
+}
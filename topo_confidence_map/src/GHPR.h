@@ -4,9 +4,11 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
 
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_types.h>
+#include <pcl/pcl_config.h>
 
 //flann based
 #include <pcl/kdtree/kdtree.h>
@@ -16,6 +18,18 @@
 #include <pcl/surface/convex_hull.h>
 #include <pcl/surface/concave_hull.h>//important
 
+//simd of spherical flipping
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//incremental convex hull
+#include "QuickHull.h"
+//batched visibility
+#include "ThreadPool.h"
+
 ///************************************************************************///
 // a class to implement the GHPR algorithm
 // GHPR - Generalized Hidden Point Removal operator
@@ -26,12 +40,60 @@
 // - add the implementation of the HPR algorithm
 //Version 1.1 2018.12.18
 // - add the implementation of the GHPR algorithm
+//Version 1.2
+// - add the incremental visibility engine, which keeps the flipped points and hull between calls
+// - the hull vertex indices are given by QuickHull directly, qhull is only a fallback
+// - add the batched visibility of multiple viewpoints, each viewpoint keeps its own hull
+// - the spherical flipping is done on structure of arrays with simd
 
 ///************************************************************************///
 
 namespace topology_map {
 
 
+//the flipped points in structure of arrays
+struct FlipBuffer{
+
+	std::vector<float> vX;
+	std::vector<float> vY;
+	std::vector<float> vZ;
+
+	//the capacity is kept between calls
+	void Resize(const int & iPointNum){
+
+		vX.resize(iPointNum);
+		vY.resize(iPointNum);
+		vZ.resize(iPointNum);
+
+	};
+
+};
+
+//the cached data of incremental visibility engine (one viewpoint)
+struct HullCache{
+
+	//the hull of flipped points, the viewpoint (origin) is one of its points
+	QuickHull oHull;
+	//the viewpoint of cached hull
+	pcl::PointXYZ oView;
+	//gamma of cached hull, new points farther than it need a rebuild
+	float fGamma;
+	//raw point of each hull point
+	std::vector<pcl::PointXYZ> vPoints;
+	//point key to hull point index
+	std::unordered_map<long long, int> mKeyToHullIdx;
+	//the flipping buffer of rebuilding
+	FlipBuffer oFlipBuffer;
+
+	HullCache(){
+
+		fGamma = 0.0;
+
+	};
+
+};
+
+
 class GHPR{
 
 public:
@@ -50,22 +112,105 @@ public:
 	inline float LinearKernel(const float & fGamma, 
 		                      const float & fPointNorm);
 
+	//shift the viewpoint to the origin, return the maximum square norm
+	float ShiftToView(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                  const pcl::PointXYZ & oViewPoint,
+	                  FlipBuffer & oBuffer);
+
+	//flip the shifted points (simd)
+	void FlipKernel(FlipBuffer & oBuffer,
+	                const float & fGamma);
+
+	//spherical flipping of the point clouds
+	void SphericalFlip(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                   const pcl::PointXYZ & oViewPoint,
+	                   FlipBuffer & oBuffer);
+	//output with the viewpoint added at the end
+	void SphericalFlip(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                   const pcl::PointXYZ & oViewPoint,
+	                   FlipBuffer & oBuffer,
+	                   pcl::PointCloud<pcl::PointXYZ> & vFlipCloud);
+
 	//compute the visiable point cloud set based on the input viewpoint
 	std::vector<bool> ComputeVisibility(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
 		                                            const pcl::PointXYZ & oViewPoint);
 
+	//compute the visiable point cloud set using pcl::ConvexHull (qhull)
+	std::vector<bool> ComputeVisibilityQhull(const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+		                                                const pcl::PointXYZ & oViewPoint,
+		                                                      bool bKdTreeFlag = false);
+
 	//find the indices of convex hull
+	void FindVisibleIndices(std::vector<bool> & vVisibleRes,
+		                    const QuickHull & oConvexHull);
+	//find the indices of convex hull by kdtree (pcl older than 1.8.0)
 	void FindVisibleIndices(std::vector<bool> & vVisibleRes,
 		                    const pcl::PointCloud<pcl::PointXYZ>::Ptr & pTransforCloud,
 		                    const pcl::PointCloud<pcl::PointXYZ>::Ptr & pHullCloud);
 
+	//***incremental visibility engine***
+	//set the reuse conditions of the cached hull
+	void SetIncrementalParams(float f_fViewTolerance,
+	                          float f_fGammaMargin = 0.1);
+
+	//compute the visibility and reuse the hull of last call if possible
+	bool UpdateVisibility(std::vector<bool> & vVisibleRes,
+	                      const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                      const std::vector<long long> & vPointKeys,
+	                      const pcl::PointXYZ & oViewPoint);
+
+	//compute the visibility from each viewpoint in parallel, the hull of each viewpoint is reused if possible
+	int UpdateVisibilityBatch(std::vector<std::vector<bool> > & vVisibleRes,
+	                          const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                          const std::vector<long long> & vPointKeys,
+	                          const std::vector<pcl::PointXYZ> & vViewPoints,
+	                          ThreadPool & oThreadPool);
+
+	//drop the cached hull (e.g., the point keys are no longer valid)
+	void ResetIncremental();
+
 private:
 
+	//clear a cached hull
+	void ResetCache(HullCache & oCache);
+
+	//spherically flip a point and add it to the cached hull
+	inline int AddFlippedPoint(HullCache & oCache,
+	                           const pcl::PointXYZ & oPoint);
+
+	//rebuild the cached hull from scratch
+	bool RebuildIncremental(HullCache & oCache,
+	                        const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                        const std::vector<long long> & vPointKeys,
+	                        const pcl::PointXYZ & oViewPoint);
+
+	//compute the visibility with a cached hull
+	bool UpdateCachedVisibility(HullCache & oCache,
+	                            std::vector<bool> & vVisibleRes,
+	                            const pcl::PointCloud<pcl::PointXYZ> & vCloud,
+	                            const std::vector<long long> & vPointKeys,
+	                            const pcl::PointXYZ & oViewPoint);
+
 	//m_fParam >= 1.0, in practice, it will be very large
     //param designed in HPR algorithm, which is published in below 
 	//Katz S , Tal A , Basri R . Direct visibility of point sets[J]. ACM Transactions on Graphics, 2007, 26(3):24.
 	float m_fParam;///<make the gamma is larger than the maximum distance of point set to viewpoint
 
+	//***buffers of ComputeVisibility, kept to avoid reallocation***
+	FlipBuffer m_oFlipBuffer;
+	QuickHull m_oFlipHull;
+
+	//***incremental visibility engine data***
+	//the cached hull of UpdateVisibility
+	HullCache m_oCache;
+	//the cached hulls of UpdateVisibilityBatch, one for each viewpoint
+	std::vector<HullCache> m_vViewCaches;
+
+	//the viewpoint/point shift that is still regarded as the same
+	float m_fViewTolerance;
+	//gamma is enlarged by this rate so that later points can be inserted
+	float m_fGammaMargin;
+
 };
 
 
@@ -88,4 +233,15 @@ private:
 //for (int i = 0; i != vVisableIdx.size(); ++i) {
 //	//label visiable result
 //	vLabel[vVisableIdx[i]] = 1;
-//}//end for i
\ No newline at end of file
+//}//end for i
+//
+////incremental usage, a key is a stable id of each point (e.g., its index in the whole map)
+////the hull is reused if the viewpoint is not moved and only new points are appended
+//oGHPRer.SetIncrementalParams(0.05);
+//std::vector<bool> vVisableRes;
+//oGHPRer.UpdateVisibility(vVisableRes, *pCloud, vPointKeys, oViewPoint);
+//
+////batched usage, the visibility from each viewpoint is computed in parallel
+//ThreadPool oThreadPool(4);
+//std::vector<std::vector<bool> > vBatchRes;
+//oGHPRer.UpdateVisibilityBatch(vBatchRes, *pCloud, vPointKeys, vViewPoints, oThreadPool);
\ No newline at end of file
@@ -294,127 +294,55 @@ float HausdorffDimension::BoxCounting(const pcl::PointCloud<pcl::PointXYZ> & vCl
 		return fDimensionRes;
     
 	//*****************major part******************
+	//the depth is limited by the bits of morton key
+	if(m_iIterMax > 21)
+		m_iIterMax = 21;
+	if(m_iIterMax < 0)
+		m_iIterMax = 0;
+
 	float boxsize = m_fBoundBoxLen / pow(2.0f,float(m_iIterMax));
-	float boxnumber = 0;
 	
-	//The total number of boxes, in fact, the number of boxes is equal to the resolution
+	//The total number of boxes at each axis, in fact, the number of boxes is equal to the resolution
     int xnumber = (int)(pow(2.0f,float(m_iIterMax)));
-	//save boxes
-	std::vector<std::vector<std::vector<int>>> downbox;//root box
-	std::vector<std::vector<std::vector<int>>> upbox;//
-
-	for(int i = 0; i != xnumber; ++i){
 
-		std::vector<std::vector<int>> boxy;
-		for(int j = 0; j != xnumber; ++j){
-			//initial as zero
-			std::vector<int> boxz(xnumber,0);
-			boxy.push_back(boxz);
-		}
-		downbox.push_back(boxy);
-	} 
-
-	//the number of non-empty boxes
-	int xvalue,yvalue,zvalue;
+	//encode the box of each point as a morton key
+	//a box at a coarser scale is the key shifted by 3 bits, which is like reverse octree
+	m_vBoxKeys.resize(vCloud.size());
 	for(int i = 0; i != vCloud.size(); ++i){
 
-		xvalue = floor((vCloud[i].x - m_oMinCoor.x) / boxsize);
-		yvalue = floor((vCloud[i].y - m_oMinCoor.y) / boxsize);
-		zvalue = floor((vCloud[i].z - m_oMinCoor.z) / boxsize);
-		downbox[xvalue][yvalue][zvalue]++;
-
-	}
+		int xvalue = floor((vCloud[i].x - m_oMinCoor.x) / boxsize);
+		int yvalue = floor((vCloud[i].y - m_oMinCoor.y) / boxsize);
+		int zvalue = floor((vCloud[i].z - m_oMinCoor.z) / boxsize);
+		
+		//defend the precision problem at the border
+		xvalue = std::min(std::max(xvalue, 0), xnumber - 1);
+		yvalue = std::min(std::max(yvalue, 0), xnumber - 1);
+		zvalue = std::min(std::max(zvalue, 0), xnumber - 1);
 
-	//using generalized dimension pi^q
-	for(int i = 0; i != xnumber; ++i){
-		for(int j = 0; j != xnumber; ++j){
-			for(int k = 0; k != xnumber; ++k){
+		m_vBoxKeys[i] = MortonKey(xvalue, yvalue, zvalue);
 
-				if(downbox[i][j][k])
-					boxnumber=boxnumber + pow(float(downbox[i][j][k]),m_fParaQ);
-			}
-		}
 	}
 
-	//store the first pair of results, followers are stored in a loop
-	HitsInScale oFirstScaleRes;
-	oFirstScaleRes.boxNum = log(float(boxnumber));
-	oFirstScaleRes.boxScale = log(boxsize);
-	vSpectrum.push_back(oFirstScaleRes);
-	
-	//current iterion time
-	int iters = m_iIterMax - 1;
+	//the points in the same box are neighboring after sorting, at any scale
+	SortBoxKeys(3 * m_iIterMax);
 
-	//counting boxes at different scale using a loop 
+	//counting boxes from the smallest scale to the largest one
 	//the smaller the scale be used, the smaller the box becames
 	//it does not make scene when the measuring scale is larger than the length of bounding box
-	while(iters - m_iIterMin + 1 > 0){
-		
-		boxnumber = 0;
-		boxsize = boxsize * 2.0;
-		// use a structure similiar to octree so that calculations can be reduced
-		// set the size of the new upbox
-		upbox.clear();
-		int ocnumber = (int)(pow(2.0f,float(iters)));
-		
-		//
-		if(ocnumber < 1)
-			ocnumber = 1;
-		
-		//Traversing 
-		for(int i = 0;i != ocnumber; ++i){
-			
-			std::vector<std::vector<int>> boxy;
-			//initial as zero
-			for(int j = 0;j != ocnumber; ++j){
-				std::vector<int> boxz(ocnumber,0);
-				boxy.push_back(boxz);
-			}
-			
-			upbox.push_back(boxy);
-		} 
-		
-		//Traversing 
-		//compare the position of the lower level and assign result to the superior level
-		for(int i = 0;i != downbox.size(); ++i){
-			
-			for(int j = 0;j != downbox.size(); ++j){
-				
-				for(int k = 0; k != downbox.size(); ++k){
-
-					if(downbox[i][j][k])
-						//merge low level boxes and accumulate non-empty quantity
-						upbox[floor(float(i)/2)][floor(float(j)/2)][floor(float(k)/2)]
-					     = upbox[floor(float(i)/2)][floor(float(j)/2)][floor(float(k)/2)] + downbox[i][j][k];
-				}//end k
-			}//end j
-		}//end i
-		
-		//counting
-		for(int i = 0;i != upbox.size(); ++i){
-			
-			for(int j = 0;j != upbox.size(); ++j){
-				
-				for(int k = 0;k != upbox.size(); ++k){
-					
-					if(upbox[i][j][k])
-						boxnumber = boxnumber + pow(float(upbox[i][j][k]),m_fParaQ);
-				}
-			}
-		}
-		
+	for(int iters = m_iIterMax; iters == m_iIterMax || iters - m_iIterMin + 1 > 0; --iters){
+
+		//merge the boxes into the superior level (the first one merges the points into the smallest boxes)
+		//using generalized dimension pi^q
+		float boxnumber = MergeBoxes(iters != m_iIterMax);
+
 		//get the log value
 		HitsInScale oScaleRes;
 		oScaleRes.boxNum = log(float(boxnumber));
 		oScaleRes.boxScale = log(boxsize);
-	
 		vSpectrum.push_back(oScaleRes);
-		
-		//Turn the subordinate boxes into the current boxes
-		downbox.clear();
-		downbox=upbox;
 
-		iters--;
+		boxsize = boxsize * 2.0;
+
 	}
 
     //fitting by using the least squares
@@ -427,6 +355,158 @@ float HausdorffDimension::BoxCounting(const pcl::PointCloud<pcl::PointXYZ> & vCl
 
 }
 
+/*************************************************
+Function: MortonKey
+Description: encode the box index as a morton (z-order) key
+Calls: nothing
+Called By: BoxCounting
+Table Accessed: none
+Table Updated: none
+Input: iX, iY, iZ - the box index at each axis (21 bits at most)
+Output: none
+Return: the morton key, whose bits are ...z1y1x1z0y0x0
+Others: the key of parent box is the key shifted by 3 bits
+*************************************************/
+inline unsigned long long HausdorffDimension::MortonKey(const int & iX,
+	                                                    const int & iY,
+	                                                    const int & iZ){
+
+	return SpreadBits(iX) | (SpreadBits(iY) << 1) | (SpreadBits(iZ) << 2);
+
+}
+
+/*************************************************
+Function: SpreadBits
+Description: insert two zero bits between each bit of a value
+Calls: nothing
+Called By: MortonKey
+Table Accessed: none
+Table Updated: none
+Input: iValue - a value of 21 bits at most
+Output: none
+Return: the spread value
+Others: none
+*************************************************/
+inline unsigned long long HausdorffDimension::SpreadBits(const int & iValue){
+
+	unsigned long long iBits = (unsigned long long)(iValue) & 0x1fffffULL;
+	iBits = (iBits | (iBits << 32)) & 0x1f00000000ffffULL;
+	iBits = (iBits | (iBits << 16)) & 0x1f0000ff0000ffULL;
+	iBits = (iBits | (iBits << 8)) & 0x100f00f00f00f00fULL;
+	iBits = (iBits | (iBits << 4)) & 0x10c30c30c30c30c3ULL;
+	iBits = (iBits | (iBits << 2)) & 0x1249249249249249ULL;
+	return iBits;
+
+}
+
+/*************************************************
+Function: SortBoxKeys
+Description: sort the morton keys by the radix sorting
+Calls: nothing
+Called By: BoxCounting
+Table Accessed: none
+Table Updated: none
+Input: iKeyBits - the number of used bits of keys
+Output: m_vBoxKeys - sorted keys
+Return: none
+Others: only a few passes are needed since the key has 3 * m_iIterMax bits
+*************************************************/
+void HausdorffDimension::SortBoxKeys(const int & iKeyBits){
+
+	//11 bits each pass
+	const int iDigitBits = 11;
+	const int iBucketNum = 1 << iDigitBits;
+
+	m_vSortBuffer.resize(m_vBoxKeys.size());
+	std::vector<int> vBucketCounts(iBucketNum);
+
+	for(int iShift = 0; iShift < iKeyBits; iShift += iDigitBits){
+
+		//count each digit
+		std::fill(vBucketCounts.begin(), vBucketCounts.end(), 0);
+		for(size_t i = 0; i != m_vBoxKeys.size(); ++i)
+			vBucketCounts[(m_vBoxKeys[i] >> iShift) & (iBucketNum - 1)]++;
+
+		//the beginning of each bucket
+		int iOffset = 0;
+		for(int j = 0; j != iBucketNum; ++j){
+			int iCount = vBucketCounts[j];
+			vBucketCounts[j] = iOffset;
+			iOffset += iCount;
+		}
+
+		//stable distribution
+		for(size_t i = 0; i != m_vBoxKeys.size(); ++i)
+			m_vSortBuffer[vBucketCounts[(m_vBoxKeys[i] >> iShift) & (iBucketNum - 1)]++] = m_vBoxKeys[i];
+
+		m_vBoxKeys.swap(m_vSortBuffer);
+
+	}//end for iShift
+
+}
+
+/*************************************************
+Function: MergeBoxes
+Description: merge the sorted boxes into the superior level and count the non-empty boxes
+Calls: nothing
+Called By: BoxCounting
+Table Accessed: none
+Table Updated: none
+Input: bParentFlag - true to merge 8 boxes into their parent,
+                     false to merge the points into the smallest boxes 
+Output: m_vBoxKeys - the key of each non-empty box (sorted)
+        m_vBoxHits - the point number of each non-empty box
+Return: the sum of pi^q of all non-empty boxes, where pi is the point number in a box
+Others: q = 0 is the number of non-empty boxes, q = 2 is the sum of squares,
+        the number of boxes is smaller and smaller after each merging
+*************************************************/
+float HausdorffDimension::MergeBoxes(bool bParentFlag){
+
+	float boxnumber = 0;
+
+	//each point is a box with one hit before the first merging
+	if(!bParentFlag)
+		m_vBoxHits.assign(m_vBoxKeys.size(), 1);
+
+	int iShiftBits = bParentFlag ? 3 : 0;
+
+	size_t iBoxNum = 0;
+	size_t iBegin = 0;
+	while(iBegin != m_vBoxKeys.size()){
+
+		//find the boxes inside the same superior box
+		unsigned long long iBoxKey = m_vBoxKeys[iBegin] >> iShiftBits;
+		int iPointNum = m_vBoxHits[iBegin];
+		size_t iEnd = iBegin + 1;
+		while(iEnd != m_vBoxKeys.size() && (m_vBoxKeys[iEnd] >> iShiftBits) == iBoxKey){
+			iPointNum += m_vBoxHits[iEnd];
+			iEnd++;
+		}
+
+		//save in place
+		m_vBoxKeys[iBoxNum] = iBoxKey;
+		m_vBoxHits[iBoxNum] = iPointNum;
+		iBoxNum++;
+
+		float fPointNum = float(iPointNum);
+		if(m_fParaQ == 0)
+			boxnumber = boxnumber + 1.0f;
+		else if(m_fParaQ == 2)
+			boxnumber = boxnumber + fPointNum * fPointNum;
+		else
+			boxnumber = boxnumber + pow(fPointNum, m_fParaQ);
+
+		iBegin = iEnd;
+
+	}
+
+	m_vBoxKeys.resize(iBoxNum);
+	m_vBoxHits.resize(iBoxNum);
+
+	return boxnumber;
+
+}
+
 /*************************************************
 Function: LinearFitting
 Description: Linear fitting of two-dimensional lines
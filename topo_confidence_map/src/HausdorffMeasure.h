@@ -5,6 +5,10 @@
 
 #include <cfloat>
 
+#include <vector>
+
+#include <algorithm>
+
 #include <pcl/point_types.h>
 
 #include <pcl/point_cloud.h>
@@ -39,6 +43,8 @@ struct HitsInScale{
 // - modified functions and remove something others
 //Version 1.1 2019.1.1
 // - add the notes
+//Version 1.2
+// - box counting uses the sorted morton keys of points instead of dense 3D boxes
 
 ///************************************************************************///
 
@@ -124,6 +130,20 @@ public:
 	float BoxCounting(const pcl::PointCloud<pcl::PointXYZ> & vCloud);
 
 private:
+
+	//encode the box index as a morton key
+	inline unsigned long long MortonKey(const int & iX,
+	                                    const int & iY,
+	                                    const int & iZ);
+
+	//insert two zero bits between each bit
+	inline unsigned long long SpreadBits(const int & iValue);
+
+	//sort the morton keys
+	void SortBoxKeys(const int & iKeyBits);
+
+	//merge the boxes into the superior level and count them
+	float MergeBoxes(bool bParentFlag);
 	
 	//The first and last iteration times 
 	int m_iIterMax;//
@@ -154,6 +174,14 @@ private:
 	float m_fMinDis;
 	bool m_bMinDisFlag;
 
+	//sorted morton key of each non-empty box (at the current scale)
+	//they are kept between calls to avoid reallocation
+	std::vector<unsigned long long> m_vBoxKeys;
+	//the point number of each non-empty box
+	std::vector<int> m_vBoxHits;
+	//buffer of sorting
+	std::vector<unsigned long long> m_vSortBuffer;
+
 };
 
 
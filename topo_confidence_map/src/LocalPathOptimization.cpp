@@ -76,7 +76,7 @@ bool PathOptimization::NewLocalPath(pcl::PointCloud<pcl::PointXYZ> & vNewAncherC
 		                            const std::vector<float> & vQualityFeature,
 		                            const pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud, 
 	                                const ExtendedGM & oExtendGridMap,
-	                                const std::vector<ConfidenceValue> & vConfidenceMap,
+	                                const ConfidenceMap & vConfidenceMap,
 		                            float fMoveDis,
 		                            int iAnchorNum){
 
@@ -49,7 +49,7 @@ public:
 		              const std::vector<float> & vQualityFeature,
 		              const pcl::PointCloud<pcl::PointXYZ>::Ptr & pAstarCloud, 
 	                  const ExtendedGM & oExtendGridMap,
-	                  const std::vector<ConfidenceValue> & vConfidenceMap,
+	                  const ConfidenceMap & vConfidenceMap,
 		              float fMoveDis = 1.5,
 		              int iAnchorNum = 1);
 
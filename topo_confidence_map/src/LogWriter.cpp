@@ -0,0 +1,344 @@
+#include "LogWriter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+namespace topology_map {
+
+/*************************************************
+Function: LogWriter
+Description: constrcution function for LogWriter class
+Calls: WriterLoop
+Called By: TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: f_iChannelNum - the number of log files
+       f_iQueueSize - the queue size of each channel (records)
+       f_iBufferSize - the bytes written to file at once
+Output: none
+Return: none
+Others: the writer thread is started here
+*************************************************/
+LogWriter::LogWriter(int f_iChannelNum,
+	                 int f_iQueueSize,
+	                 int f_iBufferSize):m_iBufferSize(f_iBufferSize > 0 ? f_iBufferSize : 1 << 20),
+	                                    m_iDroppedNum(0),
+	                                    m_bStopFlag(false){
+
+	for (int i = 0; i < f_iChannelNum; ++i)
+		m_vChannels.push_back(std::unique_ptr<LogChannel>(new LogChannel(f_iQueueSize)));
+
+	m_oWriter = std::thread(&LogWriter::WriterLoop, this);
+
+}
+
+/*************************************************
+Function: ~LogWriter
+Description: destrcution function for LogWriter class
+Calls: none
+Called By: ~TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the producers should be stopped before, then all queued records are written
+*************************************************/
+LogWriter::~LogWriter(){
+
+	m_bStopFlag = true;
+	m_oWakeCond.notify_all();
+
+	if (m_oWriter.joinable())
+		m_oWriter.join();
+
+}
+
+/*************************************************
+Function: Open
+Description: open (create or append) the file of a channel
+Calls: Push
+Called By: TopologyMap::OutputTrajectoryFile
+           TopologyMap::OutputScannedPCFile
+           TopologyMap::OutputCoverRateFile
+           TopologyMap::PlanNextGoal
+Table Accessed: none
+Table Updated: none
+Input: iChannel - the channel
+       sFileName - the file name
+       bBinaryFlag - write the point clouds in binary records
+Output: none
+Return: false if the queue is full
+Others: the file is opened by the writer thread, the former file of channel is closed
+*************************************************/
+bool LogWriter::Open(const int & iChannel,
+	                 const std::string & sFileName,
+	                 const bool & bBinaryFlag){
+
+	LogRecord oRecord;
+	oRecord.iType = 0;
+	oRecord.sData = sFileName;
+	oRecord.bBinaryFlag = bBinaryFlag;
+
+	return Push(iChannel, oRecord);
+
+}
+
+/*************************************************
+Function: WriteText
+Description: append a text to the file of a channel
+Calls: Push
+Called By: TopologyMap::OutputTrajectoryFile
+           TopologyMap::OutputCoverRateFile
+           TopologyMap::PlanNextGoal
+Table Accessed: none
+Table Updated: none
+Input: iChannel - the channel
+       sText - the text with its line end
+Output: none
+Return: false if the queue is full
+Others: none
+*************************************************/
+bool LogWriter::WriteText(const int & iChannel,
+	                      const std::string & sText){
+
+	LogRecord oRecord;
+	oRecord.iType = 1;
+	oRecord.sData = sText;
+
+	return Push(iChannel, oRecord);
+
+}
+
+/*************************************************
+Function: WriteCloud
+Description: append a point cloud to the file of a channel
+Calls: Push
+Called By: TopologyMap::OutputScannedPCFile
+Table Accessed: none
+Table Updated: none
+Input: iChannel - the channel
+       pCloud - the point cloud, it should not be changed after this call
+       iFrame - the frame number written with each point
+Output: none
+Return: false if the queue is full
+Others: only the pointer is queued, the points are formatted in the writer thread
+*************************************************/
+bool LogWriter::WriteCloud(const int & iChannel,
+	                       const pcl::PointCloud<pcl::PointXYZ>::ConstPtr & pCloud,
+	                       const int & iFrame){
+
+	LogRecord oRecord;
+	oRecord.iType = 2;
+	oRecord.pCloud = pCloud;
+	oRecord.iFrame = iFrame;
+
+	return Push(iChannel, oRecord);
+
+}
+
+/*************************************************
+Function: Push
+Description: push a record into the queue of a channel
+Calls: SpscQueue::Push
+Called By: Open
+           WriteText
+           WriteCloud
+Table Accessed: none
+Table Updated: none
+Input: iChannel - the channel
+       oRecord - the record
+Output: none
+Return: false if the channel is invalid or its queue is full
+Others: it never waits, the dropped records are counted
+*************************************************/
+bool LogWriter::Push(const int & iChannel,
+	                 const LogRecord & oRecord){
+
+	if (iChannel < 0 || iChannel >= int(m_vChannels.size()))
+		return false;
+
+	if (!m_vChannels[iChannel]->vQueue.Push(oRecord)){
+		m_iDroppedNum++;
+		return false;
+	}
+
+	return true;
+
+}
+
+/*************************************************
+Function: WriterLoop
+Description: the loop of writer thread
+Calls: AppendRecord
+       FlushChannel
+Called By: LogWriter
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the log files
+Return: none
+Others: a buffer is written once it is larger than m_iBufferSize,
+        or at most 1 s after its first byte if the queues are idle,
+        the thread sleeps at most 20 ms if all queues are empty
+*************************************************/
+void LogWriter::WriterLoop(){
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point oLastFlush = Clock::now();
+
+	while (true){
+
+		//read it before the queues, so the records pushed before stop are all written
+		bool bStopFlag = m_bStopFlag;
+		bool bWorkFlag = false;
+
+		for (int i = 0; i != int(m_vChannels.size()); ++i){
+
+			LogChannel & oChannel = *m_vChannels[i];
+			LogRecord oRecord;
+
+			while (oChannel.vQueue.Pop(oRecord)){
+				AppendRecord(oChannel, oRecord);
+				bWorkFlag = true;
+				if (oChannel.sBuffer.size() >= m_iBufferSize)
+					FlushChannel(oChannel);
+			}
+
+		}//end for i
+
+		if (bStopFlag && !bWorkFlag)
+			break;
+
+		if (bWorkFlag)
+			continue;
+
+		//idle, write what is waiting
+		if (Clock::now() - oLastFlush >= std::chrono::seconds(1)){
+			for (int i = 0; i != int(m_vChannels.size()); ++i)
+				FlushChannel(*m_vChannels[i]);
+			oLastFlush = Clock::now();
+		}
+
+		std::unique_lock<std::mutex> oWakeLock(m_oWakeMutex);
+		if (!m_bStopFlag)
+			m_oWakeCond.wait_for(oWakeLock, std::chrono::milliseconds(20));
+
+	}//end while
+
+	for (int i = 0; i != int(m_vChannels.size()); ++i){
+		FlushChannel(*m_vChannels[i]);
+		if (m_vChannels[i]->oFile.is_open())
+			m_vChannels[i]->oFile.close();
+	}
+
+}
+
+/*************************************************
+Function: AppendRecord
+Description: format a record into the buffer of its channel
+Calls: FlushChannel
+Called By: WriterLoop
+Table Accessed: none
+Table Updated: none
+Input: oRecord - the record
+Output: oChannel - the buffer or the file of channel
+Return: none
+Others: the text of a point is the same as the ostream output (x y z frame),
+        since the default ostream format of a float is %g
+*************************************************/
+void LogWriter::AppendRecord(LogChannel & oChannel,
+	                         const LogRecord & oRecord){
+
+	//open a file
+	if (oRecord.iType == 0){
+
+		FlushChannel(oChannel);
+		if (oChannel.oFile.is_open())
+			oChannel.oFile.close();
+
+		oChannel.oFile.open(oRecord.sData.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+		oChannel.bBinaryFlag = oRecord.bBinaryFlag;
+		return;
+
+	}
+
+	//a text
+	if (oRecord.iType == 1){
+		oChannel.sBuffer += oRecord.sData;
+		return;
+	}
+
+	//a point cloud
+	if (!oRecord.pCloud)
+		return;
+
+	const pcl::PointCloud<pcl::PointXYZ> & vCloud = *oRecord.pCloud;
+	int iPointNum = int(vCloud.points.size());
+
+	if (oChannel.bBinaryFlag){
+
+		size_t iOffset = oChannel.sBuffer.size();
+		oChannel.sBuffer.resize(iOffset + 2 * sizeof(int) + size_t(iPointNum) * 3 * sizeof(float));
+		char * pData = &oChannel.sBuffer[iOffset];
+
+		memcpy(pData, &oRecord.iFrame, sizeof(int));
+		memcpy(pData + sizeof(int), &iPointNum, sizeof(int));
+		pData += 2 * sizeof(int);
+
+		for (int i = 0; i != iPointNum; ++i){
+			memcpy(pData, &vCloud.points[i].x, sizeof(float));
+			memcpy(pData + sizeof(float), &vCloud.points[i].y, sizeof(float));
+			memcpy(pData + 2 * sizeof(float), &vCloud.points[i].z, sizeof(float));
+			pData += 3 * sizeof(float);
+		}
+
+	}else{
+
+		char vLine[128];
+		for (int i = 0; i != iPointNum; ++i){
+
+			int iLength = snprintf(vLine, sizeof(vLine), "%g %g %g %d \n",
+			                       vCloud.points[i].x, vCloud.points[i].y, vCloud.points[i].z, oRecord.iFrame);
+			if (iLength > 0)
+				oChannel.sBuffer.append(vLine, std::min(iLength, int(sizeof(vLine)) - 1));
+
+			if (oChannel.sBuffer.size() >= m_iBufferSize)
+				FlushChannel(oChannel);
+
+		}//end for i
+
+	}//end else
+
+}
+
+/*************************************************
+Function: FlushChannel
+Description: write the buffer of a channel into file
+Calls: none
+Called By: WriterLoop
+           AppendRecord
+Table Accessed: none
+Table Updated: none
+Input: oChannel - the channel
+Output: the file of channel
+Return: none
+Others: the buffer is dropped if the file is not opened
+*************************************************/
+void LogWriter::FlushChannel(LogChannel & oChannel){
+
+	if (oChannel.sBuffer.empty())
+		return;
+
+	if (oChannel.oFile.is_open()){
+		oChannel.oFile.write(oChannel.sBuffer.data(), oChannel.sBuffer.size());
+		oChannel.oFile.flush();
+	}
+
+	oChannel.sBuffer.clear();
+
+}
+
+}/*namespace*/
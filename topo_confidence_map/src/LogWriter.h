@@ -0,0 +1,151 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <condition_variable>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include "SpscQueue.h"
+
+///************************************************************************///
+// a class to implement the asynchronous writer of log files
+// each log file is a channel with a lock-free queue (one producer thread for each channel),
+// a writer thread formats the records into a large buffer and writes it to file in blocks,
+// so that the threads of map and planning never open, format or flush a file
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the channels of trajectory, node, coverage and scanned point cloud logs
+// - a point cloud is queued by its shared pointer and formatted in the writer thread
+// - a channel can write the point clouds in binary records,
+//   each record is (int frame, int point number, point number x (float x, float y, float z))
+
+///************************************************************************///
+
+namespace topology_map {
+
+//a record in the queue of a channel
+struct LogRecord{
+
+	//0 opens the file named sData, 1 appends the text sData, 2 appends the point cloud pCloud
+	int iType;
+
+	//file name or text
+	std::string sData;
+
+	//write the point clouds in binary (open record)
+	bool bBinaryFlag;
+
+	//the point cloud and its frame number
+	pcl::PointCloud<pcl::PointXYZ>::ConstPtr pCloud;
+	int iFrame;
+
+	LogRecord():iType(1), bBinaryFlag(false), iFrame(0){};
+
+};
+
+class LogWriter{
+
+public:
+
+	//constructor, the channel number is fixed since the writer thread reads all queues
+	LogWriter(int f_iChannelNum,
+	          int f_iQueueSize = 1024,
+	          int f_iBufferSize = 1 << 20);
+
+	//destructor, all queued records are written before return
+	~LogWriter();
+
+	//open (create or append) the file of a channel
+	bool Open(const int & iChannel,
+	          const std::string & sFileName,
+	          const bool & bBinaryFlag = false);
+
+	//append a text to the file of a channel, it is written as it is (with its line end)
+	bool WriteText(const int & iChannel,
+	               const std::string & sText);
+
+	//append a point cloud, the text format is a line (x y z frame) of each point
+	bool WriteCloud(const int & iChannel,
+	                const pcl::PointCloud<pcl::PointXYZ>::ConstPtr & pCloud,
+	                const int & iFrame);
+
+	//the number of records dropped since a queue is full
+	inline unsigned int DroppedNum() const{
+
+		return m_iDroppedNum.load();
+
+	};
+
+private:
+
+	//forbid the copy
+	LogWriter(const LogWriter &);
+	LogWriter & operator = (const LogWriter &);
+
+	//a log file
+	struct LogChannel{
+
+		//the records from producer
+		SpscQueue<LogRecord> vQueue;
+
+		//the file and its state
+		std::ofstream oFile;
+		bool bBinaryFlag;
+
+		//the bytes waiting to be written
+		std::string sBuffer;
+
+		LogChannel(int iQueueSize):vQueue(iQueueSize), bBinaryFlag(false){};
+
+	};
+
+	//push a record into the queue of a channel
+	bool Push(const int & iChannel,
+	          const LogRecord & oRecord);
+
+	//the loop of writer thread
+	void WriterLoop();
+
+	//format a record into the buffer of its channel
+	void AppendRecord(LogChannel & oChannel,
+	                  const LogRecord & oRecord);
+
+	//write the buffer of a channel into file
+	void FlushChannel(LogChannel & oChannel);
+
+	//the channels
+	std::vector<std::unique_ptr<LogChannel> > m_vChannels;
+
+	//the buffer size written at once
+	size_t m_iBufferSize;
+
+	//the records dropped since a queue is full
+	std::atomic<unsigned int> m_iDroppedNum;
+
+	//the writer thread, the condition variable only wakes it up earlier than the polling timeout
+	std::thread m_oWriter;
+	std::atomic<bool> m_bStopFlag;
+	std::mutex m_oWakeMutex;
+	std::condition_variable m_oWakeCond;
+
+};
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//LogWriter oLogWriter(2);
+////in the producer thread of channel 0
+//oLogWriter.Open(0, "Traj.txt");
+//oLogWriter.WriteText(0, "1.0 2.0 0.0 100.5 \n");
+////in the producer thread of channel 1
+//oLogWriter.Open(1, "PC.bin", true);
+//oLogWriter.WriteCloud(1, pCloud, iFrame);
@@ -0,0 +1,772 @@
+#include "MapCheckpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <ros/ros.h>
+
+namespace topology_map {
+
+//the marks at the head and the end of a checkpoint file
+static const char CHECKPOINT_HEAD[8] = {'T', 'O', 'P', 'O', 'C', 'K', 'P', '\0'};
+static const char CHECKPOINT_END[8] = {'T', 'O', 'P', 'O', 'E', 'N', 'D', '\0'};
+
+//the version of file format, it is increased once the format is changed
+static const int CHECKPOINT_VERSION = 1;
+
+//a read only stream buffer on the mapped file
+struct MappedBuffer : public std::streambuf{
+
+	MappedBuffer(char * pBegin, const size_t & iSize){
+
+		setg(pBegin, pBegin, pBegin + iSize);
+
+	};
+
+};
+
+//write and read a value in binary
+template <class ValueT>
+static inline void WriteValue(std::ostream & oStream, const ValueT & oValue){
+
+	oStream.write(reinterpret_cast<const char *>(&oValue), sizeof(ValueT));
+
+}
+
+template <class ValueT>
+static inline bool ReadValue(std::istream & oStream, ValueT & oValue){
+
+	return bool(oStream.read(reinterpret_cast<char *>(&oValue), sizeof(ValueT)));
+
+}
+
+//whether n elements of a size are left in the stream, so that a broken count never allocates too much
+static inline bool CheckLeftBytes(std::istream & oStream, const int & iNum, const size_t & iSize){
+
+	return iNum >= 0 && double(iNum) * double(iSize) <= double(oStream.rdbuf()->in_avail());
+
+}
+
+/*************************************************
+Function: MapCheckpoint
+Description: constrcution function for MapCheckpoint class
+Calls: none
+Called By: TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the writer thread is started by the first SaveAsync
+*************************************************/
+MapCheckpoint::MapCheckpoint():m_bWritingFlag(false),
+                               m_bStopFlag(false){
+
+}
+
+/*************************************************
+Function: ~MapCheckpoint
+Description: destrcution function for MapCheckpoint class
+Calls: none
+Called By: ~TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the waiting checkpoint is written before the writer thread exits
+*************************************************/
+MapCheckpoint::~MapCheckpoint(){
+
+	{
+		std::lock_guard<std::mutex> oLock(m_oMutex);
+		m_bStopFlag = true;
+	}
+	m_oCond.notify_all();
+
+	if (m_oWriter.joinable())
+		m_oWriter.join();
+
+}
+
+/*************************************************
+Function: SaveAsync
+Description: write a checkpoint in background
+Calls: WriterLoop
+Called By: TopologyMap::SaveCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: sFileName - the checkpoint file
+       pData - the snapshot, which is not changed after this call
+Output: none
+Return: none
+Others: only the latest snapshot is kept if the writer is busy
+*************************************************/
+void MapCheckpoint::SaveAsync(const std::string & sFileName,
+	                          const std::shared_ptr<const CheckpointData> & pData){
+
+	{
+		std::lock_guard<std::mutex> oLock(m_oMutex);
+		if (m_bStopFlag)
+			return;
+
+		m_sPendingName = sFileName;
+		m_pPending = pData;
+
+		if (!m_oWriter.joinable())
+			m_oWriter = std::thread(&MapCheckpoint::WriterLoop, this);
+	}
+
+	m_oCond.notify_one();
+
+}
+
+/*************************************************
+Function: IsBusy
+Description: whether a checkpoint is being written or waiting
+Calls: none
+Called By: TopologyMap::SaveCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: true if the writer is busy
+Others: the caller can skip the snapshot if it is busy
+*************************************************/
+bool MapCheckpoint::IsBusy() const{
+
+	std::lock_guard<std::mutex> oLock(m_oMutex);
+
+	return m_bWritingFlag || m_pPending;
+
+}
+
+/*************************************************
+Function: WriterLoop
+Description: the loop of writer thread
+Calls: Save
+Called By: SaveAsync
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the checkpoint files
+Return: none
+Others: the snapshot is released once it is written
+*************************************************/
+void MapCheckpoint::WriterLoop(){
+
+	std::unique_lock<std::mutex> oLock(m_oMutex);
+
+	while (true){
+
+		m_oCond.wait(oLock, [this]{ return m_pPending || m_bStopFlag; });
+
+		//stopped and nothing is waiting
+		if (!m_pPending)
+			break;
+
+		std::string sFileName = m_sPendingName;
+		std::shared_ptr<const CheckpointData> pData;
+		pData.swap(m_pPending);
+		m_bWritingFlag = true;
+		oLock.unlock();
+
+		if (!Save(sFileName, *pData))
+			ROS_WARN("Can not write the checkpoint %s", sFileName.c_str());
+		pData.reset();
+
+		oLock.lock();
+		m_bWritingFlag = false;
+
+	}//end while
+
+}
+
+/*************************************************
+Function: Save
+Description: write a checkpoint file
+Calls: WriteData
+Called By: WriterLoop
+Table Accessed: none
+Table Updated: none
+Input: sFileName - the checkpoint file
+       oData - the state
+Output: the checkpoint file
+Return: whether it is written
+Others: the file is written as sFileName.tmp and renamed at last,
+        so that a crash during writing never breaks the last checkpoint
+*************************************************/
+bool MapCheckpoint::Save(const std::string & sFileName,
+	                     const CheckpointData & oData){
+
+	std::string sTempName = sFileName + ".tmp";
+
+	std::ofstream oFile(sTempName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!oFile.is_open())
+		return false;
+
+	WriteData(oFile, oData);
+	oFile.close();
+
+	if (oFile.fail()){
+		std::remove(sTempName.c_str());
+		return false;
+	}
+
+	return !std::rename(sTempName.c_str(), sFileName.c_str());
+
+}
+
+/*************************************************
+Function: Load
+Description: read a checkpoint file by mmap
+Calls: ReadData
+Called By: TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: sFileName - the checkpoint file
+Output: oData - the state
+Return: false if the file is missing, broken or of another version
+Others: the mapped file is read as a stream without any copy of the whole file
+*************************************************/
+bool MapCheckpoint::Load(const std::string & sFileName,
+	                     CheckpointData & oData){
+
+	int iFile = open(sFileName.c_str(), O_RDONLY);
+	if (iFile < 0)
+		return false;
+
+	struct stat oFileStat;
+	if (fstat(iFile, &oFileStat) || oFileStat.st_size <= 0){
+		close(iFile);
+		return false;
+	}
+
+	size_t iFileSize = size_t(oFileStat.st_size);
+	void * pMapped = mmap(NULL, iFileSize, PROT_READ, MAP_PRIVATE, iFile, 0);
+	//the mapping is kept after the file is closed
+	close(iFile);
+	if (pMapped == MAP_FAILED)
+		return false;
+
+	madvise(pMapped, iFileSize, MADV_SEQUENTIAL);
+
+	bool bReadFlag;
+	{
+		MappedBuffer oBuffer(static_cast<char *>(pMapped), iFileSize);
+		std::istream oStream(&oBuffer);
+		bReadFlag = ReadData(oStream, oData);
+	}
+
+	munmap(pMapped, iFileSize);
+
+	return bReadFlag;
+
+}
+
+/*************************************************
+Function: WriteData
+Description: write the whole file content
+Calls: WriteTiledMap
+       WriteCloud
+       WriteIdxs
+Called By: Save
+Table Accessed: none
+Table Updated: none
+Input: oData - the state
+Output: oStream - the file stream
+Return: none
+Others: the storage is
+        head mark, version, sizeof(ConfidenceCold), grids of a tile,
+        map geometry, exploration state, confidence map,
+        boundary points and buckets, obstacle points, node times and buckets,
+        op nodes and node lists, end mark
+*************************************************/
+void MapCheckpoint::WriteData(std::ostream & oStream,
+	                          const CheckpointData & oData){
+
+	//head
+	oStream.write(CHECKPOINT_HEAD, sizeof(CHECKPOINT_HEAD));
+	WriteValue(oStream, CHECKPOINT_VERSION);
+	WriteValue(oStream, int(sizeof(ConfidenceCold)));
+	WriteValue(oStream, oData.vConfidenceMap.TileGridNum());
+
+	//map geometry
+	WriteValue(oStream, oData.dMapPosX);
+	WriteValue(oStream, oData.dMapPosY);
+	WriteValue(oStream, oData.dResolution);
+	for (int i = 0; i != 3; ++i)
+		WriteValue(oStream, oData.vMinCorner[i]);
+	for (int i = 0; i != 3; ++i)
+		WriteValue(oStream, oData.vMaxCorner[i]);
+
+	//exploration state
+	WriteValue(oStream, oData.iNodeTimes);
+	WriteValue(oStream, oData.iComputedFrame);
+	WriteValue(oStream, oData.oNodeGoal.x);
+	WriteValue(oStream, oData.oNodeGoal.y);
+	WriteValue(oStream, oData.oNodeGoal.z);
+
+	//maps
+	WriteTiledMap(oStream, oData.vConfidenceMap);
+
+	WriteCloud(oStream, oData.vBoundCloud);
+	WriteTiledMap(oStream, oData.vBoundPntMapIdx);
+
+	WriteCloud(oStream, oData.vObstacleCloud);
+	WriteIdxs(oStream, oData.vObstNodeTimes);
+	WriteTiledMap(oStream, oData.vObstlPntMapIdx);
+
+	//op nodes, field by field since Node has padding
+	WriteValue(oStream, int(oData.vAllNodes.size()));
+	for (int i = 0; i != int(oData.vAllNodes.size()); ++i){
+		const Node & oNode = oData.vAllNodes[i];
+		WriteValue(oStream, oNode.point.x);
+		WriteValue(oStream, oNode.point.y);
+		WriteValue(oStream, oNode.point.z);
+		WriteValue(oStream, oNode.gridIdx);
+		WriteValue(oStream, oNode.parentIdx);
+		WriteValue(oStream, char(oNode.visitedFlag));
+		WriteValue(oStream, char(oNode.wideFlag));
+	}
+	WriteValue(oStream, oData.iCurrNodeIdx);
+	WriteIdxs(oStream, oData.vPlanNodeIdxs);
+	WriteIdxs(oStream, oData.vPastNodeIdxs);
+
+	//end
+	oStream.write(CHECKPOINT_END, sizeof(CHECKPOINT_END));
+
+}
+
+/*************************************************
+Function: ReadData
+Description: read the whole file content
+Calls: ReadTiledMap
+       ReadCloud
+       ReadIdxs
+       CheckPointIdxs
+Called By: Load
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+Output: oData - the state
+Return: false if the file is broken or of another version
+Others: the indexes in file are checked, so a broken file never gives an index out of range
+*************************************************/
+bool MapCheckpoint::ReadData(std::istream & oStream,
+	                         CheckpointData & oData){
+
+	//head
+	char vMark[sizeof(CHECKPOINT_HEAD)];
+	if (!oStream.read(vMark, sizeof(vMark)) || std::memcmp(vMark, CHECKPOINT_HEAD, sizeof(vMark)))
+		return false;
+
+	int iVersion = 0, iColdSize = 0, iTileGridNum = 0;
+	if (!ReadValue(oStream, iVersion) || iVersion != CHECKPOINT_VERSION)
+		return false;
+	if (!ReadValue(oStream, iColdSize) || iColdSize != int(sizeof(ConfidenceCold)))
+		return false;
+	if (!ReadValue(oStream, iTileGridNum) || iTileGridNum != oData.vConfidenceMap.TileGridNum())
+		return false;
+
+	//map geometry
+	if (!ReadValue(oStream, oData.dMapPosX) || !ReadValue(oStream, oData.dMapPosY) ||
+	    !ReadValue(oStream, oData.dResolution))
+		return false;
+	for (int i = 0; i != 3; ++i)
+		if (!ReadValue(oStream, oData.vMinCorner[i]))
+			return false;
+	for (int i = 0; i != 3; ++i)
+		if (!ReadValue(oStream, oData.vMaxCorner[i]))
+			return false;
+
+	//exploration state
+	if (!ReadValue(oStream, oData.iNodeTimes) || !ReadValue(oStream, oData.iComputedFrame) ||
+	    !ReadValue(oStream, oData.oNodeGoal.x) || !ReadValue(oStream, oData.oNodeGoal.y) ||
+	    !ReadValue(oStream, oData.oNodeGoal.z))
+		return false;
+
+	//maps
+	if (!ReadTiledMap(oStream, oData.vConfidenceMap))
+		return false;
+
+	if (!ReadCloud(oStream, oData.vBoundCloud) || !ReadTiledMap(oStream, oData.vBoundPntMapIdx))
+		return false;
+
+	if (!ReadCloud(oStream, oData.vObstacleCloud) || !ReadIdxs(oStream, oData.vObstNodeTimes) ||
+	    !ReadTiledMap(oStream, oData.vObstlPntMapIdx))
+		return false;
+
+	//the buckets have the same size as the confidence map
+	if (oData.vBoundPntMapIdx.size() != oData.vConfidenceMap.size() ||
+	    oData.vObstlPntMapIdx.size() != oData.vConfidenceMap.size())
+		return false;
+
+	if (oData.vObstNodeTimes.size() != oData.vObstacleCloud.points.size())
+		return false;
+
+	if (!CheckPointIdxs(oData.vBoundPntMapIdx, int(oData.vBoundCloud.points.size())) ||
+	    !CheckPointIdxs(oData.vObstlPntMapIdx, int(oData.vObstacleCloud.points.size())))
+		return false;
+
+	//op nodes
+	int iNodeNum = 0;
+	if (!ReadValue(oStream, iNodeNum) || !CheckLeftBytes(oStream, iNodeNum, 5 * sizeof(int) + 2))
+		return false;
+
+	oData.vAllNodes.assign(iNodeNum, Node());
+	for (int i = 0; i != iNodeNum; ++i){
+		Node & oNode = oData.vAllNodes[i];
+		char cVisitedFlag = 0, cWideFlag = 0;
+		if (!ReadValue(oStream, oNode.point.x) || !ReadValue(oStream, oNode.point.y) ||
+		    !ReadValue(oStream, oNode.point.z) || !ReadValue(oStream, oNode.gridIdx) ||
+		    !ReadValue(oStream, oNode.parentIdx) || !ReadValue(oStream, cVisitedFlag) ||
+		    !ReadValue(oStream, cWideFlag))
+			return false;
+		oNode.visitedFlag = cVisitedFlag != 0;
+		oNode.wideFlag = cWideFlag != 0;
+		if (oNode.gridIdx < 0 || oNode.gridIdx >= oData.vConfidenceMap.size())
+			return false;
+	}
+
+	if (!ReadValue(oStream, oData.iCurrNodeIdx) || !ReadIdxs(oStream, oData.vPlanNodeIdxs) ||
+	    !ReadIdxs(oStream, oData.vPastNodeIdxs))
+		return false;
+
+	//the node lists index m_vAllNodes
+	if (oData.iCurrNodeIdx < 0 || oData.iCurrNodeIdx >= std::max(iNodeNum, 1))
+		return false;
+	for (int i = 0; i != int(oData.vPlanNodeIdxs.size()); ++i)
+		if (oData.vPlanNodeIdxs[i] < 0 || oData.vPlanNodeIdxs[i] >= iNodeNum)
+			return false;
+	for (int i = 0; i != int(oData.vPastNodeIdxs.size()); ++i)
+		if (oData.vPastNodeIdxs[i] < 0 || oData.vPastNodeIdxs[i] >= iNodeNum)
+			return false;
+
+	//end
+	if (!oStream.read(vMark, sizeof(vMark)) || std::memcmp(vMark, CHECKPOINT_END, sizeof(vMark)))
+		return false;
+
+	return true;
+
+}
+
+/*************************************************
+Function: WriteCloud
+Description: write a point cloud
+Calls: none
+Called By: WriteData
+Table Accessed: none
+Table Updated: none
+Input: vCloud - the point cloud
+Output: oStream - the file stream
+Return: none
+Others: the storage is point number and (x y z) of each point
+*************************************************/
+void MapCheckpoint::WriteCloud(std::ostream & oStream,
+	                           const pcl::PointCloud<pcl::PointXYZ> & vCloud){
+
+	WriteValue(oStream, int(vCloud.points.size()));
+
+	for (int i = 0; i != int(vCloud.points.size()); ++i){
+		WriteValue(oStream, vCloud.points[i].x);
+		WriteValue(oStream, vCloud.points[i].y);
+		WriteValue(oStream, vCloud.points[i].z);
+	}
+
+}
+
+/*************************************************
+Function: ReadCloud
+Description: read a point cloud
+Calls: none
+Called By: ReadData
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+Output: vCloud - the point cloud
+Return: whether it is read
+Others: none
+*************************************************/
+bool MapCheckpoint::ReadCloud(std::istream & oStream,
+	                          pcl::PointCloud<pcl::PointXYZ> & vCloud){
+
+	int iPointNum = 0;
+	if (!ReadValue(oStream, iPointNum) || !CheckLeftBytes(oStream, iPointNum, 3 * sizeof(float)))
+		return false;
+
+	vCloud.points.resize(iPointNum);
+	for (int i = 0; i != iPointNum; ++i)
+		if (!ReadValue(oStream, vCloud.points[i].x) || !ReadValue(oStream, vCloud.points[i].y) ||
+		    !ReadValue(oStream, vCloud.points[i].z))
+			return false;
+
+	vCloud.width = vCloud.points.size();
+	vCloud.height = 1;
+
+	return true;
+
+}
+
+/*************************************************
+Function: WriteIdxs
+Description: write an index vector
+Calls: none
+Called By: WriteData
+           WriteTile
+Table Accessed: none
+Table Updated: none
+Input: vIdxs - the indexes
+Output: oStream - the file stream
+Return: none
+Others: the storage is the number and the indexes
+*************************************************/
+void MapCheckpoint::WriteIdxs(std::ostream & oStream,
+	                          const std::vector<int> & vIdxs){
+
+	WriteValue(oStream, int(vIdxs.size()));
+	if (vIdxs.size())
+		oStream.write(reinterpret_cast<const char *>(&vIdxs[0]), vIdxs.size() * sizeof(int));
+
+}
+
+/*************************************************
+Function: ReadIdxs
+Description: read an index vector
+Calls: none
+Called By: ReadData
+           ReadTile
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+Output: vIdxs - the indexes
+Return: whether it is read
+Others: none
+*************************************************/
+bool MapCheckpoint::ReadIdxs(std::istream & oStream,
+	                         std::vector<int> & vIdxs){
+
+	int iIdxNum = 0;
+	if (!ReadValue(oStream, iIdxNum) || !CheckLeftBytes(oStream, iIdxNum, sizeof(int)))
+		return false;
+
+	vIdxs.resize(iIdxNum);
+	if (iIdxNum && !oStream.read(reinterpret_cast<char *>(&vIdxs[0]), iIdxNum * sizeof(int)))
+		return false;
+
+	return true;
+
+}
+
+/*************************************************
+Function: WriteTile
+Description: write a confidence tile
+Calls: ConfidenceTile::Write
+Called By: WriteTiledMap
+Table Accessed: none
+Table Updated: none
+Input: vTile - the tile
+Output: oStream - the file stream
+Return: none
+Others: the arrays of tile are written in binary
+*************************************************/
+void MapCheckpoint::WriteTile(std::ostream & oStream,
+	                          const ConfidenceTile & vTile){
+
+	vTile.Write(oStream);
+
+}
+
+/*************************************************
+Function: ReadTile
+Description: read a confidence tile
+Calls: ConfidenceTile::Read
+Called By: ReadTiledMap
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+       iGridNum - the grid number of a tile
+Output: vTile - the tile
+Return: whether it is read
+Others: none
+*************************************************/
+bool MapCheckpoint::ReadTile(std::istream & oStream,
+	                         const int & iGridNum,
+	                         ConfidenceTile & vTile){
+
+	return vTile.Read(oStream, iGridNum);
+
+}
+
+/*************************************************
+Function: WriteTile
+Description: write a point index tile
+Calls: WriteIdxs
+Called By: WriteTiledMap
+Table Accessed: none
+Table Updated: none
+Input: vTile - the point indexes of each grid
+Output: oStream - the file stream
+Return: none
+Others: the storage is (point number, point indexes) of each grid
+*************************************************/
+void MapCheckpoint::WriteTile(std::ostream & oStream,
+	                          const std::vector<std::vector<int> > & vTile){
+
+	for (int i = 0; i != int(vTile.size()); ++i)
+		WriteIdxs(oStream, vTile[i]);
+
+}
+
+/*************************************************
+Function: ReadTile
+Description: read a point index tile
+Calls: ReadIdxs
+Called By: ReadTiledMap
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+       iGridNum - the grid number of a tile
+Output: vTile - the point indexes of each grid
+Return: whether it is read
+Others: none
+*************************************************/
+bool MapCheckpoint::ReadTile(std::istream & oStream,
+	                         const int & iGridNum,
+	                         std::vector<std::vector<int> > & vTile){
+
+	vTile.assign(iGridNum, std::vector<int>());
+
+	for (int i = 0; i != iGridNum; ++i)
+		if (!ReadIdxs(oStream, vTile[i]))
+			return false;
+
+	return true;
+
+}
+
+/*************************************************
+Function: WriteTiledMap
+Description: write the allocated tiles of a tiled map
+Calls: WriteTile
+Called By: WriteData
+Table Accessed: none
+Table Updated: none
+Input: vMap - the tiled map
+Output: oStream - the file stream
+Return: none
+Others: the storage is row number, column number, tile side, tile origin, allocated tile number,
+        and (tile row, tile column, tile) of each allocated tile
+*************************************************/
+template <class T, class TileT>
+void MapCheckpoint::WriteTiledMap(std::ostream & oStream,
+	                              const TiledMap<T, TileT> & vMap){
+
+	WriteValue(oStream, vMap.RowNum());
+	WriteValue(oStream, vMap.ColNum());
+	WriteValue(oStream, vMap.TileSide());
+	WriteValue(oStream, vMap.TileRowOrigin());
+	WriteValue(oStream, vMap.TileColOrigin());
+	WriteValue(oStream, vMap.AllocatedTileNum());
+
+	for (int iTileRow = 0; iTileRow != vMap.TileRows(); ++iTileRow){
+		for (int iTileCol = 0; iTileCol != vMap.TileCols(); ++iTileCol){
+
+			const TileT & vTile = vMap.Tile(iTileRow, iTileCol);
+			if (vTile.empty())
+				continue;
+
+			WriteValue(oStream, iTileRow);
+			WriteValue(oStream, iTileCol);
+			WriteTile(oStream, vTile);
+
+		}//end for iTileCol
+	}//end for iTileRow
+
+}
+
+/*************************************************
+Function: ReadTiledMap
+Description: read the allocated tiles of a tiled map
+Calls: ReadTile
+Called By: ReadData
+Table Accessed: none
+Table Updated: none
+Input: oStream - the file stream
+Output: vMap - the tiled map, it is initialized with the size in file
+Return: false if the tile side is different or a tile is broken
+Others: none
+*************************************************/
+template <class T, class TileT>
+bool MapCheckpoint::ReadTiledMap(std::istream & oStream,
+	                             TiledMap<T, TileT> & vMap){
+
+	int iRowNum = 0, iColNum = 0, iTileSide = 0;
+	int iTileRowOrigin = 0, iTileColOrigin = 0, iTileNum = 0;
+	if (!ReadValue(oStream, iRowNum) || !ReadValue(oStream, iColNum) || !ReadValue(oStream, iTileSide) ||
+	    !ReadValue(oStream, iTileRowOrigin) || !ReadValue(oStream, iTileColOrigin) || !ReadValue(oStream, iTileNum))
+		return false;
+
+	if (iRowNum <= 0 || iColNum <= 0 || iTileSide != vMap.TileSide())
+		return false;
+
+	vMap.Initialize(iRowNum, iColNum);
+	vMap.SetTileOrigin(iTileRowOrigin, iTileColOrigin);
+
+	if (iTileNum < 0 || iTileNum > vMap.TileNum())
+		return false;
+
+	for (int i = 0; i != iTileNum; ++i){
+
+		int iTileRow = -1, iTileCol = -1;
+		if (!ReadValue(oStream, iTileRow) || !ReadValue(oStream, iTileCol))
+			return false;
+
+		if (iTileRow < 0 || iTileRow >= vMap.TileRows() || iTileCol < 0 || iTileCol >= vMap.TileCols())
+			return false;
+
+		if (!ReadTile(oStream, vMap.TileGridNum(), vMap.Tile(iTileRow, iTileCol)))
+			return false;
+
+	}//end for i
+
+	return true;
+
+}
+
+/*************************************************
+Function: CheckPointIdxs
+Description: check the point indexes of grids
+Calls: none
+Called By: ReadData
+Table Accessed: none
+Table Updated: none
+Input: vPointMapIdx - the point indexes of grids
+       iPointNum - the point number of point clouds
+Output: none
+Return: whether all indexes are inside the point clouds
+Others: none
+*************************************************/
+bool MapCheckpoint::CheckPointIdxs(TiledMap<std::vector<int> > & vPointMapIdx,
+	                               const int & iPointNum){
+
+	bool bValidFlag = true;
+
+	vPointMapIdx.ForEachAllocated([&](const int & /*iGridIdx*/, std::vector<int> & vGridPntIdx){
+
+		for (int i = 0; i != int(vGridPntIdx.size()); ++i)
+			if (vGridPntIdx[i] < 0 || vGridPntIdx[i] >= iPointNum)
+				bValidFlag = false;
+
+	});
+
+	return bValidFlag;
+
+}
+
+}/*namespace*/
@@ -0,0 +1,183 @@
+#ifndef MAPCHECKPOINT_H
+#define MAPCHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include "OP.h"
+
+///************************************************************************///
+// a class to implement the binary checkpoint of the exploration state
+// the checkpoint covers the confidence map, the boundary and obstacle point clouds
+// with their grid buckets, the node times of obstacle points and the op nodes,
+// it is written by a background thread from a snapshot and read with mmap at startup,
+// so that a restarted exploration resumes without scanning the site again
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the checkpoint file (version 1) and the background writer
+// - the arrays are stored in the memory layout of this build,
+//   a file of a different build (sizeof of structures) is rejected
+
+///************************************************************************///
+
+namespace topology_map {
+
+//the state stored in a checkpoint
+struct CheckpointData{
+
+	//**map geometry**
+	//the center and resolution of grid map
+	double dMapPosX;
+	double dMapPosY;
+	double dResolution;
+	//the bounding box of map
+	double vMinCorner[3];
+	double vMaxCorner[3];
+
+	//**exploration state**
+	unsigned int iNodeTimes;
+	int iComputedFrame;
+	pcl::PointXYZ oNodeGoal;
+
+	//**maps**
+	//the confidence map, its size and tile origin are the map geometry in grids
+	ConfidenceMap vConfidenceMap;
+
+	//the point clouds and the point indexes of grids
+	pcl::PointCloud<pcl::PointXYZ> vBoundCloud;
+	pcl::PointCloud<pcl::PointXYZ> vObstacleCloud;
+	std::vector<int> vObstNodeTimes;
+	TiledMap<std::vector<int> > vBoundPntMapIdx;
+	TiledMap<std::vector<int> > vObstlPntMapIdx;
+
+	//**op nodes**
+	std::vector<Node> vAllNodes;
+	int iCurrNodeIdx;
+	std::vector<int> vPlanNodeIdxs;
+	std::vector<int> vPastNodeIdxs;
+
+	CheckpointData():dMapPosX(0.0), dMapPosY(0.0), dResolution(0.0),
+	                 iNodeTimes(0), iComputedFrame(0), iCurrNodeIdx(0){
+
+		for (int i = 0; i != 3; ++i){
+			vMinCorner[i] = 0.0;
+			vMaxCorner[i] = 0.0;
+		}
+
+	};
+
+};
+
+class MapCheckpoint{
+
+public:
+
+	//constructor
+	MapCheckpoint();
+
+	//destructor, the waiting checkpoint is written before return
+	~MapCheckpoint();
+
+	//write a checkpoint in background, a waiting one that is not started is replaced
+	void SaveAsync(const std::string & sFileName,
+	               const std::shared_ptr<const CheckpointData> & pData);
+
+	//whether a checkpoint is being written or waiting
+	bool IsBusy() const;
+
+	//write a checkpoint file, it is written into a temporary file and renamed at last
+	static bool Save(const std::string & sFileName,
+	                 const CheckpointData & oData);
+
+	//read a checkpoint file by mmap, return false if it is missing, broken or of another version
+	static bool Load(const std::string & sFileName,
+	                 CheckpointData & oData);
+
+private:
+
+	//the loop of writer thread
+	void WriterLoop();
+
+	//write and read the whole file content
+	static void WriteData(std::ostream & oStream,
+	                      const CheckpointData & oData);
+
+	static bool ReadData(std::istream & oStream,
+	                     CheckpointData & oData);
+
+	//write and read the parts of file
+	static void WriteCloud(std::ostream & oStream,
+	                       const pcl::PointCloud<pcl::PointXYZ> & vCloud);
+
+	static bool ReadCloud(std::istream & oStream,
+	                      pcl::PointCloud<pcl::PointXYZ> & vCloud);
+
+	static void WriteIdxs(std::ostream & oStream,
+	                      const std::vector<int> & vIdxs);
+
+	static bool ReadIdxs(std::istream & oStream,
+	                     std::vector<int> & vIdxs);
+
+	static void WriteTile(std::ostream & oStream,
+	                      const ConfidenceTile & vTile);
+
+	static bool ReadTile(std::istream & oStream,
+	                     const int & iGridNum,
+	                     ConfidenceTile & vTile);
+
+	static void WriteTile(std::ostream & oStream,
+	                      const std::vector<std::vector<int> > & vTile);
+
+	static bool ReadTile(std::istream & oStream,
+	                     const int & iGridNum,
+	                     std::vector<std::vector<int> > & vTile);
+
+	//the allocated tiles of a tiled map
+	template <class T, class TileT>
+	static void WriteTiledMap(std::ostream & oStream,
+	                          const TiledMap<T, TileT> & vMap);
+
+	template <class T, class TileT>
+	static bool ReadTiledMap(std::istream & oStream,
+	                         TiledMap<T, TileT> & vMap);
+
+	//whether the point indexes of grids are inside the point clouds
+	static bool CheckPointIdxs(TiledMap<std::vector<int> > & vPointMapIdx,
+	                           const int & iPointNum);
+
+	//the writer thread, it is started by the first checkpoint
+	std::thread m_oWriter;
+
+	//the waiting checkpoint
+	std::string m_sPendingName;
+	std::shared_ptr<const CheckpointData> m_pPending;
+
+	//a checkpoint is being written
+	bool m_bWritingFlag;
+	bool m_bStopFlag;
+
+	mutable std::mutex m_oMutex;
+	std::condition_variable m_oCond;
+
+};
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//MapCheckpoint oCheckpoint;
+////in the map thread, take a snapshot and write it in background
+//std::shared_ptr<CheckpointData> pData(new CheckpointData);
+//pData->vConfidenceMap = vConfidenceMap;
+//if (!oCheckpoint.IsBusy())
+//	oCheckpoint.SaveAsync("Checkpoint.bin", pData);
+////at startup
+//CheckpointData oData;
+//if (MapCheckpoint::Load("Checkpoint.bin", oData))
+//	ResumeFrom(oData);
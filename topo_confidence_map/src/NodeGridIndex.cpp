@@ -0,0 +1,226 @@
+#include "NodeGridIndex.h"
+
+namespace topology_map {
+
+/*************************************************
+Function: NodeGridIndex
+Description: constrcution function for NodeGridIndex class
+Calls: none
+Called By: OP
+Table Accessed: none
+Table Updated: none
+Input: f_fCellSize - the cell size in meter
+Output: none
+Return: none
+Others: none
+*************************************************/
+NodeGridIndex::NodeGridIndex(float f_fCellSize):m_fCellSize(f_fCellSize){
+
+	if (m_fCellSize <= 0.0)
+		m_fCellSize = 1.0;
+
+}
+
+/*************************************************
+Function: ~NodeGridIndex
+Description: destrcution function for NodeGridIndex class
+Calls: none
+Called By: ~OP
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+NodeGridIndex::~NodeGridIndex(){
+
+}
+
+/*************************************************
+Function: Reset
+Description: remove all nodes and set the cell size
+Calls: none
+Called By: OP::Initial
+           OP::RestoreNodes
+Table Accessed: none
+Table Updated: none
+Input: fResolution - the resolution of map, so that the cells are aligned to the map grids
+       fCellSize - the expected cell size, which is usually the suppression radius
+Output: none
+Return: none
+Others: the cell size is rounded up to a multiple of resolution,
+        so a radius query no larger than it only checks 3 x 3 cells
+*************************************************/
+void NodeGridIndex::Reset(const float & fResolution,
+	                      const float & fCellSize){
+
+	if (fResolution > 0.0)
+		m_fCellSize = fResolution * std::max(1.0f, std::ceil(fCellSize / fResolution - 1e-4f));
+	else if (fCellSize > 0.0)
+		m_fCellSize = fCellSize;
+
+	m_mCells.clear();
+	m_vNodeX.clear();
+	m_vNodeY.clear();
+	m_vNodeKeys.clear();
+	m_vNodeIdxs.clear();
+	m_vListPos.clear();
+
+}
+
+/*************************************************
+Function: Insert
+Description: add a node into the index
+Calls: CellKey
+       CellCoord
+Called By: OP::AddNode
+Table Accessed: none
+Table Updated: none
+Input: iNodeIdx - the index of node in node list
+       oPoint - the node position
+Output: none
+Return: none
+Others: a node in the index is moved if it is inserted again
+*************************************************/
+void NodeGridIndex::Insert(const int & iNodeIdx,
+	                       const pcl::PointXYZ & oPoint){
+
+	if (iNodeIdx < 0)
+		return;
+
+	if (Has(iNodeIdx))
+		Remove(iNodeIdx);
+
+	if (iNodeIdx >= int(m_vListPos.size())){
+		m_vNodeX.resize(iNodeIdx + 1, 0.0);
+		m_vNodeY.resize(iNodeIdx + 1, 0.0);
+		m_vNodeKeys.resize(iNodeIdx + 1, 0);
+		m_vListPos.resize(iNodeIdx + 1, -1);
+	}
+
+	int64_t iKey = CellKey(CellCoord(oPoint.x), CellCoord(oPoint.y));
+
+	m_vNodeX[iNodeIdx] = oPoint.x;
+	m_vNodeY[iNodeIdx] = oPoint.y;
+	m_vNodeKeys[iNodeIdx] = iKey;
+	m_mCells[iKey].push_back(iNodeIdx);
+
+	m_vListPos[iNodeIdx] = int(m_vNodeIdxs.size());
+	m_vNodeIdxs.push_back(iNodeIdx);
+
+}
+
+/*************************************************
+Function: Remove
+Description: remove a node from the index
+Calls: none
+Called By: Insert
+           OP::MarkVisited
+Table Accessed: none
+Table Updated: none
+Input: iNodeIdx - the index of node in node list
+Output: none
+Return: none
+Others: nothing is done if the node is not in the index
+*************************************************/
+void NodeGridIndex::Remove(const int & iNodeIdx){
+
+	if (!Has(iNodeIdx))
+		return;
+
+	//remove from its cell
+	std::unordered_map<int64_t, std::vector<int> >::iterator oCellIter = m_mCells.find(m_vNodeKeys[iNodeIdx]);
+	if (oCellIter != m_mCells.end()){
+		std::vector<int> & vCellIdxs = oCellIter->second;
+		for (int i = 0; i != int(vCellIdxs.size()); ++i){
+			if (vCellIdxs[i] == iNodeIdx){
+				vCellIdxs[i] = vCellIdxs.back();
+				vCellIdxs.pop_back();
+				break;
+			}
+		}
+		if (vCellIdxs.empty())
+			m_mCells.erase(oCellIter);
+	}
+
+	//remove from the list by swapping with the last one
+	int iListPos = m_vListPos[iNodeIdx];
+	int iLastIdx = m_vNodeIdxs.back();
+	m_vNodeIdxs[iListPos] = iLastIdx;
+	m_vListPos[iLastIdx] = iListPos;
+	m_vNodeIdxs.pop_back();
+	m_vListPos[iNodeIdx] = -1;
+
+}
+
+/*************************************************
+Function: RadiusSearch
+Description: find the nodes within a radius
+Calls: CellKey
+       CellCoord
+Called By: OP::GetNewNodeSuppression
+Table Accessed: none
+Table Updated: none
+Input: oQueryPoint - the query position
+       fRadius - the radius, the distance is 2d (z is ignored)
+Output: vNodeIdxs - the nodes whose distance is not larger than the radius
+Return: none
+Others: none
+*************************************************/
+void NodeGridIndex::RadiusSearch(const pcl::PointXYZ & oQueryPoint,
+	                             const float & fRadius,
+	                             std::vector<int> & vNodeIdxs) const{
+
+	vNodeIdxs.clear();
+
+	int64_t iMinX = CellCoord(oQueryPoint.x - fRadius);
+	int64_t iMaxX = CellCoord(oQueryPoint.x + fRadius);
+	int64_t iMinY = CellCoord(oQueryPoint.y - fRadius);
+	int64_t iMaxY = CellCoord(oQueryPoint.y + fRadius);
+	float fSquareRadius = fRadius * fRadius;
+
+	for (int64_t ix = iMinX; ix <= iMaxX; ++ix){
+		for (int64_t iy = iMinY; iy <= iMaxY; ++iy){
+
+			std::unordered_map<int64_t, std::vector<int> >::const_iterator oCellIter = m_mCells.find(CellKey(ix, iy));
+			if (oCellIter == m_mCells.end())
+				continue;
+
+			const std::vector<int> & vCellIdxs = oCellIter->second;
+			for (int i = 0; i != int(vCellIdxs.size()); ++i){
+				float fDX = m_vNodeX[vCellIdxs[i]] - oQueryPoint.x;
+				float fDY = m_vNodeY[vCellIdxs[i]] - oQueryPoint.y;
+				if (fDX * fDX + fDY * fDY <= fSquareRadius)
+					vNodeIdxs.push_back(vCellIdxs[i]);
+			}
+
+		}//end for iy
+	}//end for ix
+
+}
+
+/*************************************************
+Function: SortedNodeIdxs
+Description: get all nodes in the index
+Calls: none
+Called By: OP::UpdateNodes
+           OP::GTR
+           OP::BranchBoundMethod
+           OP::AnytimeMethod
+           OP::OutputUnvisitedNodes
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: vNodeIdxs - the nodes in ascending order
+Return: none
+Others: the order is the same as the node list, it costs O(k log k) for k indexed nodes
+*************************************************/
+void NodeGridIndex::SortedNodeIdxs(std::vector<int> & vNodeIdxs) const{
+
+	vNodeIdxs = m_vNodeIdxs;
+	std::sort(vNodeIdxs.begin(), vNodeIdxs.end());
+
+}
+
+}/*namespace*/
@@ -0,0 +1,113 @@
+#ifndef NODEGRIDINDEX_H
+#define NODEGRIDINDEX_H
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <pcl/point_types.h>
+
+///************************************************************************///
+// a class to implement a uniform grid hash of node positions
+// the cell size is a multiple of the map resolution,
+// the neighbours within a radius are found by checking the nearby cells only
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the node index used by the suppression and the unvisited node queries of OP
+
+///************************************************************************///
+
+namespace topology_map {
+
+class NodeGridIndex{
+
+public:
+
+	//constructor
+	NodeGridIndex(float f_fCellSize = 1.0);
+
+	//destructor
+	~NodeGridIndex();
+
+	//remove all nodes and set the cell size, which is rounded up to a multiple of resolution
+	void Reset(const float & fResolution,
+	           const float & fCellSize);
+
+	//add a node, the index is its index in node list
+	void Insert(const int & iNodeIdx,
+	            const pcl::PointXYZ & oPoint);
+
+	//remove a node
+	void Remove(const int & iNodeIdx);
+
+	//whether a node is in the index
+	inline bool Has(const int & iNodeIdx) const{
+
+		return iNodeIdx >= 0 && iNodeIdx < int(m_vListPos.size()) && m_vListPos[iNodeIdx] >= 0;
+
+	};
+
+	//the number of nodes in the index
+	inline int Size() const{
+
+		return int(m_vNodeIdxs.size());
+
+	};
+
+	//the nodes within a radius (2d distance)
+	void RadiusSearch(const pcl::PointXYZ & oQueryPoint,
+	                  const float & fRadius,
+	                  std::vector<int> & vNodeIdxs) const;
+
+	//all nodes in the index, in ascending order
+	void SortedNodeIdxs(std::vector<int> & vNodeIdxs) const;
+
+private:
+
+	//the key of the cell covering a position
+	inline int64_t CellKey(const int64_t & iCellX,
+	                       const int64_t & iCellY) const{
+
+		return int64_t((uint64_t(iCellX) << 32) ^ (uint64_t(iCellY) & 0xffffffffULL));
+
+	};
+
+	//the cell coordinate of a position
+	inline int64_t CellCoord(const float & fValue) const{
+
+		return int64_t(std::floor(fValue / m_fCellSize));
+
+	};
+
+	//the cell size
+	float m_fCellSize;
+
+	//the nodes in each cell
+	std::unordered_map<int64_t, std::vector<int> > m_mCells;
+
+	//the position and cell of each node
+	std::vector<float> m_vNodeX;
+	std::vector<float> m_vNodeY;
+	std::vector<int64_t> m_vNodeKeys;
+
+	//all nodes in the index and the position of each node in the list (-1 means not in index)
+	std::vector<int> m_vNodeIdxs;
+	std::vector<int> m_vListPos;
+
+};
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//NodeGridIndex oIndex;
+//oIndex.Reset(0.1, 1.0);
+//oIndex.Insert(0, oNodePoint);
+////find the nodes within 1 meter
+//std::vector<int> vNearIdxs;
+//oIndex.RadiusSearch(oQueryPoint, 1.0, vNearIdxs);
+//if (!vNearIdxs.size())
+//	oIndex.Insert(1, oQueryPoint);
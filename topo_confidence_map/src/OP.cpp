@@ -14,13 +14,64 @@ Return: none
 Others: none
 *************************************************/
 OP::OP():m_iCurrNodeIdx(0),
-               BBSolver(5){
+               BBSolver(5),
+               m_iOPSolverType(1),
+               m_dOPTimeBudget(50.0),
+               m_iObjectEvalNum(0){
 
     //5 in BBSolver(5) is a placeholder
     //it will be changed when using ObjectiveMatrix
 
 }
 
+/*************************************************
+Function: ShiftGrids
+Description: update the grid index of nodes after the map is moved (rolling map)
+Calls: MarkVisited
+Called By: TopologyMap::RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: oFeatureMap - the moved grid map
+Output: m_vAllNodes - the grid index of each node
+Return: the number of unvisited nodes that are out of map
+Others: a node out of map takes the nearest grid on map border, so that its index is still valid,
+        and an unvisited one is labeled as visited because it can not be reached by the planning on map
+*************************************************/
+int OP::ShiftGrids(const grid_map::GridMap & oFeatureMap){
+
+	int iRetiredNum = 0;
+
+	//the centers of border grids
+	double dHalfX = 0.5 * (oFeatureMap.getLength().x() - oFeatureMap.getResolution());
+	double dHalfY = 0.5 * (oFeatureMap.getLength().y() - oFeatureMap.getResolution());
+	const grid_map::Position & oMapCenter = oFeatureMap.getPosition();
+
+	for (int i = 0; i != int(m_vAllNodes.size()); ++i){
+
+		grid_map::Position oNodePos(m_vAllNodes[i].point.x, m_vAllNodes[i].point.y);
+
+		if (!oFeatureMap.isInside(oNodePos)){
+
+			oNodePos.x() = std::max(oMapCenter.x() - dHalfX, std::min(oMapCenter.x() + dHalfX, oNodePos.x()));
+			oNodePos.y() = std::max(oMapCenter.y() - dHalfY, std::min(oMapCenter.y() + dHalfY, oNodePos.y()));
+
+			if (!m_vAllNodes[i].visitedFlag){
+				MarkVisited(i);
+				iRetiredNum++;
+			}
+
+		}//end if
+
+		grid_map::Index oNodeIdx;
+		oFeatureMap.getIndex(oNodePos, oNodeIdx);
+		m_vAllNodes[i].gridIdx = ExtendedGM::TwotoOneDIdx(oNodeIdx);
+
+	}//end for i
+
+	return iRetiredNum;
+
+}
+
 /*************************************************
 Function: ~OP
 Description: destruction of OP class
@@ -38,6 +89,84 @@ OP::~OP(){
 
 }
 
+/*************************************************
+Function: SetOPSolver
+Description: set the solver used in BranchBoundMethod
+Calls: BranchBound::SetDPMaxNodeNum
+Called By: TopologyMap::ReadLaunchParams
+Table Accessed: none
+Table Updated: none
+Input: iSolverType - 0 is the raw branch and bound (SolveOP),
+                     1 is the exact solver (SolveOPExact)
+                     2 is the anytime solver (AnytimeMethod)
+       iDPMaxNodeNum - the largest node number solved by dynamic programming in the exact solver (at most 20)
+       dTimeBudget - the time budget of anytime solver in millisecond
+Output: none
+Return: none
+Others: the larger node sets use the pruned branch and bound in the exact solver
+*************************************************/
+void OP::SetOPSolver(const int & iSolverType,
+	                 const int & iDPMaxNodeNum,
+	                 const double & dTimeBudget){
+
+	m_iOPSolverType = iSolverType;
+
+	BBSolver.SetDPMaxNodeNum(iDPMaxNodeNum);
+
+	m_dOPTimeBudget = dTimeBudget;
+
+}
+
+
+/*************************************************
+Function: AddNode
+Description: add a node into the node list and the node index
+Calls: NodeGridIndex::Insert
+Called By: Initial
+           RestoreNodes
+           GetNewNode
+           GetNewNodeSuppression
+Table Accessed: none
+Table Updated: none
+Input: oNewNode - the new node
+Output: m_vAllNodes - the node list
+        m_oNodeIndex - the node index
+Return: none
+Others: all nodes must be added by this function so that the index is consistent with the list
+*************************************************/
+void OP::AddNode(const Node & oNewNode){
+
+	m_vAllNodes.push_back(oNewNode);
+
+	//only the unvisited nodes are indexed
+	if (!oNewNode.visitedFlag)
+		m_oNodeIndex.Insert(int(m_vAllNodes.size()) - 1, oNewNode.point);
+
+}
+
+/*************************************************
+Function: MarkVisited
+Description: label a node as visited and remove it from the node index
+Calls: NodeGridIndex::Remove
+Called By: UpdateNodes
+           GTR
+           BranchBoundMethod
+           AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: iNodeIdx - the node index in m_vAllNodes
+Output: m_vAllNodes - the visited flag
+        m_oNodeIndex - the node index
+Return: none
+Others: all nodes must be labeled by this function so that the index is consistent with the list
+*************************************************/
+void OP::MarkVisited(const int & iNodeIdx){
+
+	m_vAllNodes[iNodeIdx].visitedFlag = true;
+
+	m_oNodeIndex.Remove(iNodeIdx);
+
+}
 
 /*************************************************
 Function: ~OP
@@ -55,6 +184,12 @@ void OP::Initial(const pcl::PointXYZ & oOriginPoint,
 	             const grid_map::GridMap & oFeatureMap){
 
 	m_vAllNodes.clear();
+	//the cells of node index are aligned to map grids and cover the default suppression radius (1 meter)
+	m_oNodeIndex.Reset(oFeatureMap.getResolution(), 1.0);
+	//the cache of old nodes is useless
+	m_vObjectCache.clear();
+	m_vCacheStates.clear();
+
 	//a new node
 	Node oNewNode;
 
@@ -74,7 +209,7 @@ void OP::Initial(const pcl::PointXYZ & oOriginPoint,
     oNewNode.visitedFlag = false;
 
     //get the new node
-	m_vAllNodes.push_back(oNewNode);
+	AddNode(oNewNode);
 
 }
 
@@ -227,7 +362,7 @@ Output: a flag indicats it is a wide grid (true) or not (false)
 Return: a bool value
 Others: none
 *************************************************/
-bool OP::IsWideGrid(const std::vector<ConfidenceValue> & vConfidenceMap,
+bool OP::IsWideGrid(const ConfidenceMap & vConfidenceMap,
 	                                              const int & iQueryIdx) {
 
     //if this grid is not close to boundary and also visiable to current robot
@@ -253,7 +388,7 @@ Output: a Euclidean distance
 Return: float distance
 Others: none
 *************************************************/
-void OP::GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
+void OP::GetNewNode(const ConfidenceMap & vConfidenceMap,
 	                                            const int & iNewNodeIdx,
 			                          const pcl::PointXYZ & oNodePoints){
 	
@@ -281,14 +416,14 @@ void OP::GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
     	oNewNode.wideFlag = false;
 
     //get the new node
-	m_vAllNodes.push_back(oNewNode);
+	AddNode(oNewNode);
     
     //need update path strategy since the new input comes
 	m_vPlanNodeIdxs.clear();
 
 }
 //reload with multiple inputs
-void OP::GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
+void OP::GetNewNode(const ConfidenceMap & vConfidenceMap,
 	                              const std::vector<int> & vNewNodeIdxs,
 			          const std::vector<pcl::PointXYZ> & vNewNodeClouds){
 
@@ -320,7 +455,7 @@ void OP::GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
 		else
 			oNewNode.wideFlag = false;
 		//get the grid idx of new node
-		m_vAllNodes.push_back(oNewNode);
+		AddNode(oNewNode);
 
 	}//end for int i = 0; i != vNewNodeIdxs.size(); ++i)
 
@@ -342,30 +477,17 @@ Output: a Euclidean distance
 Return: float distance
 Others: none
 *************************************************/
-void OP::GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceMap,
+void OP::GetNewNodeSuppression(const ConfidenceMap & vConfidenceMap,
 	                                                       const int & iNewNodeIdx,
 			                                      const pcl::PointXYZ & oNodePoint,
 					                                           float fSuppressionR){
 
-    //define a rule
-	float fMinDis = FLT_MAX;
-
 	//find wether the input new node is near a unvisited node
-	for(int i = 0; i != m_vAllNodes.size(); ++i){
-
-		if(!m_vAllNodes[i].visitedFlag){
-		//compute the distance
-	    float fDis = TwoDDistance(oNodePoint, m_vAllNodes[i].point);
-
-		//record the shortest distance
-		if(fDis < fMinDis)
-		   fMinDis = fDis;
-        }//end if
-
-	}//end for
+	std::vector<int> vNearNodeIdxs;
+	m_oNodeIndex.RadiusSearch(oNodePoint, fSuppressionR, vNearNodeIdxs);
 
-	//if this grid is too close to a generated node
-	if(fMinDis > fSuppressionR){
+	//if this grid is not too close to a generated node
+	if(!vNearNodeIdxs.size()){
        
        	//a new node
 	    Node oNewNode;
@@ -387,7 +509,7 @@ void OP::GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceM
         else
         	oNewNode.wideFlag = false;
         //get the new node
-	    m_vAllNodes.push_back(oNewNode);
+	    AddNode(oNewNode);
 
 	    //need update path strategy since the new input comes
 	    m_vPlanNodeIdxs.clear();
@@ -396,79 +518,59 @@ void OP::GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceM
 
 }
 //reload with multiple inputs
-void OP::GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceMap,
+void OP::GetNewNodeSuppression(const ConfidenceMap & vConfidenceMap,
 	                                         const std::vector<int> & vNewNodeIdxs,
 			                     const std::vector<pcl::PointXYZ> & vNewNodeClouds,
 					                                           float fSuppressionR){
 
-	//new a point cloud to save thr unvisited point
-    pcl::PointCloud<pcl::PointXYZ>::Ptr pUnVisitCloud(new pcl::PointCloud<pcl::PointXYZ>);
-
-	for (int i = 0; i != m_vAllNodes.size(); ++i){
-	    if(!m_vAllNodes[i].visitedFlag)
-	    	pUnVisitCloud->points.push_back(m_vAllNodes[i].point);
+	if(vNewNodeIdxs.size() != vNewNodeClouds.size()){
+		ROS_INFO("Error: node index size and node point size are not the same.");
+		return ;
 	}
 
+	//find whether each new node is near a unvisited node
+	//the new nodes of the same input do not suppress each other
+	std::vector<bool> vFarFlags(vNewNodeClouds.size(), false);
+	std::vector<int> vNearNodeIdxs;
+	for (int i = 0; i != vNewNodeClouds.size(); ++i) {
+		m_oNodeIndex.RadiusSearch(vNewNodeClouds[i], fSuppressionR, vNearNodeIdxs);
+		vFarFlags[i] = !vNearNodeIdxs.size();
+	}
 
-    //if there is the unvisited node
-    if(pUnVisitCloud->points.size()){
-
-	    //new a kdtree for unvisited point clouds
-	    pcl::KdTreeFLANN<pcl::PointXYZ> oUnVisitKDTree;
-	    oUnVisitKDTree.setInputCloud(pUnVisitCloud);
-
-	    //to each new node
-	    for (int i = 0; i != vNewNodeClouds.size(); ++i) {
-			
-		    //set the searched vector
-		    std::vector<int> vSearchedIdx;
-		    std::vector<float> vSearchedDis;
-		    //find the nearest unvisited node
-		    oUnVisitKDTree.nearestKSearch(vNewNodeClouds[i], 1, vSearchedIdx, vSearchedDis);
-
-		    float fRealDis = sqrt(vSearchedDis[0]);
-
-			//if they are far away (the distance farther than threshold)
-			if(fRealDis > fSuppressionR){
-
-				//a new node
-	            Node oNewNode;
-
-	            oNewNode.point.x = vNewNodeClouds[i].x;
-	            oNewNode.point.y = vNewNodeClouds[i].y;
-	            //oNewNode.point.z = vNodePoints.point.z;
-                oNewNode.point.z = 0.0;//
-
-	            //the corresponding grid idx of node
-                oNewNode.gridIdx = vNewNodeIdxs[i];
-                //the parent id
-                oNewNode.parentIdx = m_iCurrNodeIdx;
-                //visited or not
-                oNewNode.visitedFlag = false;
-			    //wide or not
-			    if(oNewNode.parentIdx != 0)
-			    	oNewNode.wideFlag = IsWideGrid(vConfidenceMap, vNewNodeIdxs[i]);
-			    else
-			    	oNewNode.wideFlag = false;
-	            //get the grid idx of new node
-			    m_vAllNodes.push_back(oNewNode);
-			    
-			    //need update path strategy since the new input comes
-	            m_vPlanNodeIdxs.clear();
-
-			}//end if
-
-		}//end for int i = 0; i != vNewNodeIdxs.size(); ++i)
-
-	}else{//there are not unvisited nodes
-
-	    //directly save input nodes
-        GetNewNode(vConfidenceMap, vNewNodeIdxs, vNewNodeClouds);
+	//to each new node
+	for (int i = 0; i != vNewNodeClouds.size(); ++i) {
+
+		//if they are far away (the distance farther than threshold)
+		if(vFarFlags[i]){
+
+			//a new node
+            Node oNewNode;
+
+            oNewNode.point.x = vNewNodeClouds[i].x;
+            oNewNode.point.y = vNewNodeClouds[i].y;
+            //oNewNode.point.z = vNodePoints.point.z;
+            oNewNode.point.z = 0.0;//
+
+            //the corresponding grid idx of node
+            oNewNode.gridIdx = vNewNodeIdxs[i];
+            //the parent id
+            oNewNode.parentIdx = m_iCurrNodeIdx;
+            //visited or not
+            oNewNode.visitedFlag = false;
+		    //wide or not
+		    if(oNewNode.parentIdx != 0)
+		    	oNewNode.wideFlag = IsWideGrid(vConfidenceMap, vNewNodeIdxs[i]);
+		    else
+		    	oNewNode.wideFlag = false;
+            //get the grid idx of new node
+		    AddNode(oNewNode);
+		    
+		    //need update path strategy since the new input comes
+            m_vPlanNodeIdxs.clear();
 
-        //need update path strategy since the new input comes
-	    m_vPlanNodeIdxs.clear();
+		}//end if
 
-	}//end else
+	}//end for int i = 0; i != vNewNodeIdxs.size(); ++i)
 
 }
 
@@ -485,7 +587,7 @@ Output: a Euclidean distance
 Return: float distance
 Others: none
 *************************************************/
-bool OP::UpdateNodes(const std::vector<ConfidenceValue> & vConfidenceMap,
+bool OP::UpdateNodes(const ConfidenceMap & vConfidenceMap,
 	                                                      float fWideThr,
 	                                                   float fNonWideThr){
 
@@ -499,8 +601,12 @@ bool OP::UpdateNodes(const std::vector<ConfidenceValue> & vConfidenceMap,
 	int iWideNodeNum = 0;
 
     std::cout<<"updating node totalvalue: "<<std::endl;
+	//only the unvisited nodes are checked
+	std::vector<int> vUnvisitedIdxs;
+	m_oNodeIndex.SortedNodeIdxs(vUnvisitedIdxs);
 	//a status indicating whether the node is removed or not
-	for (int i = 0; i != m_vAllNodes.size(); ++i) {
+	for (int k = 0; k != vUnvisitedIdxs.size(); ++k) {
+		int i = vUnvisitedIdxs[k];
 		//search all unvisited wide node
 		if(!m_vAllNodes[i].visitedFlag){
             //if it not need to go
@@ -522,7 +628,7 @@ bool OP::UpdateNodes(const std::vector<ConfidenceValue> & vConfidenceMap,
 
             //if it is up to a value and also not a near node from original node (original node can only generate near node)
 			if(vConfidenceMap[m_vAllNodes[i].gridIdx].travelTerm > fWithDrawThr){
-			   m_vAllNodes[i].visitedFlag = true;
+			   MarkVisited(i);
 			   iRemoveNum++;
 			   continue;
 			}//end if >
@@ -592,7 +698,7 @@ Output: a Euclidean distance
 Return: float distance
 Others: none
 *************************************************/
-inline float OP::ObjectiveFunction(const std::vector<ConfidenceValue> & vConfidenceMap,
+inline float OP::ObjectiveFunction(const ConfidenceMap & vConfidenceMap,
 	                                                           const Node & oQueryNode,
 	                                                          const Node & oTargetNode){
 
@@ -627,6 +733,141 @@ inline float OP::ObjectiveFunction(const std::vector<ConfidenceValue> & vConfide
 
 }
 
+/*************************************************
+Function: UpdateObjectCache
+Description: refresh the objective cache with the current node states
+Calls: none
+Called By: GTR
+           BranchBoundMethod
+           AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map
+Output: m_vObjectCache - the cached objective values
+        m_vCacheStates - the node states of cache
+Return: none
+Others: the new nodes only add new rows and columns,
+        a moved node removes its row and column (the distance is changed),
+        a node whose total value is changed removes its column (the reward is changed),
+        so the refresh costs O(kN) for k changed nodes and the values are computed lazily in CachedObjective
+*************************************************/
+void OP::UpdateObjectCache(const ConfidenceMap & vConfidenceMap){
+
+	int iOldNum = int(m_vCacheStates.size());
+	int iNodeNum = int(m_vAllNodes.size());
+
+	//add the rows and columns of new nodes
+	if (iNodeNum > iOldNum){
+
+		for (int i = 0; i != iOldNum; ++i)
+			m_vObjectCache[i].resize(iNodeNum, -1.0);
+		m_vObjectCache.resize(iNodeNum, std::vector<float>(iNodeNum, -1.0));
+
+		for (int i = iOldNum; i != iNodeNum; ++i){
+			NodeCacheState oState;
+			oState.x = m_vAllNodes[i].point.x;
+			oState.y = m_vAllNodes[i].point.y;
+			oState.value = vConfidenceMap[m_vAllNodes[i].gridIdx].totalValue;
+			m_vCacheStates.push_back(oState);
+		}
+
+	}//end if iNodeNum > iOldNum
+
+	//check the old nodes
+	for (int i = 0; i != iOldNum; ++i){
+
+		NodeCacheState & oState = m_vCacheStates[i];
+		float fValue = vConfidenceMap[m_vAllNodes[i].gridIdx].totalValue;
+
+		bool bMoveFlag = oState.x != m_vAllNodes[i].point.x
+		              || oState.y != m_vAllNodes[i].point.y;
+
+		//the node is not changed
+		if (!bMoveFlag && oState.value == fValue)
+			continue;
+
+		//the values to node i (its distance or reward is changed)
+		for (int j = 0; j != iNodeNum; ++j)
+			m_vObjectCache[j][i] = -1.0;
+
+		//the values from node i (only its distance is changed)
+		if (bMoveFlag)
+			m_vObjectCache[i].assign(iNodeNum, -1.0);
+
+		oState.x = m_vAllNodes[i].point.x;
+		oState.y = m_vAllNodes[i].point.y;
+		oState.value = fValue;
+
+	}//end for i
+
+}
+
+/*************************************************
+Function: CachedObjective
+Description: get the objective value of two nodes from the cache
+Calls: ObjectiveFunction
+Called By: GTR
+           PlanObjectMatrix
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map
+       iQueryIdx - the source node (index is in m_vAllNodes)
+       iTargetIdx - the target node (index is in m_vAllNodes)
+Output: m_vObjectCache - the computed value is saved
+Return: the objective value from the source node to the target node
+Others: UpdateObjectCache must be called after the nodes are changed
+*************************************************/
+float OP::CachedObjective(const ConfidenceMap & vConfidenceMap,
+	                                                 const int & iQueryIdx,
+	                                                const int & iTargetIdx){
+
+	float & fObjectValue = m_vObjectCache[iQueryIdx][iTargetIdx];
+
+	if (fObjectValue < 0.0){
+		fObjectValue = ObjectiveFunction(vConfidenceMap,
+		                                 m_vAllNodes[iQueryIdx],
+		                                 m_vAllNodes[iTargetIdx]);
+		m_iObjectEvalNum++;
+	}
+
+	return fObjectValue;
+
+}
+
+/*************************************************
+Function: PlanObjectMatrix
+Description: construct the objective matrix of the planned nodes
+Calls: UpdateObjectCache
+       CachedObjective
+Called By: BranchBoundMethod
+           AnytimeMethod
+Table Accessed: none
+Table Updated: none
+Input: vConfidenceMap - the confidence map
+       vPlanNodeIdxs - the planned nodes (index is in m_vAllNodes)
+Output: vEffectMatrix - vEffectMatrix[i][j] is the objective value from vPlanNodeIdxs[i] to vPlanNodeIdxs[j]
+Return: none
+Others: none
+*************************************************/
+void OP::PlanObjectMatrix(const ConfidenceMap & vConfidenceMap,
+	                                  const std::vector<int> & vPlanNodeIdxs,
+	                       std::vector<std::vector<float> > & vEffectMatrix){
+
+	UpdateObjectCache(vConfidenceMap);
+	m_iObjectEvalNum = 0;
+
+	vEffectMatrix.assign(vPlanNodeIdxs.size(), std::vector<float>(vPlanNodeIdxs.size(), 0.0));
+
+	//construct a measured matrix among unvisited nodes
+	for (int i = 0; i != vPlanNodeIdxs.size(); ++i)
+		for (int j = 0; j != vPlanNodeIdxs.size(); ++j)
+			vEffectMatrix[i][j] = CachedObjective(vConfidenceMap, vPlanNodeIdxs[i], vPlanNodeIdxs[j]);
+
+	std::cout << "objective cache: " << m_iObjectEvalNum << " of "
+	          << vPlanNodeIdxs.size() * vPlanNodeIdxs.size() << " values are computed" << std::endl;
+
+}
+
 /*************************************************
 Function: TwoDDistance
 Description: compute distance
@@ -641,22 +882,19 @@ Return: float distance
 Others: none
 *************************************************/
 bool OP::GTR(const pcl::PointXYZ & oCurOdom,
-	         const std::vector<ConfidenceValue> & vConfidenceMap) {
+	         const ConfidenceMap & vConfidenceMap) {
 
 	//whatever the robot successfully reached target node 
+	MarkVisited(m_iCurrNodeIdx);
 	m_vAllNodes[m_iCurrNodeIdx].point.x = oCurOdom.x;
 	m_vAllNodes[m_iCurrNodeIdx].point.y = oCurOdom.y;
 	//m_vAllNodes[m_iCurrNodeIdx].point.z = 0.0;
-	m_vAllNodes[m_iCurrNodeIdx].visitedFlag = true;
 	//record at node trajectory
     m_vPastNodeIdxs.push_back(m_iCurrNodeIdx);
 
 	//check whether all are completed
 	std::vector<int> vPlanNodeIdxs;
-	for (int i = 0; i != m_vAllNodes.size();++i) {
-		if (!m_vAllNodes[i].visitedFlag)
-			vPlanNodeIdxs.push_back(i);
-    }
+	m_oNodeIndex.SortedNodeIdxs(vPlanNodeIdxs);
 
     //define output
 	//if there are not any new nodes shoule be invoked
@@ -665,6 +903,9 @@ bool OP::GTR(const pcl::PointXYZ & oCurOdom,
     }
 
 
+    //the current node is moved to the robot position
+    UpdateObjectCache(vConfidenceMap);
+
     int iMinIdx;
     float fMinMeasure = FLT_MAX;
 	//to each unselected point
@@ -673,9 +914,7 @@ bool OP::GTR(const pcl::PointXYZ & oCurOdom,
 		int iTargetIdx = vPlanNodeIdxs[i];
 
 		//cost function which considers the reward and cost of node
-		float fPairMeasure = ObjectiveFunction(vConfidenceMap,
-			                                   m_vAllNodes[m_iCurrNodeIdx], 
-			                                   m_vAllNodes[iTargetIdx]);
+		float fPairMeasure = CachedObjective(vConfidenceMap, m_iCurrNodeIdx, iTargetIdx);
 			   
 		//find the shorest route
 		if (fPairMeasure < fMinMeasure) {
@@ -705,13 +944,13 @@ Return: float distance
 Others: none
 *************************************************/
 bool OP::BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
-	                       const std::vector<ConfidenceValue> & vConfidenceMap) {
+	                       const ConfidenceMap & vConfidenceMap) {
 
     //whatever the robot successfully reached target node 
+	MarkVisited(m_iCurrNodeIdx);
 	m_vAllNodes[m_iCurrNodeIdx].point.x = oCurOdom.x;
 	m_vAllNodes[m_iCurrNodeIdx].point.y = oCurOdom.y;
 	//m_vAllNodes[m_iCurrNodeIdx].point.z = 0.0;
-	m_vAllNodes[m_iCurrNodeIdx].visitedFlag = true;
 	//record at node trajectory
     m_vPastNodeIdxs.push_back(m_iCurrNodeIdx);
 
@@ -755,11 +994,8 @@ bool OP::BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
 
    	//check which points are need to be planed
 	std::vector<int> vPlanNodeIdxs;
-	vPlanNodeIdxs.push_back(m_iCurrNodeIdx);
-	for (int i = 0; i != m_vAllNodes.size();++i) {
-		if (!m_vAllNodes[i].visitedFlag)
-			vPlanNodeIdxs.push_back(i);
-    }
+	m_oNodeIndex.SortedNodeIdxs(vPlanNodeIdxs);
+	vPlanNodeIdxs.insert(vPlanNodeIdxs.begin(), m_iCurrNodeIdx);
 
 	//still check again if some nodes has been removed in updating map
 	if (vPlanNodeIdxs.size() < 2){
@@ -767,30 +1003,9 @@ bool OP::BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
     }
 
     //construct a directed graph for remained nodes
-	//effective matrix
+	//effective matrix, only the values of changed nodes are computed again
 	std::vector<std::vector<float>> vEffectMatrix;
-	std::vector<float> vArray(vPlanNodeIdxs.size(), 0.0);
-	for (int i = 0; i != vPlanNodeIdxs.size(); ++i) {
-		vEffectMatrix.push_back(vArray);
-	}
-	
-	//construct a measured matrix among unvisited nodes
-	for (int i = 0; i != vPlanNodeIdxs.size(); ++i) {
-
-		int iSourceIdx = vPlanNodeIdxs[i];
-
-		for(int j = 0; j != vPlanNodeIdxs.size(); ++j) {
-			
-			//compute the real cost using the given cost function
-			int iTargetIdx =vPlanNodeIdxs[j];
-
-			//cost function which considers the reward and cost of node
-			vEffectMatrix[i][j] = ObjectiveFunction(vConfidenceMap,
-			                                        m_vAllNodes[iSourceIdx], 
-			                                        m_vAllNodes[iTargetIdx]);
-
-		}//end if(vUnVisitedStatus[i])
-	}
+	PlanObjectMatrix(vConfidenceMap, vPlanNodeIdxs, vEffectMatrix);
 
     //input the matrix to bb object
 	BBSolver.ObjectiveMatrix(vEffectMatrix);
@@ -798,7 +1013,11 @@ bool OP::BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
 	std::vector<int> vResTour;
 	//output without the frist element, the frist one of output is the goal(next best node)
 	//use the non-closed type
-	float fBestEffective = BBSolver.SolveOP(vResTour);  
+	float fBestEffective;
+	if (m_iOPSolverType)
+		fBestEffective = BBSolver.SolveOPExact(vResTour);
+	else
+		fBestEffective = BBSolver.SolveOP(vResTour);
 	std::cout << "new plan! and the best effective is " << fBestEffective << std::endl;
 	
 	for (int i = 1; i != vResTour.size(); ++i) {//start from 1
@@ -821,6 +1040,119 @@ bool OP::BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
 
 }
 
+/*************************************************
+Function: AnytimeMethod
+Description: plan the tour of unvisited nodes in a time budget
+Calls: PlanObjectMatrix
+       AnytimeOP::StopBackground
+       AnytimeOP::Solve
+       AnytimeOP::StartBackground
+Called By: TopologyMap::PlanNextGoal
+Table Accessed: none
+Table Updated: none
+Input: oCurOdom - the current robot position
+       vConfidenceMap - the confidence map
+Output: m_vPlanNodeIdxs - the new plan
+        m_iCurrNodeIdx - the next best node (goal)
+Return: true if all nodes are visited
+Others: the tour is replanned at each node with the latest node values,
+        it starts from the better one of the greedy tour (the same as GTR) and the tour improved in background,
+        after the goal is chosen, the rest of tour is improved in background until the robot arrives at the goal
+*************************************************/
+bool OP::AnytimeMethod(const pcl::PointXYZ & oCurOdom,
+	                   const ConfidenceMap & vConfidenceMap) {
+
+	//whatever the robot successfully reached target node 
+	MarkVisited(m_iCurrNodeIdx);
+	m_vAllNodes[m_iCurrNodeIdx].point.x = oCurOdom.x;
+	m_vAllNodes[m_iCurrNodeIdx].point.y = oCurOdom.y;
+	//record at node trajectory
+    m_vPastNodeIdxs.push_back(m_iCurrNodeIdx);
+
+    //get the tour improved since the last node
+    std::vector<int> vBackTour;
+    m_oAnytimeSolver.StopBackground(vBackTour);
+
+   	//check which points are need to be planed
+	std::vector<int> vPlanNodeIdxs;
+	m_oNodeIndex.SortedNodeIdxs(vPlanNodeIdxs);
+	vPlanNodeIdxs.insert(vPlanNodeIdxs.begin(), m_iCurrNodeIdx);
+
+    m_vPlanNodeIdxs.clear();
+
+	//all nodes are visited
+	if (vPlanNodeIdxs.size() < 2){
+		m_vBackNodeIdxs.clear();
+		return true;
+    }
+
+	//construct a measured matrix among unvisited nodes
+	std::vector<std::vector<float> > vEffectMatrix;
+	PlanObjectMatrix(vConfidenceMap, vPlanNodeIdxs, vEffectMatrix);
+
+	//the greedy seed
+	std::vector<int> vSeedTour;
+	AnytimeOP::GreedyTour(vEffectMatrix, vSeedTour);
+	float fSeedCost = AnytimeOP::TourCost(vEffectMatrix, vSeedTour);
+
+	//the background seed, whose removed nodes are skipped and new nodes are inserted
+	if (vBackTour.size()){
+
+		//the position of each node in this plan
+		std::vector<int> vPlanPos(m_vAllNodes.size(), -1);
+		for (int i = 1; i != vPlanNodeIdxs.size(); ++i)
+			vPlanPos[vPlanNodeIdxs[i]] = i;
+
+		std::vector<int> vBackSeedTour(1, 0);
+		for (int i = 0; i != vBackTour.size(); ++i){
+			int iPos = vPlanPos[m_vBackNodeIdxs[vBackTour[i]]];
+			if (iPos > 0)
+				vBackSeedTour.push_back(iPos);
+		}
+		AnytimeOP::CompleteTour(vEffectMatrix, vBackSeedTour);
+
+		float fBackSeedCost = AnytimeOP::TourCost(vEffectMatrix, vBackSeedTour);
+		if (fBackSeedCost < fSeedCost){
+			vSeedTour.swap(vBackSeedTour);
+			fSeedCost = fBackSeedCost;
+		}
+
+	}//end if vBackTour.size()
+
+	//improve the tour in the time budget
+	std::vector<int> vResTour;
+	float fBestEffective = m_oAnytimeSolver.Solve(vEffectMatrix, vSeedTour, vResTour, m_dOPTimeBudget);
+	std::cout << "anytime plan! seed effective is " << fSeedCost
+	          << " and the best effective is " << fBestEffective << std::endl;
+
+	for (int i = 1; i != vResTour.size(); ++i) {//start from 1
+		int iNodeIdx = vPlanNodeIdxs[vResTour[i]];
+	    m_vPlanNodeIdxs.push_back(iNodeIdx);
+        //print the plan
+		PrintPlanNodes(m_vAllNodes[iNodeIdx].gridIdx, vConfidenceMap);
+		std::cout<<" -> ";
+	}
+	std::cout << std::endl;
+
+    //get the next best viewpoint
+	m_iCurrNodeIdx = m_vPlanNodeIdxs[0];
+
+	//improve the rest of tour (from the goal) until the robot arrives at the goal
+	m_vBackNodeIdxs = m_vPlanNodeIdxs;
+	std::vector<std::vector<float> > vBackMatrix(vResTour.size() - 1,
+	                                             std::vector<float>(vResTour.size() - 1, 0.0));
+	std::vector<int> vBackSeedTour(vResTour.size() - 1, 0);
+	for (int i = 1; i != vResTour.size(); ++i) {
+		vBackSeedTour[i - 1] = i - 1;
+		for (int j = 1; j != vResTour.size(); ++j)
+			vBackMatrix[i - 1][j - 1] = vEffectMatrix[vResTour[i]][vResTour[j]];
+	}
+	m_oAnytimeSolver.StartBackground(vBackMatrix, vBackSeedTour);
+
+	return false;
+
+}
+
 /*************************************************
 Function: TwoDDistance
 Description: compute distance
@@ -910,11 +1242,12 @@ void OP::OutputUnvisitedNodes(std::vector<pcl::PointXYZ> & vOutputNodes){
 
 	vOutputNodes.clear();
 
+	std::vector<int> vUnvisitedIdxs;
+	m_oNodeIndex.SortedNodeIdxs(vUnvisitedIdxs);
+
 	//assignment
-	for (int i = 0; i != m_vAllNodes.size(); ++i){
-		if(!m_vAllNodes[i].visitedFlag)
-			vOutputNodes.push_back(m_vAllNodes[i].point);
-	}
+	for (int i = 0; i != vUnvisitedIdxs.size(); ++i)
+		vOutputNodes.push_back(m_vAllNodes[vUnvisitedIdxs[i]].point);
 
 }
 
@@ -947,6 +1280,70 @@ void OP::OutputGoalPos(int & iGoalGridIdx){
 
 }
 
+/*************************************************
+Function: OutputNodeLists
+Description: output the node lists which are not public
+Calls: none
+Called By: TopologyMap::SaveCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: iCurrNodeIdx - the current node (goal) index
+        vPlanNodeIdxs - the nodes to be visited
+        vPastNodeIdxs - the visited nodes
+Return: none
+Others: the node list itself is m_vAllNodes
+*************************************************/
+void OP::OutputNodeLists(int & iCurrNodeIdx,
+	                     std::vector<int> & vPlanNodeIdxs,
+	                     std::vector<int> & vPastNodeIdxs) const{
+
+	iCurrNodeIdx = m_iCurrNodeIdx;
+	vPlanNodeIdxs = m_vPlanNodeIdxs;
+	vPastNodeIdxs = m_vPastNodeIdxs;
+
+}
+
+/*************************************************
+Function: RestoreNodes
+Description: restore the nodes and node lists from a checkpoint
+Calls: AddNode
+       NodeGridIndex::Reset
+Called By: TopologyMap::ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: vAllNodes - all generated nodes
+       iCurrNodeIdx - the current node (goal) index
+       vPlanNodeIdxs - the nodes to be visited
+       vPastNodeIdxs - the visited nodes
+       oFeatureMap - the grid map, whose resolution aligns the node index
+Output: m_vAllNodes - the node list
+        m_oNodeIndex - the index of unvisited nodes
+Return: none
+Others: it replaces Initial, the objective cache and the background tour are dropped
+*************************************************/
+void OP::RestoreNodes(const std::vector<Node> & vAllNodes,
+	                  const int & iCurrNodeIdx,
+	                  const std::vector<int> & vPlanNodeIdxs,
+	                  const std::vector<int> & vPastNodeIdxs,
+	                  const grid_map::GridMap & oFeatureMap){
+
+	m_vAllNodes.clear();
+	m_oNodeIndex.Reset(oFeatureMap.getResolution(), 1.0);
+	m_vObjectCache.clear();
+	m_vCacheStates.clear();
+	m_vBackNodeIdxs.clear();
+
+	//the unvisited nodes are indexed again
+	for (int i = 0; i != int(vAllNodes.size()); ++i)
+		AddNode(vAllNodes[i]);
+
+	m_iCurrNodeIdx = iCurrNodeIdx;
+	m_vPlanNodeIdxs = vPlanNodeIdxs;
+	m_vPastNodeIdxs = vPastNodeIdxs;
+
+}
+
 
 /*************************************************
 Function: TwoDDistance
@@ -962,7 +1359,7 @@ Return: float distance
 Others: none
 *************************************************/
 void OP::PrintPlanNodes(const int & iQueryIdx,
-	                    const std::vector<ConfidenceValue> & vConfidenceMap){
+	                    const ConfidenceMap & vConfidenceMap){
 
 
 	std::cout << " node id is " << iQueryIdx
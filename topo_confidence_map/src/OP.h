@@ -2,6 +2,8 @@
 #define OP_H
 #include <queue>
 #include "BranchBound.h"
+#include "AnytimeOP.h"
+#include "NodeGridIndex.h"
 #include "ConfidenceMap.h"
 
 
@@ -28,6 +30,17 @@ struct Node{
 
 };
 
+//the node state used by the objective cache
+//a cached objective value is out of date once the state of its nodes is changed
+struct NodeCacheState{
+	//the position
+	float x;
+	float y;
+	//the total value of node grid
+	float value;
+
+};
+
 //OP class
 //OP is the orienteering problem
 //
@@ -40,10 +53,28 @@ public:
 	//destructor
 	~OP();
 
+    //set the solver of BranchBoundMethod
+    //0 is the raw branch and bound, 1 is the exact solver (dynamic programming for small node sets and pruned branch and bound)
+    //2 is the anytime solver (AnytimeMethod) which replaces both GTR and BranchBoundMethod
+	void SetOPSolver(const int & iSolverType,
+	                 const int & iDPMaxNodeNum = 16,
+	                 const double & dTimeBudget = 50.0);
+
+	//get the solver type
+	inline int GetOPSolverType() const{
+
+		return m_iOPSolverType;
+
+	};
+
     //initial the orginal robot location as the first node
 	void Initial(const pcl::PointXYZ & oOriginPoint,
 	             const grid_map::GridMap & oFeatureMap);
 
+	//update the grid index of nodes after the map is moved (rolling map)
+	//the unvisited nodes out of map are labeled as visited, return their number
+	int ShiftGrids(const grid_map::GridMap & oFeatureMap);
+
 	//judge whether the robot is close/near the goal node (movement target)
 	//choose the next best view as soon as the robot is inside the target region  
 	bool NearGoal(const std::queue<pcl::PointXYZ> & vOdoms,
@@ -63,30 +94,30 @@ public:
 	bool CheckNodeTimes();
 
     //check whether the grid is wide
-	bool IsWideGrid(const std::vector<ConfidenceValue> & vConfidenceMap,
+	bool IsWideGrid(const ConfidenceMap & vConfidenceMap,
 	                                              const int & iQueryIdx);
 
 	//get the current node index
-	void GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
+	void GetNewNode(const ConfidenceMap & vConfidenceMap,
 	                                            const int & iNewNodeIdx,
 			                          const pcl::PointXYZ & oNodePoints);
-	void GetNewNode(const std::vector<ConfidenceValue> & vConfidenceMap,
+	void GetNewNode(const ConfidenceMap & vConfidenceMap,
 	                              const std::vector<int> & vNewNodeIdxs,
 			          const std::vector<pcl::PointXYZ> & vNewNodeClouds);
 
 	//get the newly generated nodes
-	void GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceMap,
+	void GetNewNodeSuppression(const ConfidenceMap & vConfidenceMap,
 	                                                       const int & iNewNodeIdx,
 			                                      const pcl::PointXYZ & oNodePoint,
 					                                     float fSuppressionR = 1.0);
 
-	void GetNewNodeSuppression(const std::vector<ConfidenceValue> & vConfidenceMap,
+	void GetNewNodeSuppression(const ConfidenceMap & vConfidenceMap,
 		                                     const std::vector<int> & vNewNodeIdxs,
 			                     const std::vector<pcl::PointXYZ> & vNewNodeClouds,
 					                                     float fSuppressionR = 1.0);
 
     //update the node value
-	bool UpdateNodes(const std::vector<ConfidenceValue> & vConfidenceMap,
+	bool UpdateNodes(const ConfidenceMap & vConfidenceMap,
 	                                                float fWideThr = 0.7,
 	                                             float fNonWideThr = 0.8);
 
@@ -96,17 +127,34 @@ public:
 
 
 	//the measured function of a pairs of nodes
-    float ObjectiveFunction(const std::vector<ConfidenceValue> & vConfidenceMap,
+    float ObjectiveFunction(const ConfidenceMap & vConfidenceMap,
 	                                                    const Node & oQueryNode,
 	                                                   const Node & oTargetNode);
 
+    //refresh the objective cache, only the values of changed nodes are removed
+    void UpdateObjectCache(const ConfidenceMap & vConfidenceMap);
+
+    //the objective value of two nodes from the cache
+    float CachedObjective(const ConfidenceMap & vConfidenceMap,
+	                                                 const int & iQueryIdx,
+	                                                const int & iTargetIdx);
+
+    //the objective matrix of the planned nodes
+    void PlanObjectMatrix(const ConfidenceMap & vConfidenceMap,
+	                                  const std::vector<int> & vPlanNodeIdxs,
+	                       std::vector<std::vector<float> > & vEffectMatrix);
+
     //greed method
     bool GTR(const pcl::PointXYZ & oCurOdom,
-	         const std::vector<ConfidenceValue> & vConfidenceMap);
+	         const ConfidenceMap & vConfidenceMap);
 
     //branch and bound method to solve op problem
     bool BranchBoundMethod(const pcl::PointXYZ & oCurOdom,
-	                       const std::vector<ConfidenceValue> & vConfidenceMap);
+	                       const ConfidenceMap & vConfidenceMap);
+
+    //anytime method to solve op problem in a time budget
+    bool AnytimeMethod(const pcl::PointXYZ & oCurOdom,
+	                   const ConfidenceMap & vConfidenceMap);
 
     //local path
     bool LocalPathOptimization(const pcl::PointCloud<pcl::PointXYZ>::Ptr & pAttractorCloud, 
@@ -124,15 +172,32 @@ public:
     //get goal grid idx
     void OutputGoalPos(int & iGoalGridIdx);
 
+    //output the node lists and restore them (checkpoint)
+    void OutputNodeLists(int & iCurrNodeIdx,
+                         std::vector<int> & vPlanNodeIdxs,
+                         std::vector<int> & vPastNodeIdxs) const;
+
+    void RestoreNodes(const std::vector<Node> & vAllNodes,
+                      const int & iCurrNodeIdx,
+                      const std::vector<int> & vPlanNodeIdxs,
+                      const std::vector<int> & vPastNodeIdxs,
+                      const grid_map::GridMap & oFeatureMap);
+
     //some functions for test
     void PrintPlanNodes(const int & iQueryIdx,
-	                    const std::vector<ConfidenceValue> & vConfidenceMap);  
+	                    const ConfidenceMap & vConfidenceMap);  
 
     //all generated nodes
 	std::vector<Node> m_vAllNodes;
 
 private:
 
+	//add a node into the node list and the node index
+	void AddNode(const Node & oNewNode);
+
+	//label a node as visited and remove it from the node index
+	void MarkVisited(const int & iNodeIdx);
+
 	//the grid index of which current robot is 
 	//it also will became the target idx after using plan function
 	//this value will be the core variable in path plan 
@@ -147,6 +212,31 @@ private:
 	//branch and bound based method's object
 	BranchBound BBSolver;
 
+	//the solver type of BranchBoundMethod
+	int m_iOPSolverType;
+
+	//anytime solver's object
+	AnytimeOP m_oAnytimeSolver;
+
+	//the time budget of anytime solver (millisecond)
+	double m_dOPTimeBudget;
+
+	//the uniform grid hash of unvisited nodes
+	NodeGridIndex m_oNodeIndex;
+
+	//the cached objective values, m_vObjectCache[i][j] is from node i to node j (index is in m_vAllNodes)
+	//a negative value means the value is not computed
+	std::vector<std::vector<float> > m_vObjectCache;
+
+	//the node states when the cache is refreshed
+	std::vector<NodeCacheState> m_vCacheStates;
+
+	//the number of objective values computed since the last plan
+	int m_iObjectEvalNum;
+
+	//the nodes of tour improved in background, the first one is the goal (index is in m_vAllNodes)
+	std::vector<int> m_vBackNodeIdxs;
+
 };
 
 }/*namespace*/
@@ -0,0 +1,818 @@
+#include "QuickHull.h"
+
+namespace topology_map {
+
+/*************************************************
+Function: QuickHull
+Description: constrcution function for QuickHull class
+Calls: Clear
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+QuickHull::QuickHull(){
+
+	Clear();
+
+}
+
+/*************************************************
+Function: ~QuickHull
+Description: destrcution function for QuickHull class
+Calls: none
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+QuickHull::~QuickHull(){
+
+	//nothing
+
+}
+
+/*************************************************
+Function: Clear
+Description: clear all points and faces, the memory is retained for reuse
+Calls: none
+Called By: QuickHull
+           GHPR::ComputeVisibility
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: an empty hull
+Return: none
+Others: none
+*************************************************/
+void QuickHull::Clear(){
+
+	m_vPoints.clear();
+	m_vFaces.clear();
+	m_vFreeFaces.clear();
+	m_vPendingFaces.clear();
+	m_vHorizonStamp.clear();
+	m_vHorizonFace.clear();
+
+	m_iStamp = 0;
+	m_iInsertedNum = 0;
+	m_dEps = 0.0;
+	m_dMaxCoor[0] = m_dMaxCoor[1] = m_dMaxCoor[2] = 0.0;
+	m_dCenter[0] = m_dCenter[1] = m_dCenter[2] = 0.0;
+	m_iWalkSeed = 1;
+	m_bReady = false;
+
+}
+
+/*************************************************
+Function: Reserve
+Description: reserve the point storage
+Calls: none
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: iPointNum - the expected point number
+Output: none
+Return: none
+Others: none
+*************************************************/
+void QuickHull::Reserve(const int & iPointNum){
+
+	m_vPoints.reserve(3 * iPointNum);
+
+}
+
+/*************************************************
+Function: ComputeTolerance
+Description: compute the tolerance of plane test based on the coordinate range
+Calls: none
+Called By: Build
+           InsertNewPoints
+Table Accessed: none
+Table Updated: none
+Input: iBeginIdx - the first point involved
+Output: m_dEps - tolerance
+Return: none
+Others: the same rule as qhull, i.e., 3 * DBL_EPSILON * (max|x| + max|y| + max|z|)
+*************************************************/
+void QuickHull::ComputeTolerance(const int & iBeginIdx){
+
+	for (int i = iBeginIdx; i < PointNum(); ++i){
+		for (int k = 0; k != 3; ++k){
+			double dAbsCoor = fabs(m_vPoints[3 * i + k]);
+			if (dAbsCoor > m_dMaxCoor[k])
+				m_dMaxCoor[k] = dAbsCoor;
+		}
+	}//end for i
+
+	m_dEps = 3.0 * DBL_EPSILON * (m_dMaxCoor[0] + m_dMaxCoor[1] + m_dMaxCoor[2]);
+
+}
+
+/*************************************************
+Function: NewFace
+Description: generate a new face with given vertices and compute its plane
+Calls: none
+Called By: InitialSimplex
+           ExpandFace
+Table Accessed: none
+Table Updated: none
+Input: iVertexA, iVertexB, iVertexC - vertices in counter clockwise order (seen from outside)
+Output: a new face in m_vFaces
+Return: the face index
+Others: the neighbors are not set here
+*************************************************/
+int QuickHull::NewFace(const int & iVertexA,
+	                   const int & iVertexB,
+	                   const int & iVertexC){
+
+	int iFaceIdx;
+	//reuse a dead face if possible
+	if (m_vFreeFaces.size()){
+		iFaceIdx = m_vFreeFaces.back();
+		m_vFreeFaces.pop_back();
+	}else{
+		iFaceIdx = m_vFaces.size();
+		m_vFaces.push_back(HullFace());
+	}
+
+	HullFace & oFace = m_vFaces[iFaceIdx];
+	oFace.vertex[0] = iVertexA;
+	oFace.vertex[1] = iVertexB;
+	oFace.vertex[2] = iVertexC;
+	oFace.neighbor[0] = oFace.neighbor[1] = oFace.neighbor[2] = -1;
+	oFace.vOutsideIdxs.clear();
+	oFace.alive = true;
+	oFace.visitStamp = 0;
+
+	//normal = (B - A) x (C - A)
+	const double * pA = &m_vPoints[3 * iVertexA];
+	const double * pB = &m_vPoints[3 * iVertexB];
+	const double * pC = &m_vPoints[3 * iVertexC];
+	double vAB[3] = { pB[0] - pA[0], pB[1] - pA[1], pB[2] - pA[2] };
+	double vAC[3] = { pC[0] - pA[0], pC[1] - pA[1], pC[2] - pA[2] };
+
+	oFace.normal[0] = vAB[1] * vAC[2] - vAB[2] * vAC[1];
+	oFace.normal[1] = vAB[2] * vAC[0] - vAB[0] * vAC[2];
+	oFace.normal[2] = vAB[0] * vAC[1] - vAB[1] * vAC[0];
+
+	double dNorm = sqrt(oFace.normal[0] * oFace.normal[0]
+	                  + oFace.normal[1] * oFace.normal[1]
+	                  + oFace.normal[2] * oFace.normal[2]);
+
+	//a sliver face is never visible
+	if (dNorm > 0.0){
+		oFace.normal[0] /= dNorm;
+		oFace.normal[1] /= dNorm;
+		oFace.normal[2] /= dNorm;
+	}
+
+	//the plane passes the centroid of face
+	oFace.offset = (oFace.normal[0] * (pA[0] + pB[0] + pC[0])
+	              + oFace.normal[1] * (pA[1] + pB[1] + pC[1])
+	              + oFace.normal[2] * (pA[2] + pB[2] + pC[2])) / 3.0;
+
+	return iFaceIdx;
+
+}
+
+/*************************************************
+Function: DeleteFace
+Description: kill a face and push it into the free list
+Calls: none
+Called By: ExpandFace
+Table Accessed: none
+Table Updated: none
+Input: iFaceIdx - the face index
+Output: none
+Return: none
+Others: the outside list keeps its capacity for the next reuse
+*************************************************/
+void QuickHull::DeleteFace(const int & iFaceIdx){
+
+	m_vFaces[iFaceIdx].alive = false;
+	m_vFaces[iFaceIdx].vOutsideIdxs.clear();
+	m_vFreeFaces.push_back(iFaceIdx);
+
+}
+
+/*************************************************
+Function: InitialSimplex
+Description: construct the initial tetrahedron from the extreme points
+Calls: NewFace
+       AssignPoint
+Called By: Build
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: four faces and their outside lists
+Return: false if the points are degenerate (coplanar or collinear)
+Others: none
+*************************************************/
+bool QuickHull::InitialSimplex(){
+
+	int iPointNum = PointNum();
+
+	//extreme points on each axis
+	int vExtremeIdx[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 1; i < iPointNum; ++i){
+		for (int k = 0; k != 3; ++k){
+			if (m_vPoints[3 * i + k] < m_vPoints[3 * vExtremeIdx[2 * k] + k])
+				vExtremeIdx[2 * k] = i;
+			if (m_vPoints[3 * i + k] > m_vPoints[3 * vExtremeIdx[2 * k + 1] + k])
+				vExtremeIdx[2 * k + 1] = i;
+		}
+	}//end for i
+
+	//the most distant pair of extreme points
+	int vSimplexIdx[4] = { -1, -1, -1, -1 };
+	double dMaxDis = -1.0;
+	for (int i = 0; i != 6; ++i){
+		for (int j = i + 1; j != 6; ++j){
+			const double * pI = &m_vPoints[3 * vExtremeIdx[i]];
+			const double * pJ = &m_vPoints[3 * vExtremeIdx[j]];
+			double dDis = (pI[0] - pJ[0]) * (pI[0] - pJ[0])
+			            + (pI[1] - pJ[1]) * (pI[1] - pJ[1])
+			            + (pI[2] - pJ[2]) * (pI[2] - pJ[2]);
+			if (dDis > dMaxDis){
+				dMaxDis = dDis;
+				vSimplexIdx[0] = vExtremeIdx[i];
+				vSimplexIdx[1] = vExtremeIdx[j];
+			}
+		}
+	}//end for i
+
+	if (sqrt(dMaxDis) <= m_dEps)
+		return false;
+
+	//the point farthest from the line
+	const double * pA = &m_vPoints[3 * vSimplexIdx[0]];
+	const double * pB = &m_vPoints[3 * vSimplexIdx[1]];
+	double vLine[3] = { pB[0] - pA[0], pB[1] - pA[1], pB[2] - pA[2] };
+	double dLineNorm = sqrt(dMaxDis);
+	dMaxDis = -1.0;
+	for (int i = 0; i < iPointNum; ++i){
+		const double * pP = &m_vPoints[3 * i];
+		double vAP[3] = { pP[0] - pA[0], pP[1] - pA[1], pP[2] - pA[2] };
+		double vCross[3] = { vAP[1] * vLine[2] - vAP[2] * vLine[1],
+		                     vAP[2] * vLine[0] - vAP[0] * vLine[2],
+		                     vAP[0] * vLine[1] - vAP[1] * vLine[0] };
+		double dDis = vCross[0] * vCross[0] + vCross[1] * vCross[1] + vCross[2] * vCross[2];
+		if (dDis > dMaxDis){
+			dMaxDis = dDis;
+			vSimplexIdx[2] = i;
+		}
+	}//end for i
+
+	if (sqrt(dMaxDis) / dLineNorm <= m_dEps)
+		return false;
+
+	//the point farthest from the plane
+	int iBaseFace = NewFace(vSimplexIdx[0], vSimplexIdx[1], vSimplexIdx[2]);
+	dMaxDis = -1.0;
+	for (int i = 0; i < iPointNum; ++i){
+		double dDis = fabs(PointToFace(m_vFaces[iBaseFace], i));
+		if (dDis > dMaxDis){
+			dMaxDis = dDis;
+			vSimplexIdx[3] = i;
+		}
+	}//end for i
+
+	bool bAboveFlag = PointToFace(m_vFaces[iBaseFace], vSimplexIdx[3]) > 0.0;
+	m_vFaces.clear();
+	m_vFreeFaces.clear();
+
+	if (dMaxDis <= m_dEps)
+		return false;
+
+	//make sure the fourth point is behind the base face
+	if (bAboveFlag)
+		std::swap(vSimplexIdx[1], vSimplexIdx[2]);
+
+	//the centroid is always inside the hull since the hull only grows
+	for (int k = 0; k != 3; ++k){
+		m_dCenter[k] = (m_vPoints[3 * vSimplexIdx[0] + k] + m_vPoints[3 * vSimplexIdx[1] + k] +
+		                m_vPoints[3 * vSimplexIdx[2] + k] + m_vPoints[3 * vSimplexIdx[3] + k]) / 4.0;
+	}
+
+	//four faces, each of them is counter clockwise from outside
+	int vFaceIdxs[4];
+	vFaceIdxs[0] = NewFace(vSimplexIdx[0], vSimplexIdx[1], vSimplexIdx[2]);
+	vFaceIdxs[1] = NewFace(vSimplexIdx[0], vSimplexIdx[3], vSimplexIdx[1]);
+	vFaceIdxs[2] = NewFace(vSimplexIdx[1], vSimplexIdx[3], vSimplexIdx[2]);
+	vFaceIdxs[3] = NewFace(vSimplexIdx[2], vSimplexIdx[3], vSimplexIdx[0]);
+
+	//link the neighbors by matching the reversed edges
+	for (int i = 0; i != 4; ++i){
+		HullFace & oFace = m_vFaces[vFaceIdxs[i]];
+		for (int e = 0; e != 3; ++e){
+			int iEdgeA = oFace.vertex[e];
+			int iEdgeB = oFace.vertex[(e + 1) % 3];
+			for (int j = 0; j != 4; ++j){
+				if (i == j)
+					continue;
+				const HullFace & oOther = m_vFaces[vFaceIdxs[j]];
+				for (int k = 0; k != 3; ++k){
+					if (oOther.vertex[k] == iEdgeB && oOther.vertex[(k + 1) % 3] == iEdgeA)
+						oFace.neighbor[e] = vFaceIdxs[j];
+				}
+			}
+		}//end for e
+	}//end for i
+
+	//assign the other points to the faces
+	std::vector<int> vAllFaces(vFaceIdxs, vFaceIdxs + 4);
+	for (int i = 0; i < iPointNum; ++i){
+		if (i == vSimplexIdx[0] || i == vSimplexIdx[1] ||
+			i == vSimplexIdx[2] || i == vSimplexIdx[3])
+			continue;
+		AssignPoint(i, vAllFaces, true);
+	}//end for i
+
+	for (int i = 0; i != 4; ++i){
+		if (m_vFaces[vFaceIdxs[i]].vOutsideIdxs.size())
+			m_vPendingFaces.push_back(vFaceIdxs[i]);
+	}
+
+	return true;
+
+}
+
+/*************************************************
+Function: LocateFace
+Description: find the face hit by the ray from the interior center to a point,
+             by walking across the face adjacency
+Calls: none
+Called By: InsertNewPoints
+Table Accessed: none
+Table Updated: none
+Input: iPointIdx - the point index
+       iStartFace - an alive face where the walk starts (e.g., the last located face)
+Output: none
+Return: the face index, or -1 if the walk does not converge
+Others: the point is outside the hull if and only if it is above the located face,
+        the edge to cross is chosen randomly when several edges are valid (stochastic walk),
+        which makes sure the walk does not loop
+*************************************************/
+int QuickHull::LocateFace(const int & iPointIdx,
+	                      const int & iStartFace){
+
+	const double * pP = &m_vPoints[3 * iPointIdx];
+	double vCP[3] = { pP[0] - m_dCenter[0], pP[1] - m_dCenter[1], pP[2] - m_dCenter[2] };
+
+	int iCurrFace = iStartFace;
+	int iPrevFace = -1;
+	int iMaxStep = 2 * int(sqrt(double(m_vFaces.size()))) + 64;
+
+	for (int iStep = 0; iStep != iMaxStep; ++iStep){
+
+		const HullFace & oFace = m_vFaces[iCurrFace];
+
+		//check the three wedge planes spanned by the center and each edge
+		int vCrossEdges[3];
+		int iCrossNum = 0;
+		for (int e = 0; e != 3; ++e){
+
+			const double * pA = &m_vPoints[3 * oFace.vertex[e]];
+			const double * pB = &m_vPoints[3 * oFace.vertex[(e + 1) % 3]];
+			double vCA[3] = { pA[0] - m_dCenter[0], pA[1] - m_dCenter[1], pA[2] - m_dCenter[2] };
+			double vCB[3] = { pB[0] - m_dCenter[0], pB[1] - m_dCenter[1], pB[2] - m_dCenter[2] };
+			//the face is counter clockwise from outside, thus the inside of wedge is positive 
+			double dDet = vCP[0] * (vCA[1] * vCB[2] - vCA[2] * vCB[1])
+			            + vCP[1] * (vCA[2] * vCB[0] - vCA[0] * vCB[2])
+			            + vCP[2] * (vCA[0] * vCB[1] - vCA[1] * vCB[0]);
+
+			if (dDet < 0.0)
+				vCrossEdges[iCrossNum++] = e;
+
+		}//end for e
+
+		//the ray passes this face
+		if (!iCrossNum)
+			return iCurrFace;
+
+		//do not go back if there is another choice
+		if (iCrossNum > 1){
+			for (int i = 0; i != iCrossNum; ++i){
+				if (oFace.neighbor[vCrossEdges[i]] == iPrevFace){
+					vCrossEdges[i] = vCrossEdges[--iCrossNum];
+					break;
+				}
+			}
+		}
+
+		//stochastic walk
+		m_iWalkSeed = m_iWalkSeed * 1103515245u + 12345u;
+		int iEdge = vCrossEdges[(m_iWalkSeed >> 16) % iCrossNum];
+		iPrevFace = iCurrFace;
+		iCurrFace = oFace.neighbor[iEdge];
+
+	}//end for iStep
+
+	return -1;
+
+}
+
+/*************************************************
+Function: AssignPoint
+Description: assign a point to the outside list of one of the given faces
+Calls: PointToFace
+Called By: InitialSimplex
+           ExpandFace
+           InsertNewPoints
+Table Accessed: none
+Table Updated: none
+Input: iPointIdx - the point index
+       vFaceIdxs - the candidate faces
+       bFarthestFlag - choose the farthest face or the first visible one
+Output: the outside list of a face
+Return: true if the point is outside of one candidate face
+Others: none
+*************************************************/
+bool QuickHull::AssignPoint(const int & iPointIdx,
+	                        const std::vector<int> & vFaceIdxs,
+	                        bool bFarthestFlag){
+
+	int iBestFace = -1;
+	double dBestDis = m_dEps;
+
+	for (int i = 0; i != vFaceIdxs.size(); ++i){
+		double dDis = PointToFace(m_vFaces[vFaceIdxs[i]], iPointIdx);
+		if (dDis > dBestDis){
+			iBestFace = vFaceIdxs[i];
+			dBestDis = dDis;
+			if (!bFarthestFlag)
+				break;
+		}
+	}//end for i
+
+	if (iBestFace < 0)
+		return false;
+
+	m_vFaces[iBestFace].vOutsideIdxs.push_back(iPointIdx);
+	return true;
+
+}
+
+/*************************************************
+Function: ExpandFace
+Description: add the farthest outside point of a face to the hull, i.e.,
+             remove the faces visible from the point and connect the point to the horizon
+Calls: PointToFace
+       NewFace
+       DeleteFace
+       AssignPoint
+Called By: ProcessPendingFaces
+Table Accessed: none
+Table Updated: none
+Input: iFaceIdx - a face with non-empty outside list
+Output: updated faces
+Return: false if the horizon is not a simple loop (numerical failure)
+Others: none
+*************************************************/
+bool QuickHull::ExpandFace(const int & iFaceIdx){
+
+	//find the farthest point (eye point)
+	int iEyeIdx = -1;
+	double dMaxDis = -DBL_MAX;
+	const std::vector<int> & vOutsideIdxs = m_vFaces[iFaceIdx].vOutsideIdxs;
+	for (int i = 0; i != vOutsideIdxs.size(); ++i){
+		double dDis = PointToFace(m_vFaces[iFaceIdx], vOutsideIdxs[i]);
+		if (dDis > dMaxDis){
+			dMaxDis = dDis;
+			iEyeIdx = vOutsideIdxs[i];
+		}
+	}//end for i
+
+	//search the visible faces from eye point
+	++m_iStamp;
+	m_vVisibleFaces.clear();
+	m_vNewFaces.clear();
+	m_vSearchStack.clear();
+
+	m_vFaces[iFaceIdx].visitStamp = m_iStamp;
+	m_vSearchStack.push_back(iFaceIdx);
+
+	while (m_vSearchStack.size()){
+
+		int iCurrFace = m_vSearchStack.back();
+		m_vSearchStack.pop_back();
+		m_vVisibleFaces.push_back(iCurrFace);
+
+		for (int e = 0; e != 3; ++e){
+			int iNeighbor = m_vFaces[iCurrFace].neighbor[e];
+			if (m_vFaces[iNeighbor].visitStamp == m_iStamp)
+				continue;
+			if (PointToFace(m_vFaces[iNeighbor], iEyeIdx) > m_dEps){
+				m_vFaces[iNeighbor].visitStamp = m_iStamp;
+				m_vSearchStack.push_back(iNeighbor);
+			}
+		}//end for e
+
+	}//end while
+
+	//connect the eye point to each horizon edge
+	for (int i = 0; i != m_vVisibleFaces.size(); ++i){
+
+		int iVisFace = m_vVisibleFaces[i];
+
+		for (int e = 0; e != 3; ++e){
+
+			int iNeighbor = m_vFaces[iVisFace].neighbor[e];
+			if (m_vFaces[iNeighbor].visitStamp == m_iStamp)
+				continue;
+
+			//a horizon edge A->B
+			int iEdgeA = m_vFaces[iVisFace].vertex[e];
+			int iEdgeB = m_vFaces[iVisFace].vertex[(e + 1) % 3];
+
+			//each horizon vertex starts one edge only
+			if (m_vHorizonStamp[iEdgeA] == m_iStamp)
+				return false;
+
+			//NewFace may reallocate m_vFaces, thus no reference is kept here
+			int iNewFace = NewFace(iEdgeA, iEdgeB, iEyeIdx);
+			m_vFaces[iNewFace].neighbor[0] = iNeighbor;
+			m_vNewFaces.push_back(iNewFace);
+
+			m_vHorizonStamp[iEdgeA] = m_iStamp;
+			m_vHorizonFace[iEdgeA] = iNewFace;
+
+			//let the horizon face point to the new face
+			HullFace & oNeighbor = m_vFaces[iNeighbor];
+			for (int k = 0; k != 3; ++k){
+				if (oNeighbor.vertex[k] == iEdgeB && oNeighbor.vertex[(k + 1) % 3] == iEdgeA)
+					oNeighbor.neighbor[k] = iNewFace;
+			}
+
+		}//end for e
+
+	}//end for i
+
+	//link the new faces around the eye point
+	for (int i = 0; i != m_vNewFaces.size(); ++i){
+
+		HullFace & oNewFace = m_vFaces[m_vNewFaces[i]];
+		int iEdgeB = oNewFace.vertex[1];
+
+		if (m_vHorizonStamp[iEdgeB] != m_iStamp)
+			return false;
+
+		int iNextFace = m_vHorizonFace[iEdgeB];
+		//edge B->eye of this face is eye->B of the next face
+		oNewFace.neighbor[1] = iNextFace;
+		m_vFaces[iNextFace].neighbor[2] = m_vNewFaces[i];
+
+	}//end for i
+
+	//collect the outside points of visible faces
+	m_vOrphanIdxs.clear();
+	for (int i = 0; i != m_vVisibleFaces.size(); ++i){
+		const std::vector<int> & vVisOutside = m_vFaces[m_vVisibleFaces[i]].vOutsideIdxs;
+		for (int j = 0; j != vVisOutside.size(); ++j){
+			if (vVisOutside[j] != iEyeIdx)
+				m_vOrphanIdxs.push_back(vVisOutside[j]);
+		}
+		DeleteFace(m_vVisibleFaces[i]);
+	}//end for i
+
+	//reassign them to the new faces, the others are inside the hull now
+	for (int i = 0; i != m_vOrphanIdxs.size(); ++i)
+		AssignPoint(m_vOrphanIdxs[i], m_vNewFaces);
+
+	for (int i = 0; i != m_vNewFaces.size(); ++i){
+		if (m_vFaces[m_vNewFaces[i]].vOutsideIdxs.size())
+			m_vPendingFaces.push_back(m_vNewFaces[i]);
+	}
+
+	return true;
+
+}
+
+/*************************************************
+Function: ProcessPendingFaces
+Description: expand faces until no point is outside of the hull
+Calls: ExpandFace
+Called By: Build
+           InsertNewPoints
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the convex hull
+Return: false if the numerical failure happens
+Others: none
+*************************************************/
+bool QuickHull::ProcessPendingFaces(){
+
+	//make sure horizon records cover all points
+	if (m_vHorizonStamp.size() < PointNum()){
+		m_vHorizonStamp.resize(PointNum(), 0);
+		m_vHorizonFace.resize(PointNum(), -1);
+	}
+
+	while (m_vPendingFaces.size()){
+
+		int iFaceIdx = m_vPendingFaces.back();
+		m_vPendingFaces.pop_back();
+
+		//the face may be killed after pushing
+		if (!m_vFaces[iFaceIdx].alive || !m_vFaces[iFaceIdx].vOutsideIdxs.size())
+			continue;
+
+		if (!ExpandFace(iFaceIdx)){
+			m_bReady = false;
+			return false;
+		}
+
+	}//end while
+
+	return true;
+
+}
+
+/*************************************************
+Function: Build
+Description: construct the convex hull of all saved points
+Calls: ComputeTolerance
+       InitialSimplex
+       ProcessPendingFaces
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the convex hull
+Return: false if the points are degenerate or the numerical failure happens
+Others: none
+*************************************************/
+bool QuickHull::Build(){
+
+	m_vFaces.clear();
+	m_vFreeFaces.clear();
+	m_vPendingFaces.clear();
+	m_vHorizonStamp.assign(PointNum(), 0);
+	m_vHorizonFace.assign(PointNum(), -1);
+	m_iStamp = 0;
+	m_dMaxCoor[0] = m_dMaxCoor[1] = m_dMaxCoor[2] = 0.0;
+	m_bReady = false;
+
+	if (PointNum() < 4)
+		return false;
+
+	ComputeTolerance(0);
+
+	if (!InitialSimplex())
+		return false;
+
+	m_bReady = true;
+	m_iInsertedNum = PointNum();
+
+	return ProcessPendingFaces();
+
+}
+
+/*************************************************
+Function: InsertNewPoints
+Description: insert the points added after the last Build/InsertNewPoints
+Calls: ComputeTolerance
+       AssignPoint
+       ProcessPendingFaces
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the updated convex hull
+Return: false if the hull is not ready or the numerical failure happens
+Others: a point inside the current hull is simply dropped
+*************************************************/
+bool QuickHull::InsertNewPoints(){
+
+	if (!m_bReady)
+		return false;
+
+	int iBeginIdx = m_iInsertedNum;
+	m_iInsertedNum = PointNum();
+
+	if (iBeginIdx == m_iInsertedNum)
+		return true;
+
+	ComputeTolerance(iBeginIdx);
+
+	//gather current faces
+	std::vector<int> vAliveFaces;
+	vAliveFaces.reserve(m_vFaces.size());
+	for (int i = 0; i != m_vFaces.size(); ++i){
+		if (m_vFaces[i].alive)
+			vAliveFaces.push_back(i);
+	}
+
+	//put each new point in the outside list of the face hit by the ray from center
+	int iLastFace = vAliveFaces[0];
+	for (int i = iBeginIdx; i != m_iInsertedNum; ++i){
+
+		int iHitFace = LocateFace(i, iLastFace);
+
+		//scan all faces if the walk fails
+		if (iHitFace < 0){
+			AssignPoint(i, vAliveFaces);
+			continue;
+		}
+
+		iLastFace = iHitFace;
+		//a point inside the hull is dropped
+		if (PointToFace(m_vFaces[iHitFace], i) > m_dEps)
+			m_vFaces[iHitFace].vOutsideIdxs.push_back(i);
+
+	}//end for i
+
+	//several points may share a face, thus each face is pushed once
+	for (int i = 0; i != vAliveFaces.size(); ++i){
+		if (m_vFaces[vAliveFaces[i]].vOutsideIdxs.size())
+			m_vPendingFaces.push_back(vAliveFaces[i]);
+	}
+
+	return ProcessPendingFaces();
+
+}
+
+/*************************************************
+Function: GetVertexFlags
+Description: output whether each saved point is a vertex of hull
+Calls: none
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: vVertexFlags - true if the point is a hull vertex
+Return: none
+Others: none
+*************************************************/
+void QuickHull::GetVertexFlags(std::vector<bool> & vVertexFlags) const{
+
+	vVertexFlags.assign(PointNum(), false);
+
+	for (int i = 0; i != m_vFaces.size(); ++i){
+		if (m_vFaces[i].alive){
+			vVertexFlags[m_vFaces[i].vertex[0]] = true;
+			vVertexFlags[m_vFaces[i].vertex[1]] = true;
+			vVertexFlags[m_vFaces[i].vertex[2]] = true;
+		}
+	}//end for i
+
+}
+
+/*************************************************
+Function: GetVertexIndices
+Description: output the point index of each hull vertex
+Calls: GetVertexFlags
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: vVertexIdxs - point indices of hull vertices (ascending)
+Return: none
+Others: none
+*************************************************/
+void QuickHull::GetVertexIndices(std::vector<int> & vVertexIdxs) const{
+
+	std::vector<bool> vVertexFlags;
+	GetVertexFlags(vVertexFlags);
+
+	vVertexIdxs.clear();
+	for (int i = 0; i != vVertexFlags.size(); ++i){
+		if (vVertexFlags[i])
+			vVertexIdxs.push_back(i);
+	}
+
+}
+
+/*************************************************
+Function: FaceNum
+Description: count the alive faces
+Calls: none
+Called By: GHPR
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: the number of faces of current hull
+Others: none
+*************************************************/
+int QuickHull::FaceNum() const{
+
+	int iFaceNum = 0;
+	for (int i = 0; i != m_vFaces.size(); ++i){
+		if (m_vFaces[i].alive)
+			iFaceNum++;
+	}
+
+	return iFaceNum;
+
+}
+
+}/*namespace*/
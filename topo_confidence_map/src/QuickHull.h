@@ -0,0 +1,204 @@
+#ifndef QUICKHULL_H
+#define QUICKHULL_H
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+
+///************************************************************************///
+// a class to implement an incremental 3D convex hull based on quickhull
+// Barber C.B., Dobkin D.P., Huhdanpaa H., The quickhull algorithm for convex hulls,
+// ACM Transactions on Mathematical Software, 1996, 22(4):469-483.
+// different from pcl::ConvexHull (qhull), the faces, their adjacency and the conflict
+// (outside) lists are kept after construction, thus:
+// 1. hull vertices are reported by the input point index directly
+// 2. points arriving later can be inserted without rebuilding the hull
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the incremental quickhull used by the GHPR visibility engine
+
+///************************************************************************///
+
+namespace topology_map {
+
+//a triangle face of the hull
+//vertices are counter clockwise when the face is seen from outside
+struct HullFace{
+
+	//point index of each vertex
+	int vertex[3];
+	//face index across edge vertex[i] -> vertex[(i+1)%3]
+	int neighbor[3];
+	//outward unit normal and offset of face plane (n * p = offset)
+	double normal[3];
+	double offset;
+	//points which are outside of this face (conflict list)
+	std::vector<int> vOutsideIdxs;
+	//whether the face belongs to current hull
+	bool alive;
+	//visit stamp of the visible face searching
+	int visitStamp;
+
+	HullFace(){
+
+		alive = false;
+		visitStamp = 0;
+
+	};
+
+};
+
+//quickhull class
+//points are saved inside the object, call AddPoint then Build or InsertNewPoints
+class QuickHull{
+
+public:
+
+	//constructor
+	QuickHull();
+
+	//destructor
+	~QuickHull();
+
+	//clear all points and faces
+	void Clear();
+
+	//reserve the point storage
+	void Reserve(const int & iPointNum);
+
+	//add a point to the point storage, return its index
+	inline int AddPoint(const double & dX,
+	                    const double & dY,
+	                    const double & dZ){
+
+		m_vPoints.push_back(dX);
+		m_vPoints.push_back(dY);
+		m_vPoints.push_back(dZ);
+		return int(m_vPoints.size() / 3) - 1;
+
+	};
+
+	//the number of saved points
+	inline int PointNum() const{
+
+		return int(m_vPoints.size() / 3);
+
+	};
+
+	//whether a hull has been built
+	inline bool IsReady() const{
+
+		return m_bReady;
+
+	};
+
+	//the number of points that has been processed by Build/InsertNewPoints
+	inline int InsertedNum() const{
+
+		return m_iInsertedNum;
+
+	};
+
+	//construct the hull of all saved points
+	bool Build();
+
+	//insert the points added after the last Build/InsertNewPoints
+	bool InsertNewPoints();
+
+	//output whether each saved point is a vertex of hull
+	void GetVertexFlags(std::vector<bool> & vVertexFlags) const;
+
+	//output the point index of each hull vertex
+	void GetVertexIndices(std::vector<int> & vVertexIdxs) const;
+
+	//the number of alive faces
+	int FaceNum() const;
+
+private:
+
+	//signed distance from a point to a face plane
+	inline double PointToFace(const HullFace & oFace,
+	                          const int & iPointIdx) const{
+
+		const double * pPoint = &m_vPoints[3 * iPointIdx];
+		return oFace.normal[0] * pPoint[0] + oFace.normal[1] * pPoint[1]
+		     + oFace.normal[2] * pPoint[2] - oFace.offset;
+
+	};
+
+	//compute the tolerance based on the point coordinates
+	void ComputeTolerance(const int & iBeginIdx);
+
+	//get a new face (reused from dead faces if possible)
+	int NewFace(const int & iVertexA,
+	            const int & iVertexB,
+	            const int & iVertexC);
+
+	//kill a face and recycle it
+	void DeleteFace(const int & iFaceIdx);
+
+	//construct the initial tetrahedron
+	bool InitialSimplex();
+
+	//find the face hit by the ray from the interior center to a point
+	int LocateFace(const int & iPointIdx,
+	               const int & iStartFace);
+
+	//assign a point to the outside list of one of the given faces
+	bool AssignPoint(const int & iPointIdx,
+	                 const std::vector<int> & vFaceIdxs,
+	                 bool bFarthestFlag = false);
+
+	//add the farthest outside point of a face to the hull
+	bool ExpandFace(const int & iFaceIdx);
+
+	//process the faces with non-empty outside list
+	bool ProcessPendingFaces();
+
+	//point coordinates in x y z x y z ... order
+	std::vector<double> m_vPoints;
+
+	//all faces (include the dead one)
+	std::vector<HullFace> m_vFaces;
+
+	//dead faces which can be reused
+	std::vector<int> m_vFreeFaces;
+
+	//faces whose outside list is not empty
+	std::vector<int> m_vPendingFaces;
+
+	//the horizon recording
+	std::vector<int> m_vHorizonStamp;
+	std::vector<int> m_vHorizonFace;
+
+	//temps of each expanding, kept to avoid reallocation
+	std::vector<int> m_vVisibleFaces;
+	std::vector<int> m_vNewFaces;
+	std::vector<int> m_vOrphanIdxs;
+	std::vector<int> m_vSearchStack;
+
+	//the visit stamp
+	int m_iStamp;
+
+	//the number of points inserted in hull calculation
+	int m_iInsertedNum;
+
+	//tolerance of plane test
+	double m_dEps;
+	//maximum absolute coordinates, used by tolerance
+	double m_dMaxCoor[3];
+	//a point inside the hull (centroid of the initial tetrahedron)
+	double m_dCenter[3];
+	//random state of face walking
+	unsigned int m_iWalkSeed;
+
+	//whether the hull has been built
+	bool m_bReady;
+
+};
+
+}/*namespace*/
+
+#endif
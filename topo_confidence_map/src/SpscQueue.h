@@ -0,0 +1,184 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+///************************************************************************///
+// a class template to implement a bounded lock-free queue of one producer and one consumer
+// the elements are kept in a ring whose size is a power of two,
+// the producer only writes the tail and the consumer only writes the head,
+// so the two threads never wait for each other
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the queues between the ros callbacks, the map worker and the planning worker
+
+///************************************************************************///
+
+namespace topology_map {
+
+template <class T>
+class SpscQueue{
+
+public:
+
+	//constructor, the capacity is rounded up to a power of two
+	SpscQueue(int f_iCapacity = 64);
+
+	//destructor
+	~SpscQueue();
+
+	//called by the producer only, return false if the queue is full
+	bool Push(const T & oValue);
+
+	//called by the consumer only, return false if the queue is empty
+	bool Pop(T & oValue);
+
+	//the number of waiting elements, it is exact only in the producer or the consumer
+	inline int Size() const{
+
+		return int(m_iTail.load(std::memory_order_acquire) - m_iHead.load(std::memory_order_acquire));
+
+	};
+
+	//the maximum number of waiting elements
+	inline int Capacity() const{
+
+		return int(m_vSlots.size());
+
+	};
+
+private:
+
+	//forbid the copy
+	SpscQueue(const SpscQueue &);
+	SpscQueue & operator = (const SpscQueue &);
+
+	//the ring
+	std::vector<T> m_vSlots;
+	size_t m_iMask;
+
+	//the head and tail are in different cache lines to avoid false sharing
+	char m_cHeadPad[64];
+	//the next element to be popped, written by the consumer
+	std::atomic<size_t> m_iHead;
+	char m_cTailPad[64];
+	//the next slot to be pushed, written by the producer
+	std::atomic<size_t> m_iTail;
+	char m_cEndPad[64];
+
+};
+
+/*************************************************
+Function: SpscQueue
+Description: constrcution function for SpscQueue class
+Calls: none
+Called By: TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: f_iCapacity - the expected capacity
+Output: none
+Return: none
+Others: none
+*************************************************/
+template <class T>
+SpscQueue<T>::SpscQueue(int f_iCapacity):m_iHead(0),
+                                         m_iTail(0){
+
+	size_t iCapacity = 2;
+	while (int(iCapacity) < f_iCapacity)
+		iCapacity <<= 1;
+
+	m_vSlots.resize(iCapacity);
+	m_iMask = iCapacity - 1;
+
+}
+
+/*************************************************
+Function: ~SpscQueue
+Description: destrcution function for SpscQueue class
+Calls: none
+Called By: ~TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+template <class T>
+SpscQueue<T>::~SpscQueue(){
+
+}
+
+/*************************************************
+Function: Push
+Description: add an element at the tail
+Calls: none
+Called By: the producer thread
+Table Accessed: none
+Table Updated: none
+Input: oValue - the element
+Output: none
+Return: true if it is added, false if the queue is full
+Others: the element is written before the tail is released,
+        thus the consumer always gets a complete element
+*************************************************/
+template <class T>
+bool SpscQueue<T>::Push(const T & oValue){
+
+	size_t iTail = m_iTail.load(std::memory_order_relaxed);
+	if (iTail - m_iHead.load(std::memory_order_acquire) > m_iMask)
+		return false;
+
+	m_vSlots[iTail & m_iMask] = oValue;
+	m_iTail.store(iTail + 1, std::memory_order_release);
+
+	return true;
+
+}
+
+/*************************************************
+Function: Pop
+Description: remove the element at the head
+Calls: none
+Called By: the consumer thread
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: oValue - the element
+Return: true if an element is removed, false if the queue is empty
+Others: the slot is reset so that a shared pointer in it is released at once
+*************************************************/
+template <class T>
+bool SpscQueue<T>::Pop(T & oValue){
+
+	size_t iHead = m_iHead.load(std::memory_order_relaxed);
+	if (iHead == m_iTail.load(std::memory_order_acquire))
+		return false;
+
+	T & oSlot = m_vSlots[iHead & m_iMask];
+	oValue = std::move(oSlot);
+	oSlot = T();
+	m_iHead.store(iHead + 1, std::memory_order_release);
+
+	return true;
+
+}
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//SpscQueue<pcl::PointCloud<pcl::PointXYZ>::Ptr> vCloudQueue(64);
+////in the callback thread
+//if (!vCloudQueue.Push(pCloud))
+//	ROS_WARN("queue is full, the frame is dropped");
+////in the worker thread
+//pcl::PointCloud<pcl::PointXYZ>::Ptr pCloud;
+//while (vCloudQueue.Pop(pCloud))
+//	IngestCloud(*pCloud);
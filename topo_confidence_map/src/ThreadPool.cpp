@@ -0,0 +1,253 @@
+#include "ThreadPool.h"
+
+namespace topology_map {
+
+/*************************************************
+Function: ThreadPool
+Description: constrcution function for ThreadPool class
+Calls: StartWorkers
+Called By: Confidence
+Table Accessed: none
+Table Updated: none
+Input: f_iThreadNum - the number of workers, 0 means the number of hardware threads
+Output: none
+Return: none
+Others: none
+*************************************************/
+ThreadPool::ThreadPool(int f_iThreadNum):m_bStopFlag(false){
+
+	StartWorkers(f_iThreadNum);
+
+}
+
+/*************************************************
+Function: ~ThreadPool
+Description: destrcution function for ThreadPool class
+Calls: StopWorkers
+Called By: main function of project
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the waiting tasks are finished before the workers quit
+*************************************************/
+ThreadPool::~ThreadPool(){
+
+	StopWorkers();
+
+}
+
+/*************************************************
+Function: SetThreadNum
+Description: restart the pool with a new number of workers
+Calls: StopWorkers
+       StartWorkers
+Called By: Confidence::SetVisViewNum
+Table Accessed: none
+Table Updated: none
+Input: iThreadNum - the number of workers, 0 means the number of hardware threads
+Output: none
+Return: none
+Others: it must not be called when ParallelFor is running
+*************************************************/
+void ThreadPool::SetThreadNum(int iThreadNum){
+
+	StopWorkers();
+
+	StartWorkers(iThreadNum);
+
+}
+
+/*************************************************
+Function: StartWorkers
+Description: create the workers
+Calls: WorkerLoop
+Called By: ThreadPool
+           SetThreadNum
+Table Accessed: none
+Table Updated: none
+Input: iThreadNum - the number of workers, 0 means the number of hardware threads
+Output: none
+Return: none
+Others: none
+*************************************************/
+void ThreadPool::StartWorkers(int iThreadNum){
+
+	if (iThreadNum <= 0)
+		iThreadNum = int(std::thread::hardware_concurrency());
+
+	//at least one worker
+	if (iThreadNum <= 0)
+		iThreadNum = 1;
+
+	m_bStopFlag = false;
+
+	for (int i = 0; i != iThreadNum; ++i)
+		m_vWorkers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+
+}
+
+/*************************************************
+Function: StopWorkers
+Description: finish the waiting tasks and join the workers
+Calls: none
+Called By: ~ThreadPool
+           SetThreadNum
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+void ThreadPool::StopWorkers(){
+
+	{
+		std::unique_lock<std::mutex> oLock(m_oTaskMutex);
+		m_bStopFlag = true;
+	}
+
+	m_oTaskCond.notify_all();
+
+	for (size_t i = 0; i != m_vWorkers.size(); ++i)
+		m_vWorkers[i].join();
+
+	m_vWorkers.clear();
+
+}
+
+/*************************************************
+Function: WorkerLoop
+Description: the loop of each worker, which takes a task from the queue and runs it
+Calls: none
+Called By: ThreadPool
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+void ThreadPool::WorkerLoop(){
+
+	while (true){
+
+		std::function<void()> fTask;
+
+		{
+			std::unique_lock<std::mutex> oLock(m_oTaskMutex);
+			//wait for a task or the stop
+			while (!m_bStopFlag && m_vTasks.empty())
+				m_oTaskCond.wait(oLock);
+
+			if (m_bStopFlag && m_vTasks.empty())
+				return;
+
+			fTask = m_vTasks.front();
+			m_vTasks.pop();
+		}
+
+		fTask();
+
+	}//end while
+
+}
+
+/*************************************************
+Function: ParallelFor
+Description: run a task for each index in parallel and wait until all of them are done
+Calls: ParallelForSlot
+Called By: GHPR::UpdateVisibilityBatch
+Table Accessed: none
+Table Updated: none
+Input: iTaskNum - the number of indices
+       fTask - the task of one index
+Output: none
+Return: none
+Others: see ParallelForSlot
+*************************************************/
+void ThreadPool::ParallelFor(const int & iTaskNum,
+	                         const std::function<void(int)> & fTask){
+
+	ParallelForSlot(iTaskNum, [&](int iTaskIdx, int /*iSlotIdx*/){
+		fTask(iTaskIdx);
+	});
+
+}
+
+/*************************************************
+Function: ParallelForSlot
+Description: run a task for each index in parallel and wait until all of them are done,
+             the task also gets the slot of the thread running it
+Calls: none
+Called By: ParallelFor
+           Confidence::QualityTerm
+Table Accessed: none
+Table Updated: none
+Input: iTaskNum - the number of indices
+       fTask - the task of one index, fTask(iTaskIdx, iSlotIdx)
+Output: none
+Return: none
+Others: the calling thread also runs the tasks with slot 0, the workers use slot 1 to SlotNum() - 1,
+        the indices are taken one by one so that a slow index does not block others,
+        fTask must not write the same data in different indices
+*************************************************/
+void ThreadPool::ParallelForSlot(const int & iTaskNum,
+	                             const std::function<void(int, int)> & fTask){
+
+	if (iTaskNum <= 0)
+		return;
+
+	//run in current thread if there is only one task
+	if (iTaskNum == 1 || m_vWorkers.empty()){
+		for (int i = 0; i != iTaskNum; ++i)
+			fTask(i, 0);
+		return;
+	}
+
+	//the next index and the number of finished helpers
+	int iNextIdx = 0;
+	int iDoneNum = 0;
+	std::mutex oStateMutex;
+	std::condition_variable oDoneCond;
+
+	//take the indices one by one
+	std::function<void(int)> fRunner = [&](int iSlotIdx){
+		while (true){
+			int iTaskIdx;
+			{
+				std::unique_lock<std::mutex> oLock(oStateMutex);
+				iTaskIdx = iNextIdx++;
+			}
+			if (iTaskIdx >= iTaskNum)
+				break;
+			fTask(iTaskIdx, iSlotIdx);
+		}
+	};
+
+	//the workers help the calling thread
+	int iHelperNum = std::min(int(m_vWorkers.size()), iTaskNum - 1);
+	{
+		std::unique_lock<std::mutex> oLock(m_oTaskMutex);
+		for (int i = 0; i != iHelperNum; ++i){
+			m_vTasks.push([&, i](){
+				fRunner(i + 1);
+				std::unique_lock<std::mutex> oStateLock(oStateMutex);
+				iDoneNum++;
+				oDoneCond.notify_one();
+			});
+		}
+	}
+	m_oTaskCond.notify_all();
+
+	fRunner(0);
+
+	//wait for the helpers, the local states must live until then
+	std::unique_lock<std::mutex> oLock(oStateMutex);
+	while (iDoneNum != iHelperNum)
+		oDoneCond.wait(oLock);
+
+}
+
+}/*namespace*/
@@ -0,0 +1,103 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+///************************************************************************///
+// a class to implement a fixed size thread pool
+// the workers are created once and wait for tasks,
+// which avoids creating threads in each frame of the real time processing
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the thread pool used by the batched visibility calculation
+// - add the slot index of running thread for the scratch data
+
+///************************************************************************///
+
+namespace topology_map {
+
+class ThreadPool{
+
+public:
+
+	//constructor, 0 means the number of hardware threads
+	ThreadPool(int f_iThreadNum = 0);
+
+	//destructor
+	~ThreadPool();
+
+	//restart the pool with a new number of workers, 0 means the number of hardware threads
+	void SetThreadNum(int iThreadNum);
+
+	//the number of workers
+	inline int ThreadNum() const{
+
+		return int(m_vWorkers.size());
+
+	};
+
+	//the number of threads running the tasks of ParallelFor (workers and the calling thread)
+	inline int SlotNum() const{
+
+		return int(m_vWorkers.size()) + 1;
+
+	};
+
+	//run fTask(0), fTask(1) ... fTask(iTaskNum - 1) on workers and wait until all of them are done
+	void ParallelFor(const int & iTaskNum,
+	                 const std::function<void(int)> & fTask);
+
+	//the same as ParallelFor, fTask(iTaskIdx, iSlotIdx) also gets the slot of running thread (0 to SlotNum() - 1)
+	//which is used to index the scratch data of each thread
+	void ParallelForSlot(const int & iTaskNum,
+	                     const std::function<void(int, int)> & fTask);
+
+private:
+
+	//forbid the copy
+	ThreadPool(const ThreadPool &);
+	ThreadPool & operator = (const ThreadPool &);
+
+	//create the workers
+	void StartWorkers(int iThreadNum);
+
+	//finish the waiting tasks and join the workers
+	void StopWorkers();
+
+	//the loop of each worker
+	void WorkerLoop();
+
+	//the workers
+	std::vector<std::thread> m_vWorkers;
+
+	//the waiting tasks
+	std::queue<std::function<void()> > m_vTasks;
+
+	//lock of task queue
+	std::mutex m_oTaskMutex;
+	//notify workers that a task arrives
+	std::condition_variable m_oTaskCond;
+
+	//stop the workers
+	bool m_bStopFlag;
+
+};
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//ThreadPool oPool(4);
+//std::vector<float> vRes(100);
+////compute each element in parallel
+//oPool.ParallelFor(vRes.size(), [&](int i){
+//	vRes[i] = i * i;
+//});
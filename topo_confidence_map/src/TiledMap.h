@@ -0,0 +1,552 @@
+#ifndef TILEDMAP_H
+#define TILEDMAP_H
+
+#include <vector>
+#include <functional>
+
+///************************************************************************///
+// a class template to implement a sparse grid storage in square tiles
+// the map is indexed by the same 1D index as ExtendedGM (row * column number + column)
+// or by the 2D index (row, column), each tile (64 x 64 grids by default) is allocated
+// when one of its grids is written at the first time, so the unknown region costs nothing
+// created and edited by Huang Pengdi
+
+//Version 1.0
+// - add the tiled storage of the confidence map and the point indexes of grids
+// - add the tile shift of rolling map, the tiles out of map are handed to an eviction function
+// - the tile storage is a template parameter, a tile may store the grids in separate arrays
+// - the tiles and their global coordinate can be accessed directly, which is used by the checkpoint
+
+///************************************************************************///
+
+namespace topology_map {
+
+//the tile storage (TileT) needs the members of std::vector below:
+//reference, const_reference, empty(), size(), assign(n, value), operator[] and swap()
+//the reference type can be a proxy of the grid fields, e.g., ConfidenceTile in ConfidenceMap.h
+template <class T, class TileT = std::vector<T> >
+class TiledMap{
+
+public:
+
+	//the access type of a grid
+	typedef typename TileT::reference Reference;
+	typedef typename TileT::const_reference ConstReference;
+
+	//constructor, the tile side is 2^f_iTileBits grids
+	TiledMap(int f_iTileBits = 6);
+
+	//destructor
+	~TiledMap();
+
+	//set the map size and release all tiles
+	void Initialize(const int & iRowNum,
+	                const int & iColNum,
+	                const T & oDefaultValue = T());
+
+	//the function to initialize each grid of a new tile, fInit(iOneDIdx, oGridValue)
+	void SetGridInitializer(const std::function<void(const int &, Reference)> & fInit);
+
+	//release all tiles, the size is not changed
+	void clear();
+
+	//grid number of the whole map (the same as the dense vector)
+	inline int size() const{
+
+		return m_iRowNum * m_iColNum;
+
+	};
+
+	//the number of grids in rows and columns
+	inline int RowNum() const{
+
+		return m_iRowNum;
+
+	};
+
+	inline int ColNum() const{
+
+		return m_iColNum;
+
+	};
+
+	//the write access of a grid by 1D index, its tile is allocated if it has not been
+	inline Reference operator[](const int & iOneDIdx){
+
+		int iRow = iOneDIdx / m_iColNum;
+		return At(iRow, iOneDIdx - iRow * m_iColNum);
+
+	};
+
+	//the read access of a grid by 1D index, a grid in an unallocated tile reads the default value
+	inline ConstReference operator[](const int & iOneDIdx) const{
+
+		int iRow = iOneDIdx / m_iColNum;
+		return At(iRow, iOneDIdx - iRow * m_iColNum);
+
+	};
+
+	//the write access of a grid by 2D index
+	inline Reference At(const int & iRow,
+	                    const int & iCol){
+
+		TileT & vTile = m_vTiles[TileIdx(iRow, iCol)];
+		if (vTile.empty())
+			AllocateTile(iRow, iCol);
+		return vTile[InTileIdx(iRow, iCol)];
+
+	};
+
+	//the read access of a grid by 2D index
+	inline ConstReference At(const int & iRow,
+	                         const int & iCol) const{
+
+		const TileT & vTile = m_vTiles[TileIdx(iRow, iCol)];
+		if (vTile.empty())
+			return m_oDefaultTile[0];
+		return vTile[InTileIdx(iRow, iCol)];
+
+	};
+
+	//whether the tile of a grid is allocated
+	inline bool IsAllocated(const int & iOneDIdx) const{
+
+		int iRow = iOneDIdx / m_iColNum;
+		return !m_vTiles[TileIdx(iRow, iOneDIdx - iRow * m_iColNum)].empty();
+
+	};
+
+	//visit each grid of the allocated tiles, fVisit(iOneDIdx, oGridValue)
+	//the grids are visited tile by tile, which is not the order of 1D index
+	template <class VisitFunc>
+	void ForEachAllocated(VisitFunc fVisit);
+
+	//the number of allocated tiles
+	int AllocatedTileNum() const;
+
+	//the number of all tiles
+	inline int TileNum() const{
+
+		return int(m_vTiles.size());
+
+	};
+
+	//the number of grids in a tile
+	inline int TileGridNum() const{
+
+		return m_iTileSide * m_iTileSide;
+
+	};
+
+	//the number of grids in a tile side
+	inline int TileSide() const{
+
+		return m_iTileSide;
+
+	};
+
+	//the number of tiles in rows and columns
+	inline int TileRows() const{
+
+		return m_iTileRows;
+
+	};
+
+	inline int TileCols() const{
+
+		return m_iTileCols;
+
+	};
+
+	//the tile (iTileRow, iTileCol) of map, an empty tile is not allocated
+	inline TileT & Tile(const int & iTileRow,
+	                    const int & iTileCol){
+
+		return m_vTiles[iTileRow * m_iTileCols + iTileCol];
+
+	};
+
+	inline const TileT & Tile(const int & iTileRow,
+	                          const int & iTileCol) const{
+
+		return m_vTiles[iTileRow * m_iTileCols + iTileCol];
+
+	};
+
+	//the global coordinate of tile (0, 0)
+	inline int TileRowOrigin() const{
+
+		return m_iTileRowOrigin;
+
+	};
+
+	inline int TileColOrigin() const{
+
+		return m_iTileColOrigin;
+
+	};
+
+	//set the global coordinate of tile (0, 0), e.g., the map is restored from a checkpoint
+	inline void SetTileOrigin(const int & iTileRowOrigin,
+	                          const int & iTileColOrigin){
+
+		m_iTileRowOrigin = iTileRowOrigin;
+		m_iTileColOrigin = iTileColOrigin;
+
+	};
+
+	//move the tiles with the map, the tile (i, j) is the old tile (i + iTileRowShift, j + iTileColShift)
+	//fEvict(global tile row, global tile column, tile) receives each allocated tile moved out of map
+	//fLoad(global tile row, global tile column, tile) may fill each tile moved into map, return whether it is filled
+	void ShiftTiles(const int & iTileRowShift,
+	                const int & iTileColShift,
+	                const std::function<void(const int &, const int &, TileT &)> & fEvict,
+	                const std::function<bool(const int &, const int &, TileT &)> & fLoad);
+
+private:
+
+	//the tile of a grid
+	inline int TileIdx(const int & iRow,
+	                   const int & iCol) const{
+
+		return (iRow >> m_iTileBits) * m_iTileCols + (iCol >> m_iTileBits);
+
+	};
+
+	//the grid index in its tile
+	inline int InTileIdx(const int & iRow,
+	                     const int & iCol) const{
+
+		return ((iRow & m_iTileMask) << m_iTileBits) | (iCol & m_iTileMask);
+
+	};
+
+	//allocate the tile covering a grid
+	void AllocateTile(const int & iRow,
+	                  const int & iCol);
+
+	//tile side
+	int m_iTileBits;
+	int m_iTileSide;
+	int m_iTileMask;
+
+	//map size in grids and in tiles
+	int m_iRowNum;
+	int m_iColNum;
+	int m_iTileRows;
+	int m_iTileCols;
+
+	//the global coordinate of tile (0, 0), which is changed by the shift of rolling map
+	int m_iTileRowOrigin;
+	int m_iTileColOrigin;
+
+	//the tiles, an empty tile is not allocated
+	std::vector<TileT> m_vTiles;
+
+	//the value of a grid in an unallocated tile
+	T m_oDefaultValue;
+	//a tile of one grid with the default value, which is read for the grids in unallocated tiles
+	TileT m_oDefaultTile;
+
+	//the initializer of the grids of a new tile
+	std::function<void(const int &, Reference)> m_fGridInit;
+
+};
+
+/*************************************************
+Function: TiledMap
+Description: constrcution function for TiledMap class
+Calls: none
+Called By: TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: f_iTileBits - the tile side is 2^f_iTileBits grids
+Output: none
+Return: none
+Others: none
+*************************************************/
+template <class T, class TileT>
+TiledMap<T, TileT>::TiledMap(int f_iTileBits):m_iRowNum(0),
+                                       m_iColNum(1),
+                                       m_iTileRows(0),
+                                       m_iTileCols(0),
+                                       m_iTileRowOrigin(0),
+                                       m_iTileColOrigin(0){
+
+	if (f_iTileBits < 1)
+		f_iTileBits = 1;
+
+	m_iTileBits = f_iTileBits;
+	m_iTileSide = 1 << m_iTileBits;
+	m_iTileMask = m_iTileSide - 1;
+
+	m_oDefaultTile.assign(1, m_oDefaultValue);
+
+}
+
+/*************************************************
+Function: ~TiledMap
+Description: destrcution function for TiledMap class
+Calls: none
+Called By: ~TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+template <class T, class TileT>
+TiledMap<T, TileT>::~TiledMap(){
+
+}
+
+/*************************************************
+Function: Initialize
+Description: set the map size and release all tiles
+Calls: none
+Called By: TopologyMap::InitializeGridMap
+Table Accessed: none
+Table Updated: none
+Input: iRowNum - the row number of map (getSize()(0) of grid_map)
+       iColNum - the column number of map (getSize()(1) of grid_map)
+       oDefaultValue - the value of a grid in an unallocated tile
+Output: none
+Return: none
+Others: none
+*************************************************/
+template <class T, class TileT>
+void TiledMap<T, TileT>::Initialize(const int & iRowNum,
+	                         const int & iColNum,
+	                         const T & oDefaultValue){
+
+	m_iRowNum = iRowNum > 0 ? iRowNum : 0;
+	m_iColNum = iColNum > 0 ? iColNum : 1;
+	m_iTileRows = (m_iRowNum + m_iTileMask) >> m_iTileBits;
+	m_iTileCols = (m_iColNum + m_iTileMask) >> m_iTileBits;
+
+	m_iTileRowOrigin = 0;
+	m_iTileColOrigin = 0;
+
+	m_oDefaultValue = oDefaultValue;
+	m_oDefaultTile.assign(1, m_oDefaultValue);
+
+	m_vTiles.clear();
+	m_vTiles.resize(m_iTileRows * m_iTileCols);
+
+}
+
+/*************************************************
+Function: SetGridInitializer
+Description: set the function to initialize each grid of a new tile
+Calls: none
+Called By: TopologyMap::InitializeGridMap
+Table Accessed: none
+Table Updated: none
+Input: fInit - fInit(iOneDIdx, oGridValue) is called for each grid of a new tile after it is set as the default value
+Output: none
+Return: none
+Others: it is used for the data which depends on the grid position (e.g., the center point)
+*************************************************/
+template <class T, class TileT>
+void TiledMap<T, TileT>::SetGridInitializer(const std::function<void(const int &, Reference)> & fInit){
+
+	m_fGridInit = fInit;
+
+}
+
+/*************************************************
+Function: clear
+Description: release all tiles
+Calls: none
+Called By: TopologyMap::InitializeGridMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the map size is kept, each grid reads the default value again
+*************************************************/
+template <class T, class TileT>
+void TiledMap<T, TileT>::clear(){
+
+	for (int i = 0; i != int(m_vTiles.size()); ++i)
+		TileT().swap(m_vTiles[i]);
+
+}
+
+/*************************************************
+Function: AllocatedTileNum
+Description: count the allocated tiles
+Calls: none
+Called By: TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: the number of allocated tiles
+Others: none
+*************************************************/
+template <class T, class TileT>
+int TiledMap<T, TileT>::AllocatedTileNum() const{
+
+	int iTileNum = 0;
+
+	for (int i = 0; i != int(m_vTiles.size()); ++i)
+		if (!m_vTiles[i].empty())
+			iTileNum++;
+
+	return iTileNum;
+
+}
+
+/*************************************************
+Function: ForEachAllocated
+Description: visit each grid of the allocated tiles
+Calls: none
+Called By: TopologyMap::SamplingPointClouds
+Table Accessed: none
+Table Updated: none
+Input: fVisit - fVisit(iOneDIdx, oGridValue) is called for each grid
+Output: none
+Return: none
+Others: the grids in unallocated tiles have the default value, they are skipped
+*************************************************/
+template <class T, class TileT>
+template <class VisitFunc>
+void TiledMap<T, TileT>::ForEachAllocated(VisitFunc fVisit){
+
+	for (int iTileRow = 0; iTileRow != m_iTileRows; ++iTileRow){
+		for (int iTileCol = 0; iTileCol != m_iTileCols; ++iTileCol){
+
+			TileT & vTile = m_vTiles[iTileRow * m_iTileCols + iTileCol];
+			if (vTile.empty())
+				continue;
+
+			int iBeginRow = iTileRow << m_iTileBits;
+			int iBeginCol = iTileCol << m_iTileBits;
+
+			for (int i = 0; i != m_iTileSide && iBeginRow + i < m_iRowNum; ++i)
+				for (int j = 0; j != m_iTileSide && iBeginCol + j < m_iColNum; ++j)
+					fVisit((iBeginRow + i) * m_iColNum + iBeginCol + j, vTile[(i << m_iTileBits) | j]);
+
+		}//end for iTileCol
+	}//end for iTileRow
+
+}
+
+/*************************************************
+Function: ShiftTiles
+Description: move the tiles with the map (rolling map)
+Calls: none
+Called By: TopologyMap::RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: iTileRowShift - the tile row shift, the new tile row i is the old tile row i + iTileRowShift
+       iTileColShift - the tile column shift
+       fEvict - fEvict(global tile row, global tile column, tile) receives each allocated tile moved out of map
+       fLoad - fLoad(global tile row, global tile column, tile) may fill each tile moved into map
+Output: none
+Return: none
+Others: the grid shift is a multiple of tile side, so that no tile is split,
+        and the map size should be a multiple of tile side, otherwise the grids out of a border tile are lost
+*************************************************/
+template <class T, class TileT>
+void TiledMap<T, TileT>::ShiftTiles(const int & iTileRowShift,
+	                         const int & iTileColShift,
+	                         const std::function<void(const int &, const int &, TileT &)> & fEvict,
+	                         const std::function<bool(const int &, const int &, TileT &)> & fLoad){
+
+	if (!iTileRowShift && !iTileColShift)
+		return;
+
+	std::vector<TileT> vNewTiles(m_vTiles.size());
+
+	//move the old tiles, the ones out of map are evicted
+	for (int iTileRow = 0; iTileRow != m_iTileRows; ++iTileRow){
+		for (int iTileCol = 0; iTileCol != m_iTileCols; ++iTileCol){
+
+			TileT & vTile = m_vTiles[iTileRow * m_iTileCols + iTileCol];
+			if (vTile.empty())
+				continue;
+
+			int iNewRow = iTileRow - iTileRowShift;
+			int iNewCol = iTileCol - iTileColShift;
+
+			if (iNewRow >= 0 && iNewRow < m_iTileRows && iNewCol >= 0 && iNewCol < m_iTileCols)
+				vNewTiles[iNewRow * m_iTileCols + iNewCol].swap(vTile);
+			else if (fEvict)
+				fEvict(iTileRow + m_iTileRowOrigin, iTileCol + m_iTileColOrigin, vTile);
+
+		}//end for iTileCol
+	}//end for iTileRow
+
+	m_vTiles.swap(vNewTiles);
+	m_iTileRowOrigin += iTileRowShift;
+	m_iTileColOrigin += iTileColShift;
+
+	if (!fLoad)
+		return;
+
+	//the tiles moved into map may be stored before
+	for (int iTileRow = 0; iTileRow != m_iTileRows; ++iTileRow){
+		for (int iTileCol = 0; iTileCol != m_iTileCols; ++iTileCol){
+
+			int iOldRow = iTileRow + iTileRowShift;
+			int iOldCol = iTileCol + iTileColShift;
+			if (iOldRow >= 0 && iOldRow < m_iTileRows && iOldCol >= 0 && iOldCol < m_iTileCols)
+				continue;
+
+			TileT & vTile = m_vTiles[iTileRow * m_iTileCols + iTileCol];
+			if (!fLoad(iTileRow + m_iTileRowOrigin, iTileCol + m_iTileColOrigin, vTile) || int(vTile.size()) != TileGridNum())
+				TileT().swap(vTile);
+
+		}//end for iTileCol
+	}//end for iTileRow
+
+}
+
+/*************************************************
+Function: AllocateTile
+Description: allocate the tile covering a grid
+Calls: none
+Called By: At
+Table Accessed: none
+Table Updated: none
+Input: iRow - the row of grid
+       iCol - the column of grid
+Output: none
+Return: none
+Others: the grids outside the map in a border tile are allocated but never used
+*************************************************/
+template <class T, class TileT>
+void TiledMap<T, TileT>::AllocateTile(const int & iRow,
+	                           const int & iCol){
+
+	TileT & vTile = m_vTiles[TileIdx(iRow, iCol)];
+	vTile.assign(m_iTileSide * m_iTileSide, m_oDefaultValue);
+
+	if (!m_fGridInit)
+		return;
+
+	int iBeginRow = (iRow >> m_iTileBits) << m_iTileBits;
+	int iBeginCol = (iCol >> m_iTileBits) << m_iTileBits;
+
+	for (int i = 0; i != m_iTileSide && iBeginRow + i < m_iRowNum; ++i)
+		for (int j = 0; j != m_iTileSide && iBeginCol + j < m_iColNum; ++j)
+			m_fGridInit((iBeginRow + i) * m_iColNum + iBeginCol + j, vTile[(i << m_iTileBits) | j]);
+
+}
+
+}/*namespace*/
+
+#endif
+
+//*********************an example display how to use this class***********************
+//TiledMap<ConfidenceValue> vConfidenceMap;
+//vConfidenceMap.Initialize(oFeatureMap.getSize()(0), oFeatureMap.getSize()(1));
+////the same as a dense vector
+//vConfidenceMap[iGridIdx].label = 2;
+////read without allocation
+//const TiledMap<ConfidenceValue> & vReadMap = vConfidenceMap;
+//int iLabel = vReadMap[iOtherGridIdx].label;
@@ -35,6 +35,9 @@ Others: m_oCnfdnSolver - (f_fSigma - the computed radius of robot
 	    m_iAncherCount - count visited anchor in a trip 
 	    m_iOdomSampingNum - smapling number of odometry points
 	    m_bGridMapReadyFlag - a flag indicating the grid map has been initialized (true) or not (false)
+	    m_bRollingMapFlag - a flag indicating the map is moved with the robot (true) or fixed (false)
+	    m_bMapResetFlag - a flag indicating the whole grid map should be published (true) or only its changed region (false)
+	    m_bResumeFlag - a flag indicating the exploration resumes from the checkpoint (true) or not (false)
 	    m_bCoverFileFlag - a flag indicating whether an coverage file is generated (true) or not (false)
 	    m_bOutTrajFileFlag - a flag indicating whether an out trajectroy file is generated
 	    m_bAnchorGoalFlag - a flag indicating the robot is moving Moving on a local optimization path
@@ -50,22 +53,42 @@ TopologyMap::TopologyMap(ros::NodeHandle & node,
 	                     m_iBoundFrames(0),
 	                     m_iObstacleFrames(0),
 	                     m_iComputedFrame(0),
+	                     m_iOdomViewCount(0),
 	                     m_iNodeTimes(0),
 	                     m_iAncherCount(0),
 	                     m_iOdomSampingNum(25),
 	                     m_bGridMapReadyFlag(false),
+	                     m_bRollingMapFlag(false),
+	                     m_fRollingMargin(10.0),
+	                     m_dCheckpointPeriod(30.0),
+	                     m_dLastCheckpointTime(0.0),
+	                     m_bResumeFlag(false),
 	                     m_bCoverFileFlag(false),
 	                     m_bOutTrajFileFlag(false),
 	                     m_bOutPCFileFlag(false),
+	                     m_bBinaryCloudLogFlag(false),
 	                     m_bMapFileFlag(false),
 	                     m_bAnchorGoalFlag(false),
+	                     m_dKeyframePeriod(10.0),
+	                     m_dLastKeyframeTime(0.0),
+	                     m_bMapResetFlag(true),
 	                     oDisTermDur(0.0),
                          oBoundTermDur(0.0),
                          oVisTermDur(0.0),
                          oNodeDur(0.0),
                          oFractTermDur(0.0),
                          oLocalPathTermDur(0.0),
-	                     m_bOutNodeFileFlag(false){
+	                     m_bOutNodeFileFlag(false),
+	                     m_oLogWriter(LOG_CHANNEL_NUM),
+	                     m_vOdomQueue(256),
+	                     m_vGroundQueue(64),
+	                     m_vBoundQueue(64),
+	                     m_vObstacleQueue(64),
+	                     m_vPlanJobs(2),
+	                     m_vPlanResults(2),
+	                     m_bPlanningFlag(false),
+	                     m_iDroppedFrames(0),
+	                     m_bStopFlag(false){
 
 
 
@@ -88,6 +111,9 @@ TopologyMap::TopologyMap(ros::NodeHandle & node,
 	//publish topic
 	m_oGridMapPublisher = nodeHandle.advertise<grid_map_msgs::GridMap>("grid_map", 1, true);
 
+	//the submaps are merged into the last keyframe by subscribers, thus they are queued rather than latched
+	m_oGridMapUpdatePublisher = nodeHandle.advertise<grid_map_msgs::GridMap>("grid_map_updates", 10, false);
+
 	m_oCloudPublisher = nodeHandle.advertise<sensor_msgs::PointCloud2>("test_clouds", 1, true);
 
 	m_oPlanNodePublisher = nodeHandle.advertise<sensor_msgs::PointCloud2>("plannode_clouds", 1, true);
@@ -96,13 +122,18 @@ TopologyMap::TopologyMap(ros::NodeHandle & node,
 
 	m_oGoalPublisher = nodeHandle.advertise<nav_msgs::Odometry>("goal_odom", 1, true);
 
+	//the workers consume the queues filled by the callbacks above and publish on the topics above,
+	//thus they are started after all publishers are advertised
+	StartWorkers();
+
 }
 
 
 /*************************************************
 Function: ~TopologyMap
 Description: deconstrcution function for TopologyMap class
-Calls: all member functions
+Calls: StopWorkers
+       SaveCheckpoint
 Called By: main function of project
 Table Accessed: none
 Table Updated: none
@@ -114,6 +145,12 @@ Others: none
 
 TopologyMap::~TopologyMap() {
 
+	//the workers use all members, thus they are stopped first
+	StopWorkers();
+
+	//the last state is kept for a restart
+	SaveCheckpoint(true);
+
 }
 
 
@@ -136,6 +173,9 @@ bool TopologyMap::ReadLaunchParams(ros::NodeHandle & nodeHandle) {
 	//output file name
 	nodeHandle.param("file_outputpath", m_sFileHead, std::string("./"));
 
+	//the scanned point clouds are recorded in binary records (true) or in text (false)
+	nodeHandle.param("cloudlog_binary", m_bBinaryCloudLogFlag, false);
+
 	//input topic
 	nodeHandle.param("odom_in_topic", m_sOdomTopic, std::string("/odometry/filtered"));
 
@@ -167,6 +207,18 @@ bool TopologyMap::ReadLaunchParams(ros::NodeHandle & nodeHandle) {
 	if(m_iPastOdomNum <= 0)
 	   m_iPastOdomNum = 1;//at least one point (in this case, this point will be front and back point of quene)
 
+	//the number of past viewpoints in each occlusion calculation
+	nodeHandle.param("pastview_num", m_iPastViewNum, 4);
+	if(m_iPastViewNum <= 0)
+	   m_iPastViewNum = 1;
+	if(m_iPastViewNum > m_iPastOdomNum)
+	   m_iPastViewNum = m_iPastOdomNum;
+
+	//the workers of parallel calculation (0 is the number of hardware threads)
+	int iWorkerThreadNum;
+	nodeHandle.param("worker_threads", iWorkerThreadNum, 0);
+	m_oCnfdnSolver.SetThreadNum(iWorkerThreadNum);
+
 	double dShockDuration;
 	nodeHandle.param("shock_duration", dShockDuration, 8.0);
 	m_iShockNum = int(dShockDuration * m_dSamplingHz);
@@ -211,11 +263,35 @@ bool TopologyMap::ReadLaunchParams(ros::NodeHandle & nodeHandle) {
 		                 dMaxMapZ,
 		              sMapFrameID);
 
+	//rolling map, the map follows the robot and the tiles out of map are stored in files
+	nodeHandle.param("rolling_map", m_bRollingMapFlag, false);
+	double dRollingMargin;
+	nodeHandle.param("rolling_margin", dRollingMargin, 10.0);
+	m_fRollingMargin = float(dRollingMargin);
+	//the map is moved by whole tiles, thus its size is a multiple of tile side
+	if(m_bRollingMapFlag){
+		m_oGMer.SetTileAlignment(m_vConfidenceMap.TileSide());
+		ROS_INFO("Set rolling map with margin [%f] m", m_fRollingMargin);
+	}
+
+	//the whole map is published in this period, and the changed submaps between two keyframes
+	nodeHandle.param("gridmap_keyframe_period", m_dKeyframePeriod, 10.0);
+
+	//checkpoint, the exploration state is written periodically and can be resumed at startup
+	nodeHandle.param("checkpoint_period", m_dCheckpointPeriod, 30.0);
+	nodeHandle.param("resume_checkpoint", m_bResumeFlag, false);
+	if(m_dCheckpointPeriod > 0.0)
+		ROS_INFO("Set checkpoint every [%f] s in %s", m_dCheckpointPeriod, CheckpointFileName().c_str());
+
 	//robot's neighborhood searching radius
 	double dRbtLocalRadius;
 	nodeHandle.param("robot_local_r", dRbtLocalRadius, 5.0);
 	m_oCnfdnSolver.SetSigmaValue(dRbtLocalRadius);
 
+	//the neighborhood of robot should be inside the rolling map
+	if(m_fRollingMargin < float(dRbtLocalRadius))
+		m_fRollingMargin = float(dRbtLocalRadius);
+
 	//generate robot neighborhood searching mask 
 	m_oGMer.m_vRobotSearchMask.clear();
 	m_oGMer.m_vRobotSearchMask = m_oGMer.GenerateCircleMask(dRbtLocalRadius);
@@ -245,6 +321,22 @@ bool TopologyMap::ReadLaunchParams(ros::NodeHandle & nodeHandle) {
 	nodeHandle.param("initial_r", dInitialR, 4.5);
     m_oGMer.m_vInitialMask.clear();
 	m_oGMer.m_vInitialMask = m_oGMer.GenerateCircleMask(dInitialR);
+
+	//cluster size (grids) of the hierarchical astar search for far goals, 0 means the full map search only
+	int iAstarClusterSize;
+	nodeHandle.param("astar_clustersize", iAstarClusterSize, 32);
+	m_oAstar.SetClusterSize(iAstarClusterSize);
+
+	//the solver of orienteering problem when no wide node exists
+	//0 is the raw branch and bound, 1 is the exact solver (dynamic programming up to op_dpmaxnode nodes)
+	//2 is the anytime solver for all nodes, which returns the best tour in op_timebudget milliseconds
+	int iOPSolverType;
+	nodeHandle.param("op_solver", iOPSolverType, 1);
+	int iOPDPMaxNodeNum;
+	nodeHandle.param("op_dpmaxnode", iOPDPMaxNodeNum, 16);
+	double dOPTimeBudget;
+	nodeHandle.param("op_timebudget", dOPTimeBudget, 50.0);
+	m_oOPSolver.SetOPSolver(iOPSolverType, iOPDPMaxNodeNum, dOPTimeBudget);
  
     //local region for quality measurement
 	m_oGMer.m_vLocalQualityMask.clear();//the local region of dimension based method
@@ -277,6 +369,7 @@ Function: InitializeGridMap
 Description: initialize the confidence map by using a grid_map lib
 Calls: all member functions
 Called By: TopologyMap(), which is the construction function 
+           ResumeCheckpoint
 Table Accessed: none
 Table Updated: none
 Input: pcl::PointXYZ & oRobotPos - the current robot position with a pcl pointxyz type
@@ -294,36 +387,26 @@ void TopologyMap::InitializeGridMap(const pcl::PointXYZ & oRobotPos) {
 	ExtendedGM::iGridRawNum = m_oGMer.m_oFeatureMap.getSize()(1);
 	ROS_INFO("Set grid raw number as [%d]", ExtendedGM::iGridRawNum);
 
-	//generate confidence map
-	m_vConfidenceMap.clear();
+	//generate confidence map, the tiles are allocated when their grids are written
+	m_vConfidenceMap.Initialize(m_oGMer.m_oFeatureMap.getSize()(0), m_oGMer.m_oFeatureMap.getSize()(1));
 
-    ConfidenceValue oGridCnfd;
-	for(int i = 0; i != m_oGMer.m_oFeatureMap.getSize()(0)*m_oGMer.m_oFeatureMap.getSize()(1); ++i)
-	    m_vConfidenceMap.push_back(oGridCnfd);
+	//the center point of each grid is set when its tile is allocated
+	const grid_map::GridMap & oFeatureMap = m_oGMer.m_oFeatureMap;
+	m_vConfidenceMap.SetGridInitializer([&oFeatureMap](const int & iGridIdx, ConfidenceRef oGridCnfd){
 
+		grid_map::Position oGridPos;
+		ExtendedGM::OneDIdxtoPoint(oGridPos, iGridIdx, oFeatureMap);
+		oGridCnfd.oCenterPoint.x = oGridPos.x();
+		oGridCnfd.oCenterPoint.y = oGridPos.y();
 
-	m_vBoundPntMapIdx.resize(m_oGMer.m_oFeatureMap.getSize()(0)*m_oGMer.m_oFeatureMap.getSize()(1));
-	m_vObstlPntMapIdx.resize(m_oGMer.m_oFeatureMap.getSize()(0)*m_oGMer.m_oFeatureMap.getSize()(1));
-
-	//initial elevation map and center point clouds
-	for (int i = 0; i != m_oGMer.m_oFeatureMap.getSize()(0); ++i) {//i
+	});
 
-		for (int j = 0; j != m_oGMer.m_oFeatureMap.getSize()(1); ++j) {//j
-
-			grid_map::Index oGridIdx;
-			oGridIdx(0) = i;
-			oGridIdx(1) = j;
-			int iGridIdx = ExtendedGM::TwotoOneDIdx(oGridIdx);
-
-			//find the 1d and 2d index
-			grid_map::Position oGridPos;
-			m_oGMer.m_oFeatureMap.getPosition(oGridIdx, oGridPos);
-			//center point
-			m_vConfidenceMap[iGridIdx].oCenterPoint.x = oGridPos.x();
-			m_vConfidenceMap[iGridIdx].oCenterPoint.y = oGridPos.y();
-		}//end i
-
-	}//end j
+	m_vBoundPntMapIdx.Initialize(m_oGMer.m_oFeatureMap.getSize()(0), m_oGMer.m_oFeatureMap.getSize()(1));
+	m_vObstlPntMapIdx.Initialize(m_oGMer.m_oFeatureMap.getSize()(0), m_oGMer.m_oFeatureMap.getSize()(1));
+	//the distance to boundary grids used by the boundary term
+	m_oCnfdnSolver.InitBoundDistance(m_oGMer.m_oFeatureMap.getSize()(0), m_oGMer.m_oFeatureMap.getSize()(1),
+	                                 m_oGMer.m_oFeatureMap.getResolution());
+	ROS_INFO("Set confidence map as [%d] tiles of [%d] grids", m_vConfidenceMap.TileNum(), m_vConfidenceMap.TileGridNum());
     
     //get the neighborhood of original coordiante value and initial a rough travelable region
 	std::vector<MapIndex> vOriginalNearIdx;
@@ -336,6 +419,7 @@ void TopologyMap::InitializeGridMap(const pcl::PointXYZ & oRobotPos) {
     for(int i = 0; i != vOriginalNearIdx.size(); ++i){
     	m_vConfidenceMap[vOriginalNearIdx[i].iOneIdx].travelable = 1;
     	m_vConfidenceMap[vOriginalNearIdx[i].iOneIdx].nodeCount = m_iNodeTimes;
+    	m_oCnfdnSolver.AddNodeCandidate(m_vConfidenceMap, vOriginalNearIdx[i].iOneIdx);
     }
 
     //initial op solver
@@ -345,6 +429,9 @@ void TopologyMap::InitializeGridMap(const pcl::PointXYZ & oRobotPos) {
     m_oAstar.InitAstarTravelMap(m_oGMer.m_oFeatureMap);
 
 	m_bGridMapReadyFlag = true;
+	m_dLastCheckpointTime = ros::Time::now().toSec();
+	//the whole map is published as a keyframe next time
+	m_bMapResetFlag = true;
 
 }
 
@@ -419,9 +506,12 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
 
 }
 //reload with extracting all nearby point clouds
+//vNearAllKeys is the key of each point in vNearAllClouds, which is (label << 40) + point index
+//ground point index is its grid index, the others are the indices in the whole boundary/obstacle point clouds
 void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndClouds,
                                   pcl::PointCloud<pcl::PointXYZ> & vNearBndryClouds,
                                     pcl::PointCloud<pcl::PointXYZ> & vNearAllClouds,
+                                           std::vector<long long> & vNearAllKeys,
 	                                         std::vector<int> & vNearGroundGridIdxs,
                                           const std::vector<MapIndex> & vNearByIdxs){
 
@@ -429,9 +519,12 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
 	vNearGrndClouds.clear();
     vNearBndryClouds.clear();
     vNearAllClouds.clear();
+    vNearAllKeys.clear();
 	vNearGroundGridIdxs.clear();
 
 	pcl::PointCloud<pcl::PointXYZ> vNearObstClouds;//nearby obstacle point clouds
+	std::vector<long long> vNearBndryKeys;//key of boundary points
+	std::vector<long long> vNearObstKeys;//key of obstacle points
 
 	//to each nearby grids
 	for (int i = 0; i != vNearByIdxs.size(); ++i) {
@@ -441,8 +534,10 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
         switch (m_vConfidenceMap[iNearGridId].label){
 
         	case 1 : //the grid is a obstacle grid
-        	    for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j)
+        	    for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j){
         	    	vNearObstClouds.points.push_back(m_pObstacleCloud->points[m_vObstlPntMapIdx[iNearGridId][j]]);
+        	    	vNearObstKeys.push_back((1LL << 40) + m_vObstlPntMapIdx[iNearGridId][j]);
+        	    }
             break;
 
             case 2 : //the grid is a ground grid
@@ -450,16 +545,22 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
         	    vNearGroundGridIdxs.push_back(iNearGridId);
         	    //if the obstacle is large (perhaps some obstacles above the ground,e.g.,leafs points, high vegetation)
         	    if(m_vObstlPntMapIdx[iNearGridId].size() > 20){
-        	    	for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j)
+        	    	for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j){
         	    		vNearObstClouds.points.push_back(m_pObstacleCloud->points[m_vObstlPntMapIdx[iNearGridId][j]]);
+        	    		vNearObstKeys.push_back((1LL << 40) + m_vObstlPntMapIdx[iNearGridId][j]);
+        	    	}
         	    }
             break;
 
             case 3 : //the grid is a boundary grid
-                for (int j = 0; j != m_vBoundPntMapIdx[iNearGridId].size(); ++j)
+                for (int j = 0; j != m_vBoundPntMapIdx[iNearGridId].size(); ++j){
 				    vNearBndryClouds.points.push_back(m_pBoundCloud->points[m_vBoundPntMapIdx[iNearGridId][j]]);
-				for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j)
+				    vNearBndryKeys.push_back((3LL << 40) + m_vBoundPntMapIdx[iNearGridId][j]);
+				}
+				for (int j = 0; j != m_vObstlPntMapIdx[iNearGridId].size(); ++j){
         	    	vNearObstClouds.points.push_back(m_pObstacleCloud->points[m_vObstlPntMapIdx[iNearGridId][j]]);
+        	    	vNearObstKeys.push_back((1LL << 40) + m_vObstlPntMapIdx[iNearGridId][j]);
+        	    }
             break;
 
             default:
@@ -470,15 +571,22 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
 
     //make a all label point clouds (for occlusion detection)
     vNearAllClouds.reserve(vNearGrndClouds.size() + vNearBndryClouds.size() + vNearObstClouds.size());
+    vNearAllKeys.reserve(vNearAllClouds.points.capacity());
 
-    for(int i = 0; i != vNearGrndClouds.size(); ++i)
+    for(int i = 0; i != vNearGrndClouds.size(); ++i){
     	vNearAllClouds.push_back(vNearGrndClouds.points[i]);
+    	vNearAllKeys.push_back((2LL << 40) + vNearGroundGridIdxs[i]);
+    }
 
-    for(int i = 0; i != vNearBndryClouds.size(); ++i)
+    for(int i = 0; i != vNearBndryClouds.size(); ++i){
     	vNearAllClouds.push_back(vNearBndryClouds.points[i]);
+    	vNearAllKeys.push_back(vNearBndryKeys[i]);
+    }
 
-    for(int i = 0; i != vNearObstClouds.size(); ++i)
+    for(int i = 0; i != vNearObstClouds.size(); ++i){
     	vNearAllClouds.push_back(vNearObstClouds.points[i]);
+    	vNearAllKeys.push_back(vNearObstKeys[i]);
+    }
 
 }
 //reload with generating ground and boundary points only
@@ -523,8 +631,8 @@ void TopologyMap::ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndCl
 Function: SamplingPointClouds
 Description: down samples point clouds number (seems like pseudo random)
 Calls: none
-Called By: HandleBoundClouds
-           HandleObstacleClouds
+Called By: IngestBoundCloud
+           IngestObstacleCloud
 Table Accessed: none
 Table Updated: none
 Input: pCloud - the point cloud to be sampled
@@ -532,94 +640,591 @@ Input: pCloud - the point cloud to be sampled
 	   iSmplNum - sampling number
 Output: pCloud - the point cloud to be sampled
 	    vPointMapIdx - point index in the grid map
-Return: oRealGoalPoint - a motion goal position of robot 
-Others: none
+Return: none
+Others: only the allocated tiles are visited, the point indexes of grids are
+        remapped to the positions in the sampled point clouds
 *************************************************/
 void TopologyMap::SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
-	                                 std::vector<std::vector<int> > & vPointMapIdx,
+	                                     TiledMap<std::vector<int> > & vPointMapIdx,
 	                                                                  int iSmplNum){
 
-    //point clouds sampling based on the idx vector
-	for(int i = 0; i != vPointMapIdx.size(); ++i){
-		//retain at least one point in grid
-		if(vPointMapIdx[i].size()){
+    pcl::PointCloud<pcl::PointXYZ> vSmplClouds;
 
-			std::vector<int> vOneSmplIdx;
-		        //sampling
-			for(int j = 0; j != vPointMapIdx[i].size(); j = j + iSmplNum)
-				vOneSmplIdx.push_back(vPointMapIdx[i][j]);
-			
+    //point clouds sampling based on the idx vector, only the allocated tiles have points
+    vPointMapIdx.ForEachAllocated([&](const int & /*iGridIdx*/, std::vector<int> & vGridPntIdx){
 
-            vPointMapIdx[i].clear();
-            for(int j = 0; j != vOneSmplIdx.size(); ++j)
-                vPointMapIdx[i].push_back(vOneSmplIdx[j]);
+    	//retain at least one point in grid
+    	if(!vGridPntIdx.size())
+    		return;
 
-        }//end if
+    	int iSmplCount = 0;
+    	for(int j = 0; j < vGridPntIdx.size(); j = j + iSmplNum){
+    		vSmplClouds.push_back(pCloud->points[vGridPntIdx[j]]);
+    		//the index is the new position in the sampled clouds
+    		vGridPntIdx[iSmplCount++] = int(vSmplClouds.size()) - 1;
+    	}
+    	vGridPntIdx.resize(iSmplCount);
 
-    }//end for
+    });
 
+    //clear the point vector and save the new sampled points
+	pCloud->points.swap(vSmplClouds.points);
+	pCloud->width = pCloud->points.size();
+	pCloud->height = 1;
+
+}
+//reload with adding a label vector
+void TopologyMap::SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
+	                                     TiledMap<std::vector<int> > & vPointMapIdx,
+	                                               std::vector<int> & vCloudLabels,
+	                                                                  int iSmplNum){
 
     pcl::PointCloud<pcl::PointXYZ> vSmplClouds;
+    std::vector<int> vSmpCLoudLabels;
 
-    //save each corresponding points
-    for(int i = 0; i != vPointMapIdx.size(); ++i){
-    	for(int j = 0; j != vPointMapIdx[i].size(); ++j){
-			vSmplClouds.push_back(pCloud->points[vPointMapIdx[i][j]]);	
-        }
-	}
+    //point clouds sampling based on the idx vector, only the allocated tiles have points
+    vPointMapIdx.ForEachAllocated([&](const int & /*iGridIdx*/, std::vector<int> & vGridPntIdx){
+
+    	//retain at least one point in grid
+    	if(!vGridPntIdx.size())
+    		return;
+
+    	int iSmplCount = 0;
+    	for(int j = 0; j < vGridPntIdx.size(); j = j + iSmplNum){
+    		vSmplClouds.push_back(pCloud->points[vGridPntIdx[j]]);
+    		vSmpCLoudLabels.push_back(vCloudLabels[vGridPntIdx[j]]);
+    		//the index is the new position in the sampled clouds
+    		vGridPntIdx[iSmplCount++] = int(vSmplClouds.size()) - 1;
+    	}
+    	vGridPntIdx.resize(iSmplCount);
+
+    });
 
     //clear the point vector and save the new sampled points
-	pCloud->points.clear();
-	for(int i = 0; i != vSmplClouds.size(); ++i)
-		pCloud->points.push_back(vSmplClouds.points[i]);
+	pCloud->points.swap(vSmplClouds.points);
+	pCloud->width = pCloud->points.size();
+	pCloud->height = 1;
+	vCloudLabels.swap(vSmpCLoudLabels);
+
+}
 
+/*************************************************
+Function: RecenterMap
+Description: move the map and its data with the robot by whole tiles (rolling map)
+Calls: ExtendedGM::ShiftMap
+       TiledMap::ShiftTiles
+       SamplingPointClouds
+       Confidence::ShiftGrids
+       Confidence::RebuildBoundDistance
+       OP::ShiftGrids
+       Astar::UpdateTravelMap
+Called By: ProcessTrajectory
+Table Accessed: none
+Table Updated: none
+Input: oRobotPos - the current robot position
+Output: the moved map, confidence map, point indexes, node grids and astar map
+Return: none
+Others: nothing is done unless the robot is closer to the map border than m_fRollingMargin,
+        the tiles moved out of map are written into files and read back when they are on map again,
+        the points of evicted tiles are removed from the point clouds, 
+        thus the memory depends on the map size rather than the whole explored region
+*************************************************/
+void TopologyMap::RecenterMap(const pcl::PointXYZ & oRobotPos){
+
+	grid_map::GridMap & oFeatureMap = m_oGMer.m_oFeatureMap;
+	const grid_map::Position & oMapCenter = oFeatureMap.getPosition();
+
+	//check the distance to map border
+	float fHalfLength = 0.5f * float(oFeatureMap.getLength().x());
+	if(std::fabs(oRobotPos.x - oMapCenter.x()) < fHalfLength - m_fRollingMargin &&
+	   std::fabs(oRobotPos.y - oMapCenter.y()) < fHalfLength - m_fRollingMargin)
+		return;
+
+	//the shift (whole tiles) that moves the map center closest to the robot
+	//the row index increases with -x and the column index increases with -y
+	int iTileSide = m_vConfidenceMap.TileSide();
+	double dTileLength = double(iTileSide) * oFeatureMap.getResolution();
+	int iTileRowShift = int(std::floor((oMapCenter.x() - oRobotPos.x) / dTileLength + 0.5));
+	int iTileColShift = int(std::floor((oMapCenter.y() - oRobotPos.y) / dTileLength + 0.5));
+
+	if(!iTileRowShift && !iTileColShift)
+		return;
+
+	if(!m_oGMer.ShiftMap(iTileRowShift * iTileSide, iTileColShift * iTileSide))
+		return;
+
+	//move the confidence map
+	m_vConfidenceMap.ShiftTiles(iTileRowShift, iTileColShift,
+		[this](const int & iTileRow, const int & iTileCol, ConfidenceTile & vTile){
+			EvictConfidenceTile(iTileRow, iTileCol, vTile);
+		},
+		[this](const int & iTileRow, const int & iTileCol, ConfidenceTile & vTile){
+			return LoadConfidenceTile(iTileRow, iTileCol, vTile);
+		});
+
+	//move the point indexes, the points of loaded tiles are appended to point clouds
+	m_vBoundPntMapIdx.ShiftTiles(iTileRowShift, iTileColShift,
+		[this](const int & iTileRow, const int & iTileCol, std::vector<std::vector<int> > & vTile){
+			EvictPointTile("Bound", m_pBoundCloud, NULL, iTileRow, iTileCol, vTile);
+		},
+		[this](const int & iTileRow, const int & iTileCol, std::vector<std::vector<int> > & vTile){
+			return LoadPointTile("Bound", m_pBoundCloud, NULL, iTileRow, iTileCol, vTile);
+		});
+
+	m_vObstlPntMapIdx.ShiftTiles(iTileRowShift, iTileColShift,
+		[this](const int & iTileRow, const int & iTileCol, std::vector<std::vector<int> > & vTile){
+			EvictPointTile("Obstacle", m_pObstacleCloud, &m_vObstNodeTimes, iTileRow, iTileCol, vTile);
+		},
+		[this](const int & iTileRow, const int & iTileCol, std::vector<std::vector<int> > & vTile){
+			return LoadPointTile("Obstacle", m_pObstacleCloud, &m_vObstNodeTimes, iTileRow, iTileCol, vTile);
+		});
+
+	//remove the points of evicted tiles, which are not indexed by any grid now
+	SamplingPointClouds(m_pBoundCloud, m_vBoundPntMapIdx, 1);
+	SamplingPointClouds(m_pObstacleCloud, m_vObstlPntMapIdx, m_vObstNodeTimes, 1);
+	//point indices are changed, thus the visibility hull can not be reused
+	m_oCnfdnSolver.ResetVisibility();
+
+	//move the other grid indexes
+	m_oCnfdnSolver.ShiftGrids(iTileRowShift * iTileSide, iTileColShift * iTileSide,
+		                      oFeatureMap.getSize()(0), oFeatureMap.getSize()(1));
+	m_oCnfdnSolver.RebuildBoundDistance(m_vConfidenceMap);
+
+	int iRetiredNum = m_oOPSolver.ShiftGrids(oFeatureMap);
+
+	//the obstacle bits are rebuilt from the moved labels
+	m_oAstar.InitAstarTravelMap(oFeatureMap);
+	m_oAstar.UpdateTravelMap(oFeatureMap, m_vConfidenceMap);
+
+	//the layers of grid map are moved with empty cells, thus they are all filled again
+	m_bMapResetFlag = true;
+
+	ROS_INFO("Rolling map is moved by [%d, %d] tiles, [%d] tiles in memory, [%d] nodes out of map", 
+		      iTileRowShift, iTileColShift, m_vConfidenceMap.AllocatedTileNum(), iRetiredNum);
 
 }
-//reload with adding a label vector
-void TopologyMap::SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
-	                                 std::vector<std::vector<int> > & vPointMapIdx,
-	                                               std::vector<int> & vCloudLabels,
-	                                                                  int iSmplNum){
 
-    //point clouds sampling based on the idx vector
-	for(int i = 0; i != vPointMapIdx.size(); ++i){
-		//retain at least one point in grid
-		if(vPointMapIdx[i].size()){
+/*************************************************
+Function: TileFileName
+Description: the file of a tile moved out of the rolling map
+Calls: none
+Called By: EvictConfidenceTile
+           LoadConfidenceTile
+           EvictPointTile
+           LoadPointTile
+Table Accessed: none
+Table Updated: none
+Input: sLayer - the data name of tile
+       iTileRow - the global tile row
+       iTileCol - the global tile column
+Output: none
+Return: the file name
+Others: the file is in the output path (file_outputpath)
+*************************************************/
+std::string TopologyMap::TileFileName(const std::string & sLayer,
+	                                  const int & iTileRow,
+	                                  const int & iTileCol){
 
-			std::vector<int> vOneSmplIdx;
-		    //sampling
-			for(int j = 0; j != vPointMapIdx[i].size(); j = j + iSmplNum)
-				vOneSmplIdx.push_back(vPointMapIdx[i][j]);
-			
-            //clear row data and the turn other rows
-            vPointMapIdx[i].clear();
-            for(int j = 0; j != vOneSmplIdx.size(); ++j)
-                vPointMapIdx[i].push_back(vOneSmplIdx[j]);
+	std::stringstream sFileName;
+	sFileName << m_sFileHead << "Tile_" << sLayer << "_" << iTileRow << "_" << iTileCol << ".bin";
 
-        }//end if
+	return sFileName.str();
 
-    }//end for
+}
 
+/*************************************************
+Function: EvictConfidenceTile
+Description: write a confidence tile moved out of map into file
+Calls: TileFileName
+Called By: RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: iTileRow - the global tile row
+       iTileCol - the global tile column
+       vTile - the grids of tile
+Output: a tile file
+Return: none
+Others: the arrays of tile are written in binary, the file is only read by the same process
+*************************************************/
+void TopologyMap::EvictConfidenceTile(const int & iTileRow,
+	                                  const int & iTileCol,
+	                                  ConfidenceTile & vTile){
+
+	std::ofstream oTileFile(TileFileName("Confidence", iTileRow, iTileCol).c_str(), std::ios::out | std::ios::binary);
+	if(!oTileFile.is_open()){
+		ROS_INFO("Can not write the confidence tile [%d, %d], it is dropped", iTileRow, iTileCol);
+		return;
+	}
 
-    pcl::PointCloud<pcl::PointXYZ> vSmplClouds;
-    std::vector<int> vSmpCLoudLabels;
+	vTile.Write(oTileFile);
+	oTileFile.close();
 
-    //save each corresponding points
-    for(int i = 0; i != vPointMapIdx.size(); ++i){
-    	for(int j = 0; j != vPointMapIdx[i].size(); ++j){
-			vSmplClouds.push_back(pCloud->points[vPointMapIdx[i][j]]);	
-			vSmpCLoudLabels.push_back(vCloudLabels[vPointMapIdx[i][j]]);
-        }
+}
+
+/*************************************************
+Function: LoadConfidenceTile
+Description: read a confidence tile moved into map from file
+Calls: TileFileName
+Called By: RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: iTileRow - the global tile row
+       iTileCol - the global tile column
+Output: vTile - the grids of tile
+Return: whether the tile is stored before
+Others: the file is removed after reading
+*************************************************/
+bool TopologyMap::LoadConfidenceTile(const int & iTileRow,
+	                                 const int & iTileCol,
+	                                 ConfidenceTile & vTile){
+
+	std::string sFileName = TileFileName("Confidence", iTileRow, iTileCol);
+	std::ifstream oTileFile(sFileName.c_str(), std::ios::in | std::ios::binary);
+	if(!oTileFile.is_open())
+		return false;
+
+	bool bReadFlag = vTile.Read(oTileFile, m_vConfidenceMap.TileGridNum());
+	oTileFile.close();
+
+	std::remove(sFileName.c_str());
+
+	return bReadFlag;
+
+}
+
+/*************************************************
+Function: EvictPointTile
+Description: write a point index tile moved out of map into file together with its points
+Calls: TileFileName
+Called By: RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: sLayer - the data name of tile
+       pCloud - the point clouds indexed by tile
+       pCloudLabels - the label of each point, NULL means no label
+       iTileRow - the global tile row
+       iTileCol - the global tile column
+       vTile - the point indexes of each grid
+Output: a tile file
+Return: none
+Others: the storage of file is (point number, points (x y z), labels) of each grid,
+        the points are still in point clouds until they are removed by SamplingPointClouds
+*************************************************/
+void TopologyMap::EvictPointTile(const std::string & sLayer,
+	             const pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
+	                            const std::vector<int> * pCloudLabels,
+	                                          const int & iTileRow,
+	                                          const int & iTileCol,
+	                          std::vector<std::vector<int> > & vTile){
+
+	//an empty tile needs no file
+	bool bEmptyFlag = true;
+	for(int i = 0; i != vTile.size() && bEmptyFlag; ++i)
+		if(vTile[i].size())
+			bEmptyFlag = false;
+	if(bEmptyFlag)
+		return;
+
+	std::ofstream oTileFile(TileFileName(sLayer, iTileRow, iTileCol).c_str(), std::ios::out | std::ios::binary);
+	if(!oTileFile.is_open()){
+		ROS_INFO("Can not write the %s tile [%d, %d], it is dropped", sLayer.c_str(), iTileRow, iTileCol);
+		return;
 	}
 
-    //clear the point vector and save the new sampled points
-	pCloud->points.clear();
-	vCloudLabels.clear();
-	for(int i = 0; i != vSmplClouds.size(); ++i){
-		pCloud->points.push_back(vSmplClouds.points[i]);
-		vCloudLabels.push_back(vSmpCLoudLabels[i]);
+	for(int i = 0; i != vTile.size(); ++i){
+
+		int iPointNum = int(vTile[i].size());
+		oTileFile.write(reinterpret_cast<const char *>(&iPointNum), sizeof(int));
+
+		for(int j = 0; j != vTile[i].size(); ++j){
+			const pcl::PointXYZ & oPoint = pCloud->points[vTile[i][j]];
+			oTileFile.write(reinterpret_cast<const char *>(&oPoint.x), sizeof(float));
+			oTileFile.write(reinterpret_cast<const char *>(&oPoint.y), sizeof(float));
+			oTileFile.write(reinterpret_cast<const char *>(&oPoint.z), sizeof(float));
+		}
+
+		if(pCloudLabels)
+			for(int j = 0; j != vTile[i].size(); ++j)
+				oTileFile.write(reinterpret_cast<const char *>(&(*pCloudLabels)[vTile[i][j]]), sizeof(int));
+
+	}//end for i
+
+	oTileFile.close();
+
+}
+
+/*************************************************
+Function: LoadPointTile
+Description: read a point index tile moved into map from file together with its points
+Calls: TileFileName
+Called By: RecenterMap
+Table Accessed: none
+Table Updated: none
+Input: sLayer - the data name of tile
+       iTileRow - the global tile row
+       iTileCol - the global tile column
+Output: pCloud - the points of tile are appended
+        pCloudLabels - the labels of points are appended, NULL means no label
+        vTile - the point indexes of each grid
+Return: whether the tile is stored before and read completely
+Others: the file is removed after reading, a broken tile is dropped with its points
+*************************************************/
+bool TopologyMap::LoadPointTile(const std::string & sLayer,
+	                  pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
+	                                  std::vector<int> * pCloudLabels,
+	                                          const int & iTileRow,
+	                                          const int & iTileCol,
+	                          std::vector<std::vector<int> > & vTile){
+
+	std::string sFileName = TileFileName(sLayer, iTileRow, iTileCol);
+	std::ifstream oTileFile(sFileName.c_str(), std::ios::in | std::ios::binary);
+	if(!oTileFile.is_open())
+		return false;
+
+	vTile.assign(m_vConfidenceMap.TileGridNum(), std::vector<int>());
+
+	//the sizes before reading, which are restored if the file is broken
+	int iOldPointNum = int(pCloud->points.size());
+	int iOldLabelNum = pCloudLabels ? int(pCloudLabels->size()) : 0;
+	bool bReadFlag = true;
+
+	for(int i = 0; i != vTile.size() && bReadFlag; ++i){
+
+		int iPointNum = 0;
+		if(!oTileFile.read(reinterpret_cast<char *>(&iPointNum), sizeof(int)) || iPointNum < 0){
+			bReadFlag = false;
+			break;
+		}
+
+		for(int j = 0; j != iPointNum; ++j){
+			pcl::PointXYZ oPoint;
+			oTileFile.read(reinterpret_cast<char *>(&oPoint.x), sizeof(float));
+			oTileFile.read(reinterpret_cast<char *>(&oPoint.y), sizeof(float));
+			oTileFile.read(reinterpret_cast<char *>(&oPoint.z), sizeof(float));
+			if(!oTileFile){
+				bReadFlag = false;
+				break;
+			}
+			vTile[i].push_back(int(pCloud->points.size()));
+			pCloud->points.push_back(oPoint);
+		}
+
+		if(pCloudLabels && bReadFlag){
+			for(int j = 0; j != iPointNum; ++j){
+				int iLabel = 0;
+				if(!oTileFile.read(reinterpret_cast<char *>(&iLabel), sizeof(int))){
+					bReadFlag = false;
+					break;
+				}
+				pCloudLabels->push_back(iLabel);
+			}
+		}
+
+	}//end for i
+
+	oTileFile.close();
+
+	std::remove(sFileName.c_str());
+
+	//drop the whole tile if the file is broken
+	if(!bReadFlag){
+		pCloud->points.resize(iOldPointNum);
+		if(pCloudLabels)
+			pCloudLabels->resize(iOldLabelNum);
+		vTile.clear();
+		ROS_WARN("The tile file %s is broken, it is dropped", sFileName.c_str());
+	}
+
+	//keep the size of point clouds
+	pCloud->width = pCloud->points.size();
+	pCloud->height = 1;
+
+	return bReadFlag;
+
+}
+
+/*************************************************
+Function: CheckpointFileName
+Description: the checkpoint file of exploration state
+Calls: none
+Called By: SaveCheckpoint
+           ResumeCheckpoint
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: the file name
+Others: the file is in the output path (file_outputpath), together with the tile files of rolling map
+*************************************************/
+std::string TopologyMap::CheckpointFileName(){
+
+	return m_sFileHead + "Checkpoint.bin";
+
+}
+
+/*************************************************
+Function: SaveCheckpoint
+Description: take a snapshot of exploration state and write it in background
+Calls: OP::OutputNodeLists
+       MapCheckpoint::SaveAsync
+Called By: ProcessTrajectory
+           ~TopologyMap
+Table Accessed: none
+Table Updated: none
+Input: bForceFlag - write it whatever the period is (at exit)
+Output: a checkpoint file
+Return: none
+Others: the snapshot is only a copy of the members, the file is written by the writer thread of m_oCheckpoint,
+        it is skipped during planning since the planning worker owns the op solver meanwhile,
+        the tiles out of rolling map are not in the checkpoint, they are still in their tile files
+*************************************************/
+void TopologyMap::SaveCheckpoint(bool bForceFlag){
+
+	if(m_dCheckpointPeriod <= 0.0 || !m_bGridMapReadyFlag)
+		return;
+
+	double dNowTime = ros::Time::now().toSec();
+	if(!bForceFlag){
+		if(dNowTime - m_dLastCheckpointTime < m_dCheckpointPeriod)
+			return;
+		//the last one is still being written
+		if(m_bPlanningFlag || m_oCheckpoint.IsBusy())
+			return;
 	}
+	m_dLastCheckpointTime = dNowTime;
+
+	std::shared_ptr<CheckpointData> pData(new CheckpointData);
+
+	//map geometry
+	const grid_map::GridMap & oFeatureMap = m_oGMer.m_oFeatureMap;
+	pData->dMapPosX = oFeatureMap.getPosition().x();
+	pData->dMapPosY = oFeatureMap.getPosition().y();
+	pData->dResolution = oFeatureMap.getResolution();
+	for(int i = 0; i != 3; ++i){
+		pData->vMinCorner[i] = m_oGMer.m_oMinCorner(i);
+		pData->vMaxCorner[i] = m_oGMer.m_oMaxCorner(i);
+	}
+
+	//exploration state
+	pData->iNodeTimes = m_iNodeTimes;
+	pData->iComputedFrame = m_iComputedFrame;
+	pData->oNodeGoal = m_oNodeGoal;
 
+	//maps
+	pData->vConfidenceMap = m_vConfidenceMap;
+	pData->vBoundCloud = *m_pBoundCloud;
+	pData->vObstacleCloud = *m_pObstacleCloud;
+	pData->vObstNodeTimes = m_vObstNodeTimes;
+	pData->vBoundPntMapIdx = m_vBoundPntMapIdx;
+	pData->vObstlPntMapIdx = m_vObstlPntMapIdx;
+
+	//op nodes
+	pData->vAllNodes = m_oOPSolver.m_vAllNodes;
+	m_oOPSolver.OutputNodeLists(pData->iCurrNodeIdx, pData->vPlanNodeIdxs, pData->vPastNodeIdxs);
+
+	m_oCheckpoint.SaveAsync(CheckpointFileName(), pData);
+
+}
+
+/*************************************************
+Function: ResumeCheckpoint
+Description: restore the exploration state from the checkpoint
+Calls: MapCheckpoint::Load
+       ExtendedGM::GridNum
+       ExtendedGM::HalfLength
+       InitializeGridMap
+       OP::RestoreNodes
+       Confidence::ResetVisibility
+       Confidence::RebuildBoundDistance
+       Confidence::RebuildNodeCandidates
+       Astar::UpdateTravelMap
+Called By: ProcessTrajectory
+Table Accessed: none
+Table Updated: none
+Input: oRobotPos - the current robot position
+Output: the map, point clouds, node lists and goal of last run
+Return: false if there is no valid checkpoint or the robot is out of its map,
+        then a new map should be built by InitializeGridMap
+Others: the map is built at the stored center and takes the stored tiles,
+        the data derived from the map (boundary distance, node candidates and astar map) are computed again
+*************************************************/
+bool TopologyMap::ResumeCheckpoint(const pcl::PointXYZ & oRobotPos){
+
+	CheckpointData oData;
+	if(!MapCheckpoint::Load(CheckpointFileName(), oData)){
+		ROS_INFO("No valid checkpoint in %s, a new map is built", CheckpointFileName().c_str());
+		return false;
+	}
+
+	//check the checkpoint header before any map is built,
+	//since the map will be built again if the checkpoint is not used
+	if(std::fabs(oData.dResolution - m_oGMer.Resolution()) > 1e-6){
+		ROS_WARN("The resolution of checkpoint is different, a new map is built");
+		return false;
+	}
+
+	const int iGridNum = m_oGMer.GridNum();
+	if(oData.vConfidenceMap.RowNum() != iGridNum ||
+	   oData.vConfidenceMap.ColNum() != iGridNum){
+		ROS_WARN("The map size of checkpoint is different, a new map is built");
+		return false;
+	}
+
+	const double dHalfLength = m_oGMer.HalfLength();
+	if(std::fabs(double(oRobotPos.x) - oData.dMapPosX) >= dHalfLength ||
+	   std::fabs(double(oRobotPos.y) - oData.dMapPosY) >= dHalfLength){
+		ROS_WARN("The robot is out of the map of checkpoint, a new map is built");
+		return false;
+	}
+
+	//build the map at the stored center
+	pcl::PointXYZ oMapCenter;
+	oMapCenter.x = float(oData.dMapPosX);
+	oMapCenter.y = float(oData.dMapPosY);
+	oMapCenter.z = oRobotPos.z;
+	InitializeGridMap(oMapCenter);
+
+	grid_map::GridMap & oFeatureMap = m_oGMer.m_oFeatureMap;
+
+	for(int i = 0; i != 3; ++i){
+		m_oGMer.m_oMinCorner(i) = oData.vMinCorner[i];
+		m_oGMer.m_oMaxCorner(i) = oData.vMaxCorner[i];
+	}
+
+	//take the stored tiles
+	for(int i = 0; i != m_vConfidenceMap.TileRows(); ++i){
+		for(int j = 0; j != m_vConfidenceMap.TileCols(); ++j){
+			m_vConfidenceMap.Tile(i, j).swap(oData.vConfidenceMap.Tile(i, j));
+			m_vBoundPntMapIdx.Tile(i, j).swap(oData.vBoundPntMapIdx.Tile(i, j));
+			m_vObstlPntMapIdx.Tile(i, j).swap(oData.vObstlPntMapIdx.Tile(i, j));
+		}
+	}
+	m_vConfidenceMap.SetTileOrigin(oData.vConfidenceMap.TileRowOrigin(), oData.vConfidenceMap.TileColOrigin());
+	m_vBoundPntMapIdx.SetTileOrigin(oData.vBoundPntMapIdx.TileRowOrigin(), oData.vBoundPntMapIdx.TileColOrigin());
+	m_vObstlPntMapIdx.SetTileOrigin(oData.vObstlPntMapIdx.TileRowOrigin(), oData.vObstlPntMapIdx.TileColOrigin());
+
+	//point clouds
+	*m_pBoundCloud = oData.vBoundCloud;
+	*m_pObstacleCloud = oData.vObstacleCloud;
+	m_vObstNodeTimes.swap(oData.vObstNodeTimes);
+
+	//exploration state
+	m_iNodeTimes = oData.iNodeTimes;
+	m_iComputedFrame = oData.iComputedFrame;
+	m_oNodeGoal = oData.oNodeGoal;
+	m_oOPSolver.RestoreNodes(oData.vAllNodes, oData.iCurrNodeIdx, oData.vPlanNodeIdxs, oData.vPastNodeIdxs, oFeatureMap);
+
+	//the data derived from the map
+	m_oCnfdnSolver.ResetVisibility();
+	m_oCnfdnSolver.RebuildBoundDistance(m_vConfidenceMap);
+	m_oCnfdnSolver.RebuildNodeCandidates(m_vConfidenceMap, m_iNodeTimes);
+	m_oAstar.InitAstarTravelMap(oFeatureMap);
+	m_oAstar.UpdateTravelMap(oFeatureMap, m_vConfidenceMap);
+
+	ROS_INFO("Resume from checkpoint with [%d] tiles, [%d] nodes and node times [%d]", 
+		      m_vConfidenceMap.AllocatedTileNum(), int(m_oOPSolver.m_vAllNodes.size()), int(m_iNodeTimes));
+
+	return true;
 
 }
 
@@ -627,20 +1232,46 @@ void TopologyMap::SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pClo
 Function: HandleTrajectory
 Description: a callback function in below:
 m_oOdomSuber = nodeHandle.subscribe(m_sOdomTopic, 1, &TopologyMap::HandleTrajectory, this);
-this is the trigger functions and backbone functions of class TopologyMap
+this is the trigger functions of class TopologyMap
+Calls: none
+Called By: TopologyMap()
+Table Accessed: none
+Table Updated: none
+Input: oTrajectory - a ros type odometry position
+Output: 
+Return: none
+Others: the odometry is only queued, it is handled by ProcessTrajectory in the map worker
+*************************************************/
+void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
+
+	if (!m_vOdomQueue.Push(oTrajectory)){
+		m_iDroppedFrames++;
+		ROS_WARN_THROTTLE(1.0, "Odometry queue is full, [%u] frames are dropped", (unsigned int)m_iDroppedFrames);
+	}
+
+	m_oMapWakeCond.notify_one();
+
+}
+
+/*************************************************
+Function: ProcessTrajectory
+Description: update the map with a queued odometry (map worker)
+this is the backbone functions of class TopologyMap
 Calls: InitializeGridMap()
        OutputTrajectoryFile()
        ComputeConfidence()
+       RequestPlan()
        PublishGoalOdom()
-Called By: TopologyMap()
+Called By: MapWorkerLoop
 Table Accessed: none
 Table Updated: none
 Input: oTrajectory - a ros type odometry position
 Output: 
 Return: none
-Others: none
+Others: the planning is run by the planning worker on a snapshot,
+        the goal is not checked and the map is not moved until its result is applied
 *************************************************/
-void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
+void TopologyMap::ProcessTrajectory(const nav_msgs::Odometry & oTrajectory) {
 
 	//bool bMapUpdateFlag = false;
 	bool bSamplingFlag = false;
@@ -652,7 +1283,10 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 		oOdomPoint.x = oTrajectory.pose.pose.position.x;//z in loam is x
 		oOdomPoint.y = oTrajectory.pose.pose.position.y;//x in loam is y
 		oOdomPoint.z = oTrajectory.pose.pose.position.z;//y in loam is z
-		InitializeGridMap(oOdomPoint);
+
+		//restore the map of last run, or build a new one if there is no valid checkpoint
+		if(!m_bResumeFlag || !ResumeCheckpoint(oOdomPoint))
+			InitializeGridMap(oOdomPoint);
 	}
 	
 	if (!m_bGridMapReadyFlag)
@@ -670,7 +1304,8 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 		oOdomPoint.x = oTrajectory.pose.pose.position.x;//z in loam is x
 		oOdomPoint.y = oTrajectory.pose.pose.position.y;//x in loam is y
 		oOdomPoint.z = oTrajectory.pose.pose.position.z;//y in loam is z
-		m_vOdomViews.push(oOdomPoint);
+		m_vOdomViews.push_back(oOdomPoint);
+		m_iOdomViewCount++;
 		oOdomPoint.z = 0.0;
 		m_vOdomShocks.push(oOdomPoint);
 		OutputTrajectoryFile(oTrajectory);
@@ -679,10 +1314,15 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 		//m_vOdomViews in fact is a history odometry within a given interval
 		//it only report the current robot position (back) and past (given time before) position (front) 
 		if (m_vOdomViews.size() > m_iPastOdomNum)
-			m_vOdomViews.pop();
+			m_vOdomViews.pop_front();
 		if (m_vOdomShocks.size() > m_iShockNum)
 			m_vOdomShocks.pop();
 
+		//move the map before the robot reaches its border
+		//the planning worker uses the grid geometry and node grids, thus the map is moved after it
+		if (m_bRollingMapFlag && !m_bPlanningFlag)
+			RecenterMap(m_vOdomViews.back());
+
 		//compute the confidence map on the constructed map with surronding point clouds
 		if (m_bGridMapReadyFlag){
 			//frequency of visibility calculation should be low
@@ -693,12 +1333,14 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 		    }else{
 
 		    	//compute all features
-		    	ComputeConfidence(m_vOdomViews.back(), m_vOdomViews.front());
+		    	std::vector<pcl::PointXYZ> vPastViews;
+		    	SelectPastViews(vPastViews);
+		    	ComputeConfidence(m_vOdomViews.back(), vPastViews);
 			}//end else
 		}//end if m_bGridMapReadyFlag
      
         //if move in local way
-		if(m_bAnchorGoalFlag){
+		if(m_bAnchorGoalFlag && !m_bPlanningFlag){
             //near
             float fTouchAnchorGoal = false;
             fTouchAnchorGoal =  m_oOPSolver.NearGoal(m_vOdomShocks,m_iShockNum, m_iComputedFrame, 
@@ -719,7 +1361,8 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
         
 		float fTouchNodeGoal = false;
         //if move in global way
-		if(!m_bAnchorGoalFlag){
+		//the goal is being planned by the planning worker
+		if(!m_bAnchorGoalFlag && !m_bPlanningFlag){
             //check the robot is near the target node
             //if the robot is close to the target or the robot is standing in place in a long time
             fTouchNodeGoal =  m_oOPSolver.NearGoal(m_vOdomShocks, 
@@ -731,118 +1374,8 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
         
         //if it arrivals at the target node
         
-        if(fTouchNodeGoal){
-
-            clock_t oBeforeNode = clock();
-
-			//get the new nodes
-			std::vector<int> vNewNodeIdx;
-			std::vector<pcl::PointXYZ> vNodeClouds;
-			m_oCnfdnSolver.FindLocalMinimum(vNewNodeIdx, vNodeClouds,
-	                                        m_vConfidenceMap, m_oGMer, m_iNodeTimes);
-
-			//get new nodes
-			m_oOPSolver.GetNewNodeSuppression(m_vConfidenceMap, 
-				                                   vNewNodeIdx, 
-				                                   vNodeClouds, 1.0);
-
-            //*******use op solver*********
-			if(m_oOPSolver.UpdateNodes(m_vConfidenceMap,0.7,0.8))
-				//use greedy based method
-				m_oOPSolver.GTR(m_vOdomViews.back(),m_vConfidenceMap);
-			else
-				//use branch and bound based method
-				m_oOPSolver.BranchBoundMethod(m_vOdomViews.back(),m_vConfidenceMap);
-		    
-		    //output node
-		    m_oOPSolver.OutputGoalPos(m_oNodeGoal);
-
-
-		    if(!m_bOutNodeFileFlag){
-		    	m_sOutNodeFileName << m_sFileHead << "Node_" << ros::Time::now() << ".txt";
-		    	m_bOutNodeFileFlag = true;
-		    }
-
-		    //output txt file recording node position
-		    m_oNodeFile.open(m_sOutNodeFileName.str(), std::ios::out | std::ios::app);
-
-		    //record data
-            m_oNodeFile << m_oNodeGoal.x << " "
-                        << m_oNodeGoal.y << " "
-                        << m_oNodeGoal.z << " "  
-                        << std::endl;
-
-            m_oNodeFile.close();
-
-		    std::vector<pcl::PointXYZ> vUnvisitedNodes;
-		    m_oOPSolver.OutputUnvisitedNodes(vUnvisitedNodes);
-
-
-		    std::cout<< "remain unvisited nodes are " << vUnvisitedNodes.size()<< std::endl;
-
-
-            //clear old data of last trip
-		    m_vOdomShocks = std::queue<pcl::PointXYZ>();
-            oNodeDur = oNodeDur + (double)(clock() - oBeforeNode)/ CLOCKS_PER_SEC;
-		    //if there are still some regions to explore
-            //compute astar path for current target point
-            if(vUnvisitedNodes.size()){
-
-            	clock_t  oBeforeLocalPath = clock();
-            	//update travelable map
-		        m_oAstar.UpdateTravelMap(m_oGMer.m_oFeatureMap, m_vConfidenceMap);
-                //get raw astar path point clouds
-                pcl::PointCloud<pcl::PointXYZ>::Ptr pAstarCloud(new pcl::PointCloud<pcl::PointXYZ>);
-                pcl::PointCloud<pcl::PointXYZ>::Ptr pAttractorCloud(new pcl::PointCloud<pcl::PointXYZ>);
-                std::vector<float> vQualityFeature;
-                
-                //compute astar path
-		        bool bPathOptmFlag = m_oAstar.GetPath(pAttractorCloud, 
-		                                              vQualityFeature,
-		                                              pAstarCloud, 
-	                                                  m_oGMer,
-	                                                  m_vConfidenceMap,
-	                                                  m_vOdomViews.back(), m_oNodeGoal, false);
-
-                //if the goal has a very clear and credible path
-		        if(bPathOptmFlag){
-
-                    pcl::PointCloud<pcl::PointXY>::Ptr pAttractorSeq(new pcl::PointCloud<pcl::PointXY>);
-		            //sort the controls from max to min
-		        
-	                oLclPthOptimer.SortFromBigtoSmall(pAttractorSeq,
-	                                              pAttractorCloud, 
-		                                          vQualityFeature);
-
-	                ////generate new local path
-	                m_vAncherGoals.clear();
-	                
-	                m_bAnchorGoalFlag = oLclPthOptimer.NewLocalPath(m_vAncherGoals,
-	                                                            pAttractorSeq, 
-		                                                        vQualityFeature,
-		                                                        pAstarCloud, 
-	                                                            m_oGMer,
-	                                                            m_vConfidenceMap,1.5, 1);
-
-                    //print to screen
-                    if(m_bAnchorGoalFlag)
-                    	std::cout<<"walking in local curve. "<<std::endl;
-
-		            //PublishPointCloud(*pAttractorCloud);//for test only
-		            //PublishPointCloud(m_vAncherGoals);//for test only
-
-		        }//end if bPathOptmFlag
-
-            oLocalPathTermDur = oLocalPathTermDur + (double)(clock()-oBeforeLocalPath)/ CLOCKS_PER_SEC;
-		    }//end if vUnvisitedNodes.size()
-            
-            
-
-            //begin the next trip
-            if(m_oOPSolver.CheckNodeTimes())
-            	m_iNodeTimes++;
-		    
-		}//end if m_oOPSolver.NearGoal
+        if(fTouchNodeGoal)
+        	RequestPlan();
 
         
        
@@ -870,6 +1403,10 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 
     }//end if (!(m_iTrajFrameNum % m_iOdomSampingNum))
 
+	//the snapshot is taken between two frames, the writing is in background
+	if (bSamplingFlag)
+		SaveCheckpoint();
+
 	//if the frame count touches the least common multiple of m_iOdomSampingNum and 
 	//if( bMapUpdateFlag && bSamplingFlag ){
 	if (bSamplingFlag) {
@@ -883,6 +1420,377 @@ void TopologyMap::HandleTrajectory(const nav_msgs::Odometry & oTrajectory) {
 }
 
 
+/*************************************************
+Function: RequestPlan
+Description: send a snapshot of the map to the planning worker when the robot reaches its goal
+Calls: Confidence::FindLocalMinimum
+Called By: ProcessTrajectory
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: a planning job in m_vPlanJobs
+Return: none
+Others: the local minimum is found here since the node candidates are kept by the map worker,
+        the confidence map is copied, so the planning worker reads a consistent map 
+        while the map worker goes on updating m_vConfidenceMap
+*************************************************/
+void TopologyMap::RequestPlan(){
+
+	clock_t oBeforeNode = clock();
+
+	std::shared_ptr<PlanJob> pJob(new PlanJob);
+
+	//get the new nodes
+	m_oCnfdnSolver.FindLocalMinimum(pJob->vNewNodeIdxs, pJob->vNodeClouds,
+	                                m_vConfidenceMap, m_oGMer, m_iNodeTimes);
+
+	pJob->vConfidenceMap = m_vConfidenceMap;
+	pJob->oRobotPos = m_vOdomViews.back();
+	pJob->iNodeTimes = m_iNodeTimes;
+
+	//clear old data of last trip
+	m_vOdomShocks = std::queue<pcl::PointXYZ>();
+	oNodeDur = oNodeDur + (double)(clock() - oBeforeNode)/ CLOCKS_PER_SEC;
+
+	//the job queue is empty since only one job is running
+	m_bPlanningFlag = true;
+	m_vPlanJobs.Push(pJob);
+	m_oPlanWakeCond.notify_one();
+
+}
+
+/*************************************************
+Function: PlanNextGoal
+Description: plan the next goal and the local path to it (planning worker)
+Calls: OP::GetNewNodeSuppression
+       OP::UpdateNodes
+       OP::AnytimeMethod
+       OP::GTR
+       OP::BranchBoundMethod
+       Astar::GetPath
+       PathOptimization::NewLocalPath
+Called By: PlanWorkerLoop
+Table Accessed: none
+Table Updated: none
+Input: oJob - the snapshot of the map
+Output: oJob - the planning result
+Return: none
+Others: m_oOPSolver, m_oAstar and oLclPthOptimer are only used by this worker while a job is running,
+        the obstacle bits changed meanwhile are applied to m_oAstar in ApplyPlanResult
+*************************************************/
+void TopologyMap::PlanNextGoal(PlanJob & oJob){
+
+	clock_t oBeforeNode = clock();
+
+	const ConfidenceMap & vConfidenceMap = oJob.vConfidenceMap;
+
+	//get new nodes
+	m_oOPSolver.GetNewNodeSuppression(vConfidenceMap, 
+		                              oJob.vNewNodeIdxs, 
+		                              oJob.vNodeClouds, 1.0);
+
+	//*******use op solver*********
+	bool bWideFlag = m_oOPSolver.UpdateNodes(vConfidenceMap,0.7,0.8);
+	if(m_oOPSolver.GetOPSolverType() == 2)
+		//use anytime method whose time is limited
+		m_oOPSolver.AnytimeMethod(oJob.oRobotPos,vConfidenceMap);
+	else if(bWideFlag)
+		//use greedy based method
+		m_oOPSolver.GTR(oJob.oRobotPos,vConfidenceMap);
+	else
+		//use branch and bound based method
+		m_oOPSolver.BranchBoundMethod(oJob.oRobotPos,vConfidenceMap);
+
+	//output node
+	m_oOPSolver.OutputGoalPos(oJob.oNodeGoal);
+
+
+	if(!m_bOutNodeFileFlag){
+		m_sOutNodeFileName << m_sFileHead << "Node_" << ros::Time::now() << ".txt";
+		m_oLogWriter.Open(NODE_LOG, m_sOutNodeFileName.str());
+		m_bOutNodeFileFlag = true;
+	}
+
+	//record node position, the file is written by the log writer
+	std::stringstream sNodeLine;
+	sNodeLine << oJob.oNodeGoal.x << " "
+	          << oJob.oNodeGoal.y << " "
+	          << oJob.oNodeGoal.z << " "  
+	          << "\n";
+	m_oLogWriter.WriteText(NODE_LOG, sNodeLine.str());
+
+	std::vector<pcl::PointXYZ> vUnvisitedNodes;
+	m_oOPSolver.OutputUnvisitedNodes(vUnvisitedNodes);
+
+
+	std::cout<< "remain unvisited nodes are " << vUnvisitedNodes.size()<< std::endl;
+
+	oNodeDur = oNodeDur + (double)(clock() - oBeforeNode)/ CLOCKS_PER_SEC;
+	//if there are still some regions to explore
+	//compute astar path for current target point
+	if(vUnvisitedNodes.size()){
+
+		clock_t  oBeforeLocalPath = clock();
+		//get raw astar path point clouds
+		pcl::PointCloud<pcl::PointXYZ>::Ptr pAstarCloud(new pcl::PointCloud<pcl::PointXYZ>);
+		pcl::PointCloud<pcl::PointXYZ>::Ptr pAttractorCloud(new pcl::PointCloud<pcl::PointXYZ>);
+		std::vector<float> vQualityFeature;
+
+		//compute astar path
+		bool bPathOptmFlag = m_oAstar.GetPath(pAttractorCloud, 
+		                                      vQualityFeature,
+		                                      pAstarCloud, 
+		                                      m_oGMer,
+		                                      vConfidenceMap,
+		                                      oJob.oRobotPos, oJob.oNodeGoal, false);
+
+		//if the goal has a very clear and credible path
+		if(bPathOptmFlag){
+
+			pcl::PointCloud<pcl::PointXY>::Ptr pAttractorSeq(new pcl::PointCloud<pcl::PointXY>);
+			//sort the controls from max to min
+
+			oLclPthOptimer.SortFromBigtoSmall(pAttractorSeq,
+			                                  pAttractorCloud, 
+			                                  vQualityFeature);
+
+			////generate new local path
+			oJob.vAncherGoals.clear();
+
+			oJob.bAnchorGoalFlag = oLclPthOptimer.NewLocalPath(oJob.vAncherGoals,
+			                                                   pAttractorSeq, 
+			                                                   vQualityFeature,
+			                                                   pAstarCloud, 
+			                                                   m_oGMer,
+			                                                   vConfidenceMap,1.5, 1);
+
+			//print to screen
+			if(oJob.bAnchorGoalFlag)
+				std::cout<<"walking in local curve. "<<std::endl;
+
+		}//end if bPathOptmFlag
+
+		oLocalPathTermDur = oLocalPathTermDur + (double)(clock()-oBeforeLocalPath)/ CLOCKS_PER_SEC;
+	}//end if vUnvisitedNodes.size()
+
+	//begin the next trip
+	oJob.bNextTripFlag = m_oOPSolver.CheckNodeTimes();
+
+}
+
+/*************************************************
+Function: ApplyPlanResult
+Description: take the result of planning worker if it is done (map worker)
+Calls: Astar::SetObstacle
+Called By: MapWorkerLoop
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the goal, the local path and the node times
+Return: none
+Others: the obstacle bits changed during planning are applied to m_oAstar in order
+*************************************************/
+void TopologyMap::ApplyPlanResult(){
+
+	std::shared_ptr<PlanJob> pJob;
+	if(!m_vPlanResults.Pop(pJob))
+		return;
+
+	m_oNodeGoal = pJob->oNodeGoal;
+
+	//the anchors of last local path are kept if no new path is generated
+	if(pJob->bAnchorGoalFlag)
+		m_vAncherGoals = pJob->vAncherGoals;
+	m_bAnchorGoalFlag = pJob->bAnchorGoalFlag;
+
+	//begin the next trip
+	if(pJob->bNextTripFlag)
+		m_iNodeTimes++;
+
+	for(int i = 0; i != m_vPendingObstacles.size(); ++i)
+		m_oAstar.SetObstacle(m_vPendingObstacles[i].first, m_vPendingObstacles[i].second);
+	m_vPendingObstacles.clear();
+
+	m_bPlanningFlag = false;
+
+}
+
+/*************************************************
+Function: StartWorkers
+Description: start the map worker and planning worker
+Calls: MapWorkerLoop
+       PlanWorkerLoop
+Called By: TopologyMap()
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: none
+*************************************************/
+void TopologyMap::StartWorkers(){
+
+	m_bStopFlag = false;
+	m_oMapWorker = std::thread(&TopologyMap::MapWorkerLoop, this);
+	m_oPlanWorker = std::thread(&TopologyMap::PlanWorkerLoop, this);
+
+}
+
+/*************************************************
+Function: StopWorkers
+Description: stop the map worker and planning worker
+Calls: none
+Called By: ~TopologyMap()
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: a running planning job is finished before the planning worker stops
+*************************************************/
+void TopologyMap::StopWorkers(){
+
+	m_bStopFlag = true;
+	m_oMapWakeCond.notify_all();
+	m_oPlanWakeCond.notify_all();
+
+	if(m_oMapWorker.joinable())
+		m_oMapWorker.join();
+	if(m_oPlanWorker.joinable())
+		m_oPlanWorker.join();
+
+}
+
+/*************************************************
+Function: MapWorkerLoop
+Description: the loop of map worker, it consumes the queues of callbacks
+Calls: IngestGroundCloud
+       IngestBoundCloud
+       IngestObstacleCloud
+       ApplyPlanResult
+       ProcessTrajectory
+Called By: StartWorkers
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: none
+Return: none
+Others: the point clouds are ingested before each odometry,
+        so the confidence of an odometry is computed with all scans received before it,
+        the worker sleeps at most 10 ms if all queues are empty
+*************************************************/
+void TopologyMap::MapWorkerLoop(){
+
+	while(!m_bStopFlag){
+
+		bool bWorkFlag = false;
+		CloudPtr pCloud;
+
+		while(m_vGroundQueue.Pop(pCloud)){
+			IngestGroundCloud(pCloud);
+			bWorkFlag = true;
+		}
+
+		while(m_vBoundQueue.Pop(pCloud)){
+			IngestBoundCloud(pCloud);
+			bWorkFlag = true;
+		}
+
+		while(m_vObstacleQueue.Pop(pCloud)){
+			IngestObstacleCloud(pCloud);
+			bWorkFlag = true;
+		}
+
+		ApplyPlanResult();
+
+		//one odometry in each loop, so that the scans arriving meanwhile are ingested first
+		nav_msgs::Odometry oTrajectory;
+		if(m_vOdomQueue.Pop(oTrajectory)){
+			ProcessTrajectory(oTrajectory);
+			bWorkFlag = true;
+		}
+
+		if(!bWorkFlag){
+			std::unique_lock<std::mutex> oWakeLock(m_oMapWakeMutex);
+			m_oMapWakeCond.wait_for(oWakeLock, std::chrono::milliseconds(10));
+		}
+
+	}//end while
+
+}
+
+/*************************************************
+Function: PlanWorkerLoop
+Description: the loop of planning worker
+Calls: PlanNextGoal
+Called By: StartWorkers
+Table Accessed: none
+Table Updated: none
+Input: none
+Output: the planned jobs in m_vPlanResults
+Return: none
+Others: none
+*************************************************/
+void TopologyMap::PlanWorkerLoop(){
+
+	while(!m_bStopFlag){
+
+		std::shared_ptr<PlanJob> pJob;
+		if(!m_vPlanJobs.Pop(pJob)){
+			std::unique_lock<std::mutex> oWakeLock(m_oPlanWakeMutex);
+			m_oPlanWakeCond.wait_for(oWakeLock, std::chrono::milliseconds(10));
+			continue;
+		}
+
+		PlanNextGoal(*pJob);
+
+		//only one job is running, so the result queue is never full
+		m_vPlanResults.Push(pJob);
+		m_oMapWakeCond.notify_one();
+
+	}//end while
+
+}
+
+
+/*************************************************
+Function: SetGridLabel
+Description: set the label of a grid, the obstacle bit of astar map is flipped
+             only if the grid turns to or from an obstacle/boundary grid
+Calls: Astar::SetObstacle
+       MarkDirtyGrid
+Called By: IngestGroundCloud
+           IngestBoundCloud
+           IngestObstacleCloud
+Table Accessed: none
+Table Updated: none
+Input: iGridIdx - the 1d index of grid
+       iLabel - the new label, 0 unknown, 1 obstacle, 2 ground, 3 boundary
+Output: the label of m_vConfidenceMap, the obstacle bit of m_oAstar and m_oDirtyRect
+Return: none
+Others: all label changes after the map initialization should go through this function,
+        so that the astar map does not need to be rebuilt before planning,
+        the obstacle bit is delayed to the end of planning if a planning job is running
+*************************************************/
+void TopologyMap::SetGridLabel(const int & iGridIdx, const int & iLabel){
+
+	bool bObstacleFlag = Astar::IsObstacleLabel(iLabel);
+
+	if (Astar::IsObstacleLabel(m_vConfidenceMap[iGridIdx].label) != bObstacleFlag){
+		//the astar map is used by the planning worker
+		if (m_bPlanningFlag)
+			m_vPendingObstacles.push_back(std::make_pair(iGridIdx, bObstacleFlag));
+		else
+			m_oAstar.SetObstacle(iGridIdx, bObstacleFlag);
+	}
+
+	if (m_vConfidenceMap[iGridIdx].label != iLabel)
+		MarkDirtyGrid(iGridIdx);
+
+	m_vConfidenceMap[iGridIdx].label = iLabel;
+
+}
+
 /*************************************************
 Function: HandleGroundClouds
 Description: a callback function in below:
@@ -895,17 +1803,44 @@ Table Updated: none
 Input: vGroundRosData - a point clouds send from another ros topic
 Output: none
 Return: none
+Others: the frame is only converted and queued, it is handled by IngestGroundCloud in the map worker,
+        thus the callback is never blocked by the map update or planning
+*************************************************/
+void TopologyMap::HandleGroundClouds(const sensor_msgs::PointCloud2 & vGroundRosData) {
+
+	////a point clouds in PCL type
+	CloudPtr pOneGCloud(new pcl::PointCloud<pcl::PointXYZ>);
+	////message from ROS type to PCL type
+	pcl::fromROSMsg(vGroundRosData, *pOneGCloud);
+
+	if (!m_vGroundQueue.Push(pOneGCloud)){
+		m_iDroppedFrames++;
+		ROS_WARN_THROTTLE(1.0, "Ground cloud queue is full, [%u] frames are dropped", (unsigned int)m_iDroppedFrames);
+	}
+
+	m_oMapWakeCond.notify_one();
+
+}
+
+/*************************************************
+Function: IngestGroundCloud
+Description: update the map with a queued point cloud frame (map worker)
+this is to store ground point based on the grid (present center point of grid occupied by the ground points)
+Calls: none
+Called By: MapWorkerLoop
+Table Accessed: none
+Table Updated: none
+Input: pOneGCloud - a point clouds send from another ros topic
+Output: none
+Return: none
 Others: none
 *************************************************/
 
-void TopologyMap::HandleGroundClouds(const sensor_msgs::PointCloud2 & vGroundRosData) {
+void TopologyMap::IngestGroundCloud(const CloudPtr & pOneGCloud) {
 
-	if (m_bGridMapReadyFlag) {
+	pcl::PointCloud<pcl::PointXYZ> & vOneGCloud = *pOneGCloud;
 
-		////a point clouds in PCL type
-		pcl::PointCloud<pcl::PointXYZ> vOneGCloud;
-		////message from ROS type to PCL type
-		pcl::fromROSMsg(vGroundRosData, vOneGCloud);
+	if (m_bGridMapReadyFlag) {
 
         std::vector<int> vNewScanGridIdxs;
 		//get right point clouds from LOAM output
@@ -923,7 +1858,7 @@ void TopologyMap::HandleGroundClouds(const sensor_msgs::PointCloud2 & vGroundRos
 							m_vConfidenceMap[oAllTypeIdx.iOneIdx].oCenterPoint.z = vOneGCloud.points[i].z;
 							//to grid layer
 
-							m_vConfidenceMap[oAllTypeIdx.iOneIdx].label = 2;
+							SetGridLabel(oAllTypeIdx.iOneIdx, 2);
 							vNewScanGridIdxs.push_back(oAllTypeIdx.iOneIdx);
 						
 						}else{
@@ -934,7 +1869,7 @@ void TopologyMap::HandleGroundClouds(const sensor_msgs::PointCloud2 & vGroundRos
 							
 							//cover obstacle grid
 							if (m_vConfidenceMap[oAllTypeIdx.iOneIdx].label < 2)
-								m_vConfidenceMap[oAllTypeIdx.iOneIdx].label = 2;
+								SetGridLabel(oAllTypeIdx.iOneIdx, 2);
 
 						}//end else
 
@@ -944,7 +1879,7 @@ void TopologyMap::HandleGroundClouds(const sensor_msgs::PointCloud2 & vGroundRos
 		}//end for (int i = 0; i != vOneGCloud.size();
 
 		//record one frame of point clouds in txt file
-		//OutputScannedPCFile(vOneGCloud);
+		//OutputScannedPCFile(pOneGCloud);
 
 	}//end if m_bGridMapReadyFlag
 
@@ -955,25 +1890,53 @@ Function: HandleBoundClouds
 Description: a callback function in below:
 m_oBoundSuber = nodeHandle.subscribe(m_sBoundTopic, 1, &TopologyMap::HandleBoundClouds, this);
 this is to store boundary points
-Calls: SamplingPointClouds()
+Calls: none
 Called By: TopologyMap()
 Table Accessed: none
 Table Updated: none
-Input: vBoundRosData - a 3d point clouds send from another topic
+Input: vBoundRosData - a point clouds send from another ros topic
+Output: none
+Return: none
+Others: the frame is only converted and queued, it is handled by IngestBoundCloud in the map worker,
+        thus the callback is never blocked by the map update or planning
+*************************************************/
+void TopologyMap::HandleBoundClouds(const sensor_msgs::PointCloud2 & vBoundRosData) {
+
+	////a point clouds in PCL type
+	CloudPtr pOneBCloud(new pcl::PointCloud<pcl::PointXYZ>);
+	////message from ROS type to PCL type
+	pcl::fromROSMsg(vBoundRosData, *pOneBCloud);
+
+	if (!m_vBoundQueue.Push(pOneBCloud)){
+		m_iDroppedFrames++;
+		ROS_WARN_THROTTLE(1.0, "Bound cloud queue is full, [%u] frames are dropped", (unsigned int)m_iDroppedFrames);
+	}
+
+	m_oMapWakeCond.notify_one();
+
+}
+
+/*************************************************
+Function: IngestBoundCloud
+Description: update the map with a queued point cloud frame (map worker)
+this is to store boundary points
+Calls: SamplingPointClouds()
+       Confidence::AddBoundaryGrid
+Called By: MapWorkerLoop
+Table Accessed: none
+Table Updated: none
+Input: pOneBCloud - a 3d point clouds send from another topic
 Output: none
 Return: none
 Others: none
 *************************************************/
 
-void TopologyMap::HandleBoundClouds(const sensor_msgs::PointCloud2 & vBoundRosData) {
+void TopologyMap::IngestBoundCloud(const CloudPtr & pOneBCloud) {
+
+	pcl::PointCloud<pcl::PointXYZ> & vOneBCloud = *pOneBCloud;
 	//if grid map is built
 	if (m_bGridMapReadyFlag) {
 
-		////a point clouds in PCL type
-		pcl::PointCloud<pcl::PointXYZ> vOneBCloud;
-		////message from ROS type to PCL type
-		pcl::fromROSMsg(vBoundRosData, vOneBCloud);
-
 		//get boundary points between the ground region and obstacle region
 		for (int i = 0; i != vOneBCloud.size(); ++i) {
 			//sampling
@@ -982,12 +1945,14 @@ void TopologyMap::HandleBoundClouds(const sensor_msgs::PointCloud2 & vBoundRosDa
 				if (m_oGMer.CheckInSidePoint(vOneBCloud.points[i])) {
 					m_pBoundCloud->points.push_back(vOneBCloud.points[i]);
 					int iPointIdx = ExtendedGM::PointoOneDIdx(vOneBCloud.points[i],m_oGMer.m_oFeatureMap);
-					//to point idx
-					m_vBoundPntMapIdx[iPointIdx].push_back(m_iBoundFrames);
+					//to point idx, which is the position in point clouds (it is changed by sampling)
+					m_vBoundPntMapIdx[iPointIdx].push_back(int(m_pBoundCloud->points.size()) - 1);
 					//if this grid has not been found as a boundary region
 					if (m_vConfidenceMap[iPointIdx].label != 3) {
 						//label as boundary grid
-					    m_vConfidenceMap[iPointIdx].label = 3;
+					    SetGridLabel(iPointIdx, 3);
+					    //update the distance to boundary nearby
+					    m_oCnfdnSolver.AddBoundaryGrid(iPointIdx);
 					    //search its neighboring region (region grow scale)
 					    std::vector<int> vNearGridIdx;
 				        ExtendedGM::CircleNeighborhood(vNearGridIdx,
@@ -996,8 +1961,10 @@ void TopologyMap::HandleBoundClouds(const sensor_msgs::PointCloud2 & vBoundRosDa
 		                                               iPointIdx);
 
 				        //label as non-travelable region since it is dangerous for robot to close to obstacle in a distance
-                        for(int i = 0; i != vNearGridIdx.size(); ++i)
+                        for(int i = 0; i != vNearGridIdx.size(); ++i){
                         	m_vConfidenceMap[vNearGridIdx[i]].travelable = 4;
+                        	MarkDirtyGrid(vNearGridIdx[i]);
+                        }
 
 				    }//end if
 
@@ -1008,10 +1975,12 @@ void TopologyMap::HandleBoundClouds(const sensor_msgs::PointCloud2 & vBoundRosDa
 		}//end for
 
 		//record one frame of point clouds in txt file
-		OutputScannedPCFile(vOneBCloud);
+		OutputScannedPCFile(pOneBCloud);
 
 		if(m_pBoundCloud->points.size()>3000000){
 			SamplingPointClouds(m_pBoundCloud, m_vBoundPntMapIdx);
+			//point indices are changed, thus the visibility hull can not be reused
+			m_oCnfdnSolver.ResetVisibility();
 		}//end if if(m_pBoundCloud->points.size()>X)
 
 	}//if m_bGridMapReadyFlag
@@ -1023,24 +1992,51 @@ Function: HandleObstacleClouds
 Description: a callback function in below:
 m_oObstacleSuber = nodeHandle.subscribe(m_sObstacleTopic, 1, &TopologyMap::HandleObstacleClouds, this);
 this is to store obstacle point clouds
-Calls: SamplingPointClouds()
+Calls: none
 Called By: TopologyMap()
 Table Accessed: none
 Table Updated: none
-Input: vObstacleRosData - an obstacle point clouds send from another topic  
+Input: vObstacleRosData - a point clouds send from another ros topic
+Output: none
+Return: none
+Others: the frame is only converted and queued, it is handled by IngestObstacleCloud in the map worker,
+        thus the callback is never blocked by the map update or planning
+*************************************************/
+void TopologyMap::HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacleRosData) {
+
+	////a point clouds in PCL type
+	CloudPtr pOneOCloud(new pcl::PointCloud<pcl::PointXYZ>);
+	////message from ROS type to PCL type
+	pcl::fromROSMsg(vObstacleRosData, *pOneOCloud);
+
+	if (!m_vObstacleQueue.Push(pOneOCloud)){
+		m_iDroppedFrames++;
+		ROS_WARN_THROTTLE(1.0, "Obstacle cloud queue is full, [%u] frames are dropped", (unsigned int)m_iDroppedFrames);
+	}
+
+	m_oMapWakeCond.notify_one();
+
+}
+
+/*************************************************
+Function: IngestObstacleCloud
+Description: update the map with a queued point cloud frame (map worker)
+this is to store obstacle point clouds
+Calls: SamplingPointClouds()
+Called By: MapWorkerLoop
+Table Accessed: none
+Table Updated: none
+Input: pOneOCloud - an obstacle point clouds send from another topic  
 Output: none
 Return: none
 Others: none
 *************************************************/
 
-void TopologyMap::HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacleRosData) {
+void TopologyMap::IngestObstacleCloud(const CloudPtr & pOneOCloud) {
 
-	if (m_bGridMapReadyFlag) {
+	pcl::PointCloud<pcl::PointXYZ> & vOneOCloud = *pOneOCloud;
 
-		////a point clouds in PCL type
-		pcl::PointCloud<pcl::PointXYZ> vOneOCloud;
-		////message from ROS type to PCL type
-		pcl::fromROSMsg(vObstacleRosData, vOneOCloud);
+	if (m_bGridMapReadyFlag) {
 
 		//get obstacle points
 		for (int i = 0; i != vOneOCloud.size(); ++i) {
@@ -1055,13 +2051,13 @@ void TopologyMap::HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacl
 					m_vObstNodeTimes.push_back(m_iNodeTimes);
                     //send point index to grid member
 					int iPointIdx = ExtendedGM::PointoOneDIdx(vOneOCloud.points[i],m_oGMer.m_oFeatureMap);
-					//to point idx
-					m_vObstlPntMapIdx[iPointIdx].push_back(m_iObstacleFrames);
+					//to point idx, which is the position in point clouds (it is changed by sampling)
+					m_vObstlPntMapIdx[iPointIdx].push_back(int(m_pObstacleCloud->points.size()) - 1);
 
 					//the obstacle grid can cover unknown, ground, obstacle grids in simulation
 					if(!m_vConfidenceMap[iPointIdx].label) {
 						//label grid as obstacle grid
-						m_vConfidenceMap[iPointIdx].label = 1;
+						SetGridLabel(iPointIdx, 1);
 						//
 						m_vConfidenceMap[iPointIdx].travelable = 4;
 						
@@ -1074,10 +2070,12 @@ void TopologyMap::HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacl
 		}//end for i
 
         //record one frame of point clouds in txt file
-		OutputScannedPCFile(vOneOCloud);
+		OutputScannedPCFile(pOneOCloud);
 
 		if(m_pObstacleCloud->points.size()>8000000){
 			SamplingPointClouds(m_pObstacleCloud, m_vObstlPntMapIdx, m_vObstNodeTimes);
+			//point indices are changed, thus the visibility hull can not be reused
+			m_oCnfdnSolver.ResetVisibility();
 		}//end if if(m_pObstacleCloud->points.size()>X)
 
 	}//end if (m_bGridMapReadyFlag) 
@@ -1085,6 +2083,44 @@ void TopologyMap::HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacl
 }
 
 
+/*************************************************
+Function: SelectPastViews
+Description: select the past viewpoints of occlusion calculation from the history odometry
+Calls: none
+Called By: ProcessTrajectory
+Table Accessed: none
+Table Updated: none
+Input: m_vOdomViews - the history odometry
+Output: vPastRobotPoses - at most m_iPastViewNum past robot positions, the oldest one is the first
+Return: none
+Others: the viewpoints are picked by their count number rather than their position in m_vOdomViews,
+        thus a picked viewpoint is picked again in the next frames until it leaves the history,
+        which keeps its cached hull reusable
+*************************************************/
+void TopologyMap::SelectPastViews(std::vector<pcl::PointXYZ> & vPastRobotPoses){
+
+	vPastRobotPoses.clear();
+
+	//the count interval of two picked viewpoints
+	int iViewStep = m_iPastOdomNum / m_iPastViewNum;
+	if (iViewStep <= 0)
+		iViewStep = 1;
+
+	//count number of the oldest odometry point
+	unsigned int iFrontCount = m_iOdomViewCount - m_vOdomViews.size();
+
+	for (int i = 0; i != m_vOdomViews.size() && vPastRobotPoses.size() < m_iPastViewNum; ++i){
+		if (!((iFrontCount + i) % iViewStep))
+			vPastRobotPoses.push_back(m_vOdomViews[i]);
+	}
+
+	//at least the oldest one
+	if (!vPastRobotPoses.size())
+		vPastRobotPoses.push_back(m_vOdomViews.front());
+
+}
+
+
 /*************************************************
 Function: ComputeConfidence
 Description: this function is to compute the confidence feature of scanning scene
@@ -1095,7 +2131,7 @@ Called By: main function of project
 Table Accessed: none
 Table Updated: none
 Input: oCurrRobotPos - current robot position
-	   oPastRobotPos - past robot position
+	   vPastRobotPoses - past robot positions
 Output: m_oCnfdnSolver - confidence map
         m_oGMer - grid_map type base map data
 Return: none
@@ -1103,11 +2139,12 @@ Others: none
 *************************************************/
 
 void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos,
-	                                const pcl::PointXYZ & oPastRobotPos) {
+	                                const std::vector<pcl::PointXYZ> & vPastRobotPoses) {
 
 	pcl::PointCloud<pcl::PointXYZ>::Ptr pNearGrndClouds(new pcl::PointCloud<pcl::PointXYZ>);
 	pcl::PointCloud<pcl::PointXYZ>::Ptr pNearBndryClouds(new pcl::PointCloud<pcl::PointXYZ>);
 	pcl::PointCloud<pcl::PointXYZ>::Ptr pNearAllClouds(new pcl::PointCloud<pcl::PointXYZ>);
+    std::vector<long long> vNearAllKeys;
     std::vector<int> vNearGrndGrdIdxs;
 
     //find the neighboring point clouds
@@ -1117,17 +2154,22 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos,
 		                           m_oGMer.m_vRobotSearchMask,
 		                           oCurrRobotPos);
 
+	//the terms below only change the nearby grids, and the region grow adds its grown grids
+	m_oDirtyRect.Add(vNearByIdxs);
+
     //label the node count of computed ground grids 
 	//grow the travelable region
 	m_oCnfdnSolver.RegionGrow(m_vConfidenceMap,
 			                  vNearByIdxs,
 			                  m_oGMer,
-			                  m_iNodeTimes);
+			                  m_iNodeTimes,
+			                  m_oDirtyRect);
 
     //extract point clouds with different labels, respectively
     ExtractLabeledPCs(*pNearGrndClouds,
     	              *pNearBndryClouds,
     	              *pNearAllClouds,
+    	              vNearAllKeys,
 	                  vNearGrndGrdIdxs,
                       vNearByIdxs);
 
@@ -1142,18 +2184,18 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos,
     oDisTermDur = oDisTermDur + (double)(clock() - oBeforeDis)/ CLOCKS_PER_SEC;
 
     //in this case, robot position is based on odom frame, it need to be transfored to lidar sensor frame 
-    pcl::PointXYZ oPastView;
-    oPastView.x = oPastRobotPos.x;
-    oPastView.y = oPastRobotPos.y;
-    oPastView.z = oPastRobotPos.z + m_fViewZOffset;
+    std::vector<pcl::PointXYZ> vPastViews(vPastRobotPoses);
+    for (int i = 0; i != vPastViews.size(); ++i)
+    	vPastViews[i].z = vPastViews[i].z + m_fViewZOffset;
 
     //compute visibiity
     if(vNearGrndGrdIdxs.size() >= 3){
     	clock_t oBeforeVis = clock();
     	m_oCnfdnSolver.OcclusionTerm(m_vConfidenceMap,
 	                                   pNearAllClouds,
+	                                     vNearAllKeys,
 	                                 vNearGrndGrdIdxs,
-	                                        oPastView,
+	                                       vPastViews,
 	                                     m_iNodeTimes);
         oVisTermDur = oVisTermDur + (double)(clock() - oBeforeVis )/ CLOCKS_PER_SEC;
     }
@@ -1162,9 +2204,7 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos,
     //compute boundary term
     clock_t oBeforeBound = clock();
     m_oCnfdnSolver.BoundTerm(m_vConfidenceMap,
-                             vNearGrndGrdIdxs,
-	                         pNearGrndClouds,
-    	                     pNearBndryClouds);
+                             vNearGrndGrdIdxs);
     oBoundTermDur = oBoundTermDur + (double)(clock() - oBeforeBound)/ CLOCKS_PER_SEC;
 
     //publish result
@@ -1189,13 +2229,17 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos) {
 	                               m_oGMer.m_oFeatureMap,
 	                               m_oGMer.m_vRobotSearchMask,
 	                               oCurrRobotPos);
+
+	//the terms below only change the nearby grids, and the region grow adds its grown grids
+	m_oDirtyRect.Add(vNearByIdxs);
 	
     //label the node count of computed ground grids 
 	//grow the travelable region
 	m_oCnfdnSolver.RegionGrow(m_vConfidenceMap,
 			                  vNearByIdxs,
 			                  m_oGMer,
-			                  m_iNodeTimes);
+			                  m_iNodeTimes,
+			                  m_oDirtyRect);
 
     //extract point clouds with different labels, respectively
     ExtractLabeledPCs(*pNearGrndClouds,
@@ -1215,9 +2259,7 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos) {
     //compute boundary term
     clock_t oBeforeBound = clock();
     m_oCnfdnSolver.BoundTerm(m_vConfidenceMap,
-                             vNearGrndGrdIdxs,
-	                          pNearGrndClouds,
-    	                     pNearBndryClouds);
+                             vNearGrndGrdIdxs);
     oBoundTermDur = oBoundTermDur + (double)(clock() - oBeforeBound)/ CLOCKS_PER_SEC;
 
 
@@ -1238,8 +2280,11 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos) {
 	//PublishPointCloud(*pNearGrndClouds);//for test
 	//PublishPointCloud(*pNearBndryClouds);//for test
 
-    PublishPlanNodeClouds();
-    PublishPastNodeClouds();
+    //the nodes are being updated by the planning worker
+    if (!m_bPlanningFlag){
+    	PublishPlanNodeClouds();
+    	PublishPastNodeClouds();
+    }
 
 	//output result on screen
 	PublishGridMap();
@@ -1248,21 +2293,108 @@ void TopologyMap::ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos) {
 
 /*************************************************
 Function: PublishGridMap
-Description: constrcution function for TopologyMap class
-Calls: OutputCoverRateFile()
+Description: publish the grid map, a keyframe (whole map) periodically and the changed submap between two keyframes
+Calls: FillGridMapLayers
+       grid_map::GridMap::getSubmap
 Called By: ComputeConfidence()
 Table Accessed: none
 Table Updated: none
 Input: none
-Output: a grid map updating in rviz
+Output: a grid map updating in rviz (grid_map) and the submaps (grid_map_updates)
 Return: none
-Others: none
+Others: only the grids in m_oDirtyRect are filled unless the map is built, moved or restored,
+        a subscriber merges each submap into the last keyframe (e.g., grid_map::GridMap::addDataFrom),
+        thus the message size depends on the changed region rather than the map size
 *************************************************/
 
 void TopologyMap::PublishGridMap(){
 
+	grid_map::GridMap & oFeatureMap = m_oGMer.m_oFeatureMap;
+
+	ros::Time oNowTime = ros::Time::now();
+
+	bool bKeyframeFlag = m_bMapResetFlag || m_dKeyframePeriod <= 0.0 ||
+	                     oNowTime.toSec() - m_dLastKeyframeTime >= m_dKeyframePeriod;
+
+	//nothing is changed
+	if(!bKeyframeFlag && m_oDirtyRect.Empty())
+		return;
+
+	//the layers keep the values of last publishing, thus only the changed region is filled
+	if(m_bMapResetFlag)
+		m_oDirtyRect.SetAll(oFeatureMap.getSize()(0), oFeatureMap.getSize()(1));
+
+	int iTravelableNum = FillGridMapLayers(m_oDirtyRect);
+
+	//Output test (the count is of the filled grids)
+	//OutputCoverRateFile(iTravelableNum);
+
+    //output map files
+	//OutputMapFile();
+
+	oFeatureMap.setTimestamp(oNowTime.toNSec());
+
+	grid_map_msgs::GridMap oGridMapMessage;
+
+	if(bKeyframeFlag){
+
+		grid_map::GridMapRosConverter::toMessage(oFeatureMap, oGridMapMessage);
+		// Publish as grid map.
+		m_oGridMapPublisher.publish(oGridMapMessage);
+		m_dLastKeyframeTime = oNowTime.toSec();
+
+	}else{
+
+		//the corner grids of changed region
+		grid_map::Position oMinPos, oMaxPos;
+		oFeatureMap.getPosition(grid_map::Index(m_oDirtyRect.iMinRow, m_oDirtyRect.iMinCol), oMinPos);
+		oFeatureMap.getPosition(grid_map::Index(m_oDirtyRect.iMaxRow, m_oDirtyRect.iMaxCol), oMaxPos);
+
+		//one more grid of length, so that the submap border is not on the grid border and covers the region
+		double dResolution = oFeatureMap.getResolution();
+		grid_map::Length oSubLength(double(m_oDirtyRect.iMaxRow - m_oDirtyRect.iMinRow + 2) * dResolution,
+			                        double(m_oDirtyRect.iMaxCol - m_oDirtyRect.iMinCol + 2) * dResolution);
+
+		bool bSubmapFlag = false;
+		grid_map::GridMap oSubmap = oFeatureMap.getSubmap(0.5 * (oMinPos + oMaxPos), oSubLength, bSubmapFlag);
+
+		if(bSubmapFlag){
+			grid_map::GridMapRosConverter::toMessage(oSubmap, oGridMapMessage);
+			m_oGridMapUpdatePublisher.publish(oGridMapMessage);
+		}else{
+			//send the whole map next time
+			m_oDirtyRect.Clear();
+			m_bMapResetFlag = true;
+			return;
+		}
+
+	}//end else
+
+	m_oDirtyRect.Clear();
+	m_bMapResetFlag = false;
+
+}
+
+/*************************************************
+Function: FillGridMapLayers
+Description: write the confidence values of a region into the layers of grid map
+Calls: none
+Called By: PublishGridMap()
+Table Accessed: none
+Table Updated: none
+Input: oRect - the region (grid rows and columns)
+Output: the layers of m_oGMer.m_oFeatureMap in the region
+Return: the number of travelable ground grids in the region
+Others: none
+*************************************************/
+
+int TopologyMap::FillGridMapLayers(const GridRect & oRect){
+
 	int iTravelableNum = 0;
 
+	//read the map without allocating the unscanned tiles
+	const ConfidenceMap & vReadMap = m_vConfidenceMap;
+
     //push 
 	grid_map::Matrix& gridMapData1 = m_oGMer.m_oFeatureMap["elevation"];
 	grid_map::Matrix& gridMapData2 = m_oGMer.m_oFeatureMap["traversability"];
@@ -1273,28 +2405,28 @@ void TopologyMap::PublishGridMap(){
 	grid_map::Matrix& gridMapData7 = m_oGMer.m_oFeatureMap["quality"];
 
 	//initial elevation map and center point clouds
-	for (int i = 0; i != m_oGMer.m_oFeatureMap.getSize()(0); ++i) {//i
+	for (int i = oRect.iMinRow; i <= oRect.iMaxRow; ++i) {//i
 
-		for (int j = 0; j != m_oGMer.m_oFeatureMap.getSize()(1); ++j) {//j
+		for (int j = oRect.iMinCol; j <= oRect.iMaxCol; ++j) {//j
 
 			int iGridIdx = ExtendedGM::TwotoOneDIdx(i, j);
 
 		    //render travelable ground grid    
-			if(m_vConfidenceMap[iGridIdx].label == 2){
+			if(vReadMap[iGridIdx].label == 2){
  
                 //record the region that has been explored
-                if(m_vConfidenceMap[iGridIdx].travelable == 1)
+                if(vReadMap[iGridIdx].travelable == 1)
                 	iTravelableNum++;
 
                 //assign computed resultes
-		    	gridMapData1(i, j) = m_vConfidenceMap[iGridIdx].nodeCount;//.qualTerm
-		    	gridMapData2(i, j) = m_vConfidenceMap[iGridIdx].travelTerm;//.travelTerm
-		    	gridMapData3(i, j) = m_vConfidenceMap[iGridIdx].boundTerm;//.boundTerm
-		    	gridMapData4(i, j) = m_vConfidenceMap[iGridIdx].visiTerm.value;//.visiTerm
-		    	gridMapData5(i, j) = m_vConfidenceMap[iGridIdx].totalValue;//.totalValue
-		    	gridMapData6(i, j) = m_vConfidenceMap[iGridIdx].travelable;//.travelable
-		    	//gridMapData6(i, j) = m_oAstar.maze[i][j];//test only
-		    	//gridMapData7(i, j) = m_vConfidenceMap[iGridIdx].qualTerm;//quality term
+		    	gridMapData1(i, j) = vReadMap[iGridIdx].nodeCount;//.qualTerm
+		    	gridMapData2(i, j) = vReadMap[iGridIdx].travelTerm;//.travelTerm
+		    	gridMapData3(i, j) = vReadMap[iGridIdx].boundTerm;//.boundTerm
+		    	gridMapData4(i, j) = vReadMap[iGridIdx].visiTerm.value;//.visiTerm
+		    	gridMapData5(i, j) = vReadMap[iGridIdx].totalValue;//.totalValue
+		    	gridMapData6(i, j) = vReadMap[iGridIdx].travelable;//.travelable
+		    	//gridMapData6(i, j) = m_oAstar.IsObstacle(i, j);//test only
+		    	//gridMapData7(i, j) = vReadMap[iGridIdx].qualTerm;//quality term
             
 		   }else{
 		    	
@@ -1310,26 +2442,35 @@ void TopologyMap::PublishGridMap(){
 		   }//end else
 
             //quality is in boundary and obstacle grid
-		    gridMapData7(i, j) = m_vConfidenceMap[iGridIdx].qualTerm.means;//quality term
+		    gridMapData7(i, j) = vReadMap[iGridIdx].qualTerm.means;//quality term
 
 		}//end j
 
 	}//end i
 
-	//Output test
-	//OutputCoverRateFile(iTravelableNum);
+	return iTravelableNum;
 
-    //output map files
-	//OutputMapFile();
+}
 
-	ros::Time oNowTime = ros::Time::now();
+/*************************************************
+Function: MarkDirtyGrid
+Description: record a grid whose published values are changed
+Calls: ExtendedGM::OneDtoTwoDIdx
+Called By: SetGridLabel
+           IngestBoundCloud
+Table Accessed: none
+Table Updated: none
+Input: iGridIdx - the 1d index of grid
+Output: m_oDirtyRect - it covers the grid
+Return: none
+Others: the nearby grids of ComputeConfidence are added to m_oDirtyRect directly
+*************************************************/
 
-	m_oGMer.m_oFeatureMap.setTimestamp(oNowTime.toNSec());
+void TopologyMap::MarkDirtyGrid(const int & iGridIdx){
 
-	grid_map_msgs::GridMap oGridMapMessage;
-	grid_map::GridMapRosConverter::toMessage(m_oGMer.m_oFeatureMap, oGridMapMessage);
-	// Publish as grid map.
-	m_oGridMapPublisher.publish(oGridMapMessage);
+	grid_map::Index oGridIdx;
+	ExtendedGM::OneDtoTwoDIdx(oGridIdx, iGridIdx);
+	m_oDirtyRect.Add(oGridIdx(0), oGridIdx(1));
 
 }
 
@@ -1488,7 +2629,8 @@ Table Updated: none
 Input: none
 Output: none
 Return: none
-Others: none
+Others: the time stamp is taken once for a dump, 
+        the map for a restart is written by SaveCheckpoint in binary instead
 *************************************************/
 
 void TopologyMap::OutputMapFile(){
@@ -1508,22 +2650,28 @@ void TopologyMap::OutputMapFile(){
 	//output
 	m_oMapFile.open(m_sMapFileName.str(), std::ios::out | std::ios::ate);
 
+	//read the map without allocating the unscanned tiles
+	const ConfidenceMap & vReadMap = m_vConfidenceMap;
+
+	//all lines of a dump have the same time stamp
+	ros::Time oDumpTime = ros::Time::now();
+
 	//output in a txt file
     //the storage type of output file is x y z time frames right/left_sensor
-    for(int i = 0; i != m_vConfidenceMap.size(); ++i){
-
-    	if(m_vConfidenceMap[i].travelable == 1){
-
-    		m_oMapFile << m_vConfidenceMap[i].oCenterPoint.x << " "
-                     << m_vConfidenceMap[i].oCenterPoint.y << " "
-		             << m_vConfidenceMap[i].oCenterPoint.z << " "
-		             << m_vConfidenceMap[i].travelTerm << " "
-		             << m_vConfidenceMap[i].boundTerm  << " "
-                     << m_vConfidenceMap[i].totalValue << " "//initial each grid as not need to move there
-                     << m_vConfidenceMap[i].visiTerm.value << " "
-                     << m_vConfidenceMap[i].qualTerm.means << " "
-                     << ros::Time::now() << " "
-                     << std::endl;
+    for(int i = 0; i != vReadMap.size(); ++i){
+
+    	if(vReadMap[i].travelable == 1){
+
+    		m_oMapFile << vReadMap[i].oCenterPoint.x << " "
+                     << vReadMap[i].oCenterPoint.y << " "
+		             << vReadMap[i].oCenterPoint.z << " "
+		             << vReadMap[i].travelTerm << " "
+		             << vReadMap[i].boundTerm  << " "
+                     << vReadMap[i].totalValue << " "//initial each grid as not need to move there
+                     << vReadMap[i].visiTerm.value << " "
+                     << vReadMap[i].qualTerm.means << " "
+                     << oDumpTime << " "
+                     << "\n";
         }
     }
 
@@ -1541,7 +2689,7 @@ Table Updated: none
 Input: iTravelableNum - the counted number of ground grids 
 Output: none
 Return: none
-Others: none
+Others: the line is written by m_oLogWriter in background
 *************************************************/
 void TopologyMap::OutputCoverRateFile(const int & iTravelableNum){
 
@@ -1552,17 +2700,17 @@ void TopologyMap::OutputCoverRateFile(const int & iTravelableNum){
         //full name 
 		m_sCoverFileName << m_sFileHead << "CoverRes_" << ros::Time::now() << ".txt"; 
 
+		m_oLogWriter.Open(COVER_LOG, m_sCoverFileName.str());
+
 		m_bCoverFileFlag = true;
         //print coverage rate evaluation message
 		std::cout << "Attention a coverage rate evaluation file is created in " << m_sCoverFileName.str() << std::endl;
 	}
 
-	//output
-	m_oCoverFile.open(m_sCoverFileName.str(), std::ios::out | std::ios::app);
-
-	//output in a txt file
+	//output in a txt file, which is written by the log writer
     //the storage type of output file is x y z time frames right/left_sensor
-    m_oCoverFile << iTravelableNum << " "
+	std::stringstream sCoverLine;
+    sCoverLine << iTravelableNum << " "
                  << ros::Time::now() << " "
                  << oDisTermDur << " "
                  << oBoundTermDur << " "
@@ -1570,9 +2718,9 @@ void TopologyMap::OutputCoverRateFile(const int & iTravelableNum){
                  << oNodeDur << " "
                  << oFractTermDur << " "
                  << oLocalPathTermDur << " "
-                 << std::endl;
+                 << "\n";
 
-    m_oCoverFile.close();
+    m_oLogWriter.WriteText(COVER_LOG, sCoverLine.str());
 
 }
 
@@ -1581,13 +2729,13 @@ void TopologyMap::OutputCoverRateFile(const int & iTravelableNum){
 Function: OutputTrajectoryFile
 Description: output the odometry position in a txt file
 Calls: none
-Called By: HandleTrajectory
+Called By: ProcessTrajectory
 Table Accessed: none
 Table Updated: none
 Input: oTrajectory - odometry data in ros type
 Output: a trajectory txt file
 Return: none
-Others: none
+Others: the line is written by m_oLogWriter in background
 *************************************************/
 
 void TopologyMap::OutputTrajectoryFile(const nav_msgs::Odometry & oTrajectory){
@@ -1599,23 +2747,23 @@ void TopologyMap::OutputTrajectoryFile(const nav_msgs::Odometry & oTrajectory){
         //full name 
 		m_sOutTrajFileName << m_sFileHead << "Traj_" << oTrajectory.header.stamp << ".txt"; 
 
+		m_oLogWriter.Open(TRAJ_LOG, m_sOutTrajFileName.str());
+
 		m_bOutTrajFileFlag = true;
         //print output file generation message
 		std::cout << "[*] Attention a trajectory recording file is created in " << m_sOutTrajFileName.str() << std::endl;
 	}
 
-	//output
-	m_oTrajFile.open(m_sOutTrajFileName.str(), std::ios::out | std::ios::app);
-
-	//output in a txt file
+	//output in a txt file, which is written by the log writer
 	//the storage type of output file is x y z time frames 
-    m_oTrajFile << oTrajectory.pose.pose.position.x << " "
-                << oTrajectory.pose.pose.position.y << " "
-                << oTrajectory.pose.pose.position.z << " " 
-                << oTrajectory.header.stamp << " "
-                << std::endl;
+	std::stringstream sTrajLine;
+    sTrajLine << oTrajectory.pose.pose.position.x << " "
+              << oTrajectory.pose.pose.position.y << " "
+              << oTrajectory.pose.pose.position.z << " " 
+              << oTrajectory.header.stamp << " "
+              << "\n";
 
-    m_oTrajFile.close();
+    m_oLogWriter.WriteText(TRAJ_LOG, sTrajLine.str());
 
 }
 
@@ -1624,46 +2772,35 @@ void TopologyMap::OutputTrajectoryFile(const nav_msgs::Odometry & oTrajectory){
 Function: OutputScannedPCFile
 Description: output scanned point clouds in a txt file
 Calls: none
-Called By: HandleTrajectory
+Called By: IngestBoundCloud
+           IngestObstacleCloud
 Table Accessed: none
 Table Updated: none
-Input: vCloud - one frame scanning point cloud data
-Output: a point cloud txt file
+Input: pCloud - one frame scanning point cloud data
+Output: a point cloud txt (or binary) file
 Return: none
-Others: none
+Others: the cloud should not be changed after this call, since it is written by m_oLogWriter in background
 *************************************************/
-void TopologyMap::OutputScannedPCFile(pcl::PointCloud<pcl::PointXYZ> & vCloud){
+void TopologyMap::OutputScannedPCFile(const CloudPtr & pCloud){
   
     //generate a output file if possible
 	if(!m_bOutPCFileFlag){
 
 	    //set the current time stamp as a file name
         //full name 
-		m_sOutPCFileName << m_sFileHead << "PC_" << ros::Time::now() << ".txt"; 
+		m_sOutPCFileName << m_sFileHead << "PC_" << ros::Time::now() << (m_bBinaryCloudLogFlag ? ".bin" : ".txt"); 
+
+		m_oLogWriter.Open(CLOUD_LOG, m_sOutPCFileName.str(), m_bBinaryCloudLogFlag);
 
 		m_bOutPCFileFlag = true;
         //print output file generation message
 		std::cout << "[*] Attention, a point cloud recording file is created in " << m_sOutPCFileName.str() << std::endl;
 	}
 
-    //output
-	m_oPCFile.open(m_sOutPCFileName.str(), std::ios::out | std::ios::app);
-
-	//output in a txt file
-	//the storage type of output file is x y z time frames 
-    //record the point clouds
-    for(int i = 0; i != vCloud.size(); ++i ){
-
-        //output in a txt file
-        //the storage type of output file is x y z time frames right/left_sensor
-        m_oPCFile << vCloud.points[i].x << " "
-                  << vCloud.points[i].y << " "
-                  << vCloud.points[i].z << " " 
-                  << m_iRecordPCNum << " " 
-                  << std::endl;
-    }//end for         
-
-    m_oPCFile.close();
+	//the frame is formatted and written by the log writer, it only keeps the pointer
+	//the storage type of output file is x y z frames in text, or a binary record of each frame
+    if(!m_oLogWriter.WriteCloud(CLOUD_LOG, pCloud, m_iRecordPCNum))
+    	ROS_WARN_THROTTLE(5.0, "The point cloud log is busy, [%u] records are dropped", m_oLogWriter.DroppedNum());
 
     //count new point cloud input (plus frame) 
     m_iRecordPCNum++;
@@ -3,6 +3,12 @@
 #define TOPOLOGYMAP_H
 #include <string>
 #include <ctime>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 //ros related
 #include <ros/ros.h>
@@ -16,6 +22,9 @@
 
 #include "Astar.h"
 #include "LocalPathOptimization.h"
+#include "SpscQueue.h"
+#include "MapCheckpoint.h"
+#include "LogWriter.h"
 
 //octomap related
 //#include <octomap/octomap.h>
@@ -41,12 +50,58 @@ namespace topology_map{
 // 
 // created and edited by Huang Pengdi, 2019.04.07
 // Email: alualu628628@gmail.com
+//
+// the callbacks only convert and queue the messages,
+// the map is updated by a map worker and the goal is planned by a planning worker
 //******************************************************************
 
+//the log files written by the log writer, each one has a single producer thread
+//the node log is written by the planning worker and the others by the map worker
+enum LogChannelType{
+
+  TRAJ_LOG = 0,
+  NODE_LOG,
+  COVER_LOG,
+  CLOUD_LOG,
+  LOG_CHANNEL_NUM
+
+};
+
+//a planning request from the map worker and its result from the planning worker
+//the planning worker only reads the snapshot in it, so the map can be updated meanwhile
+struct PlanJob{
+
+  //snapshot of the confidence map when the robot reaches the goal
+  ConfidenceMap vConfidenceMap;
+
+  //robot position and node times of this decision
+  pcl::PointXYZ oRobotPos;
+  unsigned int iNodeTimes;
+
+  //new nodes found by non-minimum suppression
+  std::vector<int> vNewNodeIdxs;
+  std::vector<pcl::PointXYZ> vNodeClouds;
+
+  //**result**
+  //the next node goal
+  pcl::PointXYZ oNodeGoal;
+  //the local path to the goal
+  bool bAnchorGoalFlag;
+  pcl::PointCloud<pcl::PointXYZ> vAncherGoals;
+  //whether the next trip begins
+  bool bNextTripFlag;
+
+  PlanJob():iNodeTimes(0), bAnchorGoalFlag(false), bNextTripFlag(false){};
+
+};
+
 class TopologyMap{
 
  public:
 
+  //a point cloud frame shared by the queues, the map worker and the log writer
+  typedef pcl::PointCloud<pcl::PointXYZ>::Ptr CloudPtr;
+
   //*************Initialization function*************
   //Constructor
   TopologyMap(ros::NodeHandle & node,
@@ -61,14 +116,55 @@ class TopologyMap{
   //Initialize a fixed Grid Map
   void InitializeGridMap(const pcl::PointXYZ & oRobotPos);
 
+  //move the map and its data with the robot by whole tiles (rolling map)
+  void RecenterMap(const pcl::PointXYZ & oRobotPos);
+
+  //the file of a tile moved out of the rolling map
+  std::string TileFileName(const std::string & sLayer,
+                           const int & iTileRow,
+                           const int & iTileCol);
+
+  //write a confidence tile moved out of map into file and read it back
+  void EvictConfidenceTile(const int & iTileRow,
+                           const int & iTileCol,
+                           ConfidenceTile & vTile);
+
+  bool LoadConfidenceTile(const int & iTileRow,
+                          const int & iTileCol,
+                          ConfidenceTile & vTile);
+
+  //write a point index tile moved out of map into file together with its points (and labels) and read it back
+  void EvictPointTile(const std::string & sLayer,
+          const pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
+                     const std::vector<int> * pCloudLabels,
+                                   const int & iTileRow,
+                                   const int & iTileCol,
+                   std::vector<std::vector<int> > & vTile);
+
+  bool LoadPointTile(const std::string & sLayer,
+                pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
+                                std::vector<int> * pCloudLabels,
+                                  const int & iTileRow,
+                                  const int & iTileCol,
+                  std::vector<std::vector<int> > & vTile);
+
+  //the checkpoint file of exploration state
+  std::string CheckpointFileName();
+
+  //take a snapshot of exploration state and write it in background
+  void SaveCheckpoint(bool bForceFlag = false);
+
+  //restore the exploration state from the checkpoint, return false if there is no valid one
+  bool ResumeCheckpoint(const pcl::PointXYZ & oRobotPos);
+
   //down sample the point clouds with grid idxs
   void SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
-                          std::vector<std::vector<int> > & vPointMapIdx,
+                          TiledMap<std::vector<int> > & vPointMapIdx,
                                                        int iSmplNum = 3);
 
   //down sampling the point clouds with grid idxs and corresponding labels
   void SamplingPointClouds(pcl::PointCloud<pcl::PointXYZ>::Ptr & pCloud,
-                          std::vector<std::vector<int> > & vPointMapIdx,
+                          TiledMap<std::vector<int> > & vPointMapIdx,
                                         std::vector<int> & vCloudLabels,
                                                        int iSmplNum = 3);
 
@@ -87,6 +183,7 @@ class TopologyMap{
   void ExtractLabeledPCs(pcl::PointCloud<pcl::PointXYZ> & vNearGrndClouds,
                         pcl::PointCloud<pcl::PointXYZ> & vNearBndryClouds,
                           pcl::PointCloud<pcl::PointXYZ> & vNearAllClouds,
+                                 std::vector<long long> & vNearAllKeys,
                                    std::vector<int> & vNearGroundGridIdxs,
                                 const std::vector<MapIndex> & vNearByIdxs);
 
@@ -110,19 +207,61 @@ class TopologyMap{
   //handle the obstacle point cloud topic
   void HandleObstacleClouds(const sensor_msgs::PointCloud2 & vObstacleRosData);
 
+  //*************worker function*************
+  //start and stop the map worker and planning worker
+  void StartWorkers();
+  void StopWorkers();
+
+  //the loop of map worker, it consumes the queues of callbacks
+  void MapWorkerLoop();
+
+  //the loop of planning worker
+  void PlanWorkerLoop();
+
+  //update the map with a queued odometry, it is the backbone of the class
+  void ProcessTrajectory(const nav_msgs::Odometry & oTrajectory);
+
+  //update the map with a queued point cloud frame
+  void IngestGroundCloud(const CloudPtr & pOneGCloud);
+
+  void IngestBoundCloud(const CloudPtr & pOneBCloud);
+
+  void IngestObstacleCloud(const CloudPtr & pOneOCloud);
+
+  //send a snapshot to the planning worker
+  void RequestPlan();
+
+  //plan the next goal on a snapshot (planning worker)
+  void PlanNextGoal(PlanJob & oJob);
+
+  //take the result of planning worker if it is done (map worker)
+  void ApplyPlanResult();
+
+  //set the label of a grid and keep the obstacle bits of astar map consistent
+  void SetGridLabel(const int & iGridIdx, const int & iLabel);
+
   //update octomap octree nodes
   //void UpdatingOctomapNodes();
 
   //*************Feature calculation function (Subject function)*************
   void ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos,
-                         const pcl::PointXYZ & oPastRobotPos);
+                         const std::vector<pcl::PointXYZ> & vPastRobotPoses);
 
   void ComputeConfidence(const pcl::PointXYZ & oCurrRobotPos);
+
+  //select the past viewpoints of occlusion calculation from the history odometry
+  void SelectPastViews(std::vector<pcl::PointXYZ> & vPastRobotPoses);
   
   //*************Output function*************
-  //publish grid map
+  //publish grid map, a keyframe (whole map) or the changed submap
   void PublishGridMap();
 
+  //write the confidence values of a region into the layers of grid map
+  int FillGridMapLayers(const GridRect & oRect);
+
+  //record a grid whose published values are changed
+  void MarkDirtyGrid(const int & iGridIdx);
+
   //publish recevied octomap
   //void PublishOctoMap(octomap::OcTree* pOctomap);
   
@@ -148,7 +287,7 @@ class TopologyMap{
   void OutputTrajectoryFile(const nav_msgs::Odometry & oTrajectory);
 
   //publish scanned/obtained point clouds
-  void OutputScannedPCFile(pcl::PointCloud<pcl::PointXYZ> & vCloud); 
+  void OutputScannedPCFile(const CloudPtr & pCloud);
 
  private:
 
@@ -158,7 +297,6 @@ class TopologyMap{
 
   std::stringstream m_sCoverFileName; ///<full name of output txt that records the point clouds//defind it in the function
   bool m_bCoverFileFlag; //whether the coverage file got a full name or not 
-  std::ofstream m_oCoverFile;
 
   std::stringstream m_sMapFileName; ///<full name of output txt that records the point clouds//defind it in the function
   bool m_bMapFileFlag; //whether the coverage file got a full name or not 
@@ -166,15 +304,16 @@ class TopologyMap{
 
   std::stringstream m_sOutTrajFileName;///<full name of output txt that records the trajectory point 
   bool m_bOutTrajFileFlag;//whether the trajectory file got a full name or not 
-  std::ofstream m_oTrajFile;
 
   std::stringstream m_sOutPCFileName;///<full name of output txt that records the scanning point clouds 
   bool m_bOutPCFileFlag;//whether the point cloud recording file got a full name or not 
-  std::ofstream m_oPCFile;
+  bool m_bBinaryCloudLogFlag;//whether the point clouds are recorded in binary records or in text
 
   std::stringstream m_sOutNodeFileName;///<full name of output txt that records the visited node position 
   bool m_bOutNodeFileFlag;//whether the point cloud recording file got a full name or not 
-  std::ofstream m_oNodeFile;
+
+  //the writer of log files (trajectory, node, coverage and point cloud), it writes them in background
+  LogWriter m_oLogWriter;
 
   //input topics:
   ros::Subscriber m_oOdomSuber;//the subscirber is to hear (record) odometry from gazebo
@@ -193,7 +332,17 @@ class TopologyMap{
 
   //**output topics related**
 
-  ros::Publisher m_oGridMapPublisher;//! Grid map publisher.
+  ros::Publisher m_oGridMapPublisher;//! Grid map publisher (keyframes, latched).
+
+  ros::Publisher m_oGridMapUpdatePublisher;// publisher of the changed submaps between two keyframes
+
+  //the region changed since last publishing, only it is filled and sent between two keyframes
+  GridRect m_oDirtyRect;
+  //a keyframe (whole map) is sent in this period (second), 0 means each publishing is a keyframe
+  double m_dKeyframePeriod;
+  double m_dLastKeyframeTime;
+  //the whole map is filled and sent next time, since it is built, moved or restored
+  bool m_bMapResetFlag;
 
   //ros::Publisher m_oOctomapPublisher; //! Octomap publisher.
   //publishing point cloud is only for test
@@ -225,6 +374,10 @@ class TopologyMap{
 
   int m_iPastOdomNum; //the past view interval number for occlusion calculation
 
+  int m_iPastViewNum; //the number of past viewpoints observed in each occlusion calculation
+
+  unsigned int m_iOdomViewCount; //the number of odometry points pushed into m_vOdomViews
+
   int m_iShockNum;//the shock duration that robot can tolerate 
 
   int m_iRecordPCNum;//the times of recording point cloud frame (any category) in output file
@@ -242,7 +395,7 @@ class TopologyMap{
 
   //**point cloud related**
   //the positions of robot
-  std::queue<pcl::PointXYZ> m_vOdomViews;//I dont think it is necessary to use a circle vector
+  std::deque<pcl::PointXYZ> m_vOdomViews;//the past viewpoints are picked from it
   std::queue<pcl::PointXYZ> m_vOdomShocks;
   
   pcl::PointCloud<pcl::PointXYZ>::Ptr m_pBoundCloud;//boundary point clouds
@@ -250,19 +403,31 @@ class TopologyMap{
   std::vector<int> m_vObstNodeTimes;//records the acquired times (node times) of each obstacle point
 
   //std::vector<std::vector<int> > m_vGroundPntMapIdx;//ground point index in grid map
-  std::vector<std::vector<int> > m_vBoundPntMapIdx;//boundary point index in grid map
-  std::vector<std::vector<int> > m_vObstlPntMapIdx;//obstacle point index in grid map
+  TiledMap<std::vector<int> > m_vBoundPntMapIdx;//boundary point index in grid map
+  TiledMap<std::vector<int> > m_vObstlPntMapIdx;//obstacle point index in grid map
 
   //the map - main body 
   ExtendedGM m_oGMer;
 
   Confidence m_oCnfdnSolver;//confidence object
 
-  std::vector<ConfidenceValue> m_vConfidenceMap;//Confidence value map
+  ConfidenceMap m_vConfidenceMap;//Confidence value map
 
   //the grid map initialization flag indicates whether the map has been simply established
   bool m_bGridMapReadyFlag;
 
+  //rolling map, the map is moved by whole tiles if the robot is closer to its border than the margin
+  bool m_bRollingMapFlag;
+  float m_fRollingMargin;
+
+  //checkpoint, the period (second) of writing a snapshot, 0 means no checkpoint
+  double m_dCheckpointPeriod;
+  double m_dLastCheckpointTime;
+  //resume the exploration from the checkpoint at startup
+  bool m_bResumeFlag;
+  //the background writer of checkpoint
+  MapCheckpoint m_oCheckpoint;
+
   //a node object
   OP m_oOPSolver;
 
@@ -296,6 +461,35 @@ class TopologyMap{
   double oNodeDur;
   double oFractTermDur;
   double oLocalPathTermDur;
+
+  //**worker related**
+  //queues from callbacks to the map worker, one producer (callback) for each
+  SpscQueue<nav_msgs::Odometry> m_vOdomQueue;
+  SpscQueue<CloudPtr> m_vGroundQueue;
+  SpscQueue<CloudPtr> m_vBoundQueue;
+  SpscQueue<CloudPtr> m_vObstacleQueue;
+
+  //queues between the map worker and the planning worker
+  SpscQueue<std::shared_ptr<PlanJob> > m_vPlanJobs;
+  SpscQueue<std::shared_ptr<PlanJob> > m_vPlanResults;
+
+  //a planning job is running, the planner owns m_oOPSolver, m_oAstar and the grid geometry meanwhile
+  //it is only used by the map worker
+  bool m_bPlanningFlag;
+  //the obstacle bits set during planning, which are applied to m_oAstar after it
+  std::vector<std::pair<int, bool> > m_vPendingObstacles;
+
+  //the frames dropped since a queue is full
+  std::atomic<unsigned int> m_iDroppedFrames;
+
+  //workers, the condition variables only wake them up earlier than the polling timeout
+  std::thread m_oMapWorker;
+  std::thread m_oPlanWorker;
+  std::atomic<bool> m_bStopFlag;
+  std::mutex m_oMapWakeMutex;
+  std::condition_variable m_oMapWakeCond;
+  std::mutex m_oPlanWakeMutex;
+  std::condition_variable m_oPlanWakeCond;
   
 };
 
@@ -8,7 +8,11 @@ int main(int argc, char** argv){
   
   topology_map::TopologyMap TopologyMapping(node,privateNode);
 
-  ros::spin();
+  //one thread for each subscriber, the callbacks only queue the messages
+  //and the map update and planning run in the workers of TopologyMap
+  ros::AsyncSpinner oSpinner(4);
+  oSpinner.start();
+  ros::waitForShutdown();
 
   return 0;
 }